@@ -259,7 +259,7 @@ bool
 Analyze::setScore(uint const xAway, uint const oAway)
 {
   if( xAway == 0 && oAway == 0 ) {
-    Equities::match.reset();
+    Equities::match().reset();
     matchRange = 0;
     
     return true;
@@ -267,9 +267,9 @@ Analyze::setScore(uint const xAway, uint const oAway)
 
   // set cube to 1, non crawford
   
-  bool const ok = Equities::match.set(xAway, oAway, 1, false, 0);
+  bool const ok = Equities::match().set(xAway, oAway, 1, false, 0);
   
-  matchRange = Equities::match.range();
+  matchRange = Equities::match().range();
   
   return ok;
 }
@@ -292,24 +292,24 @@ Analyze::setScore(uint const xScore, uint const oScore, uint const matchLen)
 void
 Analyze::setCube(uint const cube, bool const xOwns)
 {
-  Equities::match.set(0, 0, cube, xOwns, -1);
+  Equities::match().set(0, 0, cube, xOwns, -1);
   
-  matchRange = Equities::match.range();
+  matchRange = Equities::match().range();
 }
 
 void
 Analyze::crawford(bool const on)
 {
-  Equities::match.set(0, 0, 0, false, on);
+  Equities::match().set(0, 0, 0, false, on);
   
-  matchRange = Equities::match.range();
+  matchRange = Equities::match().range();
 }
 
 float
 Analyze::matchEquity(void) const
 {
-  return Equities::prob(Equities::match.xAway,
-			Equities::match.oAway, Equities::match.crawfordGame);
+  return Equities::prob(Equities::match().xAway,
+			Equities::match().oAway, Equities::match().crawfordGame);
 }
 
 // direction  -> O (+) -> 0, X (-) -> 1
@@ -484,7 +484,7 @@ Analyze::analyze(Result&                r,
   r.nMoves = ml.cMoves;
     
   
-  static float sp[NUM_OUTPUTS];
+  static THREAD_LOCAL float sp[NUM_OUTPUTS];
   
   if( r.nMoves > 0 ) {
     r.actualMove = ml.cMoves+1;
@@ -570,14 +570,14 @@ Analyze::analyze(Result&                r,
     }
   }
 
-  uint const xAway = Equities::match.xAway;
-  uint const oAway = Equities::match.oAway;
-  uint const cube = Equities::match.cube;
-  bool const xOwns = Equities::match.xOwns;
+  uint const xAway = Equities::match().xAway;
+  uint const oAway = Equities::match().oAway;
+  uint const cube = Equities::match().cube;
+  bool const xOwns = Equities::match().xOwns;
   
   // not crawford, not first move and not 1,1 away
   
-  bool wantToDouble = (!Equities::match.crawfordGame &&
+  bool wantToDouble = (!Equities::match().crawfordGame &&
 		       !firstMove && !(xAway == 1 && oAway == 1));
 
   if( wantToDouble ) {
@@ -619,7 +619,7 @@ Analyze::analyze(Result&                r,
 		       xOnPlay ? xAway : oAway,
 		       xOnPlay ? oAway : xAway,
 		       xOwns == xOnPlay,
-		       Equities::match.crawfordGame, firstMove,
+		       Equities::match().crawfordGame, firstMove,
 		       cubeLife);
 
     r.rollLuck = xOnPlay ? l : -l;
@@ -762,23 +762,23 @@ Analyze::analyze(R1&               r,
     r.matchProbNoDouble =
       Equities::equityToProb(*rolloutCubefull(b, 0, r.nRolloutGames, xOnPlay));
 
-    uint& cube = Equities::match.cube;
+    uint& cube = Equities::match().cube;
 
-    Equities::match.set(0, 0, 2*cube, !xOnPlay, -1);
+    Equities::match().set(0, 0, 2*cube, !xOnPlay, -1);
     
     r.matchProbDoubleTake =
       Equities::equityToProb(*rolloutCubefull(b, 0, r.nRolloutGames, xOnPlay));
     
-    Equities::match.set(0, 0, cube/2, xOnPlay, -1);
+    Equities::match().set(0, 0, cube/2, xOnPlay, -1);
 
     {
       // away for doubler
       uint const onPlayAway =
-	xOnPlay ? Equities::match.xAway : Equities::match.oAway;
+	xOnPlay ? Equities::match().xAway : Equities::match().oAway;
 
       // away for opponent
       uint const opAway =
-	xOnPlay ? Equities::match.oAway : Equities::match.xAway;
+	xOnPlay ? Equities::match().oAway : Equities::match().xAway;
 
       r.matchProbDoubleDrop =
 	Equities::equityToProb(Equities::value(onPlayAway - cube, opAway));
@@ -841,22 +841,22 @@ Analyze::srandom(unsigned long const l)
   sgenrand(l);
 }
 
-const float*
-Analyze::rolloutCubefull(GNUbgBoard  const  board,
-			 uint const         nPlies,
-			 uint               nGames,
-			 bool const         xOnPlay)
+namespace {
+/// Play one game of a cubeful rollout from @arg{board} at the current match
+/// score, and leave in @arg{mcw} the match equity for X and in @arg{iMcw} how
+/// the game ended (as indexed in the result of @ref{rolloutCubefull}). The
+/// cube turns change the match state of the calling thread.
+//
+template<class Dice> void
+cubefulGame(Dice&                      diceGen,
+	    Analyze::GNUbgBoard const  board,
+	    bool const                 xOnPlay,
+	    uint const                 nPlies,
+	    float&                     mcw,
+	    uint&                      iMcw)
 {
-  static float amcw[1 + 2*6];
+  MatchState const& state = Equities::match();
   
-  MatchState initialMatchState = Equities::match;
-  MatchState const& state = Equities::match;
-
-  for(uint k = 0; k < 13; ++k) {
-    amcw[k] = 0;
-  }
-  
-  float& outMcw = amcw[0];
   uint const xWinsAtCube = xOnPlay ? 1 : 4;
   uint const xWinsDT = xOnPlay ? 2 : 5;
   uint const xWinsDD = xOnPlay ? 3 : 6;
@@ -867,121 +867,197 @@ Analyze::rolloutCubefull(GNUbgBoard  const  board,
   
   int dice[2];
 
-  R1 di;
+  Analyze::R1 di;
   di.nPlies = 0;
   
-  for(uint ng = 0; ng < nGames; ++ng) {
-    GNUbgBoard boardEval;
-    memcpy(&boardEval[0][0], &board[0][0], sizeof(boardEval) );
+  Analyze::GNUbgBoard boardEval;
+  memcpy(&boardEval[0][0], &board[0][0], sizeof(boardEval) );
 
-    bool xToPlay = xOnPlay;
-    bool first = true;
+  bool xToPlay = xOnPlay;
+  bool first = true;
     
-    float mcw = -2;
-    uint iMcw = 0;
+  mcw = -2;
+  iMcw = 0;
 
-    if( ng ) {
-      diceGen.next();
-    }
-
-    while( gameOn(boardEval) ) {
-      // Never consider a double on the first move. rollout starts after dice
-      // roll. User can set the cube via match state, so we get the right
-      // answer for the no-double cases.
+  while( Analyze::gameOn(boardEval) ) {
+    // Never consider a double on the first move. rollout starts after dice
+    // roll. User can set the cube via match state, so we get the right
+    // answer for the no-double cases.
       
-      if( (state.cube == 1 || (xToPlay == state.xOwns)) && ! first ) {
+    if( (state.cube == 1 || (xToPlay == state.xOwns)) && ! first ) {
 
-	di.analyze(boardEval, xToPlay, 0);
+      di.analyze(boardEval, xToPlay, 0);
 
-	if( di.actionDouble ) {
-	  if( di.actionTake ) {
-	    setCube(2*state.cube, xToPlay ? false : true);
+      if( di.actionDouble ) {
+	if( di.actionTake ) {
+	  Equities::match().set(0, 0, 2*state.cube, xToPlay ? false : true, -1);
 
-	    if( iMcw == 0 ) {
-	      iMcw = xToPlay ? xWinsDT : oWinsDT;
-	    }
+	  if( iMcw == 0 ) {
+	    iMcw = xToPlay ? xWinsDT : oWinsDT;
+	  }
 
-	    if( state.cubeDead() ) {
-	      break;
-	    }
-	  } else {
-	    if( iMcw == 0 ) {
-	      iMcw = xToPlay ? xWinsDD : oWinsDD;
-	    }
-	    
-	    mcw = Equities::value(state.xAway - (xToPlay ? state.cube : 0),
-				  state.oAway - (xToPlay ? 0 : state.cube));
+	  if( state.cubeDead() ) {
 	    break;
 	  }
+	} else {
+	  if( iMcw == 0 ) {
+	    iMcw = xToPlay ? xWinsDD : oWinsDD;
+	  }
+	    
+	  mcw = Equities::value(state.xAway - (xToPlay ? state.cube : 0),
+				state.oAway - (xToPlay ? 0 : state.cube));
+	  break;
 	}
       }
+    }
 
-      diceGen.get(dice);
+    diceGen.get(dice);
 
-      if( first ) {
-	if( state.cubeDead() ) {
-	  nGames = 1;
-	  break;
-	}
-
-	first = false;
+    if( first ) {
+      // cube dead, the rollout is one game
+      if( state.cubeDead() ) {
+	break;
       }
 
-      findBestMove(0, dice[0], dice[1], boardEval, xToPlay, nPlies);
+      first = false;
+    }
+
+    findBestMove(0, dice[0], dice[1], boardEval, xToPlay, nPlies);
 
-      xToPlay = !xToPlay;
+    xToPlay = !xToPlay;
     
-      SwapSides(boardEval);
-    }
+    SwapSides(boardEval);
+  }
 
-    if( mcw < -1 ) {
-      float p[NUM_OUTPUTS];
+  if( mcw < -1 ) {
+    float p[NUM_OUTPUTS];
 
-      EvaluatePosition(boardEval, p, 2, 0, xToPlay, 0, 0, 0/*fixme*/);
+    EvaluatePosition(boardEval, p, 2, 0, xToPlay, 0, 0, 0/*fixme*/);
 
-      if( !xToPlay ) {
-	InvertEvaluation(p);
-      }
+    if( !xToPlay ) {
+      InvertEvaluation(p);
+    }
 
-      float const xWins = p[WIN];
-      float const xWinsGammon = p[WINGAMMON];
-      float const oWins = 1 - xWins;
-      float const oWinsGammon = p[LOSEGAMMON];
+    float const xWins = p[WIN];
+    float const xWinsGammon = p[WINGAMMON];
+    float const oWins = 1 - xWins;
+    float const oWinsGammon = p[LOSEGAMMON];
 
-      float const ogr = (oWins > 0) ? oWinsGammon / oWins : 0.0;
-      float const xgr = (xWins > 0) ? xWinsGammon / xWins : 0.0;
+    float const ogr = (oWins > 0) ? oWinsGammon / oWins : 0.0;
+    float const xgr = (xWins > 0) ? xWinsGammon / xWins : 0.0;
 
-      float const xBGammons =  p[WINBACKGAMMON];
-      float const xbgr = xWinsGammon > 0 ? (xBGammons / xWinsGammon) : 0.0;
+    float const xBGammons =  p[WINBACKGAMMON];
+    float const xbgr = xWinsGammon > 0 ? (xBGammons / xWinsGammon) : 0.0;
 
-      float const oBGammons = p[LOSEBACKGAMMON];
-      float const obgr = oWinsGammon > 0 ? (oBGammons / oWinsGammon) : 0.0;
+    float const oBGammons = p[LOSEBACKGAMMON];
+    float const obgr = oWinsGammon > 0 ? (oBGammons / oWinsGammon) : 0.0;
       
-      mcw =
-	xWins * Equities::eWhenWin(xgr, xbgr,
-				   state.xAway, state.oAway, state.cube) +
-	oWins * Equities::eWhenLose(ogr, obgr,
-				    state.xAway, state.oAway, state.cube);
-
-      if( iMcw == 0 ) {
-	iMcw = xToPlay ? oWinsAtCube : xWinsAtCube;
-      }
+    mcw =
+      xWins * Equities::eWhenWin(xgr, xbgr,
+				 state.xAway, state.oAway, state.cube) +
+      oWins * Equities::eWhenLose(ogr, obgr,
+				  state.xAway, state.oAway, state.cube);
+
+    if( iMcw == 0 ) {
+      iMcw = xToPlay ? oWinsAtCube : xWinsAtCube;
     }
+  }
+}
 
-    // mcw accumulated for X, result is for side on play
+/// Cubeful rollout games played by @ref{cubefulOneGame}.
+//
+struct CubefulGames {
+  Analyze::GNUbgBoard 		board;
+  bool 				xOnPlay;
+  uint 				nPlies;
+  uint 				nGames;
+  unsigned long 		seed;
+
+  /// Match equity for X and end of each game.
+  float* 			mcw;
+  uint* 			iMcw;
+};
+
+void
+cubefulOneGame(void* const context, unsigned int const ng)
+{
+  CubefulGames const& r = *static_cast<CubefulGames*>(context);
+
+  // cube turns stay in this game
+  Equities::OwnState own;
+  
+  GameDice dice(r.seed, ng, r.nGames);
+  
+  cubefulGame(dice, r.board, r.xOnPlay, r.nPlies, r.mcw[ng], r.iMcw[ng]);
+}
+}
+
+const float*
+Analyze::rolloutCubefull(GNUbgBoard  const  board,
+			 uint const         nPlies,
+			 uint               nGames,
+			 bool const         xOnPlay,
+			 bool const         savedDice)
+{
+  static THREAD_LOCAL float amcw[1 + 2*6];
+  
+  for(uint k = 0; k < 13; ++k) {
+    amcw[k] = 0;
+  }
+  
+  if( Equities::match().cubeDead() ) {
+    nGames = 1;
+  }
+
+  float* const mcw = new float [nGames];
+  uint* const iMcw = new uint [nGames];
+  
+  if( savedDice ) {
+    MatchState const initialMatchState = Equities::match();
+
+    for(uint ng = 0; ng < nGames; ++ng) {
+      if( ng ) {
+	diceGen.next();
+      }
+
+      cubefulGame(diceGen, board, xOnPlay, nPlies, mcw[ng], iMcw[ng]);
     
-    if( ! xOnPlay ) {
-      mcw = -mcw;
+      setScore(initialMatchState.xAway, initialMatchState.oAway);
+      setCube(initialMatchState.cube, initialMatchState.xOwns);
     }
+  } else {
+    // As in rollout, each game is seeded from its number and plays with its
+    // own copy of the match state, and the games are added up in order.
+    
+    CubefulGames r;
+    memcpy(&r.board[0][0], &board[0][0], sizeof(r.board));
+    r.xOnPlay = xOnPlay;
+    r.nPlies = nPlies;
+    r.nGames = nGames;
+    r.seed = genrand();
+    r.mcw = mcw;
+    r.iMcw = iMcw;
+    
+    parallelFor(nGames, cubefulOneGame, &r);
+
+    srandom(r.seed);
+  }
 
-    outMcw += mcw;
-    amcw[2*iMcw-1] += mcw;
-    amcw[2*iMcw] += 1;
+  float& outMcw = amcw[0];
+  
+  for(uint ng = 0; ng < nGames; ++ng) {
+    // mcw accumulated for X, result is for side on play
+    
+    float const m = xOnPlay ? mcw[ng] : -mcw[ng];
     
-    setScore(initialMatchState.xAway, initialMatchState.oAway);
-    setCube(initialMatchState.cube, initialMatchState.xOwns);
+    outMcw += m;
+    amcw[2*iMcw[ng]-1] += m;
+    amcw[2*iMcw[ng]] += 1;
   }
 
+  delete [] mcw;
+  delete [] iMcw;
+  
   outMcw /= nGames;
   for(uint k = 1; k < 7; ++k) {
     if( amcw[2*k] != 0 ) {
@@ -1043,6 +1119,117 @@ rollOver(Analyze::GNUbgBoard const board, Analyze::RolloutEndsAt const target)
 }
       
   
+namespace {
+/// Play one game of a cubeless rollout from @arg{board}, and leave the
+/// probabilities for the side on play at @arg{board} in @arg{ar}.
+//
+template<class Dice> void
+rolloutGame(Dice&                         diceGen,
+	    Analyze::GNUbgBoard const     board,
+	    bool const                    xOnPlay,
+	    uint const                    nPlies,
+	    uint const                    nTruncate,
+	    Analyze::RolloutEndsAt const  endsAt,
+	    bool const                    reseedOSR,
+	    float                         ar[NUM_OUTPUTS])
+{
+  Analyze::GNUbgBoard boardEval;
+  int dice[2];
+  
+  memcpy(&boardEval[0][0], &board[0][0], sizeof(boardEval));
+
+  bool onPlay = xOnPlay;
+  uint iTurn = 0;
+
+  for(/**/; ! rollOver(boardEval, endsAt) && iTurn < nTruncate; ++iTurn) {
+
+    diceGen.get(dice);
+
+    findBestMove(0, dice[0], dice[1], boardEval, onPlay, nPlies);
+
+    onPlay = !onPlay;
+    
+    SwapSides(boardEval);
+  }
+
+  switch( endsAt ) {
+    case Analyze::RACE:
+    {
+      if( isRace(boardEval) && ! gameOver(boardEval) ) {
+	if( Analyze::useOSRinRollouts ) {
+	  // Make OSR repeatable as well
+
+	  // no nSeq, no diceGen
+	  if( reseedOSR ) {
+	    Analyze::srandom(diceGen.curSeed()+1);
+	  }
+	
+	  raceProbs(boardEval, ar, 576);
+
+	} else {
+	  // do a 1 ply
+	  EvaluatePosition(boardEval, ar, 1, 0, onPlay, 0,0,0/*fixme*/);
+	}
+      } else {
+	EvaluatePosition(boardEval, ar, 1, 0, onPlay, 0,0,0/*fixme*/);
+      }
+      break;
+    }
+    case Analyze::BEAROFF:
+    case Analyze::OVER:
+    {
+      EvaluatePosition(boardEval, ar, 0, 0, onPlay, 0,0,0/*fixme*/);
+      break;
+    }
+    case Analyze::AUTO: { break; }
+  }
+
+  if( iTurn & 1 ) {
+    InvertEvaluation(ar);
+  }
+}
+
+/// Rollout games played by @ref{rolloutOneGame}.
+//
+struct RolloutGames {
+  Analyze::GNUbgBoard 		board;
+  bool 				xOnPlay;
+  uint 				nPlies;
+  uint 				nTruncate;
+  uint 				nGames;
+  Analyze::RolloutEndsAt 	endsAt;
+  unsigned long 		seed;
+
+  /// NUM_OUTPUTS results per game.
+  float* 			ar;
+};
+
+void
+rolloutOneGame(void* const context, unsigned int const ng)
+{
+  RolloutGames const& r = *static_cast<RolloutGames*>(context);
+
+  GameDice dice(r.seed, ng, r.nGames);
+  
+  rolloutGame(dice, r.board, r.xOnPlay, r.nPlies, r.nTruncate, r.endsAt,
+	      false, r.ar + ng * NUM_OUTPUTS);
+}
+
+inline void
+addGame(const float* const ar,
+	float* const       arOutput,
+	double* const      arVariance)
+{
+  for(uint i = 0; i < NUM_OUTPUTS; ++i) {
+    float const x = min(max(ar[i], 0.0f), 1.0f);
+    arOutput[i] += x;
+    if( arVariance ) {
+      arVariance[i] += x * x;
+    }
+  }
+}
+}
+  
 void
 Analyze::rollout(GNUbgBoard const board,
 		 bool const       xOnPlay,
@@ -1056,17 +1243,6 @@ Analyze::rollout(GNUbgBoard const board,
 {
   assert( nGames > 0 );
   
-  if( nSeq >= 0 ) {
-    if( nSeq == 0 || diceGen.curNseq() != nGames ) {
-      diceGen.startSave(nGames);
-    } else {
-      diceGen.startRetrive();
-    }
-  } else {
-    // don't use
-    diceGen.endSave(nGames);
-  }
-  
   double arVariance[NUM_OUTPUTS];
   for(uint i = 0; i < NUM_OUTPUTS; ++i) {
     arOutput[i] = 0.0;
@@ -1077,85 +1253,51 @@ Analyze::rollout(GNUbgBoard const board,
     endsAt = rolloutTarget(board);
   }
   
-  GNUbgBoard boardEval;
-  int dice[2];
-
-  for(uint ng = 0; ng < nGames; ++ng) {
-  
-    memcpy(&boardEval[0][0], &board[0][0], sizeof(boardEval));
-
-    bool onPlay = xOnPlay;
-    uint iTurn = 0;
-
-    if( ng ) {
-      diceGen.next();
+  if( nSeq >= 0 ) {
+    if( nSeq == 0 || diceGen.curNseq() != nGames ) {
+      diceGen.startSave(nGames);
+    } else {
+      diceGen.startRetrive();
     }
 
-    //std::cerr << "Dice for game " << ng;
-
-    for(/**/; ! rollOver(boardEval, endsAt) && iTurn < nTruncate; ++iTurn) {
+    for(uint ng = 0; ng < nGames; ++ng) {
+      if( ng ) {
+	diceGen.next();
+      }
 
-      diceGen.get(dice);
+      float ar[NUM_OUTPUTS];
       
-      //std::cerr << " (" << dice[0] << dice[1] << ")";
+      rolloutGame(diceGen, board, xOnPlay, nPlies, nTruncate, endsAt, true, ar);
 
-      findBestMove(0, dice[0], dice[1], boardEval, onPlay, nPlies);
+      addGame(ar, arOutput, arStdDev ? arVariance : 0);
+    }
+  } else {
+    // don't use
+    diceGen.endSave(nGames);
 
-      onPlay = !onPlay;
+    // Each game is seeded from its number, and the games are added up in
+    // order, so the result does not depend on the number of threads.
     
-      SwapSides(boardEval);
-    }
+    RolloutGames r;
+    memcpy(&r.board[0][0], &board[0][0], sizeof(r.board));
+    r.xOnPlay = xOnPlay;
+    r.nPlies = nPlies;
+    r.nTruncate = nTruncate;
+    r.nGames = nGames;
+    r.endsAt = endsAt;
+    r.seed = genrand();
+    r.ar = new float [nGames * NUM_OUTPUTS];
     
-    //std::cerr << endl;
-
-    float ar[NUM_OUTPUTS];
-
-    switch( endsAt ) {
-      case RACE:
-      {
-	if( isRace(boardEval) && ! gameOver(boardEval) ) {
-	  if( useOSRinRollouts ) {
-	    // Make OSR repeatable as well
-
-	    // no nSeq, no diceGen
-	    if( nSeq >= 0 ) {
-	      Analyze::srandom(diceGen.curSeed()+1);
-	    }
-	
-	    raceProbs(boardEval, ar, 576);
+    parallelFor(nGames, rolloutOneGame, &r);
 
-	  } else {
-	    // do a 1 ply
-	    EvaluatePosition(boardEval, ar, 1, 0, onPlay, 0,0,0/*fixme*/);
-	  }
-	} else {
-	  EvaluatePosition(boardEval, ar, 1, 0, onPlay, 0,0,0/*fixme*/);
-	}
-	break;
-      }
-      case BEAROFF:
-      case OVER:
-      {
-	EvaluatePosition(boardEval, ar, 0, 0, onPlay, 0,0,0/*fixme*/);
-	break;
-      }
-      case AUTO: { break; }
+    for(uint ng = 0; ng < nGames; ++ng) {
+      addGame(r.ar + ng * NUM_OUTPUTS, arOutput, arStdDev ? arVariance : 0);
     }
-
-    // 	std::cerr << " - " << ar[0] << " " << ar[1] << " "
-    //            << ar[2] << " " << ar[3] << " " << ar[4] << endl;
     
-    if( iTurn & 1 ) {
-      InvertEvaluation(ar);
-    }
-  
-    for(uint i = 0; i < NUM_OUTPUTS; ++i) {
-      float const x = min(max(ar[i], 0.0f), 1.0f);
-      arOutput[i] += x;
-      if( arStdDev ) {
-	arVariance[i] += x * x;
-      }
-    }
+    delete [] r.ar;
+
+    // games played here have reseeded the generator
+    srandom(r.seed);
   }
 
   for(uint i = 0; i < NUM_OUTPUTS; ++i) {
@@ -277,10 +277,16 @@ public:
 			int              nSeq,
 			RolloutEndsAt    endsAt = AUTO);
   
+  /// Cubeful rollout of @arg{nGames} games at the current match score.
+  //  When @arg{savedDice}, the games replay the saved dice sequences one
+  //  after the other; otherwise each game is seeded from its number and the
+  //  games are played in parallel.
+  //
   const float*	rolloutCubefull(GNUbgBoard const board,
 				uint        nPlies,
 				uint        nGames,
-				bool        xOnPlay);
+				bool        xOnPlay,
+				bool        savedDice = true);
 
   void		probs(float*                 p,
 		      PrintMatchBoard const  board,
@@ -244,7 +244,7 @@ SEARCH_TOLERANCE = 0.30;
 static uint const
 MAX_SEARCH_CANDIDATES = 30;
 
-static move
+static THREAD_LOCAL move
 amCandidates[MAX_SEARCH_CANDIDATES];
 
 uint
@@ -582,8 +582,8 @@ findBestMove(int        anMove[8],
 	}
       }
 
-      static move* lamCandidates = 0;
-      static uint nAMcandidates = 0;
+      static THREAD_LOCAL move* lamCandidates = 0;
+      static THREAD_LOCAL uint nAMcandidates = 0;
   
       if( nAMcandidates < uint(ml.cMoves) ) {
 	lamCandidates = static_cast<move*>
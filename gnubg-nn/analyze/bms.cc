@@ -106,8 +106,8 @@ findBestMoves(movelist&            pml,
   
   // resize results array, if necessary.
   
-  static float** ar = 0;
-  static unsigned int nAr = 0;
+  static THREAD_LOCAL float** ar = 0;
+  static THREAD_LOCAL unsigned int nAr = 0;
 
   if( nAr < nMoves ) {
     float** nar = new float* [nMoves];
@@ -169,8 +169,8 @@ findBestMoves(movelist&            pml,
     sort(pml.amMoves, pml.amMoves + nMoves, SortMoves());
   } else {
 
-    static move* amCandidates = 0;
-    static uint nAMcandidates = 0;
+    static THREAD_LOCAL move* amCandidates = 0;
+    static THREAD_LOCAL uint nAMcandidates = 0;
   
     if( nAMcandidates < nMoves ) {
       amCandidates = static_cast<move*>
@@ -0,0 +1,340 @@
+/*
+ * bmscore.cc
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of version 2 of the GNU General Public License as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <string.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <map>
+#include <algorithm>
+
+#include "bgdefs.h"
+#include "bm.h"
+#include "bms.h"
+
+#include "bmscore.h"
+
+using std::string;
+using std::ifstream;
+using std::ofstream;
+using std::istringstream;
+using std::min;
+
+namespace {
+/// Start of a cache file. The last character is the format version.
+//
+const char cacheMagic[8] = {'g', 'n', 'u', 'b', 'g', 'b', 'm', '2'};
+
+bool
+keyFromString(string const& s, unsigned char auch[10])
+{
+  if( s.size() != 20 ) {
+    return false;
+  }
+
+  for(uint i = 0; i < 20; ++i) {
+    if( s[i] < 'A' || s[i] > 'P' ) {
+      return false;
+    }
+  }
+
+  for(uint i = 0; i < 10; ++i) {
+    auch[i] = ((s[2*i+0] - 'A') << 4) +  (s[2*i+1] - 'A');
+  }
+  return true;
+}
+
+/// Move chosen at @arg{nPlies} for position @arg{p}, as an index in its
+/// moves @arg{m}; @arg{p.nCandidates} when it is not one of them.
+//
+uint
+chooseMove(MoveBenchmark::Position const&  p,
+	   const MoveBenchmark::Move* const m,
+	   uint const                      nPlies)
+{
+  int board[2][25];
+
+  PositionFromKey(board, const_cast<unsigned char*>(p.auch));
+
+  if( nPlies == 0 ) {
+    // All legal moves, as gnubg.bestmove (perr.py) does
+    
+    findBestMove(0, p.dice[0], p.dice[1], board, false, 0);
+
+    SwapSides(board);
+
+    unsigned char auch[10];
+    PositionKey(board, auch);
+
+    for(uint i = 0; i < p.nCandidates; ++i) {
+      if( EqualKeys(auch, const_cast<unsigned char*>(m[i].auch)) ) {
+	return i;
+      }
+    }
+    return p.nCandidates;
+  }
+
+  if( p.nCandidates == 1 ) {
+    return 0;
+  }
+  
+  // Benchmark moves only, scored as findBestMove scores its candidates
+  
+  std::vector<move> amMoves(p.nCandidates);
+  memset(&amMoves[0], 0, p.nCandidates * sizeof(amMoves[0]));
+  
+  for(uint i = 0; i < p.nCandidates; ++i) {
+    PositionFromKey(board, const_cast<unsigned char*>(m[i].auch));
+    SwapSides(board);
+    PositionKey(board, amMoves[i].auch);
+  }
+
+  movelist ml;
+  ml.cMoves = p.nCandidates;
+  ml.amMoves = &amMoves[0];
+
+  scoreMoves(ml, nPlies, false);
+
+  return ml.iMoveBest;
+}
+}
+
+bool
+MoveBenchmark::readText(const char* const fileName, bool const interestingOnly)
+{
+  ifstream in(fileName);
+
+  if( ! in ) {
+    return false;
+  }
+
+  // '#R' lines (rollout of each benchmark move) since last 'm' line
+  std::map<string, string> rollouts;
+
+  string line;
+  while( getline(in, line) ) {
+    if( line.compare(0, 3, "#R ") == 0 ) {
+      string::size_type const e = line.find(' ', 3);
+      if( e != string::npos ) {
+	rollouts[line.substr(3, e - 3)] = line.substr(e + 1);
+      }
+      continue;
+    }
+
+    if( line.size() < 2 || line[0] != 'm' || line[1] != ' ' ) {
+      continue;
+    }
+
+    istringstream l(line.substr(2));
+
+    string b;
+    int d0, d1;
+    l >> b >> d0 >> d1;
+
+    Position p;
+    memset(&p, 0, sizeof(p));
+
+    if( ! (l && keyFromString(b, p.auch) &&
+	   1 <= d0 && d0 <= 6 && 1 <= d1 && d1 <= 6) ) {
+      rollouts.clear();
+      continue;
+    }
+
+    p.dice[0] = d0;
+    p.dice[1] = d1;
+    p.firstMove = moves.size();
+
+    // Benchmark moves: best move with its equity, then each with its loss.
+
+    bool interesting = false;
+    string best;
+    string m;
+    float v;
+    while( l >> m >> v ) {
+      Move mv;
+      memset(&mv, 0, sizeof(mv));
+
+      if( ! keyFromString(m, mv.auch) ) {
+	break;
+      }
+
+      if( p.nCandidates == 0 ) {
+	best = m;
+	mv.loss = 0.0;
+      } else {
+	mv.loss = v;
+      }
+
+      // Interesting unless all moves have the same rollout
+
+      std::map<string, string>::const_iterator const r = rollouts.find(m);
+      if( r == rollouts.end() || r->second != rollouts[best] ) {
+	interesting = true;
+      }
+
+      moves.push_back(mv);
+      ++p.nCandidates;
+    }
+
+    rollouts.clear();
+
+    if( p.nCandidates == 0 || (interestingOnly && ! interesting) ) {
+      moves.resize(p.firstMove);
+      continue;
+    }
+
+    positions.push_back(p);
+  }
+
+  interesting = interestingOnly;
+  
+  return true;
+}
+
+bool
+MoveBenchmark::load(const char* const fileName)
+{
+  ifstream in(fileName, std::ios::binary);
+
+  char magic[sizeof(cacheMagic)];
+  // positions, moves, interesting only
+  uint n[3];
+  
+  if( ! (in.read(magic, sizeof(magic)) &&
+	 memcmp(magic, cacheMagic, sizeof(magic)) == 0 &&
+	 in.read(reinterpret_cast<char*>(n), sizeof(n))) ) {
+    return false;
+  }
+
+  std::vector<Position> p(n[0]);
+  std::vector<Move> m(n[1]);
+
+  if( n[0] > 0 &&
+      ! in.read(reinterpret_cast<char*>(&p[0]), n[0] * sizeof(p[0])) ) {
+    return false;
+  }
+  
+  if( n[1] > 0 &&
+      ! in.read(reinterpret_cast<char*>(&m[0]), n[1] * sizeof(m[0])) ) {
+    return false;
+  }
+
+  for(uint k = 0; k < n[0]; ++k) {
+    Position const& pk = p[k];
+    
+    if( pk.nCandidates == 0 ||
+	pk.firstMove > n[1] || pk.nCandidates > n[1] - pk.firstMove ) {
+      return false;
+    }
+  }
+  
+  positions.swap(p);
+  moves.swap(m);
+  interesting = n[2] != 0;
+
+  return true;
+}
+
+bool
+MoveBenchmark::save(const char* const fileName) const
+{
+  ofstream out(fileName, std::ios::binary);
+
+  uint const n[3] = {uint(positions.size()), uint(moves.size()),
+		     uint(interesting)};
+  
+  out.write(cacheMagic, sizeof(cacheMagic));
+  out.write(reinterpret_cast<const char*>(n), sizeof(n));
+  if( n[0] > 0 ) {
+    out.write(reinterpret_cast<const char*>(&positions[0]),
+	      n[0] * sizeof(positions[0]));
+  }
+  if( n[1] > 0 ) {
+    out.write(reinterpret_cast<const char*>(&moves[0]),
+	      n[1] * sizeof(moves[0]));
+  }
+
+  return bool(out);
+}
+
+namespace {
+struct ScorePositions {
+  const MoveBenchmark::Position*	positions;
+  const MoveBenchmark::Move*		moves;
+  uint					nPlies;
+  
+  /// Index (in the position moves) of the chosen move of each position.
+  uint*					chosen;
+};
+
+void
+scorePosition(void* const context, unsigned int const k)
+{
+  ScorePositions const& s = *static_cast<ScorePositions*>(context);
+  MoveBenchmark::Position const& p = s.positions[k];
+  const MoveBenchmark::Move* const m = s.moves + p.firstMove;
+  
+  s.chosen[k] = chooseMove(p, m, s.nPlies);
+}
+}
+
+void
+MoveBenchmark::score(uint const nPlies, Score& s, float* const losses) const
+{
+  uint const n = positions.size();
+  
+  ScorePositions sp;
+  sp.positions = n > 0 ? &positions[0] : 0;
+  sp.moves = moves.size() > 0 ? &moves[0] : 0;
+  sp.nPlies = nPlies;
+  sp.chosen = new uint [n];
+
+  parallelFor(n, scorePosition, &sp);
+
+  s.nPositions = n;
+  s.nErrors = 0;
+  s.nOut = 0;
+  s.totalLoss = 0.0;
+
+  // added up in order, so the result does not depend on the number of threads
+  
+  for(uint k = 0; k < n; ++k) {
+    Position const& p = positions[k];
+    uint const c = sp.chosen[k];
+
+    // a move out of the benchmark list is charged the loss of its last move
+    float const loss = moves[p.firstMove + min(c, p.nCandidates - 1)].loss;
+
+    if( loss != 0.0 ) {
+      ++s.nErrors;
+    }
+    if( c >= p.nCandidates ) {
+      ++s.nOut;
+    }
+    s.totalLoss += loss;
+
+    if( losses ) {
+      losses[k] = loss;
+    }
+  }
+
+  delete [] sp.chosen;
+}
@@ -0,0 +1,110 @@
+// -*- C++ -*-
+#if !defined( BMSCORE_H )
+#define BMSCORE_H
+
+/*
+ * bmscore.h
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of version 2 of the GNU General Public License as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <vector>
+#include <sys/types.h>
+
+/// Positions of a move benchmark, ready for scoring nets.
+//
+//  Read once from the 'm' lines of a benchmark file (as written by sagnubg),
+//  and kept in a binary cache file. Each position keeps its benchmark moves,
+//  each with its loss against the best reference (rollout) move, so scoring
+//  a net needs no parsing, and above 0 ply no search.
+//
+class MoveBenchmark {
+public:
+  struct Move {
+    /// Position after the move, opponent on roll (as in the benchmark file).
+    unsigned char	auch[10];
+
+    /// Loss against the best reference move. Moves not in the benchmark
+    //  list are charged the loss of its last move.
+    float		loss;
+  };
+
+  struct Position {
+    unsigned char	auch[10];
+    unsigned char	dice[2];
+
+    /// Benchmark moves of the position are
+    //  moves[firstMove, firstMove + nCandidates), best first.
+    uint		firstMove;
+    uint		nCandidates;
+  };
+
+  struct Score {
+    uint		nPositions;
+
+    /// Positions where the chosen move has a non zero loss.
+    uint		nErrors;
+
+    /// Positions where the chosen move is not in the benchmark list.
+    uint		nOut;
+
+    double		totalLoss;
+  };
+
+  MoveBenchmark(void) : interesting(true) {}
+
+  /// Add the positions of benchmark file @arg{fileName}.
+  //  If @arg{interestingOnly}, skip positions whose benchmark moves all have
+  //  the same rollout ('#R' lines), as perr.py does.
+  //  Return false if the file can't be read.
+  //
+  bool		readText(const char* fileName, bool interestingOnly);
+
+  /// Replace positions with those in cache file @arg{fileName}.
+  //  Return false if the file can't be read or is not a cache file (or one
+  //  of an older format).
+  //
+  bool		load(const char* fileName);
+
+  /// Write positions to cache file @arg{fileName}. The cache is in host byte
+  //  order.
+  //
+  bool		save(const char* fileName) const;
+
+  uint		nPositions(void) const { return positions.size(); }
+
+  /// True if non interesting positions were skipped (kept in the cache).
+  //
+  bool		interestingOnly(void) const { return interesting; }
+
+  /// Score the current nets at @arg{nPlies}, positions spread over
+  //  evalThreads() threads.
+  //
+  //  At 0 ply the move is chosen by findBestMove, as perr.py does (through
+  //  gnubg.bestmove). Above 0 ply only the benchmark moves are scored, with
+  //  scoreMoves as findBestMove scores its candidates, so the chosen move is
+  //  never out.
+  //
+  //  When @arg{losses} is given, set the loss of each position.
+  //
+  void		score(uint nPlies, Score& s, float* losses = 0) const;
+
+private:
+  std::vector<Position>	positions;
+  std::vector<Move>	moves;
+  bool			interesting;
+};
+
+#endif
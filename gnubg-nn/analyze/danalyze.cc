@@ -573,7 +573,7 @@ Analyze::R1::cubefulEquity(GNUbgBoard const  anBoard,
 	  cube *= 2;
 	  onPlayHoldsCube = true;
 	  resetCube = true;
-	  Equities::match.set(0, 0, cube, !xOnPlay_, -1);
+	  Equities::match().set(0, 0, cube, !xOnPlay_, -1);
 	  
 #if defined( DEBUG )
 	  if( Analyze::debugOn(Analyze::DOUBLE1,1) ) {
@@ -631,7 +631,7 @@ Analyze::R1::cubefulEquity(GNUbgBoard const  anBoard,
     }
 
     if( resetCube ) {
-      Equities::match.set(0, 0, cube/2, xOnPlay_, -1);
+      Equities::match().set(0, 0, cube/2, xOnPlay_, -1);
     }
 
     if( advantage ) {
@@ -651,17 +651,17 @@ Analyze::R1::cubefulEquity(GNUbgBoard const  anBoard,
 void
 Analyze::R1::cubefulEquities(GNUbgBoard const anBoard)
 {
-  assert( Equities::match.cube == 1 || (Equities::match.xOwns == xOnPlay) );
+  assert( Equities::match().cube == 1 || (Equities::match().xOwns == xOnPlay) );
     
   // away for doubler
   uint const onPlayAway =
-    xOnPlay ? Equities::match.xAway : Equities::match.oAway;
+    xOnPlay ? Equities::match().xAway : Equities::match().oAway;
 
   // away for opponent
   uint const opAway =
-    xOnPlay ? Equities::match.oAway : Equities::match.xAway;
+    xOnPlay ? Equities::match().oAway : Equities::match().xAway;
 
-  uint const cube = Equities::match.cube;
+  uint const cube = Equities::match().cube;
 
   if( advantage ) {
     Equities::push(advantage->perDoubler);
@@ -671,12 +671,12 @@ Analyze::R1::cubefulEquities(GNUbgBoard const anBoard)
     float eqNoDouble = cubefulEquity(anBoard, xOnPlay, nPlies,
 				     onPlayAway, opAway, true, cube);
 
-    Equities::match.set(0, 0, 2*cube, !xOnPlay, -1);
+    Equities::match().set(0, 0, 2*cube, !xOnPlay, -1);
     
     float eqDoubleTake = cubefulEquity(anBoard, xOnPlay, nPlies,
 				       onPlayAway, opAway, false, 2*cube);
 
-    Equities::match.set(0, 0, cube, xOnPlay, -1);
+    Equities::match().set(0, 0, cube, xOnPlay, -1);
     
     matchProbNoDouble   = Equities::equityToProb(eqNoDouble);
     matchProbDoubleTake = Equities::equityToProb(eqDoubleTake);
@@ -781,7 +781,11 @@ Analyze::R1::analyze(GNUbgBoard const        b,
   
   cubefulEquities(b);
 
-  locC.clear();
+  // Only filled above 0 plies; left alone otherwise, as 0 ply analyses may
+  // run in parallel (cubeful rollouts).
+  if( ! locC.empty() ) {
+    locC.clear();
+  }
 
   setDecision();
 }
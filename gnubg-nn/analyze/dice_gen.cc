@@ -242,3 +242,38 @@ GetDice::get(int dice[2])
     dice[1] = d;
   }
 }
+
+GameDice::GameDice(unsigned long const seed_,
+		   uint const          nGame,
+		   uint const          nGames,
+		   bool const          semiRand) :
+  seed(seed_ + 69069UL * (nGame + 1)),
+  semiRandCounter(0)
+{
+  // first roll as GetDice in NONE mode, where game n rolls after n others
+  
+  uint const nSemi = semiRand ? (nGames - (nGames % 36)) : 0;
+
+  if( nGame < nSemi ) {
+    semiRandCounter = nSemi - nGame;
+  }
+  
+  sgenrand(seed);
+}
+
+void
+GameDice::get(int dice[2])
+{
+  if( semiRandCounter > 0 ) {
+    semiRoll(dice, semiRandCounter);
+    semiRandCounter = 0;
+  } else {
+    RollDice(dice);
+  }
+
+  if( dice[0] < dice[1] ) {
+    int const d = dice[0];
+    dice[0] = dice[1];
+    dice[1] = d;
+  }
+}
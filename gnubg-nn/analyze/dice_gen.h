@@ -87,6 +87,25 @@ private:
   uint		cur;
 };
 
+/// Dice of one game of a rollout which does not keep its sequences.
+//  Game @arg{nGame} out of @arg{nGames} is seeded from @arg{seed} and its
+//  number only, so the games may be played in any order and in any thread.
+//  Rolls with the generator of the calling thread.
+//
+class GameDice {
+public:
+  GameDice(unsigned long seed, uint nGame, uint nGames, bool semiRand = true);
+
+  void 	get(int dice[2]);
+
+  unsigned long  curSeed(void) const;
+  
+private:
+  unsigned long const seed;
+  
+  int		semiRandCounter;
+};
+
 inline uint
 GetDice::curNseq(void) const
 {
@@ -99,4 +118,10 @@ GetDice::curSeed(void) const
   return seqs[cur].seed;
 }
 
+inline unsigned long
+GameDice::curSeed(void) const
+{
+  return seed;
+}
+
 #endif
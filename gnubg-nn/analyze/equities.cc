@@ -272,17 +272,51 @@ Equities::Snowie[15][15] =
    .422, .462, .500},
 };
 
-MatchState
-Equities::match;
-
 namespace {
 
 // Set for money
 
-float xCube2 = 1.0;
-float xCube3 = 1.0;
-float oCube2 = -1.0;
-float oCube3 = -1.0;
+Equities::State sharedState = {{0, 0, 1, false, false}, 1.0, 1.0, -1.0, -1.0};
+
+/// State of a thread helping with a parallel loop, taken over from the
+/// thread running the loop.
+//
+THREAD_LOCAL Equities::State loopState;
+
+void
+saveThreadState(void* const p)
+{
+  *static_cast<Equities::State*>(p) = *Equities::curState;
+}
+
+void
+loadThreadState(const void* const p)
+{
+  loopState = *static_cast<const Equities::State*>(p);
+  Equities::curState = &loopState;
+}
+
+struct RegisterThreadState {
+  RegisterThreadState(void) {
+    setParallelState(sizeof(Equities::State),
+		     saveThreadState, loadThreadState);
+  }
+} const registerThreadState;
+}
+
+THREAD_LOCAL Equities::State*
+Equities::curState = &sharedState;
+
+Equities::OwnState::OwnState(void) :
+  own(*curState),
+  prev(curState)
+{
+  curState = &own;
+}
+
+Equities::OwnState::~OwnState()
+{
+  curState = prev;
 }
 
 extern "C" float
@@ -429,23 +463,26 @@ extern "C" float (*equityFunc)(float const p[NUM_OUTPUTS], bool direction);
 static void
 recompute(void)
 {
-  equityFunc = ::equity;
+  // only the first call changes it, as other threads may be evaluating
+  if( equityFunc != ::equity ) {
+    equityFunc = ::equity;
+  }
 
-  uint const xAway = match.xAway;
-  uint const oAway = match.oAway;
-  uint const cube = match.cube;
+  uint const xAway = match().xAway;
+  uint const oAway = match().oAway;
+  uint const cube = match().cube;
   
   if( xAway == 0 && oAway == 0 ) {
-    xCube2 = 1.0;
-    xCube3 = 1.0;
-    oCube2 = -1.0;
-    oCube3 = -1.0;
+    curState->xCube2 = 1.0;
+    curState->xCube3 = 1.0;
+    curState->oCube2 = -1.0;
+    curState->oCube3 = -1.0;
     return;
   }
   
   if( xAway == 1 && oAway == 1 ) {
-    xCube2 = xCube3 = 0.0;
-    oCube2 = oCube3 = 0.0;
+    curState->xCube2 = curState->xCube3 = 0.0;
+    curState->oCube2 = curState->oCube3 = 0.0;
     return;
   }
 
@@ -462,10 +499,10 @@ recompute(void)
     float const cube2 = (p02 - center) / one;
     float const cube3 = (p03 - center) / one;
 
-    oCube2 = cube2 + 1.0;
-    oCube3 = cube3 - cube2;
+    curState->oCube2 = cube2 + 1.0;
+    curState->oCube3 = cube3 - cube2;
     
-    xCube2 = xCube3 = 0.0;
+    curState->xCube2 = curState->xCube3 = 0.0;
 
     return;
   }
@@ -483,10 +520,10 @@ recompute(void)
     float const cube2 = (p20 - center) / one;
     float const cube3 = (p30 - center) / one;
 
-    oCube2 = oCube3 = 0.0;
+    curState->oCube2 = curState->oCube3 = 0.0;
 
-    xCube2 = cube2 - 1.0;
-    xCube3 = cube3 - cube2;
+    curState->xCube2 = cube2 - 1.0;
+    curState->xCube3 = cube3 - cube2;
     
     return;
   }
@@ -508,11 +545,11 @@ recompute(void)
   float const x3 = (p30 - center) / one;
   float const o3 = (p03 - center) / one;
 
-  xCube3 = x3 - x2;
-  xCube2 = x2 - 1.0;
+  curState->xCube3 = x3 - x2;
+  curState->xCube2 = x2 - 1.0;
 
-  oCube3 = o3 - o2;
-  oCube2 = o2 + 1.0;
+  curState->oCube3 = o3 - o2;
+  curState->oCube2 = o2 + 1.0;
 }
 
 float
@@ -560,11 +597,11 @@ normalizedEquity(const float* const p, bool const xOnPlay)
   float e = 2 * p[WIN] - 1;
   
   if( xOnPlay ) {
-    e += (xCube2 * p[WINGAMMON]  + xCube3 * p[WINBACKGAMMON] +
-	  oCube2 * p[LOSEGAMMON] + oCube3 * p[LOSEBACKGAMMON]);
+    e += (curState->xCube2 * p[WINGAMMON]  + curState->xCube3 * p[WINBACKGAMMON] +
+	  curState->oCube2 * p[LOSEGAMMON] + curState->oCube3 * p[LOSEBACKGAMMON]);
   } else {
-    e -= (oCube2 * p[WINGAMMON]  + oCube3 * p[WINBACKGAMMON] +
-	  xCube2 * p[LOSEGAMMON] + xCube3 * p[LOSEBACKGAMMON]);
+    e -= (curState->oCube2 * p[WINGAMMON]  + curState->oCube3 * p[WINBACKGAMMON] +
+	  curState->xCube2 * p[LOSEGAMMON] + curState->xCube3 * p[LOSEBACKGAMMON]);
   }
 
   return e;
@@ -1224,12 +1261,12 @@ mwc0(const float* const  ar,
 float
 mwc(const float* const p, bool const xOnPlay)
 {
-  if( match.xAway == 0 && match.oAway == 0 ) {
+  if( match().xAway == 0 && match().oAway == 0 ) {
     // money
     return normalizedEquity(p, xOnPlay);
   }
   
-  return mwc0(p, xOnPlay, match);
+  return mwc0(p, xOnPlay, match());
 }
 
 }
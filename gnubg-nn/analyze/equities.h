@@ -29,13 +29,14 @@
 #include <assert.h>
 
 #include "defs.h"
+#include "threads.h"
 
 /// Handles match score information.
+//  No constructor, so that a thread can keep its own copy; the initial
+//  (money) values are set with the shared state in equities.cc.
 //
 class MatchState {
 public:
-  MatchState(void);
-
   /// Set match score.
   //
   bool	set(uint  xAway,
@@ -77,16 +78,6 @@ public:
 };
 
 
-inline
-MatchState::MatchState(void) :
-  xAway(0),
-  oAway(0),
-  cube(1),
-  xOwns(false),
-  crawfordGame(false)
-{}
-
-
 inline bool
 MatchState::cubeDead(void) const
 {
@@ -257,9 +248,40 @@ namespace Equities {
   //
   float 	mwc(const float* p, bool xOnPlay);
 
+  /// Match score with the cube values derived from it.
+  //
+  struct State {
+    MatchState	match;
+    
+    float	xCube2;
+    float	xCube3;
+    float	oCube2;
+    float	oCube3;
+  };
+
+  /// State of the calling thread: the one shared by all threads, unless
+  //  the thread plays with its own (see @ref{OwnState}). The threads of a
+  //  parallel loop start from the state of the thread running the loop.
+  //
+  extern THREAD_LOCAL State*	curState;
+
   /// Current match score.
   //
-  extern MatchState	match;
+  inline MatchState&	match(void) { return curState->match; }
+
+  /// While in scope, the calling thread has its own copy of the current
+  //  state, so it may change the score and cube without affecting the
+  //  other threads.
+  //
+  class OwnState {
+  public:
+    OwnState(void);
+    ~OwnState();
+    
+  private:
+    State	own;
+    State*	prev;
+  };
   
   /// Compute match equity of @arg{probs}, with @arg{xOnPlay} to play.
   //
@@ -65,9 +65,9 @@ Player::rollOrDouble(PrintMatchBoard const  board,
 		     bool const             cbfMoves,
 		     const float*           prb) const 
 {
-  uint const xAway = Equities::match.xAway;
-  uint const oAway = Equities::match.oAway;
-  uint const cube = Equities::match.cube;
+  uint const xAway = Equities::match().xAway;
+  uint const oAway = Equities::match().oAway;
+  uint const cube = Equities::match().cube;
   
   if( (xOnPlay ? xAway : oAway) <= cube ) {
     doubleInfo.actionDouble = false;
@@ -159,9 +159,9 @@ Player::resignsOpAtRoll(PrintMatchBoard const  board,
     return true;
   }
 
-  uint const xAway = Equities::match.xAway;
-  uint const oAway = Equities::match.oAway;
-  uint const cube = Equities::match.cube;
+  uint const xAway = Equities::match().xAway;
+  uint const oAway = Equities::match().oAway;
+  uint const cube = Equities::match().cube;
   
   int const rsAway = xOnPlay ? xAway : oAway;
   int const away = xOnPlay ? oAway : xAway;
@@ -260,9 +260,9 @@ Player::offerResign(uint const            nPlies,
   probs(p, board, xOnPlay, nPlies);
   InvertEvaluation(p);
   
-  uint const xAway = Equities::match.xAway;
-  uint const oAway = Equities::match.oAway;
-  uint const cube = Equities::match.cube;
+  uint const xAway = Equities::match().xAway;
+  uint const oAway = Equities::match().oAway;
+  uint const cube = Equities::match().cube;
   
   bool const singleOK = cube >= (xOnPlay ? xAway : oAway);
   bool const gammonOK = 2*cube >= (xOnPlay ? xAway : oAway);
@@ -351,9 +351,9 @@ Player::accept(PrintMatchBoard const  board,
   probs(p, board, xOnPlay, nPlies);
   r.setProbs(p);
 
-  uint const xAway = Equities::match.xAway;
-  uint const oAway = Equities::match.oAway;
-  uint const cube = Equities::match.cube;
+  uint const xAway = Equities::match().xAway;
+  uint const oAway = Equities::match().oAway;
+  uint const cube = Equities::match().cube;
   
   uint const dbAway = xOnPlay ? xAway : oAway;
   uint const acAway = xOnPlay ? oAway : xAway;
@@ -537,9 +537,9 @@ Player::accept(PrintMatchBoard const  board,
   probs(p, board, xOnPlay, nPlies);
   r.setProbs(p);
 
-  uint const xAway = Equities::match.xAway;
-  uint const oAway = Equities::match.oAway;
-  uint const cube = Equities::match.cube;
+  uint const xAway = Equities::match().xAway;
+  uint const oAway = Equities::match().oAway;
+  uint const cube = Equities::match().cube;
   
   uint const dbAway = xOnPlay ? xAway : oAway;
   uint const acAway = xOnPlay ? oAway : xAway;
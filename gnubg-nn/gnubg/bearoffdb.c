@@ -76,6 +76,8 @@ InitCombination( void )
       anCombination[ i ][ j ] = anCombination[ i - 1 ][ j - 1 ] +
 	anCombination[ i - 1 ][ j ];
 
+  /* publish the table before the flag; a racing thread only fills it twice */
+  __sync_synchronize();
   fCalculated = 1;
     
   return 0;
@@ -206,7 +208,7 @@ GetDistCompressed ( bearoffcontext *pbc, const unsigned int nPosID ) {
   off_t iOffset;
   int nBytes;
   int nPos = Combination ( pbc->nPoints + pbc->nChequers, pbc->nPoints );
-  static unsigned short int aus[ 64 ];
+  static THREAD_LOCAL unsigned short int aus[ 64 ];
       
   unsigned int ioff, nz, ioffg, nzg;
 
@@ -290,7 +292,7 @@ static unsigned short int *
 GetDistUncompressed ( bearoffcontext *pbc, const unsigned int nPosID ) {
 
   unsigned char ac[ 128 ];
-  static unsigned short int aus[ 64 ];
+  static THREAD_LOCAL unsigned short int aus[ 64 ];
   unsigned char *puch;
   int iOffset;
 
@@ -702,9 +702,9 @@ eggPositionKey(int anBoard[2][26], unsigned char auchKey[10])
 
 #define MAX_MOVES 3060
 
-static emovelist moves[MAX_MOVES];
+static THREAD_LOCAL emovelist moves[MAX_MOVES];
 
-move amMoves[MAX_MOVES];
+THREAD_LOCAL move amMoves[MAX_MOVES];
 
 int
 eGenerateMoves(movelist* pml, CONST int anBoard[2][25], int n0, int n1)
@@ -48,6 +48,7 @@
 #include "mt19937int.h"
 #include "bearoffgammon.h"
 #include "racebg.h"
+#include "threads.h"
 
 
 #undef VERSION
@@ -1767,8 +1768,11 @@ FindBestMoveInEval(int nDice0, int nDice1, int anBoard[2][25], int direction)
 	    if( ( pec = CacheLookup( c, &ec, &l ) ) )   
 #endif
 	      {
+#if defined( GARY_CODE )
 	      memcpy( ec.ar, pec->ar, sizeof( pec->ar ) );
-
+#else
+	      /* CacheLookup() copied the outputs into ec */
+#endif
 	    } else {
 	      if( useEvalNet && pc == posClass ) {
 		evalPly(pc, (ConstBoard)anBoard, ec.ar /*, i*/);
@@ -1824,6 +1828,85 @@ EvaluatePositionFast(CONST int anBoard[2][25], float arOutput[])
 }
  
 
+/* The 21 rolls of an internal node, shared out by parallelFor() */
+typedef struct {
+  ConstBoard	anBoard;
+  int		nPlies;
+  int		wide;
+  int		direction;
+  int		fError;
+  /* evaluation after each roll, already weighted by its frequency */
+  float		ar[21][NUM_OUTPUTS];
+} RollsEval;
+
+static void
+evalRoll(void* context, unsigned int k)
+{
+  RollsEval* re = (RollsEval*)context;
+  int anBoardNew[2][25];
+  unsigned int n0 = 1, n1 = k, i;
+
+  /* same order as the serial loop: 11, 21, 22, 31, ... */
+  while( n1 >= n0 ) {
+    n1 -= n0;
+    ++n0;
+  }
+  ++n1;
+  
+  memcpy(anBoardNew, re->anBoard, sizeof(anBoardNew));
+
+  if( preFilter && ! re->wide ) {
+    FindBestMoveInEval(n0, n1, anBoardNew, re->direction);
+  } else {
+    FindBestMove(re->wide ? 1 : 0, 0, n0, n1, anBoardNew, 0, re->direction);
+  }
+
+  SwapSides(anBoardNew);
+
+  if( EvaluatePosition((ConstBoard)anBoardNew, re->ar[k], re->nPlies - 1, 0,
+		       !re->direction, 0, 0, 0) ) {
+    re->fError = 1;
+  }
+
+  if( n0 != n1 ) {
+    for(i = 0; i < NUM_OUTPUTS; ++i) {
+      re->ar[k][i] *= 2.0;
+    }
+  }
+}
+
+/* Sum of the evaluations after each roll, computed by evalThreads()
+   threads. The sum is taken in the same order as the serial loop, so the
+   result does not depend on the number of threads. */
+
+static int
+evalRolls(CONST int anBoard[2][25], float arOutput[], int nPlies, int wide,
+	  int direction)
+{
+  RollsEval re;
+  unsigned int k, i;
+
+  re.anBoard = anBoard;
+  re.nPlies = nPlies;
+  re.wide = wide;
+  re.direction = direction;
+  re.fError = 0;
+
+  parallelFor(21, evalRoll, &re);
+
+  if( re.fError ) {
+    return -1;
+  }
+  
+  for(k = 0; k < 21; ++k) {
+    for(i = 0; i < NUM_OUTPUTS; ++i) {
+      arOutput[i] += re.ar[k][i];
+    }
+  }
+
+  return 0;
+}
+
 static int
 EvaluatePositionFull(CONST int anBoard[2][25], float arOutput[],
 		     int nPlies, int wide,
@@ -1856,49 +1939,55 @@ EvaluatePositionFull(CONST int anBoard[2][25], float arOutput[],
     }
     
     
-    for( n0 = 1; n0 <= 6; n0++ ) {
-      for( n1 = 1; n1 <= n0; n1++ ) {
-	for( i = 0; i < 25; i++ ) {
-	  anBoardNew[ 0 ][ i ] = anBoard[ 0 ][ i ];
-	  anBoardNew[ 1 ][ i ] = anBoard[ 1 ][ i ];
-	}
-
-/*  	if( fInterrupt ) { */
-/*  	  errno = EINTR; */
-/*  	  return -1; */
-/*  	} */
+    if( ! p && evalThreads() > 1 ) {
+      if( evalRolls(anBoard, arOutput, nPlies, wide, direction) ) {
+	return -1;
+      }
+    } else {
+      for( n0 = 1; n0 <= 6; n0++ ) {
+	for( n1 = 1; n1 <= n0; n1++ ) {
+	  for( i = 0; i < 25; i++ ) {
+	    anBoardNew[ 0 ][ i ] = anBoard[ 0 ][ i ];
+	    anBoardNew[ 1 ][ i ] = anBoard[ 1 ][ i ];
+	  }
 
-	if( preFilter && ! wide ) {
-	  FindBestMoveInEval(n0, n1, anBoardNew, direction);
-	} else {
-	  FindBestMove(wide ? 1 : 0,
-		       0, n0, n1, anBoardNew, 0 ,direction);
-	}
+/*  	  if( fInterrupt ) { */
+/*  	    errno = EINTR; */
+/*  	    return -1; */
+/*  	  } */
 
-	SwapSides( anBoardNew );
+	  if( preFilter && ! wide ) {
+	    FindBestMoveInEval(n0, n1, anBoardNew, direction);
+	  } else {
+	    FindBestMove(wide ? 1 : 0,
+			 0, n0, n1, anBoardNew, 0 ,direction);
+	  }
 
-	if( EvaluatePosition( (ConstBoard)anBoardNew, ar, nPlies - 1, 0
-			      ,!direction,
-			      snp > 0 ? p : 0,
-			      snp > 0 ? snp - 1 : 0,
-			      snp > 0 ? pauch : 0) ) {
-	  return -1;
-	}
+	  SwapSides( anBoardNew );
 
-	if( p && snp > 0 ) {
-	  p += nIncrp;
-	  if( pauch ) {
-	    pauch += nIncrp * (10/NUM_OUTPUTS);
+	  if( EvaluatePosition( (ConstBoard)anBoardNew, ar, nPlies - 1, 0
+				,!direction,
+				snp > 0 ? p : 0,
+				snp > 0 ? snp - 1 : 0,
+				snp > 0 ? pauch : 0) ) {
+	    return -1;
 	  }
-	}
 
-	if( n0 == n1 ) {
-	  for( i = 0; i < NUM_OUTPUTS; i++ ) {
-	    arOutput[ i ] += ar[ i ];
+	  if( p && snp > 0 ) {
+	    p += nIncrp;
+	    if( pauch ) {
+	      pauch += nIncrp * (10/NUM_OUTPUTS);
+	    }
 	  }
-	} else {
-	  for( i = 0; i < NUM_OUTPUTS; i++ ) {
-	    arOutput[ i ] += ar[ i ] * 2.0;
+
+	  if( n0 == n1 ) {
+	    for( i = 0; i < NUM_OUTPUTS; i++ ) {
+	      arOutput[ i ] += ar[ i ];
+	    }
+	  } else {
+	    for( i = 0; i < NUM_OUTPUTS; i++ ) {
+	      arOutput[ i ] += ar[ i ] * 2.0;
+	    }
 	  }
 	}
       }
@@ -2129,7 +2218,7 @@ GameStatus(CONST int anBoard[2][25])
 float*
 NetInputs(CONST int anBoard[2][25], positionclass* pc, unsigned int* n)
 {
-  static float arInput[MAX_NUM_INPUTS];
+  static THREAD_LOCAL float arInput[MAX_NUM_INPUTS];
   
   *pc = ClassifyPosition(anBoard);
   {
@@ -2448,7 +2537,7 @@ filter(movelist* pml)
 {
   int i, anBoard[2][25];
 
-  static move* am = 0;
+  static THREAD_LOCAL move* am = 0;
   int nMoves = pml->cMoves;
   
   am = realloc(am, nMoves * sizeof(*am));
@@ -2571,7 +2660,7 @@ FindBestMoves( movelist *pml, float ar[][ NUM_OUTPUTS ], int nPlies,
 {
   int i, j;
   int k;
-  static move amCandidates[ 32 ];
+  static THREAD_LOCAL move amCandidates[ 32 ];
 
   if( c > 32 )
     c = 32;
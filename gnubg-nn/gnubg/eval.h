@@ -30,6 +30,8 @@
 
 #include <time.h>
 
+#include "threads.h"
+
 #ifndef FALSE
 #define FALSE 0
 #endif
@@ -65,7 +67,7 @@ typedef struct _move {
     float rScore, *pEval;
 } move;
 
-extern move amMoves[];
+extern THREAD_LOCAL move amMoves[];
 // extern volatile int fInterrupt;
 
 typedef struct _movelist {
@@ -58,6 +58,8 @@ typedef cacheNode evalcache;
 
 typedef struct _cache {
   cacheNode*	m;
+  /* one lock for each pair of slots */
+  unsigned char* locks;
   
   unsigned int size;
   unsigned int nAdds;
@@ -72,7 +74,10 @@ CacheCreate(cache* pc, unsigned int size);
 int
 CacheResize(cache *pc, unsigned int cNew);
 
-/* l is filled with a value which is passed to CacheAdd */
+/* l is filled with a value which is passed to CacheAdd. On a hit the
+   cached outputs are copied into e, and e is returned. Lookups and adds
+   may be done from several threads at once; the other calls may not run
+   while the cache is in use. */
 cacheNode*
 CacheLookup(cache* pc, cacheNode* e, unsigned long* l);
 
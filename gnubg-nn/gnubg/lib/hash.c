@@ -327,6 +327,7 @@ CacheCreate(cache* pc, unsigned int s)
 
   if( s == 0 ) {
     pc->m = 0;
+    pc->locks = 0;
     return 0;
   }
 
@@ -343,8 +344,14 @@ CacheCreate(cache* pc, unsigned int s)
   pc->size = ( s < pc->size ) ? 2*s : s;
   
   pc->m = malloc(pc->size * sizeof(*pc->m));
+  pc->locks = calloc(pc->size / 2, sizeof(*pc->locks));
 
-  if( pc->m == 0 ) {
+  if( pc->m == 0 || pc->locks == 0 ) {
+    free(pc->m);
+    free(pc->locks);
+    pc->m = 0;
+    pc->locks = 0;
+    pc->size = 0;
     return -1;
   }
   
@@ -353,10 +360,32 @@ CacheCreate(cache* pc, unsigned int s)
   return 0;
 }
 
+/* Each pair of slots has a lock, so that threads sharing the cache never
+   see an entry half written. They are only held for a copy. */
+
+static inline void
+lockBucket(cache* pc, unsigned long l)
+{
+  volatile unsigned char* const lock = pc->locks + (l >> 1);
+  
+  while( __sync_lock_test_and_set(lock, 1) ) {
+    while( *lock ) {
+      /* spin */
+    }
+  }
+}
+
+static inline void
+unlockBucket(cache* pc, unsigned long l)
+{
+  __sync_lock_release(pc->locks + (l >> 1));
+}
+
 cacheNode*
 CacheLookup(cache* pc, cacheNode* e, unsigned long* m)
 {
   unsigned int size = pc->size;
+  cacheNode* found = 0;
 
   if( size ) {
     unsigned long l = keyToLong(e->auchKey, e->nPlies);
@@ -367,18 +396,17 @@ CacheLookup(cache* pc, cacheNode* e, unsigned long* m)
       *m = l;
     }
 
+    /* statistics only; not exact when threads share the cache */
     ++pc->cLookup;
 
+    lockBucket(pc, l);
     {
       cacheNode* ck1 = pc->m + l;
       if( (ck1->nPlies == e->nPlies
 	   && memcmp(e->auchKey, ck1->auchKey, sizeof(e->auchKey)) == 0) ) {
 	// found at first slot
-	++pc->cHit;
-	return ck1;
-      }
-
-      if( ck1->nPlies != (unsigned int)-1 ) {
+	found = ck1;
+      } else if( ck1->nPlies != (unsigned int)-1 ) {
 	cacheNode* ck2 = pc->m + (l+1);
 	if( (ck2->nPlies == e->nPlies &&
 	     memcmp(e->auchKey, ck2->auchKey, sizeof(e->auchKey)) == 0) ) {
@@ -387,10 +415,19 @@ CacheLookup(cache* pc, cacheNode* e, unsigned long* m)
 	  *ck1 = *ck2;
 	  *ck2 = tmp;
 
-	  ++pc->cHit;
-	  return ck1;
+	  found = ck1;
 	}
       }
+
+      if( found ) {
+	memcpy(e->ar, found->ar, sizeof(e->ar));
+      }
+    }
+    unlockBucket(pc, l);
+
+    if( found ) {
+      ++pc->cHit;
+      return e;
     }
   }
   
@@ -405,10 +442,12 @@ CacheAdd(cache* pc, cacheNode* e, unsigned long l)
 
     ++pc->nAdds;
   
+    lockBucket(pc, l);
     if( ck1->nPlies != (unsigned int)-1 ) {
       pc->m[l+1] = *ck1;
     }
     *ck1 = *e;
+    unlockBucket(pc, l);
   }
 }
 
@@ -419,6 +458,9 @@ CacheDestroy(cache* pc)
   if( pc->m ) {
     free(pc->m);
   }
+  if( pc->locks ) {
+    free(pc->locks);
+  }
 }
 
 void
@@ -758,6 +758,10 @@ NeuralNetTrain(neuralnet* pnn, float arInput[], float arOutput[],
     *pr,
     *prWeight;
 
+  if( fuseSSE && sse_trainable(pnn) ) {
+    return NeuralNetTrainSSE(pnn, arInput, arOutput, arDesired, rAlpha, 0);
+  }
+  
   Evaluate(pnn, arInput, ar, arOutput, 0);
 
   /* Calculate error at output nodes */
@@ -824,6 +828,10 @@ NeuralNetTrainS(neuralnet* pnn, float arInput[], float arOutput[],
     *pr,
     *prWeight;
 
+  if( fuseSSE && sse_trainable(pnn) ) {
+    return NeuralNetTrainSSE(pnn, arInput, arOutput, arDesired, rAlpha, tList);
+  }
+  
   Evaluate(pnn, arInput, ar, arOutput, 0);
 
   /* Calculate error at output nodes */
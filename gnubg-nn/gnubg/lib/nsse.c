@@ -379,6 +379,142 @@ EvaluateSSE(const neuralnet *pnn, const float arInput[], float ar[], float arOut
   }
 }
 
+/* pr[j] += pw[j] * x for j < n. x == 1 adds pw unscaled. */
+static inline void
+addScaled(float* pr, const float* pw, float const x, int const n)
+{
+  int j;
+
+  if( x == 1.0f ) {
+    for( j = (n >> 2); j; j--, pr += 4, pw += 4 ) {
+      _mm_storeu_ps(pr, _mm_add_ps(_mm_loadu_ps(pr), _mm_loadu_ps(pw)));
+    }
+    for( j = (n & 0x3); j; j-- ) {
+      *pr++ += *pw++;
+    }
+  } else {
+    __m128 const scalevec = _mm_set1_ps(x);
+    
+    for( j = (n >> 2); j; j--, pr += 4, pw += 4 ) {
+      __m128 const vec = _mm_mul_ps(_mm_loadu_ps(pw), scalevec);
+      _mm_storeu_ps(pr, _mm_add_ps(_mm_loadu_ps(pr), vec));
+    }
+    for( j = (n & 0x3); j; j-- ) {
+      *pr++ += *pw++ * x;
+    }
+  }
+}
+
+/* Train on one position, as NeuralNetTrain() (tList == 0) or
+   NeuralNetTrainS(). The non zero inputs are listed once, and only their
+   weight rows are visited, both for the hidden activity and for the
+   update. Every weight is changed by the same operations, in the same
+   order, as in the plain C code, so the trained net is the same. */
+
+extern int
+NeuralNetTrainSSE(neuralnet* pnn, const float arInput[], float arOutput[],
+		  const float arDesired[], float const rAlpha,
+		  const int* tList)
+{
+  int const cHidden = pnn->cHidden;
+  int i, j, nActive = 0;
+  int aiActive[SSE_TRAIN_MAX_INPUTS];
+  SSE_ALIGN(float ar[SSE_TRAIN_MAX_HIDDEN]);
+  SSE_ALIGN(float arHiddenError[SSE_TRAIN_MAX_HIDDEN]);
+  float arOutputError[SSE_TRAIN_MAX_OUTPUTS];
+  const float* prWeight;
+
+  {                                       assert( sse_trainable(pnn) ); }
+
+  for( i = 0; i < pnn->cInput; i++ ) {
+    if( arInput[i] ) {
+      aiActive[nActive++] = i;
+    }
+  }
+
+  /* Calculate activity at hidden nodes */
+  memcpy(ar, pnn->arHiddenThreshold, cHidden * sizeof(float));
+
+  for( i = 0; i < nActive; i++ ) {
+    int const k = aiActive[i];
+    addScaled(ar, pnn->arHiddenWeight + k * cHidden, arInput[k], cHidden);
+  }
+  
+  for( i = 0; i < cHidden; i++ ) {
+    ar[i] = sigmoid(-pnn->rBetaHidden * ar[i]);
+  }
+
+  /* Calculate activity at output nodes */
+  prWeight = pnn->arOutputWeight;
+
+  for( i = 0; i < pnn->cOutput; i++ ) {
+    float r = pnn->arOutputThreshold[i];
+    
+    for( j = 0; j < cHidden; j++ ) {
+      r += ar[j] * *prWeight++;
+    }
+    
+    arOutput[i] = sigmoid(-pnn->rBetaOutput * r);
+  }
+
+  /* Calculate error at output nodes */
+  for( i = 0; i < pnn->cOutput; i++ ) {
+    arOutputError[i] = ( arDesired[i] - arOutput[i] ) *
+      pnn->rBetaOutput * (arOutput[i] * ( 1 - arOutput[i] ));
+  }
+
+  /* Calculate error at hidden nodes */
+  memset(arHiddenError, 0, cHidden * sizeof(float));
+
+  for( i = 0; i < pnn->cOutput; i++ ) {
+    addScaled(arHiddenError, pnn->arOutputWeight + i * cHidden,
+	      arOutputError[i], cHidden);
+  }
+
+  for( i = 0; i < cHidden; i++ ) {
+    arHiddenError[i] *= pnn->rBetaHidden * ar[i] * (1 - ar[i]);
+  }
+
+  if( ! tList ) {
+    /* Adjust weights at output nodes */
+    for( i = 0; i < pnn->cOutput; i++ ) {
+      addScaled(pnn->arOutputWeight + i * cHidden, ar,
+		rAlpha * arOutputError[i], cHidden);
+      
+      pnn->arOutputThreshold[i] += rAlpha * arOutputError[i];
+    }
+  }
+
+  /* Adjust weights at hidden nodes. arHiddenError becomes the step. */
+  for( i = 0; i < cHidden; i++ ) {
+    arHiddenError[i] *= rAlpha;
+  }
+
+  if( ! tList ) {
+    for( i = 0; i < nActive; i++ ) {
+      int const k = aiActive[i];
+      addScaled(pnn->arHiddenWeight + k * cHidden, arHiddenError,
+		arInput[k], cHidden);
+    }
+  } else {
+    for( ; *tList >= 0; ++tList ) {
+      int const k = *tList;
+      {                                 assert( 0 <= k && k < pnn->cInput ); }
+
+      if( arInput[k] ) {
+	addScaled(pnn->arHiddenWeight + k * cHidden, arHiddenError,
+		  arInput[k], cHidden);
+      }
+    }
+  }
+  
+  addScaled(pnn->arHiddenThreshold, arHiddenError, 1.0f, cHidden);
+
+  pnn->nTrained++;
+  
+  return 0;
+}
+
 extern int
 NeuralNetEvaluateSSE(const neuralnet *pnn, float arInput[], float arOutput[])
 {
@@ -400,6 +536,18 @@ int NeuralNetEvaluateSSE(const neuralnet *pnn __attribute__((unused)), float arI
   assert(0);
 }
 
+int
+NeuralNetTrainSSE(neuralnet* pnn __attribute__((unused)),
+		  const float arInput[] __attribute__((unused)),
+		  float arOutput[] __attribute__((unused)),
+		  const float arDesired[] __attribute__((unused)),
+		  float rAlpha __attribute__((unused)),
+		  const int* tList __attribute__((unused)))
+{
+  assert(0);
+  return -1;
+}
+
 #endif
 
 extern int fuseSSE;
@@ -51,4 +51,18 @@ extern int useSSE(int useSSENet);
 struct _neuralnet;
 extern int NeuralNetEvaluateSSE(const struct _neuralnet *pnn, float arInput[], float arOutput[]);
 
+// Largest nets NeuralNetTrainSSE() takes (its buffers are fixed size); the C
+// code trains larger ones. 400 is MAX_NUM_INPUTS of inputs.h.
+#define SSE_TRAIN_MAX_INPUTS 400
+#define SSE_TRAIN_MAX_HIDDEN 512
+#define SSE_TRAIN_MAX_OUTPUTS 8
+
+#define sse_trainable(pnn) ((pnn)->cInput <= SSE_TRAIN_MAX_INPUTS &&	\
+			    (pnn)->cHidden <= SSE_TRAIN_MAX_HIDDEN &&	\
+			    (pnn)->cOutput <= SSE_TRAIN_MAX_OUTPUTS)
+
+extern int NeuralNetTrainSSE(struct _neuralnet *pnn, const float arInput[],
+			     float arOutput[], const float arDesired[],
+			     float rAlpha, const int* tList);
+
 #endif
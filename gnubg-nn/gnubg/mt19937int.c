@@ -46,6 +46,8 @@
 #include "config.h"
 #endif
 
+#include "threads.h"
+
 /* Period parameters */  
 #define N 624
 #define M 397
@@ -61,8 +63,12 @@
 #define TEMPERING_SHIFT_T(y)  (y << 15)
 #define TEMPERING_SHIFT_L(y)  (y >> 18)
 
-static unsigned long mt[N]; /* the array for the state vector  */
-static int mti=N+1; /* mti==N+1 means mt[N] is not initialized */
+/* each thread has its own generator */
+static THREAD_LOCAL unsigned long mt[N]; /* the array for the state vector  */
+static THREAD_LOCAL int mti=N+1; /* mti==N+1 means mt[N] is not initialized */
+
+/* counts the threads that fell back to the default seed */
+static unsigned int nDefaultSeeds = 0;
 
 #if 0
 /* Initializing the array with a seed */
@@ -128,7 +134,8 @@ extern unsigned long genrand( void ) {
         int kk;
 
         if (mti == N+1)   /* if sgenrand() has not been called, */
-            sgenrand(4357); /* a default initial seed is used   */
+            sgenrand(4357 + 69069 * /* a default initial seed is used */
+                     __sync_fetch_and_add(&nDefaultSeeds, 1));
 
         for (kk=0;kk<N-M;kk++) {
             y = (mt[kk]&UPPER_MASK)|(mt[kk+1]&LOWER_MASK);
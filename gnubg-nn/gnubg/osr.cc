@@ -82,7 +82,7 @@ bearProbs(uint const m[6])
   
   unsigned short const nOpp = PositionBearoff(x);
 
-  static B b;
+  static THREAD_LOCAL B b;
   
   getBearoff(nOpp, &b);
   
@@ -41,6 +41,7 @@
 #include <string.h>
 
 #include "positionid.h"
+#include "threads.h"
 
 static inline void
 addBits(unsigned char auchKey[10], int const  bitPos, int const nBits)
@@ -87,7 +88,7 @@ extern char*
 PositionID(CONST int anBoard[2][25])
 {
   unsigned char auchKey[ 10 ], *puch = auchKey;
-  static char szID[ 15 ];
+  static THREAD_LOCAL char szID[ 15 ];
   char *pch = szID;
   static char aszBase64[ 64 ] =
     "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
@@ -205,6 +206,8 @@ InitCombination( void )
       anCombination[ i ][ j ] = anCombination[ i - 1 ][ j - 1 ] +
 	anCombination[ i - 1 ][ j ];
 
+  /* publish the table before the flag; a racing thread only fills it twice */
+  __sync_synchronize();
   fCalculated = 1;
     
   return 0;
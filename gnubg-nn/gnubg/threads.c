@@ -0,0 +1,142 @@
+/*
+ * threads.c
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of version 2 of the GNU General Public License as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <pthread.h>
+#include <stdlib.h>
+
+#include "threads.h"
+
+static unsigned int nThreads = 1;
+
+/* set while a thread works on a parallel loop */
+static THREAD_LOCAL int inParallel = 0;
+
+/* registered by setParallelState() */
+static unsigned int stateSize = 0;
+static void (*saveState)(void*) = 0;
+static void (*loadState)(const void*) = 0;
+
+unsigned int
+setEvalThreads(unsigned int n)
+{
+  unsigned int const prev = nThreads;
+  
+  nThreads = n > 0 ? n : 1;
+
+  return prev;
+}
+
+unsigned int
+evalThreads(void)
+{
+  return nThreads;
+}
+
+typedef struct {
+  parallelfunc		f;
+  void*			context;
+  unsigned int		n;
+  /* next index to hand out */
+  unsigned int		next;
+  /* state of the starting thread, taken before any call of f */
+  void*			state;
+} ParallelLoop;
+
+void
+setParallelState(unsigned int size, void (*save)(void* p),
+		 void (*load)(const void* p))
+{
+  stateSize = size;
+  saveState = save;
+  loadState = load;
+}
+
+static void
+runLoop(ParallelLoop* pl)
+{
+  unsigned int i;
+  int const wasParallel = inParallel;
+  
+  inParallel = 1;
+  
+  while( (i = __sync_fetch_and_add(&pl->next, 1)) < pl->n ) {
+    pl->f(pl->context, i);
+  }
+
+  inParallel = wasParallel;
+}
+
+static void*
+loopThread(void* p)
+{
+  ParallelLoop* const pl = (ParallelLoop*)p;
+
+  if( pl->state ) {
+    loadState(pl->state);
+  }
+  
+  runLoop(pl);
+  return 0;
+}
+
+void
+parallelFor(unsigned int n, parallelfunc f, void* context)
+{
+  unsigned int const nt = nThreads < n ? nThreads : n;
+  
+  if( nt <= 1 || inParallel ) {
+    unsigned int i;
+    for(i = 0; i < n; ++i) {
+      f(context, i);
+    }
+  } else {
+    ParallelLoop pl;
+    pthread_t at[nt - 1];
+    unsigned int k, nStarted = 0;
+
+    pl.f = f;
+    pl.context = context;
+    pl.n = n;
+    pl.next = 0;
+    pl.state = 0;
+
+    if( saveState && (pl.state = malloc(stateSize)) ) {
+      saveState(pl.state);
+    }
+
+    /* if a thread can't be started, the others just do more of the work */
+    
+    for(k = 0; k < nt - 1; ++k) {
+      if( pthread_create(&at[nStarted], 0, loopThread, &pl) == 0 ) {
+	++nStarted;
+      }
+    }
+
+    runLoop(&pl);
+
+    for(k = 0; k < nStarted; ++k) {
+      pthread_join(at[k], 0);
+    }
+
+    free(pl.state);
+  }
+}
@@ -0,0 +1,59 @@
+/*
+ * threads.h
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of version 2 of the GNU General Public License as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef _THREADS_H_
+#define _THREADS_H_
+
+/* Scratch storage of the evaluator. Each thread gets its own copy, so
+   several threads may evaluate at once; the nets and the position cache
+   are shared between them. */
+#define THREAD_LOCAL __thread
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+/* Number of threads an evaluation may use internally (default 1).
+   Returns the previous value. */
+extern unsigned int
+setEvalThreads(unsigned int n);
+
+extern unsigned int
+evalThreads(void);
+
+typedef void (*parallelfunc)(void* context, unsigned int i);
+
+/* Call f(context, i) for every i in [0,n), spread over evalThreads()
+   threads, the calling one included. Returns when all calls are done.
+   Loops started from inside a parallel loop run serially. */
+extern void
+parallelFor(unsigned int n, parallelfunc f, void* context);
+
+/* Per thread state (size bytes) which the threads helping with a parallel
+   loop take over from the thread that started it: save(p) copies the
+   state of the calling thread to p, load(p) sets the state of a helping
+   thread from p. Only one state can be registered. */
+extern void
+setParallelState(unsigned int size, void (*save)(void* p),
+		 void (*load)(const void* p));
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif
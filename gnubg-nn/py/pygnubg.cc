@@ -25,11 +25,14 @@
 #endif
 
 #include <iostream>
+#include <pthread.h>
+#include <sys/time.h>
 
 #include "stdutil.h"
 
 #include <analyze.h>
 #include <bm.h>
+#include <bmscore.h>
 #include <player.h>
 #include <equities.h>
 
@@ -38,6 +41,7 @@
 extern "C" {
 #include <positionid.h>
 #include <eval.h>
+#include <threads.h>
 };
 #include <br.h>
 #include <osr.h>
@@ -58,6 +62,37 @@ typedef short int AnalyzeBoard[26];
 
 namespace {
   Player analyzer;
+
+  // The evaluator may run in several Python threads at once (the GIL is
+  // released around the long calls). analyzer and the match state in
+  // Equities/Analyze are not per-thread, so calls using them take turns.
+  
+  pthread_mutex_t analyzerMutex = PTHREAD_MUTEX_INITIALIZER;
+
+  class AnalyzerLock {
+  public:
+    AnalyzerLock(void) { pthread_mutex_lock(&analyzerMutex); }
+    ~AnalyzerLock() { pthread_mutex_unlock(&analyzerMutex); }
+  };
+
+  // Games per second of the last rollout or crollout.
+  
+  double rolloutRate = 0.0;
+
+  double
+  wallClock(void)
+  {
+    struct timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec + tv.tv_usec * 1e-6;
+  }
+
+  void
+  setRolloutRate(uint const nGames, double const start)
+  {
+    double const t = wallClock() - start;
+    rolloutRate = t > 0 ? nGames / t : 0.0;
+  }
 }
 
 namespace {
@@ -569,9 +604,11 @@ gnubg_probs(PyObject*, PyObject* const args)
     case PLY_1ANDHALF:
     {
       float p1[5];
-      
+
+      Py_BEGIN_ALLOW_THREADS
       EvaluatePosition(board, p, 0, 0, 0, 0, 0, 0);
       EvaluatePosition(board, p1, 1, 0, 0, 0, 0, 0);
+      Py_END_ALLOW_THREADS
       for(uint k = 0; k < 5; ++k) {
 				p[k] = (p[k] + p1[k])/2;
       }
@@ -591,7 +628,9 @@ gnubg_probs(PyObject*, PyObject* const args)
     }
     default:
     {
+      Py_BEGIN_ALLOW_THREADS
       EvaluatePosition(board, p, nPlies, 0, 0, 0, 0, 0);
+      Py_END_ALLOW_THREADS
       break;
     }
   }
@@ -708,7 +747,7 @@ extern bool useRaceMagic;
 static PyObject*
 gnubg_doubleroll(PyObject*, PyObject* const args, PyObject* keywds)
 {
-  if( Equities::match.xAway == 0 && Equities::match.oAway == 0 ) {
+  if( Equities::match().xAway == 0 && Equities::match().oAway == 0 ) {
     PyErr_SetString(PyExc_RuntimeError, "Not implemented for money") ;
     return 0;
   }
@@ -753,7 +792,7 @@ gnubg_doubleroll(PyObject*, PyObject* const args, PyObject* keywds)
     }
   }
 
-  if( Equities::match.cube > 1 && Equities::match.xOwns != xOnPlay ) {
+  if( Equities::match().cube > 1 && Equities::match().xOwns != xOnPlay ) {
     PyErr_Format(PyExc_RuntimeError, "side (%c) does not own cube",
 		 side) ;
     return 0;
@@ -775,20 +814,26 @@ gnubg_doubleroll(PyObject*, PyObject* const args, PyObject* keywds)
     }
   }
   
-  Analyze::nPliesToDouble = nPlies;
-
   if( nPliesVerify < 0 ) {
     nPliesVerify = (nPlies == 0 ? 0 : 2);
   }
-	
-  Analyze::nPliesToDoubleVerify = nPliesVerify;
 
-  Player::R1 const& info =
-    analyzer.rollOrDouble(board, xOnPlay, ad, APopt, APshortcuts,
-			  probs[0] >= 0 ? probs : 0);
+  Analyze::R1 info;
+
+  Py_BEGIN_ALLOW_THREADS
+  {
+    AnalyzerLock lock;
+    
+    Analyze::nPliesToDouble = nPlies;
+    Analyze::nPliesToDoubleVerify = nPliesVerify;
+
+    info = analyzer.rollOrDouble(board, xOnPlay, ad, APopt, APshortcuts,
+				 probs[0] >= 0 ? probs : 0);
   
-  centeredLDweight = s_centeredLDweight;
-  ownedLDweight = s_ownedLDweight;
+    centeredLDweight = s_centeredLDweight;
+    ownedLDweight = s_ownedLDweight;
+  }
+  Py_END_ALLOW_THREADS
 
   if( verboseInfo ) {
      PyObject* const v =
@@ -832,8 +877,18 @@ gnubg_rollout(PyObject*, PyObject* const args, PyObject* keywds)
     return 0;
   }
   
-  analyzer.rollout(board, false, p, ars, nPlies,
-		   nTruncate, cGames, level);
+  Py_BEGIN_ALLOW_THREADS
+  {
+    AnalyzerLock lock;
+
+    double const start = wallClock();
+    
+    analyzer.rollout(board, false, p, ars, nPlies,
+		     nTruncate, cGames, level);
+
+    setRolloutRate(cGames, start);
+  }
+  Py_END_ALLOW_THREADS
 
   if( ! wantSts ) {
     return Py_BuildValue("ddddd", p[0], p[1], p[2], p[3], p[4]);
@@ -848,7 +903,7 @@ gnubg_rollout(PyObject*, PyObject* const args, PyObject* keywds)
 static PyObject*
 gnubg_cubefullRollout(PyObject*, PyObject* const args, PyObject* keywds)
 {
-  if( Equities::match.xAway == 0 && Equities::match.oAway == 0 ) {
+  if( Equities::match().xAway == 0 && Equities::match().oAway == 0 ) {
     PyErr_SetString(PyExc_RuntimeError, "Not implemented for money") ;
     return 0;
   }
@@ -883,7 +938,21 @@ gnubg_cubefullRollout(PyObject*, PyObject* const args, PyObject* keywds)
 
   Analyze::set(board, anBoard, xOnPlay);
   
-  const float* r = analyzer.rolloutCubefull(anBoard, nPlies, nGames, xOnPlay);
+  float r[13];
+
+  Py_BEGIN_ALLOW_THREADS
+  {
+    AnalyzerLock lock;
+
+    double const start = wallClock();
+    
+    const float* const rc =
+      analyzer.rolloutCubefull(anBoard, nPlies, nGames, xOnPlay, false);
+    std::copy(rc, rc + 13, r);
+
+    setRolloutRate(nGames, start);
+  }
+  Py_END_ALLOW_THREADS
 
   PyObject* tuple = PyTuple_New(13);
   
@@ -946,8 +1015,11 @@ gnubg_bestmove(PyObject*, PyObject* const args, PyObject* keywds)
   }
   
   int move[8];
-  
-  int const n = findBestMove(move, dice1, dice2, board, xOnPlay, nPlies, r, reduced);
+  int n;
+
+  Py_BEGIN_ALLOW_THREADS
+  n = findBestMove(move, dice1, dice2, board, xOnPlay, nPlies, r, reduced);
+  Py_END_ALLOW_THREADS
 
   PyObject* moveTuple = PyTuple_New(n/2);
   
@@ -991,7 +1063,8 @@ gnubg_bestmove(PyObject*, PyObject* const args, PyObject* keywds)
       AnalyzeBoard b;
 	      
       setBoard(b, board);
-	      
+
+      AnalyzerLock lock;
       r = analyzer.offerResign(nPlies, 2, b, true);
     }
 
@@ -1049,6 +1122,119 @@ gnubg_bestmove(PyObject*, PyObject* const args, PyObject* keywds)
   return resultTupe;  
 }
 
+static PyObject*
+gnubg_bmcache(PyObject*, PyObject* const args, PyObject* keywds)
+{
+  const char* bmFile;
+  const char* cacheFile;
+  int interestingOnly = 1;
+
+  static const char* kwlist[] = {"bm", "cache", "i", 0};
+
+  if( !PyArg_ParseTupleAndKeywords(args, keywds, "ss|i", (char**)kwlist,
+				   &bmFile, &cacheFile, &interestingOnly)) {
+    return 0;
+  }
+
+  MoveBenchmark bm;
+  bool ok;
+
+  Py_BEGIN_ALLOW_THREADS
+  ok = bm.readText(bmFile, interestingOnly) && bm.save(cacheFile);
+  Py_END_ALLOW_THREADS
+
+  if( ! ok ) {
+    PyErr_SetString(PyExc_RuntimeError, "failed to build benchmark cache.");
+    return 0;
+  }
+
+  return PyInt_FromLong(bm.nPositions());
+}
+
+static PyObject*
+gnubg_bminfo(PyObject*, PyObject* const args)
+{
+  const char* cacheFile;
+
+  if( !PyArg_ParseTuple(args, "s", &cacheFile) ) {
+    return 0;
+  }
+
+  MoveBenchmark bm;
+  bool ok;
+
+  Py_BEGIN_ALLOW_THREADS
+  ok = bm.load(cacheFile);
+  Py_END_ALLOW_THREADS
+
+  if( ! ok ) {
+    Py_INCREF(Py_None);
+    return Py_None;
+  }
+
+  return Py_BuildValue("(ii)", bm.nPositions(), int(bm.interestingOnly()));
+}
+
+static PyObject*
+gnubg_bmscore(PyObject*, PyObject* const args, PyObject* keywds)
+{
+  const char* cacheFile;
+  int nPlies = 0;
+  int list = 0;
+
+  static const char* kwlist[] = {"cache", "n", "list", 0};
+
+  if( !PyArg_ParseTupleAndKeywords(args, keywds, "s|ii", (char**)kwlist,
+				   &cacheFile, &nPlies, &list)) {
+    return 0;
+  }
+
+  if( nPlies < 0 ) {
+    PyErr_SetString(PyExc_ValueError, "negative ply");
+    return 0;
+  }
+
+  MoveBenchmark bm;
+  MoveBenchmark::Score s;
+  float* losses = 0;
+  bool ok;
+
+  Py_BEGIN_ALLOW_THREADS
+  ok = bm.load(cacheFile);
+  if( ok ) {
+    if( list ) {
+      losses = new float [bm.nPositions()];
+    }
+    bm.score(nPlies, s, losses);
+  }
+  Py_END_ALLOW_THREADS
+
+  if( ! ok ) {
+    PyErr_SetString(PyExc_RuntimeError, "failed to load benchmark cache.");
+    return 0;
+  }
+
+  PyObject* const tuple = PyTuple_New(4 + (list ? 1 : 0));
+
+  PyTuple_SET_ITEM(tuple, 0, PyInt_FromLong(s.nPositions));
+  PyTuple_SET_ITEM(tuple, 1, PyInt_FromLong(s.nErrors));
+  PyTuple_SET_ITEM(tuple, 2, PyInt_FromLong(s.nOut));
+  PyTuple_SET_ITEM(tuple, 3, PyFloat_FromDouble(s.totalLoss));
+
+  if( list ) {
+    PyObject* const l = PyTuple_New(s.nPositions);
+
+    for(uint k = 0; k < s.nPositions; ++k) {
+      PyTuple_SET_ITEM(l, k, PyFloat_FromDouble(losses[k]));
+    }
+    PyTuple_SET_ITEM(tuple, 4, l);
+
+    delete [] losses;
+  }
+
+  return tuple;
+}
+
 static PyObject*
 roll_dice(PyObject*, PyObject*)
 {
@@ -1087,6 +1273,16 @@ gnubg_ocr(PyObject*, PyObject* const args)
   return Py_BuildValue("dd", v,stdv);
 }
 
+static PyObject*
+gnubg_rolloutrate(PyObject*, PyObject* const args)
+{
+  if( !PyArg_ParseTuple(args, "") ) {
+    return 0;
+  }
+
+  return PyFloat_FromDouble(rolloutRate);
+}
+
 static PyMethodDef gnubg_methods[] = {
   {"boardfromkey",	gnubg_boardfromkey,	METH_VARARGS,
    "Expanded board representation from key."},
@@ -1121,11 +1317,23 @@ static PyMethodDef gnubg_methods[] = {
   {"bestmove",		(PyCFunction)gnubg_bestmove,
    METH_VARARGS|METH_KEYWORDS,   "Find best move."},
 
+  {"bmcache",		(PyCFunction)gnubg_bmcache,
+   METH_VARARGS|METH_KEYWORDS,   "Build a move benchmark cache file."},
+
+  {"bminfo",		gnubg_bminfo,		METH_VARARGS,
+   "Move benchmark cache (positions, interesting only), or None."},
+
+  {"bmscore",		(PyCFunction)gnubg_bmscore,
+   METH_VARARGS|METH_KEYWORDS,   "Score current nets on a move benchmark cache."},
+
   {"rollout",           (PyCFunction)gnubg_rollout,
    METH_VARARGS|METH_KEYWORDS,  "Rollout a position" },
 
   {"crollout",           (PyCFunction)gnubg_cubefullRollout,
    METH_VARARGS|METH_KEYWORDS,  "Cubefull rollout" },
+
+  {"rolloutrate",	gnubg_rolloutrate,	METH_VARARGS,
+   "Games per second of the last rollout or crollout" },
     
   {"roll",      	roll_dice,	METH_VARARGS,
    "Roll dice" },
@@ -1187,6 +1395,25 @@ set_shortcuts(PyObject*, PyObject* const args)
   return Py_None;
 }
 
+static PyObject*
+set_threads(PyObject*, PyObject* const args)
+{
+  int n;
+  
+  if( !PyArg_ParseTuple(args, "i", &n) ) {
+    return 0;
+  }
+
+  if( n < 1 ) {
+    PyErr_SetString(PyExc_ValueError, "invalid number of threads");
+    return 0;
+  }
+
+  unsigned int const prev = setEvalThreads(n);
+
+  return PyInt_FromLong(prev);
+}
+
 static PyObject*
 set_osdb(PyObject*, PyObject* const args)
 {
@@ -1304,6 +1531,8 @@ set_score(PyObject*, PyObject* const args)
     return 0;
   }
   
+  AnalyzerLock lock;
+  
   // opp is X
   analyzer.setScore(opAway, usAway);
   analyzer.crawford(crawford);
@@ -1342,6 +1571,8 @@ set_cube(PyObject*, PyObject* const args)
     }
   }
 
+  AnalyzerLock lock;
+  
   analyzer.setCube(cube, xOwn);
   
   Py_INCREF(Py_None);
@@ -1358,6 +1589,9 @@ static PyMethodDef gnubg_set_methods[] = {
 
   {"osdb",	set_osdb,	METH_VARARGS,
    "Enable/Disable OS database" },
+
+  {"threads",	set_threads,	METH_VARARGS,
+   "Set number of threads used by an evaluation. Returns the previous value." },
   
   {"ps",	set_ps,		METH_VARARGS,
    "Set move filters" },
@@ -23,9 +23,12 @@
 #include "config.h"
 #endif
 
+#include <algorithm>
+
 extern "C" {
 #include <positionid.h>
 #include <eval.h>
+#include <threads.h>
 }
 
 #include "pytrainer.h"
@@ -124,6 +127,17 @@ public:
     double	noBGerror;
     double	maxNoBGerror;
 
+    /// Add the (unadjusted) errors of more positions.
+    void add(Errors const& e) {
+      equityError += e.equityError;
+      absEquityError += e.absEquityError;
+      noBGerror += e.noBGerror;
+      
+      maxEquityError = std::max(maxEquityError, e.maxEquityError);
+      maxAbsEquityError = std::max(maxAbsEquityError, e.maxAbsEquityError);
+      maxNoBGerror = std::max(maxNoBGerror, e.maxNoBGerror);
+    }
+    
     void adjust(uint const n) {
       equityError = sqrt(equityError / n);
       absEquityError = sqrt(absEquityError / n);
@@ -132,6 +146,9 @@ public:
   };
   
   void	errors(Errors& e) const;
+
+  /// Add the errors of positions [@arg{from},@arg{to}) to @arg{e}.
+  void	errors(Errors& e, uint from, uint to) const;
   
   void	train(double a, const int* order) const;
   
@@ -160,12 +177,12 @@ Trainer::~Trainer()
 typedef int Board[2][25];
 
 void
-Trainer::errors(Errors& e) const
+Trainer::errors(Errors& e, uint const from, uint const to) const
 {
   Board board;
   float p[5];
 
-  for(uint k = 0; k < nPositions; ++k) {
+  for(uint k = from; k < to; ++k) {
     DataPosition const& t = positions[k];
     
     PositionFromKey(board, const_cast<unsigned char*>(t.auch));
@@ -180,7 +197,48 @@ Trainer::errors(Errors& e) const
     e.add_aeq(eqAbsErr(p, t.probs));
     e.add_mnbg(noBGErr(p, t.probs));
   }
+}
 
+namespace {
+// Trainer::errors() splits the positions into chunks of this size, each
+// with its own sums, and adds the chunks up in order. The result does not
+// depend on the number of threads.
+
+uint const errorsChunk = 2048;
+
+struct ErrorsChunks {
+  const Trainer*	trainer;
+  Trainer::Errors*	errors;
+};
+
+void
+chunkErrors(void* const context, unsigned int const c)
+{
+  ErrorsChunks const& ec = *static_cast<ErrorsChunks*>(context);
+  uint const from = c * errorsChunk;
+  uint const to = std::min(from + errorsChunk, ec.trainer->nPositions);
+  
+  ec.trainer->errors(ec.errors[c], from, to);
+}
+}
+
+void
+Trainer::errors(Errors& e) const
+{
+  uint const nChunks = (nPositions + errorsChunk - 1) / errorsChunk;
+  
+  ErrorsChunks ec;
+  ec.trainer = this;
+  ec.errors = new Errors [nChunks];
+
+  parallelFor(nChunks, chunkErrors, &ec);
+
+  for(uint c = 0; c < nChunks; ++c) {
+    e.add(ec.errors[c]);
+  }
+  
+  delete [] ec.errors;
+  
   e.adjust(nPositions);
 }
 
@@ -312,7 +370,10 @@ trainer_errors(PyObject* self, PyObject*)
   Trainer& t = *static_cast<TrainerObject*>(self)->trainer;
 
   Trainer::Errors e;
+
+  Py_BEGIN_ALLOW_THREADS
   t.errors(e);
+  Py_END_ALLOW_THREADS
 
   return Py_BuildValue("dddddd",
 		       e.absEquityError, e.maxAbsEquityError,
@@ -51,6 +51,15 @@ Disable usage of small net pruning.
 Resume an interrupted run. Both @file{cmd-file} and @file{output-file} must be
 given.
 
+@item @tab --threads=@var{N} @tab
+Run up to @var{N} commands at the same time. Output is still written in input
+order. Default is 1.
+
+@item @tab --shard=@var{I}/@var{N} @tab
+Run only every @var{N}th command, starting with command @var{I} (counting
+from 0). Running @var{N} processes with @var{I} from 0 to @var{N}-1 splits
+the command file between them.
+
 @item -v	--verbose @tab Print status report to stderr during run.
 
 @item -h	--help
@@ -138,6 +147,17 @@ evaluation.
 Note that output has the same format as the input, i.e. can serve as input for
 another run.
 
+With @option{--threads}, commands between @samp{s} and @samp{r} lines are run
+in batches, and @samp{c} commands one at a time. A command rolled out without
+an @samp{r} line still has its seed drawn in input order, and written to the
+output, so the results of @samp{m}, @samp{c} and @samp{o} do not depend on the
+number of threads.
+
+With @option{--shard}, all lines other than commands (@samp{m}, @samp{c},
+@samp{o}, @samp{e}, @samp{O} and @samp{b}) are processed by every shard. The
+seed of an @samp{r} line applies to the next @samp{m}, @samp{c} or @samp{o}
+command, whichever shard runs it.
+
 The positions are encoded as 20 character in the range of @samp{A} to @samp{F}.
 Each letter stands for 4 bits (A == 0x0, F == 0xf), and concatenated they form
 the 80 bit GNUbg position ID.
@@ -163,6 +183,7 @@ the 80 bit GNUbg position ID.
 
 #include <algorithm>
 #include <string>
+#include <vector>
 
 #include "GetOpt.h"
 #include <analyze.h>
@@ -183,6 +204,7 @@ using std::cin;
 using std::cout;
 
 using std::string;
+using std::vector;
 
 using std::min;
 using std::sort;
@@ -214,7 +236,7 @@ validBoard(const char s[21])
 unsigned char*
 auchFromSring(const char s[20])
 {
-  static unsigned char auch[10];
+  static THREAD_LOCAL unsigned char auch[10];
 
   for(uint i = 0; i < 10; ++i) {
     auch[i] = ((s[2*i+0] - 'A') << 4) +  (s[2*i+1] - 'A');
@@ -226,7 +248,7 @@ auchFromSring(const char s[20])
 const char*
 posFromAuch(const unsigned char* const auch)
 {
-  static char p[21];
+  static THREAD_LOCAL char p[21];
 
   for(uint i = 0; i < 10; ++i) {
     p[2*i+0] = 'A' + ((auch[i] >> 4) & 0xf);
@@ -261,6 +283,298 @@ SortScore::operator ()(move const& i1, move const& i2) const
 }
 
 
+namespace {
+/// Run settings, from the command line and 's' lines.
+//
+struct Settings {
+  uint	moves2plyLimit;
+  uint	rolloutLimit;
+  uint	nRollOutGames;
+  uint	cubeAway;
+  uint	evalPlies;
+  bool	shortCuts;
+  uint	osrGames;
+  int	osrInRoll;
+  bool	include0Ply;
+  int	verbose;
+};
+
+/// True for lines processed as commands (and counted for --shard).
+//
+bool
+isCommand(string const& line)
+{
+  string::size_type const i = line.find_first_not_of(" \t");
+
+  return i != string::npos && strchr("mcoeOb", line[i]);
+}
+
+/// A command line of the command file.
+//
+struct Command {
+  char		opr;
+  char		b[21];
+  uint		d[2];
+
+  /// Randomizer seed of 'm', 'c' and 'o'.
+  long		seed;
+
+  /// When true, @arg{seed} was not given by an 'r' line and is written
+  /// before the output.
+  bool		newSeed;
+
+  /// Output of the command.
+  string	out;
+};
+
+/// Read the arguments of @arg{c.opr} from @arg{sline}.
+/// Return false when the line is illegal.
+//
+bool
+readCommand(istream& sline, Command& c)
+{
+  c.b[0] = 0;
+  c.d[0] = c.d[1] = 0;
+
+  if( c.opr == 'm' || c.opr == 'b' ) {
+    sline >> c.b >> c.d[0] >> c.d[1];
+
+    return ! sline.fail() && validBoard(c.b) &&
+      ((1 <= c.d[0] && c.d[0] <= 6) && (1 <= c.d[1] && c.d[1] <= 6));
+  }
+  
+  sline >> c.b;
+  
+  return ! sline.fail() && validBoard(c.b);
+}
+
+/// Run command @arg{c} ('m', 'o', 'e', 'O', 'b', or '#' to echo) and leave
+/// its output in @arg{c.out}. May run in any thread.
+//
+void
+runCommand(Command& c, Settings const& opts)
+{
+  if( c.opr == '#' ) {
+    // output already set
+    return;
+  }
+  
+#if defined(GCC3)
+  std::ostringstream out;
+#else
+  std::ostrstream out;
+#endif
+
+  const char* const b = c.b;
+  const uint* const d = c.d;
+  
+  int board[2][25];
+  int btmp[2][25];
+  float p[5];
+  
+  if( c.newSeed ) {
+    out << "r " << c.seed << endl;
+  }
+
+  PositionFromKey(board, auchFromSring(b));
+  
+  switch( c.opr ) {
+    case 'm':
+    {
+      Analyze analyzer;
+      movelist ml;
+
+      Analyze::RolloutEndsAt target = analyzer.rolloutTarget(board);
+	
+      findBestMoves(ml, 0, d[0], d[1], board, 0, false,
+		    opts.moves2plyLimit, 5.0);
+
+      fortify(ml);
+
+      for(uint k = 0; k < ml.cMoves; ++k) {
+	move& mv = ml.amMoves[k];
+
+	PositionFromKey(btmp, mv.auch);
+	SwapSides(btmp);
+	// change auch to op side from now on
+	PositionKey(btmp, mv.auch);
+
+	if( opts.verbose ) {
+	  cerr << "Evaluating 2ply " << posFromAuch(mv.auch);
+	}
+	  	  
+	EvaluatePosition(btmp, p, 2, 0, 0, 0, 0, 0);
+
+	mv.rScore = -Equities::money(p);
+	  
+	if( opts.verbose ) {
+	  cerr << " - " << mv.rScore << endl;
+	}
+      }
+
+      uint const offset = opts.include0Ply ? 1 : 0;
+	
+      // keep 0ply move (if required) always in by excluding it from sort
+      sort(ml.amMoves + offset,
+	   ml.amMoves + (ml.cMoves-offset), SortScore());
+
+      if( opts.include0Ply && opts.rolloutLimit < ml.cMoves &&
+	  ml.amMoves[opts.rolloutLimit].rScore >= ml.amMoves[0].rScore ) {
+	ml.cMoves = opts.rolloutLimit + 1;
+      } else {
+	ml.cMoves = min(ml.cMoves, int(opts.rolloutLimit));
+      }
+	
+      for(uint k = 0; k < ml.cMoves; ++k) {
+	move& mv = ml.amMoves[k];
+
+	PositionFromKey(btmp, mv.auch);
+
+	if( opts.verbose ) {
+	  cerr << "Rollout (" << opts.nRollOutGames << ") "
+	       << posFromAuch(mv.auch);
+	}
+
+	Analyze::srandom(c.seed);
+	analyzer.rollout(btmp, false, p, 0, 0, 512, opts.nRollOutGames, k,
+			 target);
+
+	mv.rScore = -Equities::money(p);
+
+	if( opts.verbose ) {
+	  cerr << " - " << mv.rScore << endl;
+	}
+
+	out << "#R " << posFromAuch(mv.auch);
+	for(uint k = 0; k < 5; ++k) {
+	  out << ' ' << p[k];
+	}
+	out << endl;
+      }
+    
+      sort(ml.amMoves, ml.amMoves + ml.cMoves, SortScore());
+
+      // Output args + moves
+
+      out << "m " << b << ' ' << d[0] << ' ' << d[1];
+      for(uint k = 0; k < ml.cMoves; ++k) {
+	move& mv = ml.amMoves[k];
+
+	out << ' ' << posFromAuch(mv.auch) << ' '
+	    << (k == 0 ? mv.rScore : (ml.amMoves[0].rScore - mv.rScore));
+      }
+      out << endl;
+	
+      delete [] ml.amMoves;
+      
+      break;
+    }
+    case 'e':
+    case 'O':
+    {
+      if( c.opr == 'e' ) {
+	EvaluatePosition(board, p, opts.evalPlies, 0, 0, 0, 0, 0);
+      } else {
+	raceProbs(board, p, opts.osrGames);
+      }
+	  
+      out << c.opr << " " << b;
+      for(uint k = 0; k < 5; ++k) {
+	out << ' ' << p[k];
+      }
+      out << endl;
+	
+      break;
+    }
+    case 'b':
+    {
+      findBestMove(0, d[0], d[1], board, false, opts.evalPlies);
+
+      SwapSides(board);
+	
+      unsigned char auch[10];
+      PositionKey(board, auch);
+
+      EvaluatePosition(board, p, opts.evalPlies, 0, 0, 0, 0, 0);
+
+      out << c.opr << " " << b << " " << d[0] << " " << d[1] << " "
+	  << posFromAuch(auch);
+	
+      for(uint k = 0; k < 5; ++k) {
+	out << ' ' << p[k];
+      }
+      out << endl;
+	
+      break;
+    }
+    case 'o':
+    {
+      Analyze analyzer;
+      
+      if( opts.verbose ) {
+	cerr << "Rollout (" << opts.nRollOutGames << ") " << b << endl;
+      }
+
+      Analyze::srandom(c.seed);
+      
+      //analyzer.rollout(board, false, p, 0, 1024, nRollOutGames, 0);
+      analyzer.rollout(board, false, p, 0, 0, 1024, opts.nRollOutGames, 0);
+	  
+      out << c.opr << " " << b;
+      for(uint k = 0; k < 5; ++k) {
+	out << ' ' << p[k];
+      }
+      out << endl;
+
+      break;
+    }
+  }
+
+#if !defined(GCC3)
+  out << std::ends;
+  c.out = out.str();
+  out.freeze(false);
+#else
+  c.out = out.str();
+#endif
+}
+
+struct Batch {
+  vector<Command>*	commands;
+  Settings const*	opts;
+};
+
+void
+runBatchCommand(void* const context, unsigned int const i)
+{
+  Batch const& b = *static_cast<Batch*>(context);
+
+  runCommand((*b.commands)[i], *b.opts);
+}
+
+/// Run @arg{commands} over the threads, write their output to @arg{out} in
+/// order and clear them.
+//
+void
+runBatch(vector<Command>& commands, Settings const& opts, ostream& out)
+{
+  if( commands.empty() ) {
+    return;
+  }
+  
+  Batch b = { &commands, &opts };
+
+  parallelFor(commands.size(), runBatchCommand, &b);
+
+  for(uint i = 0; i < commands.size(); ++i) {
+    out << commands[i].out;
+  }
+  out.flush();
+  
+  commands.clear();
+}
+}
+
 static uint const N_M2P = 257;
 static uint const N_RL = 258;
 static uint const N_RG = 259;
@@ -273,6 +587,8 @@ static uint const N_EP = 263;
 static uint const N_SC = 264;
 static uint const N_OG = 265;
 static uint const N_OSRO = 266;
+static uint const N_TH = 267;
+static uint const N_SH = 268;
 
 static const GetOptLongOption
 longOpt[] =
@@ -290,6 +606,8 @@ longOpt[] =
   { "n-osr",            GetOptLongOption::required_argument,    0,  N_OG },
   { "osr-in-roll",      GetOptLongOption::required_argument,    0,  N_OSRO },
   { "resume",           GetOptLongOption::no_argument,          0,  N_RS } ,
+  { "threads",          GetOptLongOption::required_argument,    0,  N_TH } ,
+  { "shard",            GetOptLongOption::required_argument,    0,  N_SH } ,
   
   { "verbose",		GetOptLongOption::optional_argument,	0, 'v' } , 
   { "help",		GetOptLongOption::no_argument,	        0, 'h' } , 
@@ -314,6 +632,9 @@ usage(const char* const p)
        << "  --resume                  Resume an interrupted session."
           " (both 'cmd-file' and 'output-file' must be given)."
        << endl
+       << "  --threads=N               Run commands on N threads." << endl
+       << "  --shard=I/N               Run only commands I, I+N, I+2N, ..."
+          " (0 <= I < N)." << endl
        << "  -v,--verbose=N            Verbosity level. Print progress report"
           " to stderr." << endl
        << endl
@@ -325,19 +646,25 @@ int
 main(int argc, char* argv[])
 {
   const char* wFile = "";
-  uint moves2plyLimit = 20;
-  uint rolloutLimit = 5;
-  uint nRollOutGames = 1296;
-  uint cubeAway = 7;
-  uint evalPlies = 2;
-  bool shortCuts = true;
-  uint osrGames = 1296;
-  int  osrInRoll = 1;
+
+  Settings opts;
+  opts.moves2plyLimit = 20;
+  opts.rolloutLimit = 5;
+  opts.nRollOutGames = 1296;
+  opts.cubeAway = 7;
+  opts.evalPlies = 2;
+  opts.shortCuts = true;
+  opts.osrGames = 1296;
+  opts.osrInRoll = 1;
   
-  bool include0Ply = true;
+  opts.include0Ply = true;
   bool resume = false;
   
-  int verbose = 0;
+  opts.verbose = 0;
+
+  uint nThreads = 1;
+  uint shard = 0;
+  uint nShards = 1;
   
   GetOpt opt(argc, argv, 0, longOpt);
 
@@ -352,36 +679,36 @@ main(int argc, char* argv[])
       }
       case 'v':
       {
-	verbose = opt.optarg ? atoi(opt.optarg) : 1;
+	opts.verbose = opt.optarg ? atoi(opt.optarg) : 1;
 	break;
       }
       case N_M2P:
       {
-	moves2plyLimit = atoi(opt.optarg);
+	opts.moves2plyLimit = atoi(opt.optarg);
 	break;
       }
       case N_RL:
       {
-	rolloutLimit = atoi(opt.optarg);
+	opts.rolloutLimit = atoi(opt.optarg);
 	break;
       }
       case N_RG:
       {
-	nRollOutGames = atoi(opt.optarg);
+	opts.nRollOutGames = atoi(opt.optarg);
 	break;
       }
       case N_CA:
       {
-	cubeAway = atoi(opt.optarg);
+	opts.cubeAway = atoi(opt.optarg);
 
-	if( ! (1 < cubeAway && cubeAway <= 25) ) {
+	if( ! (1 < opts.cubeAway && opts.cubeAway <= 25) ) {
 	  exit(1);
 	}
 	break;
       }
       case N_I0:
       {
-	include0Ply = atoi(opt.optarg);
+	opts.include0Ply = atoi(opt.optarg);
 	
 	break;
       }
@@ -398,7 +725,7 @@ main(int argc, char* argv[])
 	  cerr << endl << "negative plies" << endl;
 	  exit(1);
 	}
-	evalPlies = (unsigned int) i;
+	opts.evalPlies = (unsigned int) i;
 	break;
       }
       case N_OG:
@@ -409,14 +736,14 @@ main(int argc, char* argv[])
 	  cerr << endl << "non positive osrGames" << endl;
 	  exit(1);
 	}
-	osrGames = (unsigned int) i;
+	opts.osrGames = (unsigned int) i;
 	break;
       }
       case N_OSRO:
       {
-	osrInRoll = atoi(opt.optarg);
+	opts.osrInRoll = atoi(opt.optarg);
 
-	if( !( osrInRoll == 0 || osrInRoll == 1) ) {
+	if( !( opts.osrInRoll == 0 || opts.osrInRoll == 1) ) {
 	  cerr << endl << "osrInRoll must be either 0 or 1" << endl;
 	  exit(1);
 	}
@@ -424,7 +751,27 @@ main(int argc, char* argv[])
       }
       case N_SC:
       {
-	shortCuts = false;
+	opts.shortCuts = false;
+	break;
+      }
+      case N_TH:
+      {
+	int i = atoi(opt.optarg);
+
+	if( i <= 0 ) {
+	  cerr << endl << "non positive threads" << endl;
+	  exit(1);
+	}
+	nThreads = (unsigned int) i;
+	break;
+      }
+      case N_SH:
+      {
+	if( sscanf(opt.optarg, "%u/%u", &shard, &nShards) != 2 ||
+	    ! (shard < nShards) ) {
+	  cerr << endl << "shard must be I/N with 0 <= I < N" << endl;
+	  exit(1);
+	}
 	break;
       }
       case 'h':
@@ -437,7 +784,7 @@ main(int argc, char* argv[])
     }
   }
 
-  const char* const weightsVersion = Analyze::init(wFile, shortCuts);
+  const char* const weightsVersion = Analyze::init(wFile, opts.shortCuts);
   
   if( ! weightsVersion ) {
     cerr << endl << "failed to initalize GNU bg" << endl;
@@ -445,7 +792,7 @@ main(int argc, char* argv[])
     exit(1);
   }
 
-  setPlyBounds(evalPlies, moves2plyLimit, 0, 0.0);
+  setPlyBounds(opts.evalPlies, opts.moves2plyLimit, 0, 0.0);
   
   srandom(time(0));
 
@@ -493,7 +840,10 @@ main(int argc, char* argv[])
 
   Analyze analyzer;
 
-  Analyze::R1 ad(nRollOutGames);
+  Analyze::R1 ad(opts.nRollOutGames);
+
+  // commands read so far, for --shard
+  unsigned long nCommands = 0;
   
   if( resume ) {
     if( !inpFile || !outFile ) {
@@ -553,26 +903,26 @@ main(int argc, char* argv[])
 	      }
 	  
 	      if( option == "moves2plyLimit" ) {
-		moves2plyLimit = atoi(value.c_str());
+		opts.moves2plyLimit = atoi(value.c_str());
 	      } else if( option == "rolloutLimit" ) {
-		rolloutLimit = atoi(value.c_str());
+		opts.rolloutLimit = atoi(value.c_str());
 	      } else if( option == "nRollOutGames" ) {
-		nRollOutGames = atoi(value.c_str());
-		ad.nRolloutGames = nRollOutGames;
+		opts.nRollOutGames = atoi(value.c_str());
+		ad.nRolloutGames = opts.nRollOutGames;
 	      } else if( option == "cubeAway" ) {
-		cubeAway = atoi(value.c_str());
+		opts.cubeAway = atoi(value.c_str());
 	      } else if( option == "include0Ply" ) {
-		include0Ply = atoi(value.c_str());
+		opts.include0Ply = atoi(value.c_str());
 	      } else if( option == "evalPlies" ) {
-		evalPlies = atoi(value.c_str());
+		opts.evalPlies = atoi(value.c_str());
 	      } else if( option == "shortCuts" ) {
-		shortCuts = atoi(value.c_str());
+		opts.shortCuts = atoi(value.c_str());
 	    
-		setShortCuts(shortCuts);
+		setShortCuts(opts.shortCuts);
 	      } else if( option == "osrGames" ) {
-		osrGames = atoi(value.c_str());
+		opts.osrGames = atoi(value.c_str());
 	      } else if( option == "osrInRoll" ) {
-		osrInRoll = atoi(value.c_str());
+		opts.osrInRoll = atoi(value.c_str());
 	      } else {
 		cerr << "Unknown option " << option << endl;
 		exit(1);
@@ -581,7 +931,7 @@ main(int argc, char* argv[])
 	    }
 
 	    // set to new values if changed
-	    setPlyBounds(evalPlies, moves2plyLimit, 0, 0.0);
+	    setPlyBounds(opts.evalPlies, opts.moves2plyLimit, 0, 0.0);
 	
 	    //*out << endl;
 	
@@ -620,6 +970,10 @@ main(int argc, char* argv[])
 	  exit(1);
 	}
 
+	if( isCommand(line) ) {
+	  ++nCommands;
+	}
+	
 	if( line.length() <= s &&
 	    lastLine.substr(0, line.length()) == line ) {
 	  *out << "#Resumed" << endl;
@@ -634,15 +988,15 @@ main(int argc, char* argv[])
   *out << "s"
        << " version "        << version
        << " weights "        << weightsVersion
-       << " moves2plyLimit " << moves2plyLimit
-       << " rolloutLimit "   << rolloutLimit
-       << " nRollOutGames "  << nRollOutGames
-       << " cubeAway "       << cubeAway
-       << " include0Ply "    << include0Ply
-       << " evalPlies "      << evalPlies
-       << " shortCuts "      << shortCuts
-       << " osrGames "       << osrGames
-       << " osrInRoll "      << osrInRoll
+       << " moves2plyLimit " << opts.moves2plyLimit
+       << " rolloutLimit "   << opts.rolloutLimit
+       << " nRollOutGames "  << opts.nRollOutGames
+       << " cubeAway "       << opts.cubeAway
+       << " include0Ply "    << opts.include0Ply
+       << " evalPlies "      << opts.evalPlies
+       << " shortCuts "      << opts.shortCuts
+       << " osrGames "       << opts.osrGames
+       << " osrInRoll "      << opts.osrInRoll
        << endl;
   
 
@@ -651,22 +1005,20 @@ main(int argc, char* argv[])
   ad.rollOutProbs = false;
   
   // 
-  Analyze::useOSRinRollouts = osrInRoll;
+  Analyze::useOSRinRollouts = opts.osrInRoll;
   
-  char b[21];
-  uint d[2];
-  int board[2][25];
-  int btmp[2][25];
-  float p[5];
-  char opr;
+  setEvalThreads(nThreads);
+
+  // Commands are run in batches spread over the threads, and the output of
+  // a batch is written in input order.
+  
+  uint const batchSize = nThreads > 1 ? 16 * nThreads : 1;
+  vector<Command> batch;
   
   string line;
   long rseed = 0;
   
   while( ! (*in).eof() ) {
-    b[0] = 0;
-    d[0] = d[1] = 0;
-
     getline(*in, line);
 
     if( ! (*in).eof() && ! (*in).good() ) {
@@ -684,6 +1036,7 @@ main(int argc, char* argv[])
     istrstream sline(line.c_str());
 #endif
     
+    char opr;
     sline >> opr;
 
     if( sline.fail() ) {
@@ -694,6 +1047,8 @@ main(int argc, char* argv[])
     switch( opr ) {
       case 's':
       {
+	runBatch(batch, opts, *out);
+	
 	string option;
 	string value;
 
@@ -715,26 +1070,26 @@ main(int argc, char* argv[])
 	  }
 	  
 	  if( option == "moves2plyLimit" ) {
-	    moves2plyLimit = atoi(value.c_str());
+	    opts.moves2plyLimit = atoi(value.c_str());
 	  } else if( option == "rolloutLimit" ) {
-	    rolloutLimit = atoi(value.c_str());
+	    opts.rolloutLimit = atoi(value.c_str());
 	  } else if( option == "nRollOutGames" ) {
-	    nRollOutGames = atoi(value.c_str());
-	    ad.nRolloutGames = nRollOutGames;
+	    opts.nRollOutGames = atoi(value.c_str());
+	    ad.nRolloutGames = opts.nRollOutGames;
 	  } else if( option == "cubeAway" ) {
-	    cubeAway = atoi(value.c_str());
+	    opts.cubeAway = atoi(value.c_str());
 	  } else if( option == "include0Ply" ) {
-	    include0Ply = atoi(value.c_str());
+	    opts.include0Ply = atoi(value.c_str());
 	  } else if( option == "evalPlies" ) {
-	    evalPlies = atoi(value.c_str());
+	    opts.evalPlies = atoi(value.c_str());
 	  } else if( option == "shortCuts" ) {
-	    shortCuts = atoi(value.c_str());
+	    opts.shortCuts = atoi(value.c_str());
 	    
-	    setShortCuts(shortCuts);
+	    setShortCuts(opts.shortCuts);
 	  } else if( option == "osrGames" ) {
-	    osrGames = atoi(value.c_str());
+	    opts.osrGames = atoi(value.c_str());
           } else if( option == "osrInRoll" ) {
-            osrInRoll = atoi(value.c_str());
+            opts.osrInRoll = atoi(value.c_str());
 	  } else {
 	    cerr << "Unknown option " << option << endl;
 	    exit(1);
@@ -743,7 +1098,7 @@ main(int argc, char* argv[])
 	}
 
 	// set to new values if changed
-	setPlyBounds(evalPlies, moves2plyLimit, 0, 0.0);
+	setPlyBounds(opts.evalPlies, opts.moves2plyLimit, 0, 0.0);
 	
 	*out << endl;
 	
@@ -751,6 +1106,8 @@ main(int argc, char* argv[])
       }
       case 'r':
       {
+	runBatch(batch, opts, *out);
+	
 	sline >> rseed;
 
 	if( sline.fail() ) {
@@ -765,238 +1122,83 @@ main(int argc, char* argv[])
 	break;
       }
       case 'm':
+      case 'c':
+      case 'o':
+      case 'e':
+      case 'O':
+      case 'b':
       {
-	sline >> b >> d[0] >> d[1];
+	Command c;
+	c.opr = opr;
 	
-	if( sline.fail() ) {
+	if( ! readCommand(sline, c) ) {
+	  runBatch(batch, opts, *out);
+	  
 	  cerr << "Illegal line '" << line << "'" << endl;
 	  exit(1);
 	}
-	
-	if( ! (validBoard(b)  && ((1 <= d[0] && d[0] <= 6)
-				  && (1 <= d[1] && d[1] <= 6))) ) {
-	  cerr << "Illegal line '" << b << "' " << d[0] << ' ' << d[1] << endl;
-	  exit(1);
-	}
-
-	if( rseed == 0 ) {
-	  rseed = random();
-	  *out << "r " << rseed << endl;
-	}
-
-	movelist ml;
-	float maxDiff = 2.0;
 
-	PositionFromKey(board, auchFromSring(b));
-
-	Analyze::RolloutEndsAt target = analyzer.rolloutTarget(board);
+	bool const seeded = (opr == 'm' || opr == 'c' || opr == 'o');
 	
-	findBestMoves(ml, 0, d[0], d[1], board, 0, false, moves2plyLimit, 5.0);
-
-	fortify(ml);
-
-	for(uint k = 0; k < ml.cMoves; ++k) {
-	  move& mv = ml.amMoves[k];
-
-	  PositionFromKey(btmp, mv.auch);
-	  SwapSides(btmp);
-	  // change auch to op side from now on
-	  PositionKey(btmp, mv.auch);
-
-	  if( verbose ) {
-	    cerr << "Evaluating 2ply " << posFromAuch(mv.auch);
-	  }
-	  	  
-	  EvaluatePosition(btmp, p, 2, 0, 0, 0, 0, 0);
-
-	  mv.rScore = -Equities::money(p);
-	  
-	  if( verbose ) {
-	    cerr << " - " << mv.rScore << endl;
+	if( (nCommands++ % nShards) != shard ) {
+	  // another shard runs it, with the seed given for it
+	  if( seeded ) {
+	    rseed = 0;
 	  }
+	  break;
 	}
 
-	uint const offset = include0Ply ? 1 : 0;
-	
-	// keep 0ply move (if required) always in by excluding it from sort
-	sort(ml.amMoves + offset,
-	     ml.amMoves + (ml.cMoves-offset), SortScore());
-
-	if( include0Ply && rolloutLimit < ml.cMoves &&
-	    ml.amMoves[rolloutLimit].rScore >= ml.amMoves[0].rScore ) {
-	  ml.cMoves = rolloutLimit + 1;
-	} else {
-	  ml.cMoves = min(ml.cMoves, int(rolloutLimit));
-	}
-	
-	for(uint k = 0; k < ml.cMoves; ++k) {
-	  move& mv = ml.amMoves[k];
-
-	  PositionFromKey(btmp, mv.auch);
-
-	  if( verbose ) {
-	    cerr << "Rollout (" << nRollOutGames << ") "
-		 << posFromAuch(mv.auch);
-	  }
-
-	  Analyze::srandom(rseed);
-          analyzer.rollout(btmp, false, p, 0, 0, 512, nRollOutGames, k, target);
-
-	  mv.rScore = -Equities::money(p);
-
-	  if( verbose ) {
-	    cerr << " - " << mv.rScore << endl;
-	  }
-
-	  *out << "#R " << posFromAuch(mv.auch);
-	  for(uint k = 0; k < 5; ++k) {
-	    *out << ' ' << p[k];
-	  }
-	  *out << endl;
-	  
+	c.newSeed = seeded && rseed == 0;
+	if( c.newSeed ) {
+	  rseed = random();
 	}
-    
-	sort(ml.amMoves, ml.amMoves + ml.cMoves, SortScore());
-
-	// Output args + moves
+	c.seed = seeded ? rseed : 0;
 
-	*out << "m " << b << ' ' << d[0] << ' ' << d[1];
-	for(uint k = 0; k < ml.cMoves; ++k) {
-	  move& mv = ml.amMoves[k];
-
-	  PositionFromKey(btmp, mv.auch);
-	  
-	  *out << ' ' << posFromAuch(mv.auch) << ' '
-	       << (k == 0 ? mv.rScore : (ml.amMoves[0].rScore - mv.rScore));
+	if( seeded ) {
+	  // reset seed
+	  rseed = 0;
 	}
-	*out << endl;
 	
-	delete [] ml.amMoves;
+	if( opr != 'c' ) {
+	  batch.push_back(c);
 
-	// reset seed
-	rseed = 0;
-	
-	break;
-      }
-      case 'e':
-      case 'O':
-      {
-	sline >> b;
-	
-	if( sline.fail() || !validBoard(b) ) {
-	  cerr << "Illegal line '" << line << "'" << endl;
-	  exit(1);
+	  if( batch.size() >= batchSize ) {
+	    runBatch(batch, opts, *out);
+	  }
+	  break;
 	}
 
-	PositionFromKey(board, auchFromSring(b));
-
-	float p[5];
-
-	if( opr == 'e' ) {
-	  EvaluatePosition(board, p, evalPlies, 0, 0, 0, 0, 0);
-	} else {
-	  raceProbs(board, p, osrGames);
-	}
-	  
-	*out << opr << " " << b;
-	for(uint k = 0; k < 5; ++k) {
-	  *out << ' ' << p[k];
-	}
-	*out << endl;
-	
-	break;
-      }
-      case 'b':
-      {
-	sline >> b >> d[0] >> d[1];
+	// The cube analysis changes the match score, which all threads
+	// share. Run it on its own.
 	
-	if( sline.fail() ) {
-	  cerr << "Illegal line '" << line << "'" << endl;
-	  exit(1);
-	}
+	runBatch(batch, opts, *out);
 	
-	if( ! (validBoard(b)  && ((1 <= d[0] && d[0] <= 6)
-				  && (1 <= d[1] && d[1] <= 6))) ) {
-	  cerr << "Illegal line '" << b << "' " << d[0] << ' ' << d[1] << endl;
-	  exit(1);
+	if( c.newSeed ) {
+	  *out << "r " << c.seed << endl;
 	}
-
-	PositionFromKey(board, auchFromSring(b));
-	
-	int const m = findBestMove(0, d[0], d[1], board, false, evalPlies);
-
-	SwapSides(board);
 	
-	unsigned char auch[10];
-	PositionKey(board, auch);
+	Analyze::srandom(c.seed);
 
-	float p[5];
-	EvaluatePosition(board, p, evalPlies, 0, 0, 0, 0, 0);
+	int board[2][25];
+	PositionFromKey(board, auchFromSring(c.b));
 
-	*out << opr << " " << b << " " << d[0] << " " << d[1] << " "
-	     << posFromAuch(auch);
-	
-	for(uint k = 0; k < 5; ++k) {
-	  *out << ' ' << p[k];
-	}
-	*out << endl;
-	
-	break;
-      }
-      case 'c':
-      case 'o':
-      {
-	sline >> b;
-	
-	if( sline.fail() || !validBoard(b) ) {
-	  cerr << "Illegal line '" << line << "'" << endl;
-	  exit(1);
+	if( opts.verbose ) {
+	  cerr << "Cube Rollout (" << opts.nRollOutGames << ") " << c.b << endl;
 	}
 	
-	if( rseed == 0 ) {
-	  rseed = random();
-	  *out << "r " << rseed << endl;
-	}
-
-	Analyze::srandom(rseed);
-
-	PositionFromKey(board, auchFromSring(b));
-
-	if( opr == 'c' ) {
-	  if( verbose ) {
-	    cerr << "Cube Rollout (" << nRollOutGames << ") " << b << endl;
-	  }
-	
-	  analyzer.setScore(cubeAway, cubeAway);
+	analyzer.setScore(opts.cubeAway, opts.cubeAway);
 
-	  analyzer.analyze(ad, board, false, 0, 0);
+	analyzer.analyze(ad, board, false, 0, 0);
 
-	  analyzer.setScore(0, 0);
+	analyzer.setScore(0, 0);
 
-	  *out << opr << " " << b
-	       << " " << 100 * ad.matchProbNoDouble
-	       << " " << 100 * ad.matchProbDoubleTake
-	       << " "
-	       << (ad.tooGood ? "TG" :
-		   (ad.actionDouble ? (ad.actionTake ? "D/T" : "D/D") : "ND"))
-	       << endl;
-	
-	} else {
-	  if( verbose ) {
-	    cerr << "Rollout (" << nRollOutGames << ") " << b << endl;
-	  }
-
-	  //analyzer.rollout(board, false, p, 0, 1024, nRollOutGames, 0);
-	  analyzer.rollout(board, false, p, 0, 0, 1024, nRollOutGames, 0);
-	  
-	  *out << opr << " " << b;
-	  for(uint k = 0; k < 5; ++k) {
-	    *out << ' ' << p[k];
-	  }
-	  *out << endl;
-	}
-	
-	rseed = 0;
+	*out << opr << " " << c.b
+	     << " " << 100 * ad.matchProbNoDouble
+	     << " " << 100 * ad.matchProbDoubleTake
+	     << " "
+	     << (ad.tooGood ? "TG" :
+		 (ad.actionDouble ? (ad.actionTake ? "D/T" : "D/D") : "ND"))
+	     << endl;
 	
 	break;
       }
@@ -1004,12 +1206,22 @@ main(int argc, char* argv[])
       default:
       {
 	// echo comment or any other lines
-	*out << line << endl;
+	Command c;
+	c.opr = '#';
+	c.out = line + '\n';
+	
+	batch.push_back(c);
+
+	if( batch.size() >= batchSize ) {
+	  runBatch(batch, opts, *out);
+	}
 	break;
       }
     }
   }
 
+  runBatch(batch, opts, *out);
+
   if( out != &cout ) {
     delete out;
   }
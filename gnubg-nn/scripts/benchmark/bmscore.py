@@ -0,0 +1,65 @@
+#!/usr/bin/env pygnubg
+""" bmscore [-n plies] [-t threads] [-c cache] [--all] benchmark-file [weights-file ...]
+
+Move errors of nets on a benchmark file (the 'm' lines of a sagnubg output),
+as perr.py reports them, without repeating the move search for each net.
+
+The positions, their benchmark moves and the reference losses are read once
+into a binary cache (benchmark-file.bmc by default), which is rebuilt when
+the benchmark file is newer or --all differs from the cache. At 0 ply each
+net picks its move from all legal moves as perr.py does; at higher plies it
+only evaluates the benchmark moves (so nothing is 'out' above 0 ply).
+
+With no weights files, score the current nets.
+"""
+
+import sys, os.path, time
+import optparse
+
+import gnubg
+
+parser = optparse.OptionParser("%prog [OPTIONS] benchmark-file [weights-file ...]")
+parser.add_option("-n", type = "int", dest = "plies", default = 0,
+                  help = "evaluation ply")
+parser.add_option("-t", type = "int", dest = "threads", default = 1,
+                  help = "number of threads")
+parser.add_option("-c", dest = "cache", default = None,
+                  help = "cache file name")
+parser.add_option("--all", dest = "all", action = "store_true", default = False,
+                  help = "keep non interesting positions (same rollout for all moves)")
+
+options, args = parser.parse_args()
+
+if len(args) < 1 :
+  parser.print_help()
+  sys.exit(1)
+
+bmFile = args[0]
+cacheFile = options.cache or bmFile + ".bmc"
+
+gnubg.set.threads(options.threads)
+
+info = None
+if os.path.exists(cacheFile) and \
+       os.path.getmtime(cacheFile) >= os.path.getmtime(bmFile) :
+  info = gnubg.bminfo(cacheFile)
+
+if info is None or info[1] != (not options.all) :
+  t = time.time()
+  n = gnubg.bmcache(bmFile, cacheFile, i = not options.all)
+  print "# cached", n, "positions in", cacheFile, "(%.1f sec)" % (time.time() - t)
+
+for net in args[1:] or [None] :
+  if net is not None :
+    gnubg.net.set(gnubg.net.get(net))
+    gnubg.net.flush()
+    print "#", net
+
+  t = time.time()
+  tot, nErr, nOut, loss = gnubg.bmscore(cacheFile, n = options.plies)
+  t = time.time() - t
+
+  if tot > 0 :
+    print str(options.plies) + "p errors",nErr,"of",tot,"avg",loss/tot
+    print "n-out (", nOut, ")" , "%.2f%%" % ((100.0 * nOut)/tot)
+  print "# %.1f sec" % t
@@ -0,0 +1,53 @@
+#!/usr/bin/env pygnubg 
+""" trainspeed [-n passes] [-a alpha] weights-file dat-file
+
+Positions per second of training, with the plain C and with the SSE
+training kernels. Both start from the net in weights-file, and should end
+with the same net (same errors). Use contact positions to time the contact
+net.
+"""
+
+import sys, time
+import optparse
+
+import gnubg
+from bgutil import readData
+
+parser = optparse.OptionParser("%prog [OPTIONS] weights-file dat-file")
+parser.add_option("-n", type = "int", dest = "passes", default = 1,
+                  help = "passes over the data for each kernel")
+parser.add_option("-a", type = "float", dest = "alpha", default = 1.0,
+                  help = "training alpha")
+
+options, args = parser.parse_args()
+
+if len(args) != 2 :
+  parser.print_help()
+  sys.exit(1)
+
+weights, dataFileName = args
+
+data = readData(dataFileName)
+nPos = len(data)
+
+trainer = gnubg.trainer(data, 0)
+del data
+
+for sse in (0, 1) :
+  gnubg.net.set(gnubg.net.get(weights))
+  
+  gnubg.net.sse(sse)
+
+  t = time.time()
+  for k in range(options.passes) :
+    trainer.train(options.alpha)
+  t = max(time.time() - t, 0.00001)
+
+  # errors are evaluated the same way for both kernels
+  gnubg.net.sse(1)
+  gnubg.net.flush()
+  
+  e = trainer.errors()
+  
+  print "%-4s %8d pos/sec  eqerr %.6lf max %.6lf" % \
+        (("C", "sse")[sse], int(options.passes * nPos / t), e[0], e[1])
@@ -1,5 +1,5 @@
 #!/usr/bin/env pygnubg 
-""" train [-a alpha -l low-alpha -b benchnark -v -n] dat-file net-base-name"""
+""" train [-a alpha -l low-alpha -b benchnark -t threads -v -n] dat-file net-base-name"""
 
 import sys, string, os, time, glob, getopt
 
@@ -31,7 +31,7 @@ benchmarkFile = None
 iTrain = list()
 ignoreBG = 0
 
-optlist, args = getopt.getopt(sys.argv[1:], "a:l:nvb:i:", \
+optlist, args = getopt.getopt(sys.argv[1:], "a:l:nvb:i:t:", \
                               ["class=", "ignorebg"])
 
 for o, a in optlist:
@@ -51,6 +51,9 @@ for o, a in optlist:
     ignoreBG = 1
   elif o == '-i':
     iTrain = [int(x) for x in a.split()]
+  elif o == '-t':
+    # threads for the error check between cycles
+    gnubg.set.threads(int(a))
     
 
 
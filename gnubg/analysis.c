@@ -113,6 +113,7 @@ When analyzing in the background, various menus are disabled so the user does no
 #include "config.h"
 
 #include <glib.h>
+#include <glib/gstdio.h>
 #include <string.h>
 #include <stdlib.h>
 
@@ -126,12 +127,15 @@ When analyzing in the background, various menus are disabled so the user does no
 #include "analysis.h"
 #include "sound.h"
 #include "matchequity.h"
+#include "openingbook.h"
 #include "formatgs.h"
 #include "progress.h"
 #include "multithread.h"
 #include "format.h"
 #include "lib/simd.h"
 #include "matchid.h" /*for quiz autoadd*/
+#include "file.h"
+#include "sgf.h"
 
 const char *aszRating[N_RATINGS] = {
     N_("rating|Awful!"),
@@ -912,10 +916,10 @@ AnalyzeMove(moverecord * pmr, matchstate * pms, const listOLD * plParentGame,
                 {
                     movelist ml;
                     MT_Release();
-                    if (FindnSaveBestMoves(&ml, pmr->anDice[0],
-                                           pmr->anDice[1],
-                                           (ConstTanBoard) pms->anBoard, &key,
-                                           arSkillLevel[SKILL_DOUBTFUL], &ci, &pesChequer->ec, aamf) < 0) {
+                    if (BookFindnSaveBestMoves(&ml, pmr->anDice[0],
+                                               pmr->anDice[1],
+                                               (ConstTanBoard) pms->anBoard, &key,
+                                               arSkillLevel[SKILL_DOUBTFUL], &ci, &pesChequer->ec, aamf) < 0) {
                         g_free(ml.amMoves);
                         return -1;
                     }
@@ -1337,6 +1341,7 @@ UpdateProgressBar(gpointer UNUSED(unused))
 static void
 AnalyseMoveMT(Task * task)
 {
+    int *pnDone = ((AnalyseMoveTask *) task)->pnDone;
     AnalyseMoveTask *amt;
     /* we create a doubleError array of 4 values rather than store a single 1,
     because when there is a take/pass decision, we want to know the MWC vs optimum, 
@@ -1362,15 +1367,180 @@ AnalyseMoveMT(Task * task)
         task = task->pLinkedTask;
         goto analyzeDouble;
     }
+
+    if (pnDone)
+        MT_SafeInc(pnDone);
+}
+
+/* Relative cost of one evaluation with pec in a position of class pc */
+static float
+EvalCost(const evalcontext * pec, positionclass pc)
+{
+    if (pc <= CLASS_PERFECT)
+        return 0.1f;            /* exact databases */
+
+    return powf(pec->fUsePrune ? 6.0f : 21.0f, (float) pec->nPlies);
+}
+
+/* Rough estimate of the cost of analysing pmr from the position in pms,
+ * so that the expensive tasks can be started first. Forced moves and
+ * database positions are nearly free while n-ply cube decisions and
+ * chequer plays with many legal moves cost orders of magnitude more. */
+static float
+AnalysisCost(const moverecord * pmr, const matchstate * pms, int fCubeUse)
+{
+    TanBoard anBoard;
+    positionclass pc;
+    movelist ml;
+    float rCost = 1.0f;
+    int cMoves;
+
+    memcpy(anBoard, pms->anBoard, sizeof(TanBoard));
+    if (pmr->fPlayer != pms->fMove)
+        SwapSides(anBoard);
+    pc = ClassifyPosition((ConstTanBoard) anBoard, pms->bgv);
+
+    switch (pmr->mt) {
+    case MOVE_NORMAL:
+        if (fAnalyseCube && fCubeUse)
+            rCost += 2.0f * EvalCost(&esAnalysisCube.ec, pc);
+
+        if (fAnalyseMove && (cMoves = GenerateMoves(&ml, (ConstTanBoard) anBoard,
+                                                    pmr->anDice[0], pmr->anDice[1], FALSE)) > 1) {
+            int nPlies = esAnalysisChequer.ec.nPlies;
+            int cCandidates = cMoves;
+
+            if (nPlies > 0 && nPlies <= MAX_FILTER_PLIES)
+                cCandidates = MIN(cMoves, aamfAnalysis[nPlies - 1][0].Accept + aamfAnalysis[nPlies - 1][0].Extra);
+            rCost += (float) cMoves + (float) cCandidates * EvalCost(&esAnalysisChequer.ec, pc);
+        }
+        break;
+
+    case MOVE_DOUBLE:
+    case MOVE_TAKE:
+    case MOVE_DROP:
+        if (fAnalyseCube && fCubeUse)
+            rCost += 2.0f * EvalCost(&esAnalysisCube.ec, pc);
+        break;
+
+    default:
+        break;
+    }
+
+    return rCost;
+}
+
+static gint
+CompareAnalysisCost(gconstpointer p0, gconstpointer p1)
+{
+    const AnalyseMoveTask *pt0 = *(AnalyseMoveTask * const *) p0;
+    const AnalyseMoveTask *pt1 = *(AnalyseMoveTask * const *) p1;
+
+    return (pt1->rCost > pt0->rCost) - (pt1->rCost < pt0->rCost);
 }
 
+/* Whether the stored analysis of pmr is at least as strong as the current
+ * settings ask for, so that incremental analysis can keep it. pms is the
+ * match state before pmr. A chequer play whose stored move list does not
+ * contain the move played is stale: the move or an earlier one was edited
+ * since it was analysed. */
 static int
-AnalyzeGame(listOLD * plGame, int wait)
+AnalysisCurrent(const moverecord * pmr, const matchstate * pms, int fCubeUse)
+{
+    matchstate msMove;
+    TanBoard anBoard;
+    cubeinfo ci;
+    positionkey key;
+    unsigned int i;
+
+    memcpy(&msMove, pms, sizeof(msMove));
+    FixMatchState(&msMove, pmr);
+    if (pmr->fPlayer != msMove.fMove
+        && (pmr->mt == MOVE_NORMAL || pmr->mt == MOVE_RESIGN || pmr->mt == MOVE_SETDICE)) {
+        SwapSides(msMove.anBoard);
+        msMove.fMove = pmr->fPlayer;
+    }
+
+    switch (pmr->mt) {
+    case MOVE_NORMAL:
+        if (pmr->evalMoveAtMoney)
+            return FALSE;
+
+        if (fAnalyseDice && pmr->rLuck == ERR_VAL)
+            return FALSE;
+
+        if (fAnalyseCube && fCubeUse) {
+            InitBoard(anBoard, msMove.bgv);
+            GetMatchStateCubeInfo(&ci, &msMove);
+            if (memcmp(anBoard, msMove.anBoard, sizeof(TanBoard)) && GetDPEq(NULL, NULL, &ci)
+                && cmp_evalsetup(&esAnalysisCube, &pmr->CubeDecPtr->esDouble) > 0)
+                return FALSE;
+        }
+
+        if (fAnalyseMove) {
+            if (!pmr->ml.cMoves || cmp_evalsetup(&esAnalysisChequer, &pmr->esChequer) > 0)
+                return FALSE;
+
+            memcpy(anBoard, msMove.anBoard, sizeof(TanBoard));
+            ApplyMove(anBoard, pmr->n.anMove, FALSE);
+            PositionKey((ConstTanBoard) anBoard, &key);
+            for (i = 0; i < pmr->ml.cMoves; i++)
+                if (EqualKeys(key, pmr->ml.amMoves[i].key))
+                    break;
+            if (i == pmr->ml.cMoves)
+                return FALSE;
+        }
+        return TRUE;
+
+    case MOVE_DOUBLE:
+    case MOVE_TAKE:
+    case MOVE_DROP:
+        /* a take or drop shares the cube decision of its double */
+        return !fAnalyseCube || !fCubeUse || cmp_evalsetup(&esAnalysisCube, &pmr->CubeDecPtr->esDouble) <= 0;
+
+    case MOVE_RESIGN:
+        return esAnalysisCube.et == EVAL_NONE || cmp_evalsetup(&esAnalysisCube, &pmr->r.esResign) <= 0;
+
+    case MOVE_SETDICE:
+        return !fAnalyseDice || pmr->rLuck != ERR_VAL;
+
+    default:
+        return TRUE;
+    }
+}
+
+/* Queue collected analysis tasks on the thread pool, most expensive first,
+ * so that a slow decision does not end up alone at the tail of the run */
+static void
+AddAnalysisTasks(GPtrArray * apt)
+{
+    guint i;
+
+    g_ptr_array_sort(apt, CompareAnalysisCost);
+
+    for (i = 0; i < apt->len; i++) {
+        multi_debug("add task: analysis");
+        MT_AddTask(g_ptr_array_index(apt, i), TRUE);
+    }
+
+    g_ptr_array_set_size(apt, 0);
+}
+
+/* Analyse the game info record and collect analysis tasks for the other
+ * moves of the game in apt. Returns the number of tasks collected, or -1
+ * if interrupted. pnDone, if not NULL, is incremented as each task ends.
+ * In incremental mode, moves whose stored analysis is current get no task
+ * and the tasks do not update the game statistics; the caller has to
+ * recompute them with updateStatisticsGame() once the tasks are done. */
+static int
+QueueGameAnalysis(listOLD * plGame, int *pnDone, GPtrArray * apt)
 {
     unsigned int i;
+    int cTasks = 0;
     listOLD *pl = plGame->plNext;
     moverecord *pmr = pl->p;
     statcontext *psc = &pmr->g.sc;
+    const int fCubeUse = pmr->g.fCubeUse;
     matchstate msAnalyse;
     unsigned int numMoves = NumberMovesGame(plGame);
     AnalyseMoveTask *pt = NULL, *pParentTask = NULL;
@@ -1394,6 +1564,9 @@ AnalyzeGame(listOLD * plGame, int wait)
             break;
         }
 
+        if (fAnalyseIncremental && !pParentTask && AnalysisCurrent(pmr, &msAnalyse, fCubeUse))
+            goto nextmove;
+
         if (!pParentTask)
             pt = (AnalyseMoveTask *) malloc(sizeof(AnalyseMoveTask));
 
@@ -1402,7 +1575,9 @@ AnalyzeGame(listOLD * plGame, int wait)
         pt->task.pLinkedTask = NULL;
         pt->pmr = pmr;
         pt->plGame = plGame;
-        pt->psc = psc;
+        pt->psc = fAnalyseIncremental ? NULL : psc;
+        pt->pnDone = pnDone;
+        pt->rCost = AnalysisCost(pmr, &msAnalyse, fCubeUse);
         memcpy(&pt->ms, &msAnalyse, sizeof(msAnalyse));
 
         if (pmr->mt == MOVE_DOUBLE) {
@@ -1415,13 +1590,16 @@ AnalyzeGame(listOLD * plGame, int wait)
             }
         } else {
             if (pParentTask) {
+                /* the pair runs as one task */
+                pParentTask->rCost += pt->rCost;
                 pt = pParentTask;
                 pParentTask = NULL;
             }
-            multi_debug("add task: analysis");
-            MT_AddTask((Task *) pt, TRUE);
+            g_ptr_array_add(apt, pt);
+            cTasks++;
         }
 
+      nextmove:
         FixMatchState(&msAnalyse, pmr);
         if ((pmr->fPlayer != msAnalyse.fMove)
             && (pmr->mt == MOVE_NORMAL || pmr->mt == MOVE_RESIGN || pmr->mt == MOVE_SETDICE)) {
@@ -1432,6 +1610,22 @@ AnalyzeGame(listOLD * plGame, int wait)
     }
     g_assert(pl->plNext == plGame);
 
+    return cTasks;
+}
+
+static int
+AnalyzeGame(listOLD * plGame, int wait)
+{
+    statcontext *psc = &((moverecord *) plGame->plNext->p)->g.sc;
+    GPtrArray *apt = g_ptr_array_new();
+    int n = QueueGameAnalysis(plGame, NULL, apt);
+
+    AddAnalysisTasks(apt);
+    g_ptr_array_free(apt, TRUE);
+
+    if (n < 0)
+        return -1;              /* Interrupted */
+
     if (wait) {
         int result;
 
@@ -1440,6 +1634,8 @@ AnalyzeGame(listOLD * plGame, int wait)
 
         if (result == -1)
             IniStatcontext(psc);
+        else if (fAnalyseIncremental)
+            updateStatisticsGame(plGame);
 
         return result;
     } else
@@ -1672,6 +1868,7 @@ CommandAnalyseMatch(char *UNUSED(sz))
 {
     listOLD *pl;
     moverecord *pmr;
+    GPtrArray *apt;
     int nMoves;
     int fStore_crawford;
     int doAR=(esAnalysisChequer.ec.fAutoRollout || esAnalysisCube.ec.fAutoRollout);
@@ -1709,10 +1906,12 @@ CommandAnalyseMatch(char *UNUSED(sz))
     }
 
     IniStatcontext(&scMatch);
- 
+
+    /* collect the tasks of all games so they can be scheduled together */
+    apt = g_ptr_array_new();
     for (pl = lMatch.plNext; pl != &lMatch; pl = pl->plNext) {
 
-        if (AnalyzeGame(pl->p, FALSE) < 0) {
+        if (QueueGameAnalysis(pl->p, NULL, apt) < 0) {
             /* analysis incomplete; erase partial summary */
 
             IniStatcontext(&scMatch);
@@ -1724,9 +1923,15 @@ CommandAnalyseMatch(char *UNUSED(sz))
         AddStatcontext(&pmr->g.sc, &scMatch);
     }
 
+    AddAnalysisTasks(apt);
+    g_ptr_array_free(apt, TRUE);
+
     multi_debug("wait for all task: analysis");
     MT_WaitForTasks(UpdateProgressBar, 250, fAutoSaveAnalysis);
 
+    if (fAnalyseIncremental && !fInterrupt)
+        updateStatisticsMatch(&lMatch);
+
     /*Post-analysis AutoRollout*/
     if(doAR) {
         fGameARRunning=TRUE;
@@ -1761,6 +1966,360 @@ CommandAnalyseSession(char *sz)
     CommandAnalyseMatch(sz);
 }
 
+/*
+ * "analyse directory": import, analyse and save every match in a folder.
+ *
+ * The matches are imported one at a time (import uses the global match
+ * state) and then detached from it, so that the next file can be imported
+ * while the thread pool is still analysing the previous ones. When all
+ * tasks of a match are done, it is attached again, its statistics are
+ * computed and it is saved as SGF. Up to ANALYSE_DIR_WINDOW matches are in
+ * the pool at any time. Files whose SGF output is newer than the input are
+ * skipped, so an interrupted run can simply be restarted.
+ */
+
+#define ANALYSE_DIR_WINDOW 4
+
+typedef struct {
+    char *szInput;
+    char *szOutput;
+    listOLD lMatch;
+    matchinfo mi;
+    char aszName[2][MAX_NAME_LEN];
+    int nMatchTo;
+    unsigned int nMoves;
+    int cTasks;
+    int cDone;
+    gint64 tStart;
+} analysejob;
+
+static void
+MoveMatchList(listOLD * plTo, listOLD * plFrom)
+{
+    ListCreate(plTo);
+
+    if (ListEmpty(plFrom))
+        return;
+
+    *plTo = *plFrom;
+    plTo->plNext->plPrev = plTo;
+    plTo->plPrev->plNext = plTo;
+    ListCreate(plFrom);
+}
+
+/* Take the match just imported away from the global match state */
+static void
+DetachMatch(analysejob * paj)
+{
+    MoveMatchList(&paj->lMatch, &lMatch);
+
+    paj->mi = mi;
+    memset(&mi, 0, sizeof(mi));
+    g_strlcpy(paj->aszName[0], ap[0].szName, MAX_NAME_LEN);
+    g_strlcpy(paj->aszName[1], ap[1].szName, MAX_NAME_LEN);
+    paj->nMatchTo = ms.nMatchTo;
+
+    ClearMatch();
+    plGame = plLastMove = NULL;
+}
+
+static void
+AttachMatch(analysejob * paj)
+{
+    FreeMatch();
+    ClearMatch();
+
+    MoveMatchList(&lMatch, &paj->lMatch);
+
+    mi = paj->mi;
+    memset(&paj->mi, 0, sizeof(paj->mi));
+    g_strlcpy(ap[0].szName, paj->aszName[0], MAX_NAME_LEN);
+    g_strlcpy(ap[1].szName, paj->aszName[1], MAX_NAME_LEN);
+    ms.nMatchTo = paj->nMatchTo;
+    plGame = ListEmpty(&lMatch) ? NULL : lMatch.plPrev->p;
+}
+
+static void
+FreeAnalyseJob(analysejob * paj)
+{
+    AttachMatch(paj);
+    FreeMatch();
+    ClearMatch();
+    plGame = plLastMove = NULL;
+
+    g_free(paj->szInput);
+    g_free(paj->szOutput);
+    g_free(paj);
+}
+
+static gboolean
+AnalyseDirectoryProgress(gpointer UNUSED(unused))
+{
+    return TRUE;
+}
+
+/* Import szInput and queue its analysis. Returns NULL on failure. */
+static analysejob *
+QueueMatchAnalysis(const char *szInput, const char *szOutput)
+{
+    analysejob *paj;
+    gchar *szCommand;
+    listOLD *pl;
+    GPtrArray *apt;
+
+    szCommand = g_strdup_printf("import auto \"%s\"", szInput);
+    HandleCommand(szCommand, acTop);
+    g_free(szCommand);
+
+    if (!plGame || ListEmpty(&lMatch)) {
+        FreeMatch();
+        ClearMatch();
+        plGame = plLastMove = NULL;
+        return NULL;
+    }
+
+    paj = g_new0(analysejob, 1);
+    paj->szInput = g_strdup(szInput);
+    paj->szOutput = g_strdup(szOutput);
+    paj->tStart = g_get_monotonic_time();
+    paj->nMoves = NumberMovesMatch(&lMatch);
+
+    DetachMatch(paj);
+
+    apt = g_ptr_array_new();
+    for (pl = paj->lMatch.plNext; pl != &paj->lMatch; pl = pl->plNext) {
+        int c = QueueGameAnalysis(pl->p, &paj->cDone, apt);
+
+        if (c < 0)
+            break;              /* interrupted */
+        paj->cTasks += c;
+    }
+    AddAnalysisTasks(apt);
+    g_ptr_array_free(apt, TRUE);
+
+#if !defined(USE_MULTITHREAD)
+    /* without threads the tasks only run while we wait for them */
+    MT_WaitForTasks(AnalyseDirectoryProgress, 1000, FALSE);
+#endif
+
+    return paj;
+}
+
+static void
+ShowMatchSummary(const char *szFile)
+{
+    GList *list = formatGS(&scMatch, ms.nMatchTo, FORMATGS_OVERALL);
+    GList *pl;
+
+    outputf("%s: %s vs %s\n", szFile, ap[0].szName, ap[1].szName);
+    for (pl = g_list_first(list); pl; pl = g_list_next(pl)) {
+        char **asz = pl->data;
+
+        outputf("    %-40s %-20s %-20s\n", asz[0], asz[1], asz[2]);
+    }
+    freeGS(list);
+}
+
+/* Compute statistics for a fully analysed match and save it */
+static int
+SaveMatchAnalysis(analysejob * paj)
+{
+    gchar *szTemp = g_strconcat(paj->szOutput, ".tmp", NULL);
+    FILE *pf;
+    listOLD *pl;
+    int fOK;
+
+    AttachMatch(paj);
+
+    if (esAnalysisChequer.ec.fAutoRollout || esAnalysisCube.ec.fAutoRollout) {
+        fGameARRunning = TRUE;
+        cmark_match_rollout(&lMatch);
+        fGameARRunning = FALSE;
+    }
+
+    updateStatisticsMatch(&lMatch);
+
+    /* write to a temporary file first so that a partial output never
+     * looks complete to a later run */
+    if (!(pf = g_fopen(szTemp, "w"))) {
+        outputerr(szTemp);
+        g_free(szTemp);
+        DetachMatch(paj);
+        return -1;
+    }
+    setvbuf(pf, NULL, _IOFBF, SGF_WRITE_BUFFER);
+
+    for (pl = lMatch.plNext; pl != &lMatch; pl = pl->plNext)
+        SaveGame(pf, pl->p);
+
+    fOK = !ferror(pf);
+    fOK = !fclose(pf) && fOK;
+
+    if (fOK) {
+        g_unlink(paj->szOutput);
+        fOK = !g_rename(szTemp, paj->szOutput);
+    }
+    if (!fOK) {
+        outputerr(paj->szOutput);
+        g_unlink(szTemp);
+    } else
+        ShowMatchSummary(paj->szOutput);
+
+    g_free(szTemp);
+    DetachMatch(paj);
+
+    return fOK ? 0 : -1;
+}
+
+extern void
+CommandAnalyseDirectory(char *sz)
+{
+    char *szIn = NextToken(&sz);
+    char *szOut = NextToken(&sz);
+    GPtrArray *aszFiles;
+    ImportType *atype;
+    GQueue qJobs;
+    analysejob *paj;
+    unsigned int i, cAnalysed = 0, cSkipped = 0, cFailed = 0, nMoves = 0;
+    gint64 tStart = g_get_monotonic_time();
+    double rElapsed;
+
+    if (!szIn || !*szIn || !szOut || !*szOut) {
+        outputl(_("You must specify an input and an output folder (see `help analyse directory')."));
+        return;
+    }
+#if defined(USE_GTK)
+    if (fX) {
+        outputl(_("`analyse directory' is only available in the command line interface."));
+        return;
+    }
+#endif
+
+    if (CheckSettings())
+        return;
+
+    if (!(aszFiles = ListFolderFiles(szIn))) {
+        outputerrf(_("Cannot read folder `%s'"), szIn);
+        return;
+    }
+
+    if (g_mkdir_with_parents(szOut, 0755) < 0) {
+        outputerr(szOut);
+        g_ptr_array_free(aszFiles, TRUE);
+        return;
+    }
+
+    if (SameFolder(szIn, szOut)) {
+        outputl(_("The output folder must be different from the input folder."));
+        g_ptr_array_free(aszFiles, TRUE);
+        return;
+    }
+
+    if (!get_input_discard()) {
+        g_ptr_array_free(aszFiles, TRUE);
+        return;
+    }
+
+    FreeMatch();
+    ClearMatch();
+    plGame = plLastMove = NULL;
+
+    atype = ReadImportTypes(aszFiles);
+
+    g_queue_init(&qJobs);
+    fBatchAnalysisRunning = TRUE;
+
+    for (i = 0; i <= aszFiles->len && !fInterrupt; i++) {
+        /* save the matches whose analysis is complete, waiting for the
+         * oldest one while the window is full or at the end */
+        while ((paj = g_queue_peek_head(&qJobs))
+               && (MT_SafeGet(&paj->cDone) == paj->cTasks
+                   || g_queue_get_length(&qJobs) >= ANALYSE_DIR_WINDOW || i == aszFiles->len)) {
+            if (MT_SafeGet(&paj->cDone) != paj->cTasks) {
+                if (MT_SafeGet(&td.result) < 0) {
+                    /* a failed move analysis called MT_AbortTasks(), which
+                     * dropped the queued tasks of every match: these
+                     * matches fail, the next ones start afresh */
+#if defined(USE_MULTITHREAD)
+                    MT_WaitForTasks(NULL, UI_UPDATETIME, FALSE);
+#endif
+                    while ((paj = g_queue_pop_head(&qJobs))) {
+                        outputf(_("Could not analyse `%s'\n"), paj->szInput);
+                        cFailed++;
+                        FreeAnalyseJob(paj);
+                    }
+                    break;
+                }
+                g_usleep(UI_UPDATETIME * 100);
+                ProcessEvents();
+                if (fInterrupt)
+                    break;
+                continue;
+            }
+
+            g_queue_pop_head(&qJobs);
+            if (SaveMatchAnalysis(paj) < 0)
+                cFailed++;
+            else {
+                cAnalysed++;
+                nMoves += paj->nMoves;
+                rElapsed = (g_get_monotonic_time() - tStart) / 1000000.0;
+                outputf(_("[%u/%u] %.1f s, %.1f moves/s overall\n"), cAnalysed + cSkipped + cFailed,
+                        aszFiles->len, (g_get_monotonic_time() - paj->tStart) / 1000000.0,
+                        rElapsed > 0 ? nMoves / rElapsed : 0.0);
+            }
+            outputx();
+            FreeAnalyseJob(paj);
+        }
+
+        if (i < aszFiles->len && !fInterrupt) {
+            const char *szInput = g_ptr_array_index(aszFiles, i);
+            gchar *szBase = g_path_get_basename(szInput);
+            gchar *pch = strrchr(szBase, '.');
+            gchar *szOutput;
+
+            if (pch && pch != szBase)
+                *pch = 0;
+            szOutput = g_strdup_printf("%s" G_DIR_SEPARATOR_S "%s.sgf", szOut, szBase);
+            g_free(szBase);
+
+            if (atype[i] == N_IMPORT_TYPES) {
+                /* not a match file */
+            } else if (OutputUpToDate(szInput, szOutput)) {
+                cSkipped++;
+            } else if ((paj = QueueMatchAnalysis(szInput, szOutput))) {
+                g_queue_push_tail(&qJobs, paj);
+            } else {
+                outputf(_("Could not import `%s'\n"), szInput);
+                cFailed++;
+            }
+
+            g_free(szOutput);
+        }
+    }
+
+    /* drain the pool before the matches it refers to are freed */
+#if defined(USE_MULTITHREAD)
+    MT_WaitForTasks(NULL, UI_UPDATETIME, FALSE);
+#endif
+    while ((paj = g_queue_pop_head(&qJobs)))
+        FreeAnalyseJob(paj);
+
+    fBatchAnalysisRunning = FALSE;
+
+    rElapsed = (g_get_monotonic_time() - tStart) / 1000000.0;
+    outputf(_("Analysed %u matches (%u moves) in %.1f s: %.1f moves/s, %.1f matches/min.\n"
+              "%u skipped as up to date, %u failed%s.\n"),
+            cAnalysed, nMoves, rElapsed, rElapsed > 0 ? nMoves / rElapsed : 0.0,
+            rElapsed > 0 ? cAnalysed * 60.0 / rElapsed : 0.0, cSkipped, cFailed,
+            fInterrupt ? _(", interrupted") : "");
+    outputx();
+
+    g_free(atype);
+    g_ptr_array_free(aszFiles, TRUE);
+    playSound(SOUND_ANALYSIS_FINISHED);
+}
+
 
 
 extern void
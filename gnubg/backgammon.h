@@ -289,6 +289,7 @@ typedef void (*AsyncFun) (void *);
 void asyncDumpDecision(decisionData * pdd);
 void asyncFindBestMoves(findData * pfd);
 void asyncFindMove(findData * pfd);
+void asyncFindBookMove(findData * pfd);
 void asyncScoreMove(scoreData * psd);
 void asyncEvalRoll(decisionData * pdd);
 void asyncAnalyzeMove(moveData * pmd);
@@ -365,6 +366,7 @@ extern float rEvalsPerSec;
 extern float rRatingOffset;
 extern int fAnalyseCube;
 extern int fAnalyseDice;
+extern int fAnalyseIncremental;
 extern int fAnalyseMove;
 extern int fAutoBearoff;
 extern int fAutoCrawford;
@@ -389,12 +391,17 @@ extern int fPlayersAreSame;
 extern int fTruncEqualPlayer0;
 extern int fCubeUse;
 extern int fDisplay;
+extern int fExternalConcurrent;
+extern int nExternalBatchWindow;
 extern int fFullScreen;
 extern int fGotoFirstGame;
 extern int fInvertMET;
 extern int fJacoby;
 extern int fNextTurn;
 extern int fOutputRawboard;
+extern int fOSRPersist;
+extern char *OSRCacheFile(void);
+extern void ShowStartupTimes(void);
 extern int fRecord;
 extern int fShowProgress;
 extern int fStyledGamelist;
@@ -559,6 +566,7 @@ extern void CommandAnalyseClearGame(char *);
 extern void CommandAnalyseClearMatch(char *);
 extern void CommandAnalyseClearMove(char *);
 extern void CommandAnalyseGame(char *);
+extern void CommandAnalyseDirectory(char *);
 extern void CommandAnalyseMatch(char *);
 extern void CommandAnalyseMove(char *);
 extern void CommandAnalyseRolloutCube(char *);
@@ -607,6 +615,7 @@ extern void CommandDrop(char *);
 extern void CommandEndGame(char *);
 extern void CommandEq2MWC(char *);
 extern void CommandEval(char *);
+extern void CommandExportDirectoryHtml(char *);
 extern void CommandExportGameGam(char *);
 extern void CommandExportGameSnowieTxt(char *);
 extern void CommandExportGameHtml(char *);
@@ -639,6 +648,7 @@ extern void CommandHelp(char *);
 extern void CommandHint(char *);
 extern void CommandHistory(char *);
 extern void CommandImportAuto(char *);
+extern void CommandImportDirectory(char *);
 extern void CommandImportBGRoom(char *);
 extern void CommandImportEmpire(char *);
 extern void CommandImportJF(char *);
@@ -653,6 +663,7 @@ extern void CommandListMatch(char *);
 extern void CommandLoadCommands(char *);
 extern void CommandLoadGame(char *);
 extern void CommandLoadMatch(char *);
+extern void CommandLoadOpeningBook(char *);
 extern void CommandLoadPosition(char *);
 extern void CommandLoadPython(char *);
 extern void CommandMove(char *);
@@ -681,6 +692,7 @@ extern void CommandRoll(char *);
 extern void CommandRollout(char *);
 extern void CommandSaveGame(char *);
 extern void CommandSaveMatch(char *);
+extern void CommandSaveOpeningBook(char *);
 extern void CommandSavePosition(char *);
 extern void CommandSaveSettings(char *);
 extern void CommandSetAnalysisBackground(char *);
@@ -690,6 +702,7 @@ extern void CommandSetAnalysisCubedecision(char *);
 extern void CommandSetAnalysisFileSetting(char*);
 extern void CommandSetAnalysisLimit(char *);
 extern void CommandSetAnalysisLuckAnalysis(char *);
+extern void CommandSetAnalysisIncremental(char *);
 extern void CommandSetAnalysisLuck(char *);
 extern void CommandSetAnalysisMoveFilter(char *);
 extern void CommandSetAnalysisMoves(char *);
@@ -778,6 +791,7 @@ extern void CommandSetExportHTMLCSSInline(char *);
 extern void CommandSetExportHTMLPictureURL(char *);
 extern void CommandSetExportHtmlSize(char *);
 extern void CommandSetExportHTMLTypeBBS(char *);
+extern void CommandSetExportHTMLTypeBoards(char *);
 extern void CommandSetExportHTMLTypeFibs2html(char *);
 extern void CommandSetExportHTMLTypeGNU(char *);
 extern void CommandSetExportIncludeAnalysis(char *);
@@ -796,6 +810,8 @@ extern void CommandSetExportParametersRollout(char *);
 extern void CommandSetExportPNGSize(char *);
 extern void CommandSetExportShowBoard(char *);
 extern void CommandSetExportShowPlayer(char *);
+extern void CommandSetExternalBatchWindow(char *);
+extern void CommandSetExternalConcurrent(char *);
 extern void CommandSetFirstTimeUpdates(char *sz);
 extern void CommandSetFullScreen(char *);
 extern void CommandSetGameList(char *);
@@ -855,6 +871,8 @@ extern void CommandSetOutputMWC(char *);
 extern void CommandSetOutputOutput(char *sz);
 extern void CommandSetOutputRawboard(char *);
 extern void CommandSetOutputWinPC(char *);
+extern void CommandSetOpeningBook(char *);
+extern void CommandSetOSRPersist(char *);
 extern void CommandSetPanels(char *);
 extern void CommandSetPanelWidth(char *);
 extern void CommandSetPlayer(char *);
@@ -890,9 +908,11 @@ extern void CommandSetRNGIsaac(char *);
 extern void CommandSetRNGManual(char *);
 extern void CommandSetRNGMD5(char *);
 extern void CommandSetRNGMersenne(char *);
+extern void CommandSetRNGPhilox(char *);
 extern void CommandSetRNGRandomDotOrg(char *);
 extern void CommandSetRolloutBearoffTruncationExact(char *);
 extern void CommandSetRolloutBearoffTruncationOS(char *);
+extern void CommandSetRolloutOSRTruncation(char *);
 extern void CommandSetRollout(char *);
 extern void CommandSetRolloutChequerplay(char *);
 extern void CommandSetRolloutCubedecision(char *);
@@ -1031,6 +1051,7 @@ extern void CommandShowMatchLength(char *);
 extern void CommandShowMatchResult(char *);
 extern void CommandShowMWC(char *);
 extern void CommandShowOneSidedRollout(char *);
+extern void CommandShowOpeningBook(char *);
 extern void CommandShowOutput(char *);
 extern void CommandShowPanels(char *);
 extern void CommandShowPipCount(char *);
@@ -1045,6 +1066,7 @@ extern void CommandShowScore(char *);
 extern void CommandShowScoreSheet(char *);
 extern void CommandShowSeed(char *);
 extern void CommandShowSound(char *);
+extern void CommandShowStatisticsFile(char *);
 extern void CommandShowStatisticsGame(char *);
 extern void CommandShowStatisticsMatch(char *);
 extern void CommandShowStatisticsSession(char *);
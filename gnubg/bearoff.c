@@ -38,6 +38,7 @@
 
 #define HEURISTIC_C 15
 #define HEURISTIC_P 6
+#define HEURISTIC_SIZE (40 + 54264 * 64)
 
 static int
 setGammonProb(const TanBoard anBoard, unsigned int bp0, unsigned int bp1, float *g0, float *g1)
@@ -64,7 +65,7 @@ setGammonProb(const TanBoard anBoard, unsigned int bp0, unsigned int bp1, float
         struct GammonProbs *gp = getBearoffGammonProbs(anBoard[0]);
         double make[3];
 
-        if (BearoffDist(pbc1, bp1, NULL, NULL, NULL, prob, NULL))
+        if (BearoffDist(GetBearoff(BDB_1), bp1, NULL, NULL, NULL, prob, NULL))
             return -1;
 
         make[0] = gp->p0 / 36.0;
@@ -80,7 +81,7 @@ setGammonProb(const TanBoard anBoard, unsigned int bp0, unsigned int bp1, float
         struct GammonProbs *gp = getBearoffGammonProbs(anBoard[1]);
         double make[3];
 
-        if (BearoffDist(pbc1, bp0, NULL, NULL, NULL, prob, NULL))
+        if (BearoffDist(GetBearoff(BDB_1), bp0, NULL, NULL, NULL, prob, NULL))
             return -1;
 
         make[0] = gp->p0 / 36.0;
@@ -234,7 +235,7 @@ GenerateBearoff(unsigned char *p, unsigned int nId)
 static unsigned char *
 HeuristicDatabase(void (*pfProgress) (unsigned int))
 {
-    unsigned char *pm = malloc(40 + 54264 * 64);
+    unsigned char *pm = malloc(HEURISTIC_SIZE);
     unsigned char *p;
     unsigned int i;
 
@@ -939,6 +940,75 @@ BearoffInit(const char *szFilename, const unsigned int bo, void (*p) (unsigned i
     return pbc;
 }
 
+/* Write a generated heuristic database to szFilename, with the header of
+ * an uncompressed one-sided database so BearoffInit() can read it back.
+ * It is written to a temporary file first so that a partial file is never
+ * picked up. Failing is not an error; it is just generated again. */
+
+static void
+SaveHeuristic(unsigned char *pm, const char *szFilename)
+{
+    static const char szHeader[] = "gnubg-OS-06-15-0-0-0heuristicxxxxxxxxxx\n";
+    char *szTemp = g_strconcat(szFilename, ".XXXXXX", NULL);
+    FILE *pf;
+    int fd, fOK;
+
+    memcpy(pm, szHeader, 40);
+
+    /* a unique name, as several instances may generate it at once */
+    if ((fd = g_mkstemp(szTemp)) < 0) {
+        g_free(szTemp);
+        return;
+    }
+
+    if ((pf = fdopen(fd, "wb")) == NULL) {
+        close(fd);
+        g_unlink(szTemp);
+        g_free(szTemp);
+        return;
+    }
+
+    fOK = fwrite(pm, 1, HEURISTIC_SIZE, pf) == HEURISTIC_SIZE;
+    if (fclose(pf))
+        fOK = FALSE;
+
+    if (!fOK || g_rename(szTemp, szFilename))
+        g_unlink(szTemp);
+
+    g_free(szTemp);
+}
+
+/*
+ * The heuristic one-sided database, used when gnubg_os0.bd is missing.
+ *
+ * Generating it takes a noticeable time, so if szCache is given the
+ * database is saved there and later runs only have to map it.
+ */
+
+extern bearoffcontext *
+BearoffHeuristic(const char *szCache, void (*p) (unsigned int))
+{
+    bearoffcontext *pbc;
+
+    if (szCache && g_file_test(szCache, G_FILE_TEST_IS_REGULAR)) {
+        pbc = BearoffInit(szCache, BO_IN_MEMORY | BO_MUST_BE_ONE_SIDED, NULL);
+        if (pbc && pbc->map && g_mapped_file_get_length(pbc->map) == HEURISTIC_SIZE
+            && pbc->nPoints == HEURISTIC_P && pbc->nChequers == HEURISTIC_C
+            && !pbc->fGammon && !pbc->fCompressed && !pbc->fND) {
+            pbc->fHeuristic = TRUE;
+            return pbc;
+        }
+        BearoffClose(pbc);
+    }
+
+    pbc = BearoffInit(NULL, BO_HEURISTIC, p);
+
+    if (szCache && pbc->p)
+        SaveHeuristic(pbc->p, szCache);
+
+    return pbc;
+}
+
 extern float
 fnd(const float x, const float mu, const float sigma)
 {
@@ -59,6 +59,8 @@ enum bearoffoptions {
 
 extern bearoffcontext *BearoffInit(const char *szFilename, const unsigned int bo, void (*p) (unsigned int));
 
+extern bearoffcontext *BearoffHeuristic(const char *szCache, void (*p) (unsigned int));
+
 extern int
  BearoffEval(const bearoffcontext * pbc, const TanBoard anBoard, float arOutput[]);
 
@@ -43,7 +43,9 @@ static int PyMySQLConnect(const char *dbfilename, const char *user, const char *
 static void PyDisconnect(void);
 static RowSet *PySelect(const char *str);
 static int PyUpdateCommand(const char *str);
+static void PyBegin(void);
 static void PyCommit(void);
+static void PyRollback(void);
 static int PyPostgreConnect(const char *dbfilename, const char *user, const char *password, const char *hostname);
 static GList *PyPostgreGetDatabaseList(const char *user, const char *password, const char *hostname);
 static int PyPostgreDeleteDatabase(const char *dbfilename, const char *user, const char *password,
@@ -56,7 +58,9 @@ static int SQLiteConnect(const char *dbfilename, const char *user, const char *p
 static void SQLiteDisconnect(void);
 static RowSet *SQLiteSelect(const char *str);
 static int SQLiteUpdateCommand(const char *str);
+static void SQLiteBegin(void);
 static void SQLiteCommit(void);
+static void SQLiteRollback(void);
 #endif
 
 #if NUM_PROVIDERS
@@ -69,7 +73,9 @@ static DBProvider providers[NUM_PROVIDERS] = {
 	.Disconnect = SQLiteDisconnect,
 	.Select = SQLiteSelect,
 	.UpdateCommand = SQLiteUpdateCommand,
+	.Begin = SQLiteBegin,
 	.Commit = SQLiteCommit,
+	.Rollback = SQLiteRollback,
 	.GetDatabaseList = SQLiteGetDatabaseList,
 	.DeleteDatabase = SQLiteDeleteDatabase,
 	.name = "SQLite",
@@ -90,7 +96,9 @@ static DBProvider providers[NUM_PROVIDERS] = {
 	.Disconnect = PyDisconnect,
 	.Select = PySelect,
 	.UpdateCommand = PyUpdateCommand,
+	.Begin = PyBegin,
 	.Commit = PyCommit,
+	.Rollback = PyRollback,
 	.GetDatabaseList = SQLiteGetDatabaseList,
 	.DeleteDatabase = SQLiteDeleteDatabase,
 	.name = "SQLite (Python)",
@@ -109,7 +117,9 @@ static DBProvider providers[NUM_PROVIDERS] = {
 	.Disconnect = PyDisconnect,
 	.Select = PySelect,
 	.UpdateCommand = PyUpdateCommand,
+	.Begin = PyBegin,
 	.Commit = PyCommit,
+	.Rollback = PyRollback,
 	.GetDatabaseList = PyMySQLGetDatabaseList,
 	.DeleteDatabase = PyMySQLDeleteDatabase,
 	.name = "MySQL (Python)",
@@ -127,7 +137,9 @@ static DBProvider providers[NUM_PROVIDERS] = {
 	.Disconnect = PyDisconnect,
 	.Select = PySelect,
 	.UpdateCommand = PyUpdateCommand,
+	.Begin = PyBegin,
 	.Commit = PyCommit,
+	.Rollback = PyRollback,
 	.GetDatabaseList = PyPostgreGetDatabaseList,
 	.DeleteDatabase = PyPostgreDeleteDatabase,
 	.name = "PostgreSQL (Python)",
@@ -149,7 +161,9 @@ DBProvider providers[1] = {
 	.Disconnect = NULL,
 	.Select = NULL,
 	.UpdateCommand = NULL,
+	.Begin = NULL,
 	.Commit = NULL,
+	.Rollback = NULL,
 	.GetDatabaseList = NULL,
 	.DeleteDatabase = NULL,
 	.name = "No Providers",
@@ -516,6 +530,11 @@ PyUpdateCommand(const char *str)
         return TRUE;
 }
 
+static void
+PyBegin(void)
+{                               /* the DB-API modules open a transaction implicitly */
+}
+
 static void
 PyCommit(void)
 {
@@ -523,6 +542,13 @@ PyCommit(void)
         PyErr_Print();
 }
 
+static void
+PyRollback(void)
+{
+    if (!PyRun_String("PyRollback()", Py_eval_input, pdict, pdict))
+        PyErr_Print();
+}
+
 static RowSet *
 ConvertPythonToRowset(PyObject * v)
 {
@@ -772,9 +798,24 @@ SQLiteUpdateCommand(const char *str)
     return (ret == SQLITE_OK);
 }
 
+static void
+SQLiteBegin(void)
+{                               /* sqlite runs in autocommit mode otherwise */
+    SQLiteUpdateCommand("BEGIN");
+}
+
 static void
 SQLiteCommit(void)
-{                               /* No transaction in sqlite by default */
+{
+    if (!sqlite3_get_autocommit(connection))
+        SQLiteUpdateCommand("COMMIT");
+}
+
+static void
+SQLiteRollback(void)
+{
+    if (!sqlite3_get_autocommit(connection))
+        SQLiteUpdateCommand("ROLLBACK");
 }
 #endif
 
@@ -36,7 +36,9 @@ typedef struct {
     void (*Disconnect) (void);
     RowSet *(*Select) (const char *str);
     int (*UpdateCommand) (const char *str);
+    void (*Begin) (void);
     void (*Commit) (void);
+    void (*Rollback) (void);
     GList *(*GetDatabaseList) (const char *user, const char *password, const char *hostname);
     int (*DeleteDatabase) (const char *database, const char *user, const char *password, const char *hostname);
 
@@ -45,6 +45,7 @@
 #include "md5.h"
 #include "SFMT.h"
 #include "isaac.h"
+#include "philox.h"
 #include <glib/gstdio.h>
 #include "glib-ext.h"
 
@@ -57,6 +58,7 @@ const char *aszRNG[NUM_RNGS] = {
     "ISAAC",
     "MD5",
     N_("Mersenne Twister"),
+    "Philox",
     N_("manual dice"),
     "www.random.org",
     N_("read from file")
@@ -67,6 +69,7 @@ const char *aszRNGTip[NUM_RNGS] = {
     N_("Bob Jenkins' Indirection, Shift, Accumulate, Add and Count " "cryptographic generator"),
     N_("A generator based on the Message Digest 5 algorithm"),
     N_("Makoto Matsumoto and Mutsuo Saito's generator"),
+    N_("Salmon et al.'s counter-based generator, reproducible per rollout trial"),
     N_("Enter each dice roll by hand"),
     N_("The online non-deterministic generator from random.org"),
     N_("Dice loaded from a file"),
@@ -75,6 +78,8 @@ const char *aszRNGTip[NUM_RNGS] = {
 rng rngCurrent = RNG_MERSENNE;
 rngcontext *rngctxCurrent = NULL;
 
+#define PHILOX_BUFFER 16        /* blocks generated at a time by RNG_PHILOX */
+
 struct rngcontext {
 
     /* RNG_FILE */
@@ -90,6 +95,12 @@ struct rngcontext {
     /* RNG_MERSENNE */
     sfmt_t sfmt;
 
+    /* RNG_PHILOX */
+    guint32 anPhiloxKey[2];     /* the seed */
+    guint64 nPhiloxBlock;       /* counter of the next blocks to generate */
+    guint32 aanPhilox[PHILOX_BUFFER][4];
+    unsigned int iPhilox;       /* words of aanPhilox used */
+
     /* RNG_BBS */
 
 #if defined(HAVE_LIBGMP)
@@ -348,6 +359,7 @@ PrintRNGCounter(const rng rngx, rngcontext * rngctx)
     case RNG_BBS:
     case RNG_ISAAC:
     case RNG_MD5:
+    case RNG_PHILOX:
         g_print(_("Number of calls since last seed: %lu."), rngctx->c);
         g_print("\n");
 
@@ -436,6 +448,7 @@ PrintRNGSeed(const rng rngx, rngcontext * rngctx)
 
     case RNG_ISAAC:
     case RNG_MERSENNE:
+    case RNG_PHILOX:
 #if defined(HAVE_LIBGMP)
         PrintRNGSeedMP(rngctx->nz);
 #else
@@ -450,6 +463,39 @@ PrintRNGSeed(const rng rngx, rngcontext * rngctx)
     g_printerr("\n");
 }
 
+static void
+InitRNGPhilox(rngcontext * rngctx, guint32 nKey0, guint32 nKey1)
+{
+    rngctx->anPhiloxKey[0] = nKey0;
+    rngctx->anPhiloxKey[1] = nKey1;
+    rngctx->nPhiloxBlock = 0;
+    rngctx->iPhilox = 4 * PHILOX_BUFFER;
+}
+
+/* Next word of the sequential stream, counters (n, 0, 0). The blocks are
+ * generated PHILOX_BUFFER at a time. */
+static guint32
+PhiloxNext(rngcontext * rngctx)
+{
+    unsigned int i;
+
+    if (rngctx->iPhilox == 4 * PHILOX_BUFFER) {
+        guint32 anCounter[4];
+
+        anCounter[0] = (guint32) rngctx->nPhiloxBlock;
+        anCounter[1] = (guint32) (rngctx->nPhiloxBlock >> 32);
+        anCounter[2] = anCounter[3] = 0;
+
+        philox4x32_fill(rngctx->aanPhilox, PHILOX_BUFFER, anCounter, rngctx->anPhiloxKey);
+        rngctx->nPhiloxBlock += PHILOX_BUFFER;
+        rngctx->iPhilox = 0;
+    }
+
+    i = rngctx->iPhilox++;
+
+    return rngctx->aanPhilox[i / 4][i % 4];
+}
+
 extern void
 InitRNGSeed(unsigned int n, const rng rngx, rngcontext * rngctx)
 {
@@ -488,6 +534,10 @@ InitRNGSeed(unsigned int n, const rng rngx, rngcontext * rngctx)
         sfmt_init_gen_rand(&rngctx->sfmt, n);
         break;
 
+    case RNG_PHILOX:
+        InitRNGPhilox(rngctx, n, 0);
+        break;
+
     case RNG_MANUAL:
     case RNG_RANDOM_DOT_ORG:
     case RNG_FILE:
@@ -536,6 +586,17 @@ InitRNGSeedMP(mpz_t n, rng rng, rngcontext * rngctx)
         InitRNGSeed((unsigned int) (mpz_get_ui(n) % UINT_MAX), rng, rngctx);
         break;
 
+    case RNG_PHILOX:{
+            /* the key is the low 64 bits of the seed */
+            guint32 *achState;
+            size_t cb;
+
+            achState = mpz_export(NULL, &cb, -1, sizeof(guint32), 0, 0, n);
+            InitRNGPhilox(rngctx, cb > 0 ? achState[0] : 0, cb > 1 ? achState[1] : 0);
+            free(achState);
+            break;
+        }
+
     case RNG_BBS:
         g_assert(rngctx->fZInit);
         mpz_set(rngctx->zSeed, n);
@@ -734,6 +795,9 @@ InitRNG(unsigned long *pnSeed, int *pfInitFrom, const int fSet, const rng rngx)
     /* Mersenne-Twister */
     rngctx->sfmt.idx = SFMT_N32 + 1;
 
+    /* Philox */
+    rngctx->iPhilox = 4 * PHILOX_BUFFER;
+
 #if defined(HAVE_LIBGMP)
     /* BBS */
     rngctx->fZInit = FALSE;
@@ -819,6 +883,14 @@ RollDice(unsigned int anDice[2], rng * prng, rngcontext * rngctx)
         rngctx->c += 2;
         break;
 
+    case RNG_PHILOX:
+        while ((tmprnd = PhiloxNext(rngctx)) >= exp232_l);      /* Try again */
+        anDice[0] = 1 + (unsigned int) (tmprnd / exp232_q);
+        while ((tmprnd = PhiloxNext(rngctx)) >= exp232_l);
+        anDice[1] = 1 + (unsigned int) (tmprnd / exp232_q);
+        rngctx->c += 2;
+        break;
+
     case RNG_RANDOM_DOT_ORG:
 #if defined(LIBCURL_PROTOCOL_HTTPS)
         anDice[0] = getDiceRandomDotOrg();
@@ -849,6 +921,17 @@ RollDice(unsigned int anDice[2], rng * prng, rngcontext * rngctx)
     return 0;
 }
 
+/* Dice number nDraw of turn nTurn of rollout trial nTrial for RNG_PHILOX,
+ * computed from the seed alone with counters (nTurn, nTrial, nDraw, 1..),
+ * which are apart from those of RollDice(). The context is not changed,
+ * so rollout threads can share it and need no reseeding for each trial. */
+extern void
+RollDiceCounter(unsigned int anDice[2], const rngcontext * rngctx, unsigned int nTrial, unsigned int nTurn,
+                unsigned int nDraw)
+{
+    philox_dice(anDice, rngctx->anPhiloxKey, nTrial, nTurn, nDraw);
+}
+
 extern FILE *
 OpenDiceFile(rngcontext * rngctx, const char *sz)
 {
@@ -24,7 +24,7 @@
 #include <stdio.h>
 
 typedef enum {
-    RNG_BBS, RNG_ISAAC, RNG_MD5, RNG_MERSENNE,
+    RNG_BBS, RNG_ISAAC, RNG_MD5, RNG_MERSENNE, RNG_PHILOX,
     RNG_MANUAL, RNG_RANDOM_DOT_ORG, RNG_FILE,
     NUM_RNGS
 } rng;
@@ -49,6 +49,8 @@ extern void InitRNGSeed(unsigned int n, const rng rngx, rngcontext * rngctx);
 extern int RNGSystemSeed(const rng rngx, void *p, unsigned long *pnSeed);
 
 extern int RollDice(unsigned int anDice[2], rng * prng, rngcontext * rngctx);
+extern void RollDiceCounter(unsigned int anDice[2], const rngcontext * rngctx, unsigned int nTrial,
+                            unsigned int nTurn, unsigned int nDraw);
 
 #if defined(HAVE_LIBGMP)
 extern int InitRNGSeedLong(char *sz, rng rng, rngcontext * rngctx);
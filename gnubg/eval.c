@@ -203,6 +203,8 @@ f_FindBestMove FindBestMove = FindBestMoveNoLocking;
 f_EvaluatePosition EvaluatePosition = EvaluatePositionNoLocking;
 f_ScoreMove ScoreMove = ScoreMoveNoLocking;
 f_GeneralCubeDecisionE GeneralCubeDecisionE = GeneralCubeDecisionENoLocking;
+f_GeneralCubeDecisionEMulti GeneralCubeDecisionEMulti = GeneralCubeDecisionEMultiNoLocking;
+f_FindnSaveBestMovesMulti FindnSaveBestMovesMulti = FindnSaveBestMovesMultiNoLocking;
 f_GeneralEvaluationE GeneralEvaluationE = GeneralEvaluationENoLocking;
 
 #define FindnSaveBestMoves FindnSaveBestMovesNoLocking
@@ -210,6 +212,8 @@ f_GeneralEvaluationE GeneralEvaluationE = GeneralEvaluationENoLocking;
 #define EvaluatePosition EvaluatePositionNoLocking
 #define ScoreMove ScoreMoveNoLocking
 #define GeneralCubeDecisionE GeneralCubeDecisionENoLocking
+#define GeneralCubeDecisionEMulti GeneralCubeDecisionEMultiNoLocking
+#define FindnSaveBestMovesMulti FindnSaveBestMovesMultiNoLocking
 #define GeneralEvaluationE GeneralEvaluationENoLocking
 #define EvaluatePositionCache EvaluatePositionCacheNoLocking
 #define FindBestMovePlied FindBestMovePliedNoLocking
@@ -217,9 +221,13 @@ f_GeneralEvaluationE GeneralEvaluationE = GeneralEvaluationENoLocking;
 #define EvaluatePositionCubeful3 EvaluatePositionCubeful3NoLocking
 #define ScoreMoves ScoreMovesNoLocking
 #define ScoreMovesPruned ScoreMovesPrunedNoLocking
+#define ScoreMoveMulti ScoreMoveMultiNoLocking
+#define ScoreMovesMulti ScoreMovesMultiNoLocking
 #define FindBestMoveInEval FindBestMoveInEvalNoLocking
 #define GeneralEvaluationEPliedCubeful GeneralEvaluationEPliedCubefulNoLocking
 #define EvaluatePositionCubeful4 EvaluatePositionCubeful4NoLocking
+#define EvaluatePositionCubefulMulti EvaluatePositionCubefulMultiNoLocking
+#define ChooseMoveInEval ChooseMoveInEvalNoLocking
 #define CacheAdd CacheAddNoLocking
 #define CacheLookup CacheLookupNoLocking
 
@@ -239,14 +247,27 @@ neuralnet nnContact, nnRace, nnCrashed;
 
 neuralnet nnpContact, nnpRace, nnpCrashed;
 
-bearoffcontext *pbcOS = NULL;
-bearoffcontext *pbcTS = NULL;
-bearoffcontext *pbc1 = NULL;
-bearoffcontext *pbc2 = NULL;
-bearoffcontext *apbcHyper[3] = { NULL, NULL, NULL };
+/* the weights file the nets point into, if loaded by LoadWeightsMapped() */
+static GMappedFile *pmfWeights = NULL;
+
+bearoffcontext *apbcBearoff[NUM_BDB];
+gint afBearoffOpen[NUM_BDB];
+const char *aszBearoffFile[NUM_BDB] = {
+    "gnubg_os0.bd", "gnubg_ts0.bd", "gnubg_os.bd", "gnubg_ts.bd",
+    "hyper1.bd", "hyper2.bd", "hyper3.bd"
+};
+
+/* where the generated heuristic database is kept between runs, if set */
+char *szHeuristicBearoff = NULL;
+
+/* no databases are used until EvalInitialise() says otherwise */
+static int fBearoffDisabled = TRUE;
+static gint64 atBearoffOpen[NUM_BDB];
+G_LOCK_DEFINE_STATIC(bearoff);
 
 evalCache cEval;
 evalCache cpEval;
+evalCache cmEval;
 unsigned int cCache;
 int fInterrupt = FALSE;
 int fMatchCancelled = FALSE;
@@ -496,6 +517,71 @@ DestroyWeights(void)
     NeuralNetDestroy(&nnpContact);
     NeuralNetDestroy(&nnpCrashed);
     NeuralNetDestroy(&nnpRace);
+
+    if (pmfWeights) {
+        g_mapped_file_unref(pmfWeights);
+        pmfWeights = NULL;
+    }
+}
+
+static bearoffcontext *
+BearoffOpenDatabase(bearoffdb bdb)
+{
+    static const unsigned int abo[NUM_BDB] = {
+        BO_IN_MEMORY | BO_MUST_BE_ONE_SIDED, BO_IN_MEMORY | BO_MUST_BE_TWO_SIDED,
+        BO_IN_MEMORY | BO_MUST_BE_ONE_SIDED, BO_IN_MEMORY | BO_MUST_BE_TWO_SIDED,
+        BO_IN_MEMORY, BO_IN_MEMORY, BO_IN_MEMORY
+    };
+    bearoffcontext *pbc;
+    char *sz = BuildFilename(aszBearoffFile[bdb]);
+
+    pbc = BearoffInit(sz, abo[bdb], NULL);
+    g_free(sz);
+
+    if (!pbc && bdb == BDB_1)
+        pbc = BearoffHeuristic(szHeuristicBearoff, NULL);
+
+    if (!pbc && bdb == BDB_2)
+        g_printerr(_("\n***WARNING***\n\n"
+                     "GNU Backgammon will not use the two-sided bearoff\n"
+                     "database since the gnubg_ts0.bd could not be found.\n"
+                     "You should obtain this file or generate it yourself\n"
+                     "with the command: makebearoff -t 6x6 -f gnubg_ts0.bd\n"
+                     "You can also generate other bearoff databases; see\n" "README for more details\n\n"));
+
+    return pbc;
+}
+
+/* Slow path of GetBearoff(): the first lookup in a database opens it.
+ * Several threads may get here at once, so the opening is serialised
+ * and the flag is only set once the context is ready to be used. */
+
+extern bearoffcontext *
+OpenBearoff(bearoffdb bdb)
+{
+    G_LOCK(bearoff);
+
+    if (!afBearoffOpen[bdb]) {
+        gint64 t = g_get_monotonic_time();
+
+        if (!fBearoffDisabled)
+            apbcBearoff[bdb] = BearoffOpenDatabase(bdb);
+        atBearoffOpen[bdb] = g_get_monotonic_time() - t;
+        g_debug("bearoff database %s: opened in %.3f s", aszBearoffFile[bdb], atBearoffOpen[bdb] / 1e6);
+        g_atomic_int_set(&afBearoffOpen[bdb], TRUE);
+    }
+
+    G_UNLOCK(bearoff);
+
+    return apbcBearoff[bdb];
+}
+
+/* Microseconds it took to open a database, or -1 if it has not been used */
+
+extern gint64
+BearoffOpenTime(bearoffdb bdb)
+{
+    return g_atomic_int_get(&afBearoffOpen[bdb]) ? atBearoffOpen[bdb] : -1;
 }
 
 extern int
@@ -504,14 +590,15 @@ EvalShutdown(void)
 
     int i;
 
-    /* close bearoff databases */
+    /* close the bearoff databases that were used */
 
-    BearoffClose(pbc1);
-    BearoffClose(pbc2);
-    BearoffClose(pbcOS);
-    BearoffClose(pbcTS);
-    for (i = 0; i < 3; ++i)
-        BearoffClose(apbcHyper[i]);
+    for (i = 0; i < NUM_BDB; ++i) {
+        if (afBearoffOpen[i]) {
+            BearoffClose(apbcBearoff[i]);
+            apbcBearoff[i] = NULL;
+            afBearoffOpen[i] = FALSE;
+        }
+    }
 
     /* destroy neural nets */
 
@@ -521,6 +608,7 @@ EvalShutdown(void)
 
     CacheDestroy(&cEval);
     CacheDestroy(&cpEval);
+    CacheDestroy(&cmEval);
 
     return 0;
 
@@ -562,6 +650,59 @@ binary_weights_failed(char *filename, FILE * weights)
     return 0;
 }
 
+/* Map a weights file written by makeweights and use the nets in place.
+ * The pages are read only, so all the processes using the same file share
+ * one copy of the weights. Returns -1 quietly if the file is not in the
+ * mapped format, for the caller to try the older binary one. */
+static int
+LoadWeightsMapped(char *filename)
+{
+    GError *error = NULL;
+    GMappedFile *pmf;
+    const char *p, *pEnd;
+    float ar[2];
+
+    if (!(pmf = g_mapped_file_new(filename, FALSE, &error))) {
+        g_error_free(error);
+        return -1;
+    }
+
+    p = g_mapped_file_get_contents(pmf);
+    pEnd = p + g_mapped_file_get_length(pmf);
+
+    if (pEnd - p < NN_MAPPED_ALIGN || (memcpy(ar, p, sizeof(ar)), ar[0] != WEIGHTS_MAGIC_MAPPED)) {
+        g_mapped_file_unref(pmf);
+        return -1;
+    }
+
+    if (ar[1] != WEIGHTS_VERSION_BINARY) {
+        char buf[20];
+        sprintf(buf, "%.2f", ar[1]);
+        g_print(_("weights file %s, has incorrect version (%s), expected (%s)"), filename, buf, WEIGHTS_VERSION);
+        g_print("\n");
+        g_mapped_file_unref(pmf);
+        return -1;
+    }
+
+    p += NN_MAPPED_ALIGN;
+
+    if (NeuralNetLoadMapped(&nnContact, &p, pEnd) ||
+        NeuralNetLoadMapped(&nnRace, &p, pEnd) ||
+        NeuralNetLoadMapped(&nnCrashed, &p, pEnd) ||
+        NeuralNetLoadMapped(&nnpContact, &p, pEnd) ||
+        NeuralNetLoadMapped(&nnpCrashed, &p, pEnd) || NeuralNetLoadMapped(&nnpRace, &p, pEnd)) {
+        perror(filename);
+        g_mapped_file_unref(pmf);
+        return -1;
+    }
+
+    if (pmfWeights)
+        g_mapped_file_unref(pmfWeights);
+    pmfWeights = pmf;
+
+    return 0;
+}
+
 static int
 weights_failed(char *filename, FILE * weights)
 {
@@ -639,6 +780,11 @@ EvalInitialise(char *szWeights, char *szWeightsBinary, int fNoBearoff, void (*pf
             return;
         }
 
+        if (CacheCreate(&cmEval, 0x1 << 16)) {
+            PrintError(_("Evaluation cache allocation failed"));
+            return;
+        }
+
         ComputeTable();
 
         rc.randrsl[0] = (ub4) time(NULL);
@@ -649,56 +795,14 @@ EvalInitialise(char *szWeights, char *szWeightsBinary, int fNoBearoff, void (*pf
         fInitialised = TRUE;
     }
 
-    if (!fNoBearoff) {
-        char *gnubg_bearoff;
-        char *gnubg_bearoff_os;
-
-        gnubg_bearoff_os = BuildFilename("gnubg_os0.bd");
-        if (!pbc1)
-            pbc1 = BearoffInit(gnubg_bearoff_os, BO_IN_MEMORY | BO_MUST_BE_ONE_SIDED, NULL);
-        g_free(gnubg_bearoff_os);
-
-        if (!pbc1)
-            pbc1 = BearoffInit(NULL, BO_HEURISTIC, pfProgress);
-
-        /* read two-sided db from gnubg.bd */
-        gnubg_bearoff = BuildFilename("gnubg_ts0.bd");
-        pbc2 = BearoffInit(gnubg_bearoff, BO_IN_MEMORY | BO_MUST_BE_TWO_SIDED, NULL);
-        g_free(gnubg_bearoff);
-
-        if (!pbc2)
-            g_printerr(
-                  _("\n***WARNING***\n\n"
-                    "GNU Backgammon will not use the two-sided bearoff\n"
-                    "database since the gnubg_ts0.bd could not be found.\n"
-                    "You should obtain this file or generate it yourself\n"
-                    "with the command: makebearoff -t 6x6 -f gnubg_ts0.bd\n"
-                    "You can also generate other bearoff databases; see\n" "README for more details\n\n"));
-
-        gnubg_bearoff_os = BuildFilename("gnubg_os.bd");
-        /* init one-sided db */
-        pbcOS = BearoffInit(gnubg_bearoff_os, BO_IN_MEMORY | BO_MUST_BE_ONE_SIDED, NULL);
-        g_free(gnubg_bearoff_os);
-
-        gnubg_bearoff = BuildFilename("gnubg_ts.bd");
-        /* init two-sided db */
-        pbcTS = BearoffInit(gnubg_bearoff, BO_IN_MEMORY | BO_MUST_BE_TWO_SIDED, NULL);
-        g_free(gnubg_bearoff);
-
-        /* hyper-gammon databases */
-
-        for (i = 0; i < 3; ++i) {
-            char *fn;
-            char sz[10];
-            sprintf(sz, "hyper%1d.bd", i + 1);
-            fn = BuildFilename(sz);
-            apbcHyper[i] = BearoffInit(fn, BO_IN_MEMORY, NULL);
-            g_free(fn);
-        }
+    /* the databases themselves are opened by GetBearoff() when first
+     * needed; most sessions never look at some of them */
+    fBearoffDisabled = fNoBearoff;
 
-    }
+    if (szWeightsBinary)
+        fReadWeights = !LoadWeightsMapped(szWeightsBinary);
 
-    if (szWeightsBinary) {
+    if (!fReadWeights && szWeightsBinary) {
         pfWeights = g_fopen(szWeightsBinary, "rb");
         if (!binary_weights_failed(szWeightsBinary, pfWeights)) {
             if (!fReadWeights && !(fReadWeights =
@@ -1630,7 +1734,7 @@ MaxTurns(int id)
     unsigned short int aus[32];
     int i;
 
-    BearoffDist(pbc1, id, NULL, NULL, NULL, aus, NULL);
+    BearoffDist(GetBearoff(BDB_1), id, NULL, NULL, NULL, aus, NULL);
 
     for (i = 31; i >= 0; i--) {
         if (aus[i])
@@ -1700,9 +1804,11 @@ SanityCheck(const TanBoard anBoard, float arOutput[])
     fContact = anBack[0] + anBack[1] >= 24;
 
     if (unlikely(!fContact)) {
+        const bearoffcontext *pbc = GetBearoff(BDB_1);
+
         for (i = 0; i < 2; i++)
-            if (anBack[i] < 6 && pbc1)
-                anMaxTurns[i] = MaxTurns(PositionBearoff(anBoard[i], pbc1->nPoints, pbc1->nChequers));
+            if (anBack[i] < 6 && pbc)
+                anMaxTurns[i] = MaxTurns(PositionBearoff(anBoard[i], pbc->nPoints, pbc->nChequers));
             else
                 anMaxTurns[i] = anCross[i] * 2;
 
@@ -1857,16 +1963,16 @@ ClassifyPosition(const TanBoard anBoard, const bgvariation bgv)
             return CLASS_CONTACT;
         } else {
 
-            if (unlikely(isBearoff(pbc2, anBoard)))
+            if (unlikely(isBearoff(GetBearoff(BDB_2), anBoard)))
                 return CLASS_BEAROFF2;
 
-            if (unlikely(isBearoff(pbcTS, anBoard)))
+            if (unlikely(isBearoff(GetBearoff(BDB_TS), anBoard)))
                 return CLASS_BEAROFF_TS;
 
-            if (unlikely(isBearoff(pbc1, anBoard)))
+            if (unlikely(isBearoff(GetBearoff(BDB_1), anBoard)))
                 return CLASS_BEAROFF1;
 
-            if (unlikely(isBearoff(pbcOS, anBoard)))
+            if (unlikely(isBearoff(GetBearoff(BDB_OS), anBoard)))
                 return CLASS_BEAROFF_OS;
 
             return CLASS_RACE;
@@ -1885,16 +1991,16 @@ ClassifyPosition(const TanBoard anBoard, const bgvariation bgv)
 static int
 EvalBearoff2(const TanBoard anBoard, float arOutput[], const bgvariation UNUSED(bgv), NNState * UNUSED(nnStates))
 {
-    g_assert(pbc2);
+    g_assert(GetBearoff(BDB_2));
 
-    return BearoffEval(pbc2, anBoard, arOutput);
+    return BearoffEval(GetBearoff(BDB_2), anBoard, arOutput);
 }
 
 static int
 EvalBearoffOS(const TanBoard anBoard, float arOutput[], const bgvariation UNUSED(bgv), NNState * UNUSED(nnStates))
 {
 
-    return BearoffEval(pbcOS, anBoard, arOutput);
+    return BearoffEval(GetBearoff(BDB_OS), anBoard, arOutput);
 
 }
 
@@ -1903,7 +2009,7 @@ static int
 EvalBearoffTS(const TanBoard anBoard, float arOutput[], const bgvariation UNUSED(bgv), NNState * UNUSED(nnStates))
 {
 
-    return BearoffEval(pbcTS, anBoard, arOutput);
+    return BearoffEval(GetBearoff(BDB_TS), anBoard, arOutput);
 
 }
 
@@ -1911,7 +2017,7 @@ static int
 EvalHypergammon1(const TanBoard anBoard, float arOutput[], const bgvariation UNUSED(bgv), NNState * UNUSED(nnStates))
 {
 
-    return BearoffEval(apbcHyper[0], anBoard, arOutput);
+    return BearoffEval(GetBearoff(BDB_HYPER1), anBoard, arOutput);
 
 }
 
@@ -1919,7 +2025,7 @@ static int
 EvalHypergammon2(const TanBoard anBoard, float arOutput[], const bgvariation UNUSED(bgv), NNState * UNUSED(nnStates))
 {
 
-    return BearoffEval(apbcHyper[1], anBoard, arOutput);
+    return BearoffEval(GetBearoff(BDB_HYPER2), anBoard, arOutput);
 
 }
 
@@ -1927,7 +2033,7 @@ static int
 EvalHypergammon3(const TanBoard anBoard, float arOutput[], const bgvariation UNUSED(bgv), NNState * UNUSED(nnStates))
 {
 
-    return BearoffEval(apbcHyper[2], anBoard, arOutput);
+    return BearoffEval(GetBearoff(BDB_HYPER3), anBoard, arOutput);
 
 }
 
@@ -1935,7 +2041,7 @@ static int
 EvalBearoff1(const TanBoard anBoard, float arOutput[], const bgvariation UNUSED(bgv), NNState * UNUSED(nnStates))
 {
 
-    return BearoffEval(pbc1, anBoard, arOutput);
+    return BearoffEval(GetBearoff(BDB_1), anBoard, arOutput);
 
 }
 
@@ -1989,14 +2095,15 @@ raceBGprob(const TanBoard anBoard, int side, const bgvariation bgv)
         float p = 0.0f;
         const long *bgp = getRaceBGprobs(dummy[1 - side]);
         if (bgp) {
-            int k = PositionBearoff(anBoard[side], pbc1->nPoints, pbc1->nChequers);
+            bearoffcontext *pbc = GetBearoff(BDB_1);
+            int k = PositionBearoff(anBoard[side], pbc->nPoints, pbc->nChequers);
             unsigned short int aProb[32];
 
             unsigned int j;
 
             unsigned long scale = (side == 0) ? 36 : 1;
 
-            BearoffDist(pbc1, k, NULL, NULL, NULL, aProb, NULL);
+            BearoffDist(pbc, k, NULL, NULL, NULL, aProb, NULL);
 
             for (j = 1 - side; j < RBG_NPROBS; j++) {
                 unsigned long sum = 0;
@@ -2375,9 +2482,9 @@ EvaluatePerfectCubeful(const TanBoard anBoard, float arEquity[], const bgvariati
 
     switch (pc) {
     case CLASS_BEAROFF2:
-        return PerfectCubeful(pbc2, anBoard, arEquity);
+        return PerfectCubeful(GetBearoff(BDB_2), anBoard, arEquity);
     case CLASS_BEAROFF_TS:
-        return PerfectCubeful(pbcTS, anBoard, arEquity);
+        return PerfectCubeful(GetBearoff(BDB_TS), anBoard, arEquity);
     default:
         g_assert_not_reached();
     }
@@ -2673,12 +2780,31 @@ ApplyMove(TanBoard anBoard, const int anMove[8], const int fCheckLegal)
     return 0;
 }
 
+/* ApplySubMove() on a packed board, for legal moves only */
+static inline void
+ApplySubMoveKey(positionkey * pkey, const int iSrc, const int nRoll)
+{
+    int iDest = iSrc - nRoll;
+
+    KeyAddChequers(pkey, 1, iSrc, -1);
+
+    if (iDest < 0)
+        return;
+
+    if (KeyPoint(pkey, 0, 23 - iDest)) {
+        /* hit the blot */
+        KeyAddChequers(pkey, 0, 23 - iDest, -1);
+        KeyAddChequers(pkey, 0, 24, 1);
+    }
+
+    KeyAddChequers(pkey, 1, iDest, 1);
+}
+
 static void
-SaveMoves(movelist * pml, unsigned int cMoves, unsigned int cPip, int anMoves[], const TanBoard anBoard, int fPartial)
+SaveMoves(movelist * pml, unsigned int cMoves, unsigned int cPip, int anMoves[], const positionkey * pkey, int fPartial)
 {
     unsigned int i, j;
     move *pm;
-    positionkey key;
 
     if (fPartial) {
         /* Save all moves, even incomplete ones */
@@ -2701,13 +2827,11 @@ SaveMoves(movelist * pml, unsigned int cMoves, unsigned int cPip, int anMoves[],
         pml->cMaxPips = cPip;
     }
 
-    PositionKey(anBoard, &key);
-
     for (i = 0; i < pml->cMoves; i++) {
 
         pm = &(pml->amMoves[i]);
 
-        if (EqualKeys(key, pm->key)) {
+        if (EqualKeys(*pkey, pm->key)) {
             if (cMoves > pm->cMoves || cPip > pm->cPips) {
                 for (j = 0; j < cMoves * 2; j++)
                     pm->anMove[j] = anMoves[j] > -1 ? anMoves[j] : -1;
@@ -2731,7 +2855,7 @@ SaveMoves(movelist * pml, unsigned int cMoves, unsigned int cPip, int anMoves[],
     if (cMoves < 4)
         pm->anMove[cMoves * 2] = -1;
 
-    CopyKey(key, pm->key);
+    CopyKey(*pkey, pm->key);
 
     pm->cMoves = cMoves;
     pm->cPips = cPip;
@@ -2746,68 +2870,64 @@ SaveMoves(movelist * pml, unsigned int cMoves, unsigned int cPip, int anMoves[],
 }
 
 static int
-LegalMove(const TanBoard anBoard, int iSrc, int nPips)
+LegalMove(const positionkey * pkey, int iSrc, int nPips)
 {
 
     int nBack;
     const int iDest = iSrc - nPips;
 
     if (iDest >= 0) {           /* Here we can do the Chris rule check */
-        return (anBoard[0][23 - iDest] < 2);
+        return (KeyPoint(pkey, 0, 23 - iDest) < 2);
     }
     /* otherwise, attempting to bear off */
 
-    for (nBack = 24; nBack > 0; nBack--)
-        if (anBoard[1][nBack] > 0)
-            break;
+    nBack = KeyBackChequer(pkey);
 
     return (nBack <= 5 && (iSrc == nBack || iDest == -1));
 }
 
+/* The moves are generated on the packed board, so that each partial move
+ * copies 28 bytes instead of a TanBoard and the saved moves need no
+ * PositionKey() */
 static int
 GenerateMovesSub(movelist * pml, int anRoll[], int nMoveDepth,
-                 int iPip, int cPip, const TanBoard anBoard, int anMoves[], int fPartial)
+                 int iPip, int cPip, const positionkey * pkey, int anMoves[], int fPartial)
 {
     int i, fUsed = 0;
-    TanBoard anBoardNew;
+    positionkey keyNew;
 
     if (nMoveDepth > 3 || !anRoll[nMoveDepth])
         return TRUE;
 
-    if (anBoard[1][24]) {       /* on bar */
-        if (anBoard[0][anRoll[nMoveDepth] - 1] >= 2)
+    if (KeyPoint(pkey, 1, 24)) {        /* on bar */
+        if (KeyPoint(pkey, 0, anRoll[nMoveDepth] - 1) >= 2)
             return TRUE;
 
         anMoves[nMoveDepth * 2] = 24;
         anMoves[nMoveDepth * 2 + 1] = 24 - anRoll[nMoveDepth];
 
-        for (i = 0; i < 25; i++) {
-            anBoardNew[0][i] = anBoard[0][i];
-            anBoardNew[1][i] = anBoard[1][i];
-        }
-
-        ApplySubMove(anBoardNew, 24, anRoll[nMoveDepth], TRUE);
+        keyNew = *pkey;
+        ApplySubMoveKey(&keyNew, 24, anRoll[nMoveDepth]);
 
         if (GenerateMovesSub(pml, anRoll, nMoveDepth + 1, 23, cPip +
-                             anRoll[nMoveDepth], (ConstTanBoard) anBoardNew, anMoves, fPartial))
-            SaveMoves(pml, nMoveDepth + 1, cPip + anRoll[nMoveDepth], anMoves, (ConstTanBoard) anBoardNew, fPartial);
+                             anRoll[nMoveDepth], &keyNew, anMoves, fPartial))
+            SaveMoves(pml, nMoveDepth + 1, cPip + anRoll[nMoveDepth], anMoves, &keyNew, fPartial);
 
         return fPartial;
     } else {
         for (i = iPip; i >= 0; i--)
-            if (anBoard[1][i] && LegalMove(anBoard, i, anRoll[nMoveDepth])) {
+            if (KeyPoint(pkey, 1, i) && LegalMove(pkey, i, anRoll[nMoveDepth])) {
                 anMoves[nMoveDepth * 2] = i;
                 anMoves[nMoveDepth * 2 + 1] = i - anRoll[nMoveDepth];
 
-                memcpy(anBoardNew, anBoard, sizeof(anBoardNew));
-
-                ApplySubMove(anBoardNew, i, anRoll[nMoveDepth], TRUE);
+                keyNew = *pkey;
+                ApplySubMoveKey(&keyNew, i, anRoll[nMoveDepth]);
 
                 if (GenerateMovesSub(pml, anRoll, nMoveDepth + 1,
                                      anRoll[0] == anRoll[1] ? i : 23,
-                                     cPip + anRoll[nMoveDepth], (ConstTanBoard) anBoardNew, anMoves, fPartial))
+                                     cPip + anRoll[nMoveDepth], &keyNew, anMoves, fPartial))
                     SaveMoves(pml, nMoveDepth + 1, cPip +
-                              anRoll[nMoveDepth], anMoves, (ConstTanBoard) anBoardNew, fPartial);
+                              anRoll[nMoveDepth], anMoves, &keyNew, fPartial);
 
                 fUsed = 1;
             }
@@ -2876,7 +2996,7 @@ CompareMovesGeneral(const move * pm0, const move * pm1)
 }
 
 extern int
-GenerateMoves(movelist * pml, const TanBoard anBoard, int n0, int n1, int fPartial)
+GenerateMovesKey(movelist * pml, const positionkey * pkey, int n0, int n1, int fPartial)
 {
 
     int anRoll[4], anMoves[8];
@@ -2887,17 +3007,27 @@ GenerateMoves(movelist * pml, const TanBoard anBoard, int n0, int n1, int fParti
 
     pml->cMoves = pml->cMaxMoves = pml->cMaxPips = pml->iMoveBest = 0;
     pml->amMoves = MT_Get_aMoves();
-    GenerateMovesSub(pml, anRoll, 0, 23, 0, anBoard, anMoves, fPartial);
+    GenerateMovesSub(pml, anRoll, 0, 23, 0, pkey, anMoves, fPartial);
 
     if (anRoll[0] != anRoll[1]) {
         swap(anRoll, anRoll + 1);
 
-        GenerateMovesSub(pml, anRoll, 0, 23, 0, anBoard, anMoves, fPartial);
+        GenerateMovesSub(pml, anRoll, 0, 23, 0, pkey, anMoves, fPartial);
     }
 
     return pml->cMoves;
 }
 
+extern int
+GenerateMoves(movelist * pml, const TanBoard anBoard, int n0, int n1, int fPartial)
+{
+    positionkey key;
+
+    PositionKey(anBoard, &key);
+
+    return GenerateMovesKey(pml, &key, n0, n1, fPartial);
+}
+
 
 extern float
 KleinmanCount(int nPipOnRoll, int nPipNotOnRoll)
@@ -3030,7 +3160,7 @@ static void
 StatusHypergammon1(char *sz)
 {
 
-    BearoffStatus(apbcHyper[0], sz);
+    BearoffStatus(GetBearoff(BDB_HYPER1), sz);
 
 }
 
@@ -3038,7 +3168,7 @@ static void
 StatusHypergammon2(char *sz)
 {
 
-    BearoffStatus(apbcHyper[1], sz);
+    BearoffStatus(GetBearoff(BDB_HYPER2), sz);
 
 }
 
@@ -3046,7 +3176,7 @@ static void
 StatusHypergammon3(char *sz)
 {
 
-    BearoffStatus(apbcHyper[2], sz);
+    BearoffStatus(GetBearoff(BDB_HYPER3), sz);
 
 }
 
@@ -3055,7 +3185,7 @@ static void
 StatusBearoff2(char *sz)
 {
 
-    BearoffStatus(pbc2, sz);
+    BearoffStatus(GetBearoff(BDB_2), sz);
 
 }
 
@@ -3063,7 +3193,7 @@ static void
 StatusBearoff1(char *sz)
 {
 
-    BearoffStatus(pbc1, sz);
+    BearoffStatus(GetBearoff(BDB_1), sz);
 
 }
 
@@ -3100,13 +3230,13 @@ StatusContact(char *sz)
 static void
 StatusOS(char *sz)
 {
-    BearoffStatus(pbcOS, sz);
+    BearoffStatus(GetBearoff(BDB_OS), sz);
 }
 
 static void
 StatusTS(char *sz)
 {
-    BearoffStatus(pbcTS, sz);
+    BearoffStatus(GetBearoff(BDB_TS), sz);
 }
 
 static classstatusfunc acsf[N_CLASSES] = {
@@ -3188,6 +3318,7 @@ extern void
 EvalCacheFlush(void)
 {
     CacheFlush(&cEval);
+    CacheFlush(&cmEval);
 }
 
 void
@@ -5286,6 +5417,8 @@ DoubleType(const int fDoubled, const int fMove, const int fTurn)
 #define EvaluatePosition EvaluatePositionWithLocking
 #define ScoreMove ScoreMoveWithLocking
 #define GeneralCubeDecisionE GeneralCubeDecisionEWithLocking
+#define GeneralCubeDecisionEMulti GeneralCubeDecisionEMultiWithLocking
+#define FindnSaveBestMovesMulti FindnSaveBestMovesMultiWithLocking
 #define GeneralEvaluationE GeneralEvaluationEWithLocking
 #define EvaluatePositionCache EvaluatePositionCacheWithLocking
 #define FindBestMovePlied FindBestMovePliedWithLocking
@@ -5293,9 +5426,13 @@ DoubleType(const int fDoubled, const int fMove, const int fTurn)
 #define EvaluatePositionCubeful3 EvaluatePositionCubeful3WithLocking
 #define ScoreMoves ScoreMovesWithLocking
 #define ScoreMovesPruned ScoreMovesPrunedWithLocking
+#define ScoreMoveMulti ScoreMoveMultiWithLocking
+#define ScoreMovesMulti ScoreMovesMultiWithLocking
 #define FindBestMoveInEval FindBestMoveInEvalWithLocking
 #define GeneralEvaluationEPliedCubeful GeneralEvaluationEPliedCubefulWithLocking
 #define EvaluatePositionCubeful4 EvaluatePositionCubeful4WithLocking
+#define EvaluatePositionCubefulMulti EvaluatePositionCubefulMultiWithLocking
+#define ChooseMoveInEval ChooseMoveInEvalWithLocking
 #define CacheAdd CacheAddWithLocking
 #define CacheLookup CacheLookupWithLocking
 
@@ -5306,6 +5443,194 @@ static int FindBestMovePlied(int anMove[8], int nDice0, int nDice1,
                              TanBoard anBoard, const cubeinfo * pci,
                              const evalcontext * pec, int nPlies, movefilter aamf[MAX_FILTER_PLIES][MAX_FILTER_PLIES]);
 
+
+/* Evaluations at one ply or more that a thread is working on.  When a
+ * thread misses the cache on a position that another thread is already
+ * evaluating with the same settings, it waits for that result instead of
+ * computing it a second time.  This cannot deadlock: an evaluation only
+ * waits for cubeless evaluations at the same depth (from a cubeful one)
+ * or for evaluations at fewer plies. */
+
+typedef struct {
+    positionkey key;
+    int nEvalContext;           /* EvalKey() of the evaluation */
+    int nPlies;
+    int cci;                    /* number of cube positions; 0 if cubeless */
+    cubeinfo *aci;              /* the cube positions ... */
+    cubeinfo ciMove;            /* ... and the one choosing the moves */
+    int cRef;                   /* the owner and the threads waiting */
+    int fDone;
+    int fOK;
+    ManualEvent evDone;         /* created by the first thread to wait */
+    float arOutput[NUM_OUTPUTS];
+    float *arCubeful;
+} inflight;
+
+G_LOCK_DEFINE_STATIC(inflight);
+static GHashTable *phInFlight = NULL;
+static unsigned int cInFlightStarted = 0;
+static unsigned int cInFlightShared = 0;
+
+static guint
+InFlightHash(gconstpointer p)
+{
+    const inflight *pif = (const inflight *) p;
+    guint h = (guint) pif->nEvalContext ^ ((guint) pif->cci << 24);
+    int i;
+
+    for (i = 0; i < 7; i++)
+        h = h * 31 + pif->key.data[i];
+
+    return h;
+}
+
+static gboolean
+InFlightEqual(gconstpointer p1, gconstpointer p2)
+{
+    const inflight *pif1 = (const inflight *) p1;
+    const inflight *pif2 = (const inflight *) p2;
+
+    if (!EqualKeys(pif1->key, pif2->key) || pif1->nEvalContext != pif2->nEvalContext
+        || pif1->nPlies != pif2->nPlies || pif1->cci != pif2->cci)
+        return FALSE;
+
+    if (!pif1->cci)
+        return TRUE;
+
+    return !memcmp(&pif1->ciMove, &pif2->ciMove, sizeof(cubeinfo))
+        && !memcmp(pif1->aci, pif2->aci, pif1->cci * sizeof(cubeinfo));
+}
+
+/* call with the lock held */
+static void
+InFlightUnref(inflight * pif)
+{
+    if (--pif->cRef)
+        return;
+
+    if (pif->evDone)
+        FreeManualEvent(pif->evDone);
+    g_free(pif->aci);
+    g_free(pif->arCubeful);
+    g_free(pif);
+}
+
+/* Register an evaluation about to start.  Returns 0 if the caller is to
+ * do it, in which case it must hand the entry in *ppif to InFlightEnd()
+ * afterwards.  If another thread was already doing it, waits for it and
+ * returns 1 with its result in arOutput (and arCubeful), or -1 if that
+ * evaluation failed. */
+static int
+InFlightBegin(const positionkey * pkey, int nEvalContext, int nPlies,
+              const cubeinfo aci[], int cci, const cubeinfo * pciMove,
+              float arOutput[NUM_OUTPUTS], float arCubeful[], inflight ** ppif)
+{
+    inflight ifKey, *pif;
+    int n;
+
+    ifKey.key = *pkey;
+    ifKey.nEvalContext = nEvalContext;
+    ifKey.nPlies = nPlies;
+    ifKey.cci = cci;
+    ifKey.aci = (cubeinfo *) aci;
+    if (cci)
+        ifKey.ciMove = *pciMove;
+
+    G_LOCK(inflight);
+
+    if (!phInFlight)
+        phInFlight = g_hash_table_new(InFlightHash, InFlightEqual);
+
+    if (!(pif = (inflight *) g_hash_table_lookup(phInFlight, &ifKey))) {
+        pif = g_new(inflight, 1);
+        *pif = ifKey;
+        if (cci) {
+            pif->aci = g_new(cubeinfo, cci);
+            memcpy(pif->aci, aci, cci * sizeof(cubeinfo));
+            pif->arCubeful = g_new(float, cci);
+        } else
+            pif->arCubeful = NULL;
+        pif->cRef = 1;
+        pif->fDone = pif->fOK = FALSE;
+        pif->evDone = NULL;
+
+        g_hash_table_insert(phInFlight, pif, pif);
+        cInFlightStarted++;
+
+        G_UNLOCK(inflight);
+
+        *ppif = pif;
+        return 0;
+    }
+
+    pif->cRef++;
+    if (!pif->evDone)
+        InitManualEvent(&pif->evDone);
+
+    while (!pif->fDone) {
+        G_UNLOCK(inflight);
+        WaitForManualEvent(pif->evDone);
+        G_LOCK(inflight);
+    }
+
+    if (pif->fOK) {
+        memcpy(arOutput, pif->arOutput, sizeof(float) * NUM_OUTPUTS);
+        if (cci)
+            memcpy(arCubeful, pif->arCubeful, cci * sizeof(float));
+        cInFlightShared++;
+        n = 1;
+    } else
+        n = -1;
+
+    InFlightUnref(pif);
+
+    G_UNLOCK(inflight);
+
+    return n;
+}
+
+/* Publish the result of an evaluation registered by InFlightBegin() to
+ * the threads waiting for it */
+static void
+InFlightEnd(inflight * pif, const float arOutput[NUM_OUTPUTS], const float arCubeful[], int fOK)
+{
+    G_LOCK(inflight);
+
+    g_hash_table_remove(phInFlight, pif);
+
+    if (fOK && pif->cRef > 1) {
+        memcpy(pif->arOutput, arOutput, sizeof(float) * NUM_OUTPUTS);
+        if (pif->cci)
+            memcpy(pif->arCubeful, arCubeful, pif->cci * sizeof(float));
+    }
+    pif->fOK = fOK;
+    pif->fDone = TRUE;
+
+    if (pif->evDone)
+        SetManualEvent(pif->evDone);
+
+    InFlightUnref(pif);
+
+    G_UNLOCK(inflight);
+}
+
+extern void
+EvalInFlightStats(unsigned int *pcStarted, unsigned int *pcShared)
+{
+    G_LOCK(inflight);
+    *pcStarted = cInFlightStarted;
+    *pcShared = cInFlightShared;
+    G_UNLOCK(inflight);
+}
+
+extern void
+EvalInFlightReset(void)
+{
+    G_LOCK(inflight);
+    cInFlightStarted = cInFlightShared = 0;
+    G_UNLOCK(inflight);
+}
+
 #endif
 
 static int GeneralEvaluationEPlied(NNState * nnStates, float arOutput[NUM_ROLLOUT_OUTPUTS],
@@ -5313,6 +5638,10 @@ static int GeneralEvaluationEPlied(NNState * nnStates, float arOutput[NUM_ROLLOU
 static int EvaluatePositionCubeful3(NNState * nnStates, const TanBoard anBoard, float arOutput[NUM_OUTPUTS],
                                     float arCubeful[], const cubeinfo aciCubePos[], int cci, cubeinfo * const pciMove,
                                     const evalcontext * pec, int nPlies, int fTop);
+static int EvaluatePositionCubefulMulti(NNState * nnStates, const TanBoard anBoard, float arOutput[],
+                                        float arCubeful[], const cubeinfo aciCubePos[], int cPos,
+                                        cubeinfo aciMove[], int cScores, const evalcontext * pec, int nPlies,
+                                        int fTop);
 
 /* Functions that have both locking and non-locking versions below here */
 
@@ -5330,27 +5659,35 @@ static int ScoreMovesPruned(movelist * pml, const cubeinfo * pci, const evalcont
 #define MIN_PRUNE_MOVES 5
 #define MAX_PRUNE_MOVES (MIN_PRUNE_MOVES + 11)
 
+/* Find the best move at 0-ply with pruning, from and to packed boards;
+ * pkeyOut is the position after the move, with the same player on roll,
+ * and anMove, if not NULL, the move itself */
 static SIMD_AVX_STACKALIGN void
-FindBestMoveInEval(NNState * nnStates, int const nDice0, int const nDice1, const TanBoard anBoardIn,
-                   TanBoard anBoardOut, cubeinfo * const pci, const evalcontext * pec)
+FindBestMoveInEval(NNState * nnStates, int const nDice0, int const nDice1, const positionkey * pkeyIn,
+                   positionkey * pkeyOut, int anMove[8], cubeinfo * const pci, const evalcontext * pec)
 {
     unsigned int i;
     movelist ml;
     positionclass evalClass = CLASS_OVER;
     unsigned int bmovesi[MAX_PRUNE_MOVES];
     unsigned int prune_moves;
+    TanBoard anBoard;
 
-    GenerateMoves(&ml, anBoardIn, nDice0, nDice1, FALSE);
+    GenerateMovesKey(&ml, pkeyIn, nDice0, nDice1, FALSE);
 
     if (ml.cMoves == 0) {
         /* no legal moves */
+        *pkeyOut = *pkeyIn;
+        if (anMove)
+            anMove[0] = -1;
         return;
     }
 
     if (ml.cMoves == 1) {
         /* forced move */
-        ml.iMoveBest = 0;
-        PositionFromKey(anBoardOut, &ml.amMoves[ml.iMoveBest].key);
+        *pkeyOut = ml.amMoves[0].key;
+        if (anMove)
+            memcpy(anMove, ml.amMoves[0].anMove, sizeof(ml.amMoves[0].anMove));
         return;
     }
 
@@ -5359,7 +5696,9 @@ FindBestMoveInEval(NNState * nnStates, int const nDice0, int const nDice1, const
 
     if (ml.cMoves <= prune_moves) {
         ScoreMoves(&ml, pci, pec, 0);
-        PositionFromKey(anBoardOut, &ml.amMoves[ml.iMoveBest].key);
+        *pkeyOut = ml.amMoves[ml.iMoveBest].key;
+        if (anMove)
+            memcpy(anMove, ml.amMoves[ml.iMoveBest].anMove, sizeof(ml.amMoves[0].anMove));
         return;
     }
 
@@ -5374,9 +5713,9 @@ FindBestMoveInEval(NNState * nnStates, int const nDice0, int const nDice1, const
          * on some gcc systems. Remove with great care. */
         move *const volatile pm = &ml.amMoves[i];
 
-        PositionFromKeySwapped(anBoardOut, &pm->key);
+        PositionFromKeySwapped(anBoard, &pm->key);
 
-        pc = ClassifyPosition((ConstTanBoard) anBoardOut, VARIATION_STANDARD);
+        pc = ClassifyPosition((ConstTanBoard) anBoard, VARIATION_STANDARD);
         if (i == 0) {
             if (pc < CLASS_RACE)
                 break;
@@ -5389,7 +5728,7 @@ FindBestMoveInEval(NNState * nnStates, int const nDice0, int const nDice1, const
         if ((l = CacheLookup(&cpEval, &ec, arOutput, NULL)) != CACHEHIT) {
             SSE_ALIGN(float arInput[NUM_PRUNING_INPUTS]);
 
-            baseInputs((ConstTanBoard) anBoardOut, arInput);
+            baseInputs((ConstTanBoard) anBoard, arInput);
             {
                 const neuralnet *nets[] = { &nnpRace, &nnpCrashed, &nnpContact };
                 const neuralnet *n = nets[pc - CLASS_RACE];
@@ -5404,9 +5743,9 @@ FindBestMoveInEval(NNState * nnStates, int const nDice0, int const nDice1, const
                 if (pc == CLASS_RACE)
                     /* special evaluation of backgammons
                      * overrides net output */
-                    EvalRaceBG((ConstTanBoard) anBoardOut, arOutput, VARIATION_STANDARD);
+                    EvalRaceBG((ConstTanBoard) anBoard, arOutput, VARIATION_STANDARD);
 
-                SanityCheck((ConstTanBoard) anBoardOut, arOutput);
+                SanityCheck((ConstTanBoard) anBoard, arOutput);
             }
             memcpy(ec.ar, arOutput, sizeof(float) * NUM_OUTPUTS);
             ec.ar[5] = 0.f;
@@ -5439,7 +5778,9 @@ FindBestMoveInEval(NNState * nnStates, int const nDice0, int const nDice1, const
     else
         ScoreMoves(&ml, pci, pec, 0);
 
-    PositionFromKey(anBoardOut, &ml.amMoves[ml.iMoveBest].key);
+    *pkeyOut = ml.amMoves[ml.iMoveBest].key;
+    if (anMove)
+        memcpy(anMove, ml.amMoves[ml.iMoveBest].anMove, sizeof(ml.amMoves[0].anMove));
 }
 
 static int
@@ -5457,37 +5798,37 @@ EvaluatePositionFull(NNState * nnStates, const TanBoard anBoard, float arOutput[
         cubeinfo ciOpp;
         float rTemp;
         int n0, n1;
+        positionkey key, keyNew;
 
         int const usePrune = pec->fUsePrune && pec->rNoise == 0.0f && pci->bgv == VARIATION_STANDARD;
 
         for (i = 0; i < NUM_OUTPUTS; i++)
             arOutput[i] = 0.0;
 
+        if (usePrune)
+            PositionKey(anBoard, &key);
+
         /* loop over rolls */
 
         for (n0 = 1; n0 <= 6; n0++) {
             for (n1 = 1; n1 <= n0; n1++) {
                 float w = (n0 == n1) ? 1.0f : 2.0f;
 
-                for (i = 0; i < 25; i++) {
-                    anBoardNew[0][i] = anBoard[0][i];
-                    anBoardNew[1][i] = anBoard[1][i];
-                }
-
                 if (fInterrupt) {
                     errno = EINTR;
                     return -1;
                 }
 
                 if (usePrune) {
-                    FindBestMoveInEval(nnStates, n0, n1, anBoard, anBoardNew, pci, pec);
+                    FindBestMoveInEval(nnStates, n0, n1, &key, &keyNew, NULL, pci, pec);
+                    /* unpack straight into the opponent's view */
+                    PositionFromKeySwapped(anBoardNew, &keyNew);
                 } else {
-
+                    memcpy(anBoardNew, anBoard, sizeof(TanBoard));
                     FindBestMovePlied(NULL, n0, n1, anBoardNew, pci, pec, 0, defaultFilters);
+                    SwapSides(anBoardNew);
                 }
 
-                SwapSides(anBoardNew);
-
                 SetCubeInfo(&ciOpp, pci->nCube, pci->fCubeOwner, !pci->fMove,
                             pci->nMatchTo, pci->anScore, pci->fCrawford, pci->fJacoby, pci->fBeavers, pci->bgv);
 
@@ -5547,6 +5888,10 @@ EvaluatePositionCache(NNState * nnStates, const TanBoard anBoard, float arOutput
 {
     evalcache ec;
     uint32_t l;
+    int n;
+#if defined(LOCKING_VERSION)
+    inflight *pif = NULL;
+#endif
     /* This should be a part of the code that is called in all
      * time-consuming operations at a relatively steady rate, so is a
      * good choice for a callback function. */
@@ -5561,7 +5906,21 @@ EvaluatePositionCache(NNState * nnStates, const TanBoard anBoard, float arOutput
         return 0;
     }
 
-    if (EvaluatePositionFull(nnStates, anBoard, arOutput, pci, pecx, nPlies, pc))
+#if defined(LOCKING_VERSION)
+    /* another thread may be evaluating this position already */
+    if (nPlies > 0
+        && (n = InFlightBegin(&ec.key, ec.nEvalContext, nPlies, NULL, 0, NULL, arOutput, NULL, &pif)) != 0)
+        return n > 0 ? 0 : -1;
+#endif
+
+    n = EvaluatePositionFull(nnStates, anBoard, arOutput, pci, pecx, nPlies, pc);
+
+#if defined(LOCKING_VERSION)
+    if (pif)
+        InFlightEnd(pif, arOutput, NULL, !n);
+#endif
+
+    if (n)
         return -1;
 
     memcpy(ec.ar, arOutput, sizeof(float) * NUM_OUTPUTS);
@@ -5581,6 +5940,24 @@ EvaluatePosition(NNState * nnStates, const TanBoard anBoard, float arOutput[],
 }
 
 
+static void
+SaveMoveEval(move * pm, const float arEval[NUM_ROLLOUT_OUTPUTS], const evalcontext * pec, int nPlies)
+{
+    /* Save evaluations */
+    memcpy(pm->arEvalMove, arEval, NUM_ROLLOUT_OUTPUTS * sizeof(float));
+
+    /* Save evaluation setup */
+    pm->esMove.et = EVAL_EVAL;
+    pm->esMove.ec = *pec;
+    pm->esMove.ec.nPlies = nPlies;
+
+    /* Score for move:
+     * rScore is the primary score (cubeful/cubeless)
+     * rScore2 is the secondary score (cubeless) */
+    pm->rScore = (pec->fCubeful) ? arEval[OUTPUT_CUBEFUL_EQUITY] : arEval[OUTPUT_EQUITY];
+    pm->rScore2 = arEval[OUTPUT_EQUITY];
+}
+
 extern int
 ScoreMove(NNState * nnStates, move * pm, const cubeinfo * pci, const evalcontext * pec, int nPlies)
 {
@@ -5602,19 +5979,61 @@ ScoreMove(NNState * nnStates, move * pm, const cubeinfo * pci, const evalcontext
     if (ci.nMatchTo)
         arEval[OUTPUT_CUBEFUL_EQUITY] = mwc2eq(arEval[OUTPUT_CUBEFUL_EQUITY], pci);
 
-    /* Save evaluations */
-    memcpy(pm->arEvalMove, arEval, NUM_ROLLOUT_OUTPUTS * sizeof(float));
+    SaveMoveEval(pm, arEval, pec, nPlies);
 
-    /* Save evaluation setup */
-    pm->esMove.et = EVAL_EVAL;
-    pm->esMove.ec = *pec;
-    pm->esMove.ec.nPlies = nPlies;
+    return 0;
+}
 
-    /* Score for move:
-     * rScore is the primary score (cubeful/cubeless)
-     * rScore2 is the secondary score (cubeless) */
-    pm->rScore = (pec->fCubeful) ? arEval[OUTPUT_CUBEFUL_EQUITY] : arEval[OUTPUT_EQUITY];
-    pm->rScore2 = arEval[OUTPUT_EQUITY];
+/* ScoreMove() of the move pm for the cci scores/cube states in aci. The
+ * cubeful evaluations are done in one walk of the ply tree (see
+ * EvaluatePositionCubefulMulti()); the cubeless ones are shared at 0-ply
+ * only, as the chequer play below depends on the gammon prices. */
+
+static int
+ScoreMoveMulti(NNState * nnStates, const move * pm, const cubeinfo aci[], int cci,
+               const evalcontext * pec, int nPlies, float aarEval[][NUM_ROLLOUT_OUTPUTS])
+{
+    TanBoard anBoardTemp;
+    SSE_ALIGN(float arOutput[MULTI_SCORE_CHUNK * NUM_OUTPUTS]);
+    cubeinfo aciSwapped[MULTI_SCORE_CHUNK];
+    float arCubeful[MULTI_SCORE_CHUNK];
+    int i, k;
+
+    g_assert(cci <= MULTI_SCORE_CHUNK);
+
+    PositionFromKeySwapped(anBoardTemp, &pm->key);
+
+    /* swap fMove in cubeinfo */
+    for (k = 0; k < cci; k++) {
+        memcpy(&aciSwapped[k], &aci[k], sizeof(cubeinfo));
+        aciSwapped[k].fMove = !aciSwapped[k].fMove;
+    }
+
+    if (pec->fCubeful) {
+        if (EvaluatePositionCubefulMulti(nnStates, (ConstTanBoard) anBoardTemp, arOutput, arCubeful,
+                                         aciSwapped, 1, aciSwapped, cci, pec, nPlies, FALSE))
+            return -1;
+    } else
+        for (k = 0; k < cci; k++)
+            if (nPlies == 0 && k > 0)
+                memcpy(arOutput + k * NUM_OUTPUTS, arOutput, NUM_OUTPUTS * sizeof(float));
+            else if (EvaluatePositionCache(nnStates, (ConstTanBoard) anBoardTemp, arOutput + k * NUM_OUTPUTS,
+                                           &aciSwapped[k], pec, nPlies,
+                                           ClassifyPosition((ConstTanBoard) anBoardTemp, aci[0].bgv)))
+                return -1;
+
+    for (k = 0; k < cci; k++) {
+        for (i = 0; i < NUM_OUTPUTS; i++)
+            aarEval[k][i] = arOutput[k * NUM_OUTPUTS + i];
+
+        aarEval[k][OUTPUT_EQUITY] = UtilityME(arOutput + k * NUM_OUTPUTS, &aciSwapped[k]);
+        aarEval[k][OUTPUT_CUBEFUL_EQUITY] = pec->fCubeful ? arCubeful[k] : 0.0f;
+
+        InvertEvaluationR(aarEval[k], &aciSwapped[k]);
+
+        if (aci[k].nMatchTo)
+            aarEval[k][OUTPUT_CUBEFUL_EQUITY] = mwc2eq(aarEval[k][OUTPUT_CUBEFUL_EQUITY], &aci[k]);
+    }
 
     return 0;
 }
@@ -5692,6 +6111,76 @@ ScoreMovesPruned(movelist * pml, const cubeinfo * pci, const evalcontext * pec,
     return r;
 }
 
+static int
+CompareMoveKeys(const move * pm0, const move * pm1)
+{
+    return memcmp(&pm0->key, &pm1->key, sizeof(positionkey));
+}
+
+/* Index of the move pm in amByKey, sorted with CompareMoveKeys() */
+
+static unsigned int
+MoveKeyIndex(const move * amByKey, unsigned int cMoves, const move * pm)
+{
+    const move *pmFound = bsearch(pm, amByKey, cMoves, sizeof(move), (cfunc) CompareMoveKeys);
+
+    g_assert(pmFound);
+
+    return (unsigned int) (pmFound - amByKey);
+}
+
+/* ScoreMoves() for the cci movelists in aml, which hold the same moves in
+ * different orders, one list per score in aci. Every move that is a
+ * candidate in at least one active list is evaluated once for all scores;
+ * aarEval holds cci evaluations for each move of amByKey. */
+
+static int
+ScoreMovesMulti(movelist aml[], const int afActive[], int cci, const move * amByKey, unsigned int cMoves,
+                float aarEval[][NUM_ROLLOUT_OUTPUTS], const cubeinfo aci[], const evalcontext * pec, int nPlies)
+{
+    unsigned int i, j;
+    int k;
+    int r = 0;                  /* return value */
+    NNState *nnStates = MT_Get_nnState();
+    char *afScore = g_malloc0(cMoves);
+
+    for (k = 0; k < cci; k++)
+        if (afActive[k])
+            for (j = 0; j < aml[k].cMoves; j++)
+                afScore[MoveKeyIndex(amByKey, cMoves, aml[k].amMoves + j)] = TRUE;
+
+    if (nPlies == 0) {
+        /* start incremental evaluations */
+        nnStates[0].state = nnStates[1].state = nnStates[2].state = NNSTATE_INCREMENTAL;
+    }
+
+    for (i = 0; i < cMoves; i++)
+        if (afScore[i] && ScoreMoveMulti(nnStates, amByKey + i, aci, cci, pec, nPlies, aarEval + i * cci) < 0) {
+            r = -1;
+            break;
+        }
+
+    if (nPlies == 0) {
+        /* reset to none */
+
+        nnStates[0].state = nnStates[1].state = nnStates[2].state = NNSTATE_NONE;
+    }
+
+    g_free(afScore);
+
+    if (r < 0)
+        return r;
+
+    for (k = 0; k < cci; k++)
+        if (afActive[k])
+            for (j = 0; j < aml[k].cMoves; j++) {
+                i = MoveKeyIndex(amByKey, cMoves, aml[k].amMoves + j);
+                SaveMoveEval(aml[k].amMoves + j, aarEval[i * cci + k], pec, nPlies);
+            }
+
+    return 0;
+}
+
 static movefilter NullFilter = { -1, 0, 0.0 };
 
 static int
@@ -5899,6 +6388,134 @@ FindnSaveBestMoves(movelist * pml, int nDice0, int nDice1, const TanBoard anBoar
 
 }
 
+/* FindnSaveBestMoves() for the cci scores/cube states in aci, which must
+ * all be money or all be match play with the same player on roll. The
+ * moves are generated once and, at each ply of the move filters, every
+ * candidate of any score is scored for MULTI_SCORE_CHUNK scores together
+ * (see ScoreMoveMulti()). The filters are then applied to each score's
+ * movelist as in FindnSaveBestMoves(), so each score is evaluated as it
+ * would be on its own. */
+
+extern int
+FindnSaveBestMovesMulti(movelist aml[], int cci, int nDice0, int nDice1, const TanBoard anBoard,
+                        const cubeinfo aci[], const evalcontext * pec,
+                        movefilter aamf[MAX_FILTER_PLIES][MAX_FILTER_PLIES])
+{
+    movelist ml;
+    move *amByKey;
+    float (*aarEval)[NUM_ROLLOUT_OUTPUTS];
+    movefilter *mFilters;
+    unsigned int nMoves, iPly;
+    int iFirst, n, k;
+    int r = 0;
+
+    for (k = 1; k < cci; k++)
+        g_assert(aci[k].fMove == aci[0].fMove && aci[k].bgv == aci[0].bgv && !aci[k].nMatchTo == !aci[0].nMatchTo);
+
+    /* see FindnSaveBestMoves() on the static data in ml */
+    GenerateMoves(&ml, anBoard, nDice0, nDice1, FALSE);
+    nMoves = ml.cMoves;
+
+    for (k = 0; k < cci; k++) {
+        memcpy(&aml[k], &ml, sizeof(movelist));
+        aml[k].amMoves = NULL;
+        if (nMoves) {
+            aml[k].amMoves = g_new(move, nMoves);
+            memcpy(aml[k].amMoves, ml.amMoves, nMoves * sizeof(move));
+        }
+    }
+
+    if (nMoves == 0)
+        /* no legal moves */
+        return 0;
+
+    amByKey = g_new(move, nMoves);
+    memcpy(amByKey, ml.amMoves, nMoves * sizeof(move));
+    qsort(amByKey, nMoves, sizeof(move), (cfunc) CompareMoveKeys);
+
+    aarEval = g_malloc(nMoves * MULTI_SCORE_CHUNK * sizeof(*aarEval));
+
+    mFilters = (pec->nPlies > 0 && pec->nPlies <= MAX_FILTER_PLIES) ?
+        aamf[pec->nPlies - 1] : aamf[MAX_FILTER_PLIES - 1];
+
+    for (iFirst = 0; iFirst < cci && !r; iFirst += n) {
+
+        movelist *pml = aml + iFirst;
+        int afActive[MULTI_SCORE_CHUNK];
+
+        n = MIN(cci - iFirst, MULTI_SCORE_CHUNK);
+
+        for (k = 0; k < n; k++)
+            afActive[k] = TRUE;
+
+        /* the filtered plies, then the top ply */
+
+        for (iPly = 0; iPly <= pec->nPlies; iPly++) {
+
+            movefilter *mFilter = (iPly == pec->nPlies) ? NULL :
+                (iPly < MAX_FILTER_PLIES) ? &mFilters[iPly] : &NullFilter;
+
+            if (mFilter && mFilter->Accept < 0)
+                continue;
+
+            if (ScoreMovesMulti(pml, afActive, n, amByKey, nMoves, aarEval, aci + iFirst, pec, iPly) < 0) {
+                r = -1;
+                break;
+            }
+
+            for (k = 0; k < n; k++) {
+
+                unsigned int c;
+
+                if (!afActive[k])
+                    continue;
+
+                qsort(pml[k].amMoves, pml[k].cMoves, sizeof(move), (cfunc) CompareMoves);
+                pml[k].iMoveBest = 0;
+                pml[k].rBestScore = pml[k].amMoves[0].rScore;
+
+                if (!mFilter)
+                    continue;
+
+                c = pml[k].cMoves;
+                pml[k].cMoves = MIN((unsigned int) mFilter->Accept, c);
+
+                {
+                    unsigned int limit = MIN(c, pml[k].cMoves + mFilter->Extra);
+
+                    for ( /**/; pml[k].cMoves < limit; ++pml[k].cMoves) {
+                        if (pml[k].amMoves[pml[k].cMoves].rScore < pml[k].amMoves[0].rScore - mFilter->Threshold) {
+                            break;
+                        }
+                    }
+                }
+
+                if (pml[k].cMoves == 1 && mFilter->Accept != 1)
+                    /* only one move left for this score */
+                    afActive[k] = FALSE;
+            }
+        }
+
+        /* set the proper size of the movelists */
+
+        for (k = 0; k < n; k++)
+            pml[k].cMoves = nMoves;
+    }
+
+    g_free(aarEval);
+    g_free(amByKey);
+
+    if (r < 0)
+        for (k = 0; k < cci; k++) {
+            g_free(aml[k].amMoves);
+            aml[k].cMoves = 0;
+            aml[k].amMoves = NULL;
+        }
+
+    return r;
+
+}
+
 extern int
 GeneralCubeDecisionE(float aarOutput[2][NUM_ROLLOUT_OUTPUTS],
                      const TanBoard anBoard,
@@ -5944,6 +6561,68 @@ GeneralCubeDecisionE(float aarOutput[2][NUM_ROLLOUT_OUTPUTS],
 
 }
 
+/* GeneralCubeDecisionE() for the cci scores/cube states in aci, which
+ * must all be money or all be match play with the same player on roll.
+ * The cube positions of MULTI_SCORE_CHUNK scores are evaluated in one walk
+ * of the ply tree, which shares the evaluations below the moves the
+ * scores agree on (see EvaluatePositionCubefulMulti()); the results are
+ * those of GeneralCubeDecisionE() at each score. */
+
+extern int
+GeneralCubeDecisionEMulti(float aaarOutput[][2][NUM_ROLLOUT_OUTPUTS],
+                          const TanBoard anBoard, cubeinfo aci[], int cci, const evalcontext * pec)
+{
+
+    SSE_ALIGN(float arOutput[MULTI_SCORE_CHUNK * NUM_OUTPUTS]);
+    cubeinfo aciCubePos[2 * MULTI_SCORE_CHUNK];
+    float arCubeful[2 * MULTI_SCORE_CHUNK];
+    int iFirst, n, i, j, k;
+
+    for (iFirst = 0; iFirst < cci; iFirst += n) {
+
+        n = MIN(cci - iFirst, MULTI_SCORE_CHUNK);
+
+        /* Setup cube for "no double" and "double, take" at each score */
+
+        for (k = 0; k < n; k++) {
+            const cubeinfo *pci = &aci[iFirst + k];
+
+            g_assert(pci->fMove == aci[0].fMove && pci->bgv == aci[0].bgv && !pci->nMatchTo == !aci[0].nMatchTo);
+
+            memcpy(&aciCubePos[2 * k], pci, sizeof(cubeinfo));
+            memcpy(&aciCubePos[2 * k + 1], pci, sizeof(cubeinfo));
+            aciCubePos[2 * k + 1].fCubeOwner = !aciCubePos[2 * k + 1].fMove;
+            aciCubePos[2 * k + 1].nCube *= 2;
+        }
+
+        if (EvaluatePositionCubefulMulti(NULL, anBoard, arOutput, arCubeful, aciCubePos, 2, &aci[iFirst], n,
+                                         pec, pec->nPlies, TRUE))
+            return -1;
+
+        for (k = 0; k < n; k++) {
+
+            /* Scale double-take equity */
+            if (!aci[iFirst + k].nMatchTo)
+                arCubeful[2 * k + 1] *= 2.0f;
+
+            for (i = 0; i < 2; i++) {
+
+                for (j = 0; j < NUM_OUTPUTS; j++)
+                    aaarOutput[iFirst + k][i][j] = arOutput[k * NUM_OUTPUTS + j];
+
+                aaarOutput[iFirst + k][i][OUTPUT_EQUITY] = UtilityME(arOutput + k * NUM_OUTPUTS,
+                                                                     &aciCubePos[2 * k + i]);
+
+                aaarOutput[iFirst + k][i][OUTPUT_CUBEFUL_EQUITY] = arCubeful[2 * k + i];
+
+            }
+        }
+    }
+
+    return 0;
+
+}
+
 extern int
 GeneralEvaluationE(float arOutput[NUM_ROLLOUT_OUTPUTS],
                    const TanBoard anBoard, cubeinfo * const pci, const evalcontext * pec)
@@ -5993,6 +6672,109 @@ GeneralEvaluationEPlied(NNState * nnStates, float arOutput[NUM_ROLLOUT_OUTPUTS],
 
 }
 
+/* The chequer play at the internal nodes of cubeful evaluations is kept in
+ * cmEval, separately from the cubeful equities in cEval. Evaluating a
+ * position again for other cube positions (say, the cube decision after
+ * the move analysis) then walks the same subtree without choosing the
+ * moves again; the leaves come from cEval as before.
+ *
+ * The context is EvalKey() of a 0-ply cubeful equity, which covers
+ * everything the choice of move depends on, with the xor undone. The
+ * nPlies and fUsePrune bits it leaves free, and the top bits, hold the
+ * roll and whether the moves were pruned. The move is stored packed in
+ * the first two outputs, five bits per point. */
+
+static inline int
+MoveContext(const evalcontext * pec, const cubeinfo * pci, int usePrune)
+{
+    return (EvalKey(pec, 0, pci, TRUE) ^ 0x6a47b47e) | (usePrune << 6);
+}
+
+static inline int
+MoveContextRoll(int nContext, int n0, int n1)
+{
+    int i = n0 * (n0 - 1) / 2 + n1 - 1;
+
+    return nContext | (i & 0xf) | ((i >> 4) << 28);
+}
+
+static inline void
+PackMove(const int anMove[8], float ar[2])
+{
+    int i, an[8];
+
+    for (i = 0; i < 8; i += 2)
+        if (i > 0 && !an[i - 2])
+            an[i] = an[i + 1] = 0;
+        else if (anMove[i] < 0)
+            an[i] = an[i + 1] = 0;
+        else {
+            an[i] = anMove[i] + 1;
+            an[i + 1] = anMove[i + 1] + 1;
+        }
+
+    ar[0] = (float) (an[0] | an[1] << 5 | an[2] << 10 | an[3] << 15);
+    ar[1] = (float) (an[4] | an[5] << 5 | an[6] << 10 | an[7] << 15);
+}
+
+static inline void
+UnpackMove(const float ar[2], int anMove[8])
+{
+    int i;
+
+    for (i = 0; i < 8; i++)
+        anMove[i] = (((int) ar[i / 4] >> (5 * (i % 4))) & 0x1f) - 1;
+}
+
+/* The board after the move the player on roll in pciMove chooses for the
+ * roll n0-n1 at an internal node of a cubeful evaluation, from the
+ * opponent's point of view. pkey is the key of anBoard if the moves are
+ * pruned or cached. */
+
+static void
+ChooseMoveInEval(NNState * nnStates, const TanBoard anBoard, const positionkey * pkey, int n0, int n1,
+                 cubeinfo * const pciMove, const evalcontext * pec, int usePrune, TanBoard anBoardNew)
+{
+    SSE_ALIGN(float ar[NUM_OUTPUTS]);
+    positionkey keyNew;
+    evalcache ecMove;
+    uint32_t l = 0;
+    int anMove[8];
+
+    int const fMoveCache = cCache && pec->rNoise == 0.0f;
+
+    if (fMoveCache) {
+        ecMove.key = *pkey;
+        memset(ecMove.ar, 0, sizeof(ecMove.ar));
+        ecMove.nEvalContext = MoveContextRoll(MoveContext(pec, pciMove, usePrune), n0, n1);
+        l = CacheLookup(&cmEval, &ecMove, ar, NULL);
+    }
+
+    if (fMoveCache && l == CACHEHIT) {
+        /* chosen before, maybe for other cube positions */
+        UnpackMove(ar, anMove);
+        memcpy(anBoardNew, anBoard, sizeof(TanBoard));
+        ApplyMove(anBoardNew, anMove, FALSE);
+        SwapSides(anBoardNew);
+        return;
+    }
+
+    if (usePrune) {
+        FindBestMoveInEval(nnStates, n0, n1, pkey, &keyNew, anMove, pciMove, pec);
+        /* unpack straight into the opponent's view */
+        PositionFromKeySwapped(anBoardNew, &keyNew);
+    } else {
+        memcpy(anBoardNew, anBoard, sizeof(TanBoard));
+        FindBestMovePlied(anMove, n0, n1, anBoardNew, pciMove, pec, 0, defaultFilters);
+        SwapSides(anBoardNew);
+    }
+
+    if (fMoveCache && !fInterrupt) {
+        PackMove(anMove, ecMove.ar);
+        CacheAdd(&cmEval, &ecMove, l);
+    }
+}
+
 static int
 EvaluatePositionCubeful4(NNState * nnStates, const TanBoard anBoard,
                          float arOutput[NUM_OUTPUTS],
@@ -6023,12 +6805,16 @@ EvaluatePositionCubeful4(NNState * nnStates, const TanBoard anBoard,
         TanBoard anBoardNew;
         int n0, n1;
         float r;
+        positionkey key;
 
         int const usePrune = pec->fUsePrune && pec->rNoise == 0.0f && pciMove->bgv == VARIATION_STANDARD;
 
         for (i = 0; i < NUM_OUTPUTS; i++)
             arOutput[i] = 0.0;
 
+        if (usePrune || (cCache && pec->rNoise == 0.0f))
+            PositionKey(anBoard, &key);
+
         for (i = 0; i < 2 * cci; i++)
             arCf[i] = 0.0;
 
@@ -6042,24 +6828,12 @@ EvaluatePositionCubeful4(NNState * nnStates, const TanBoard anBoard,
             for (n1 = 1; n1 <= n0; n1++) {
                 float w = (n0 == n1) ? 1.0f : 2.0f;
 
-                for (i = 0; i < 25; i++) {
-                    anBoardNew[0][i] = anBoard[0][i];
-                    anBoardNew[1][i] = anBoard[1][i];
-                }
-
                 if (fInterrupt) {
                     errno = EINTR;
                     return -1;
                 }
 
-                if (usePrune) {
-                    FindBestMoveInEval(nnStates, n0, n1, anBoard, anBoardNew, pciMove, pec);
-                } else {
-
-                    FindBestMovePlied(NULL, n0, n1, anBoardNew, pciMove, pec, 0, defaultFilters);
-                }
-
-                SwapSides(anBoardNew);
+                ChooseMoveInEval(nnStates, anBoard, &key, n0, n1, pciMove, pec, usePrune, anBoardNew);
 
                 SetCubeInfo(&ciMoveOpp,
                             pciMove->nCube, pciMove->fCubeOwner,
@@ -6120,7 +6894,7 @@ EvaluatePositionCubeful4(NNState * nnStates, const TanBoard anBoard,
 
         if (pc == CLASS_HYPERGAMMON1 || pc == CLASS_HYPERGAMMON2 || pc == CLASS_HYPERGAMMON3) {
 
-            bearoffcontext *pbc = apbcHyper[pc - CLASS_HYPERGAMMON1];
+            bearoffcontext *pbc = GetBearoff(BDB_HYPER1 + pc - CLASS_HYPERGAMMON1);
             unsigned int nUs, nThem, iPos;
             unsigned int n;
 
@@ -6132,7 +6906,7 @@ EvaluatePositionCubeful4(NNState * nnStates, const TanBoard anBoard,
             n = Combination(pbc->nPoints + pbc->nChequers, pbc->nPoints);
             iPos = nUs * n + nThem;
 
-            if (BearoffHyper(apbcHyper[pc - CLASS_HYPERGAMMON1], iPos, arOutput, arEquity))
+            if (BearoffHyper(pbc, iPos, arOutput, arEquity))
                 return -1;
 
         } else if (pc > CLASS_OVER && pc <= CLASS_PERFECT /* && ! pciMove->nMatchTo */ ) {
@@ -6303,7 +7077,8 @@ EvaluatePositionCubeful4(NNState * nnStates, const TanBoard anBoard,
 }
 
 /* EvaluatePositionCubeful3 is now just a wrapper for ....Cubeful4, which
- * first checks the cache, and then calls ...Cubeful3 */
+ * first checks the cache, and then calls ...Cubeful4 for the cube
+ * positions it did not find there */
 
 extern int
 EvaluatePositionCubeful3(NNState * nnStates, const TanBoard anBoard,
@@ -6313,9 +7088,14 @@ EvaluatePositionCubeful3(NNState * nnStates, const TanBoard anBoard,
                          cubeinfo * const pciMove, const evalcontext * pec, int nPlies, int fTop)
 {
 
-    int ici;
-    int fAll;
+    int ici, i;
+    int cHit, cMiss;
+    int *aiMiss;
     evalcache ec;
+#if defined(LOCKING_VERSION)
+    inflight *pif = NULL;
+#endif
+    int n;
 
     if (!cCache || pec->rNoise != 0.0f)
         /* non-deterministic evaluation; never cache */
@@ -6324,13 +7104,17 @@ EvaluatePositionCubeful3(NNState * nnStates, const TanBoard anBoard,
                                         aciCubePos, cci, pciMove, pec, nPlies, fTop);
     }
 
+    if (fTop)                   /* FIXME: fTop should be a part of EvalKey */
+        return EvaluatePositionCubeful4(nnStates, anBoard, arOutput, arCubeful,
+                                        aciCubePos, cci, pciMove, pec, nPlies, fTop);
+
     PositionKey(anBoard, &ec.key);
 
     /* check cache for existence for earlier calculation */
 
-    fAll = !fTop;               /* FIXME: fTop should be a part of EvalKey */
+    aiMiss = (int *) g_alloca(cci * sizeof(int));
 
-    for (ici = 0; ici < cci && fAll; ++ici) {
+    for (ici = 0, cHit = cMiss = 0; ici < cci; ++ici) {
 
         if (aciCubePos[ici].nCube < 0) {
             continue;
@@ -6338,38 +7122,219 @@ EvaluatePositionCubeful3(NNState * nnStates, const TanBoard anBoard,
 
         ec.nEvalContext = EvalKey(pec, nPlies, &aciCubePos[ici], TRUE);
 
-        if (CacheLookup(&cEval, &ec, arOutput, arCubeful + ici) != CACHEHIT) {
-            fAll = FALSE;
-        }
+        if (CacheLookup(&cEval, &ec, arOutput, arCubeful + ici) != CACHEHIT)
+            aiMiss[cMiss++] = ici;
+        else
+            cHit++;
     }
 
     /* get equities */
 
-    if (!fAll) {
+    if (cMiss) {
 
         /* cache miss */
-        if (EvaluatePositionCubeful4(nnStates, anBoard, arOutput, arCubeful,
-                                     aciCubePos, cci, pciMove, pec, nPlies, fTop))
+#if defined(LOCKING_VERSION)
+        /* another thread may be evaluating this position already */
+        if (nPlies > 0
+            && (n = InFlightBegin(&ec.key, EvalKey(pec, nPlies, pciMove, TRUE), nPlies,
+                                  aciCubePos, cci, pciMove, arOutput, arCubeful, &pif)) != 0)
+            return n > 0 ? 0 : -1;
+
+#endif
+
+        if (!cHit)
+            n = EvaluatePositionCubeful4(nnStates, anBoard, arOutput, arCubeful,
+                                         aciCubePos, cci, pciMove, pec, nPlies, fTop);
+        else {
+            /* the cubeful equities of each cube position are independent
+             * of the others, so only evaluate the ones not cached */
+            cubeinfo *aciMiss = (cubeinfo *) g_alloca(cMiss * sizeof(cubeinfo));
+            float *arCubefulMiss = (float *) g_alloca(cMiss * sizeof(float));
+
+            for (i = 0; i < cMiss; ++i)
+                aciMiss[i] = aciCubePos[aiMiss[i]];
+
+            n = EvaluatePositionCubeful4(nnStates, anBoard, arOutput, arCubefulMiss,
+                                         aciMiss, cMiss, pciMove, pec, nPlies, fTop);
+
+            for (i = 0; i < cMiss; ++i)
+                arCubeful[aiMiss[i]] = arCubefulMiss[i];
+        }
+
+#if defined(LOCKING_VERSION)
+        if (pif)
+            InFlightEnd(pif, arOutput, arCubeful, !n);
+#endif
+
+        if (n)
             return -1;
 
         /* add to cache */
 
-        if (!fTop) {
+        for (i = 0; i < cMiss; ++i) {
+            ici = aiMiss[i];
+
+            memcpy(ec.ar, arOutput, sizeof(float) * NUM_OUTPUTS);
+            ec.ar[5] = arCubeful[ici];  /* Cubeful equity stored in slot 5 */
+            ec.nEvalContext = EvalKey(pec, nPlies, &aciCubePos[ici], TRUE);
+
+            CacheAdd(&cEval, &ec, GetHashKey(cEval.hashMask, &ec));
+        }
+    }
+
+    return 0;
+
+}
+
+/* EvaluatePositionCubeful3() for cScores scores at once: aciCubePos holds
+ * cPos cube positions per score and aciMove the cube state whose chequer
+ * play each score follows; arOutput holds the cubeless outputs of each
+ * score. The scores walk the ply tree together for as long as they
+ * choose the same moves and split up where they don't, so each score gets
+ * exactly its own evaluation; what they share are the evaluations below
+ * the moves they agree on and at the leaves, which don't depend on the
+ * chequer play. */
+
+static int
+EvaluatePositionCubefulMulti(NNState * nnStates, const TanBoard anBoard, float arOutput[], float arCubeful[],
+                             const cubeinfo aciCubePos[], int cPos, cubeinfo aciMove[], int cScores,
+                             const evalcontext * pec, int nPlies, int fTop)
+{
+    int i, j, k;
+    positionclass pc = ClassifyPosition(anBoard, aciMove[0].bgv);
+    int const cNext = 2 * cPos;
+    int const usePrune = pec->fUsePrune && pec->rNoise == 0.0f && aciMove[0].bgv == VARIATION_STANDARD;
+    float *arCf, *arGroup, *arCfGroup;
+    cubeinfo *aci, *aciGroup, *aciMoveOpp, *aciMoveGroup;
+    TanBoard *aanBoardNew;
+    int *aiGroup;
+    char *afDone;
+    positionkey key;
+    int n0, n1;
+    float r;
+
+    if (cScores == 1 || pc <= CLASS_OVER || nPlies == 0 || (pc <= CLASS_PERFECT && !aciMove[0].nMatchTo)) {
+        /* a single score or a leaf node */
+        if (EvaluatePositionCubeful3(nnStates, anBoard, arOutput, arCubeful, aciCubePos, cScores * cPos,
+                                     aciMove, pec, nPlies, fTop))
+            return -1;
+
+        for (k = 1; k < cScores; k++)
+            memcpy(arOutput + k * NUM_OUTPUTS, arOutput, NUM_OUTPUTS * sizeof(float));
+
+        return 0;
+    }
+
+    /* internal node; recurse */
+
+    arCf = (float *) g_alloca(cScores * cNext * sizeof(float));
+    arCfGroup = (float *) g_alloca(cScores * cNext * sizeof(float));
+    arGroup = (float *) g_alloca(cScores * NUM_OUTPUTS * sizeof(float));
+    aci = (cubeinfo *) g_alloca(cScores * cNext * sizeof(cubeinfo));
+    aciGroup = (cubeinfo *) g_alloca(cScores * cNext * sizeof(cubeinfo));
+    aciMoveOpp = (cubeinfo *) g_alloca(cScores * sizeof(cubeinfo));
+    aciMoveGroup = (cubeinfo *) g_alloca(cScores * sizeof(cubeinfo));
+    aanBoardNew = (TanBoard *) g_alloca(cScores * sizeof(TanBoard));
+    aiGroup = (int *) g_alloca(cScores * sizeof(int));
+    afDone = (char *) g_alloca(cScores);
+
+    for (i = 0; i < cScores * NUM_OUTPUTS; i++)
+        arOutput[i] = 0.0f;
+    for (i = 0; i < cScores * cNext; i++)
+        arCf[i] = 0.0f;
+
+    if (usePrune || (cCache && pec->rNoise == 0.0f))
+        PositionKey(anBoard, &key);
+
+    /* construct next level cube positions; those of score k are
+     * aci[k * cNext] to aci[(k + 1) * cNext - 1] */
+
+    MakeCubePos(aciCubePos, cScores * cPos, fTop, aci, TRUE);
+
+    for (k = 0; k < cScores; k++)
+        SetCubeInfo(&aciMoveOpp[k], aciMove[k].nCube, aciMove[k].fCubeOwner, !aciMove[k].fMove,
+                    aciMove[k].nMatchTo, aciMove[k].anScore, aciMove[k].fCrawford, aciMove[k].fJacoby,
+                    aciMove[k].fBeavers, aciMove[k].bgv);
 
-            for (ici = 0; ici < cci; ++ici) {
-                if (aciCubePos[ici].nCube < 0)
+    /* loop over rolls */
+
+    for (n0 = 1; n0 <= 6; n0++) {
+        for (n1 = 1; n1 <= n0; n1++) {
+            float w = (n0 == n1) ? 1.0f : 2.0f;
+
+            if (fInterrupt) {
+                errno = EINTR;
+                return -1;
+            }
+
+            for (k = 0; k < cScores; k++)
+                ChooseMoveInEval(nnStates, anBoard, &key, n0, n1, &aciMove[k], pec, usePrune, aanBoardNew[k]);
+
+            memset(afDone, 0, cScores);
+
+            for (k = 0; k < cScores; k++) {
+                int c = 0;
+
+                if (afDone[k])
                     continue;
 
-                memcpy(ec.ar, arOutput, sizeof(float) * NUM_OUTPUTS);
-                ec.ar[5] = arCubeful[ici];      /* Cubeful equity stored in slot 5 */
-                ec.nEvalContext = EvalKey(pec, nPlies, &aciCubePos[ici], TRUE);
+                /* the scores that move to the same position as score k */
+
+                for (j = k; j < cScores; j++)
+                    if (!afDone[j] && !memcmp(aanBoardNew[j], aanBoardNew[k], sizeof(TanBoard))) {
+                        afDone[j] = TRUE;
+                        aiGroup[c] = j;
+                        memcpy(aciGroup + c * cNext, aci + j * cNext, cNext * sizeof(cubeinfo));
+                        aciMoveGroup[c] = aciMoveOpp[j];
+                        c++;
+                    }
 
-                CacheAdd(&cEval, &ec, GetHashKey(cEval.hashMask, &ec));
+                if (EvaluatePositionCubefulMulti(nnStates, (ConstTanBoard) aanBoardNew[k], arGroup, arCfGroup,
+                                                 aciGroup, cNext, aciMoveGroup, c, pec, nPlies - 1, FALSE))
+                    return -1;
 
+                /* Sum up cubeless winning chances and cubeful equities */
+
+                for (j = 0; j < c; j++) {
+                    for (i = 0; i < NUM_OUTPUTS; i++)
+                        arOutput[aiGroup[j] * NUM_OUTPUTS + i] += w * arGroup[j * NUM_OUTPUTS + i];
+                    for (i = 0; i < cNext; i++)
+                        arCf[aiGroup[j] * cNext + i] += w * arCfGroup[j * cNext + i];
+                }
             }
         }
     }
 
+    /* Flip evals, as in EvaluatePositionCubeful4() */
+
+    for (k = 0; k < cScores; k++) {
+        float *ar = arOutput + k * NUM_OUTPUTS;
+
+        ar[OUTPUT_WIN] = 1.0f - ar[OUTPUT_WIN] / 36;
+
+        r = ar[OUTPUT_WINGAMMON] / 36;
+        ar[OUTPUT_WINGAMMON] = ar[OUTPUT_LOSEGAMMON] / 36;
+        ar[OUTPUT_LOSEGAMMON] = r;
+
+        r = ar[OUTPUT_WINBACKGAMMON] / 36;
+        ar[OUTPUT_WINBACKGAMMON] = ar[OUTPUT_LOSEBACKGAMMON] / 36;
+        ar[OUTPUT_LOSEBACKGAMMON] = r;
+    }
+
+    for (i = 0; i < cScores * cNext; i++) {
+        if (aciMove[0].nMatchTo)
+            arCf[i] = 1.0f - arCf[i] / 36;
+        else
+            arCf[i] = -arCf[i] / 36;
+
+        /* invert fMove */
+        aci[i].fMove = !aci[i].fMove;
+    }
+
+    /* get cubeful equities */
+
+    GetECF3(arCubeful, cScores * cPos, arCf, aci);
+
     return 0;
 
 }
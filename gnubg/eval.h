@@ -35,6 +35,7 @@
 #define WEIGHTS_VERSION "1.01"
 #define WEIGHTS_VERSION_BINARY 1.01f
 #define WEIGHTS_MAGIC_BINARY 472.3782f
+#define WEIGHTS_MAGIC_MAPPED 472.3783f  /* padded for use in place */
 
 #define NUM_OUTPUTS 5
 #define NUM_CUBEFUL_OUTPUTS 4
@@ -127,6 +128,7 @@ typedef struct {
     unsigned int fStopOnJsd:1;
     unsigned int fStopMoveOnJsd:1;      /* stop multi-line rollout when jsd
                                          * is small enough */
+    unsigned int fTruncOSR:1;   /* cubeless rollout: trunc at races with OSR */
     unsigned short nTruncate;   /* truncation */
     unsigned int nTrials;       /* number of rollouts */
     unsigned short nLate;       /* switch evaluations on move nLate of game */
@@ -286,11 +288,34 @@ extern int fInterrupt;
 extern cubeinfo ciCubeless;
 extern const char *aszEvalType[(int) EVAL_ROLLOUT + 1];
 
-extern bearoffcontext *pbc1;
-extern bearoffcontext *pbc2;
-extern bearoffcontext *pbcOS;
-extern bearoffcontext *pbcTS;
-extern bearoffcontext *apbcHyper[3];
+/* the bearoff databases, opened on first use by GetBearoff() */
+typedef enum {
+    BDB_1,                      /* gnubg_os0.bd, or the heuristic one-sided database */
+    BDB_2,                      /* gnubg_ts0.bd */
+    BDB_OS,                     /* gnubg_os.bd */
+    BDB_TS,                     /* gnubg_ts.bd */
+    BDB_HYPER1,                 /* hyper1.bd to hyper3.bd */
+    BDB_HYPER2,
+    BDB_HYPER3,
+    NUM_BDB
+} bearoffdb;
+
+extern bearoffcontext *apbcBearoff[NUM_BDB];
+extern gint afBearoffOpen[NUM_BDB];
+extern const char *aszBearoffFile[NUM_BDB];
+extern char *szHeuristicBearoff;
+
+extern bearoffcontext *OpenBearoff(bearoffdb bdb);
+extern gint64 BearoffOpenTime(bearoffdb bdb);
+
+static inline bearoffcontext *
+GetBearoff(bearoffdb bdb)
+{
+    if (g_atomic_int_get(&afBearoffOpen[bdb]))
+        return apbcBearoff[bdb];
+
+    return OpenBearoff(bdb);
+}
 
 typedef struct {
     unsigned int cMoves;        /* and current move when building list */
@@ -376,6 +401,13 @@ EXP_LOCK_FUN(int, FindnSaveBestMoves, movelist * pml,
              positionkey * keyMove, const float rThr,
              const cubeinfo * pci, const evalcontext * pec, movefilter aamf[MAX_FILTER_PLIES][MAX_FILTER_PLIES]);
 
+/* number of scores evaluated together by the ...Multi() functions */
+#define MULTI_SCORE_CHUNK 16
+
+EXP_LOCK_FUN(int, FindnSaveBestMovesMulti, movelist aml[], int cci,
+             int nDice0, int nDice1, const TanBoard anBoard,
+             const cubeinfo aci[], const evalcontext * pec, movefilter aamf[MAX_FILTER_PLIES][MAX_FILTER_PLIES]);
+
 extern void
  PipCount(const TanBoard anBoard, unsigned int anPips[2]);
 
@@ -407,13 +439,25 @@ void SetEvalCacheSize(unsigned int size);
 extern unsigned int GetEvalCacheEntries(void);
 extern int GetCacheMB(int size);
 
+#if defined(USE_MULTITHREAD)
+/* evaluations started and evaluations shared between threads since the
+ * last reset (see EvaluatePositionCache() in the locking version) */
+extern void EvalInFlightStats(unsigned int *pcStarted, unsigned int *pcShared);
+extern void EvalInFlightReset(void);
+#endif
+
 extern evalCache cEval;
 extern evalCache cpEval;
+extern evalCache cmEval;
 extern unsigned int cCache;
 
 extern int
  GenerateMoves(movelist * pml, const TanBoard anBoard, int n0, int n1, int fPartial);
 
+/* GenerateMoves() from the packed board of a position key */
+extern int
+ GenerateMovesKey(movelist * pml, const positionkey * pkey, int n0, int n1, int fPartial);
+
 extern int ApplySubMove(TanBoard anBoard, const int iSrc, const int nRoll, const int fCheckLegal);
 
 extern int ApplyMove(TanBoard anBoard, const int anMove[8], const int fCheckLegal);
@@ -476,6 +520,9 @@ extern cubedecision FindCubeDecision(float arDouble[], float aarOutput[][NUM_ROL
 EXP_LOCK_FUN(int, GeneralCubeDecisionE, float aarOutput[2][NUM_ROLLOUT_OUTPUTS],
              const TanBoard anBoard, cubeinfo * const pci, const evalcontext * pec, const evalsetup * pes);
 
+EXP_LOCK_FUN(int, GeneralCubeDecisionEMulti, float aaarOutput[][2][NUM_ROLLOUT_OUTPUTS],
+             const TanBoard anBoard, cubeinfo aci[], int cci, const evalcontext * pec);
+
 EXP_LOCK_FUN(int, GeneralEvaluationE, float arOutput[NUM_ROLLOUT_OUTPUTS],
              const TanBoard anBoard, cubeinfo * const pci, const evalcontext * pec);
 
@@ -36,6 +36,7 @@
 #include "export.h"
 #include "eval.h"
 #include "list.h"
+#include "multithread.h"
 #include "positionid.h"
 #include "renderprefs.h"
 #include "matchid.h"
@@ -477,13 +478,48 @@ CommandExportMatchPS(char *sz)
         outputerrf(_("Failed to create cairo surface for %s"), sz);
 }
 
+static void
+BoardImageAppearance(renderdata * prd)
+{
+    CopyAppearance(prd);
+    prd->nSize = exsExport.nHtmlSize;
+}
+
+/* The appearance part of the board picture names */
+extern char *
+BoardImageKey(void)
+{
+    renderdata rd;
+
+    BoardImageAppearance(&rd);
+
+    return RenderDataKey(&rd);
+}
+
+extern char *
+BoardImageName(const char *szKey, const boardimage * pbi)
+{
+    GChecksum *pcs = g_checksum_new(G_CHECKSUM_MD5);
+    char *sz;
+
+    g_checksum_update(pcs, (const guchar *) szKey, (gssize) strlen(szKey));
+    g_checksum_update(pcs, (const guchar *) pbi, sizeof(*pbi));
+
+    sz = g_strconcat("b-", g_checksum_get_string(pcs), NULL);
+    g_checksum_free(pcs);
+
+    return sz;
+}
+
 #if defined(HAVE_LIBPNG)
 
 /* size of HTML images in steps of BOARD_WIDTH x BOARD_HEIGHT
  * as defined in boarddim.h */
 
-extern int
-WritePNG(const char *sz, unsigned char *puch, unsigned int nStride, unsigned int nSizeX, unsigned int nSizeY)
+/* As WritePNG(), but without any output, so that it can run on any
+ * thread. Returns -2 for errors from libpng. */
+static int
+WritePNGFile(const char *sz, unsigned char *puch, unsigned int nStride, unsigned int nSizeX, unsigned int nSizeY)
 {
 
     FILE *pf;
@@ -507,10 +543,9 @@ WritePNG(const char *sz, unsigned char *puch, unsigned int nStride, unsigned int
     }
 
     if (setjmp(png_jmpbuf(ppng))) {
-        outputerr(sz);
         fclose(pf);
         png_destroy_write_struct(&ppng, &pinfo);
-        return -1;
+        return -2;
     }
 
     png_init_io(ppng, pf);
@@ -558,14 +593,27 @@ WritePNG(const char *sz, unsigned char *puch, unsigned int nStride, unsigned int
 
 }
 
-static int
-GenerateImage(renderimages * pri, renderdata * prd,
-              const TanBoard anBoard,
-              const char *szName,
-              const int nSize, const int nSizeX, const int nSizeY,
-              const int nOffsetX, const int nOffsetY,
-              const int fMove, const int fTurn, const int fCube,
-              const unsigned int anDice[2], const int nCube, const int fDoubled, const int fCubeOwner)
+extern int
+WritePNG(const char *sz, unsigned char *puch, unsigned int nStride, unsigned int nSizeX, unsigned int nSizeY)
+{
+    int n = WritePNGFile(sz, puch, nStride, nSizeX, nSizeY);
+
+    if (n == -2) {
+        outputerr(sz);
+        n = -1;
+    }
+
+    return n;
+}
+
+/* Draw a whole board from the images in pri. Only reads its arguments
+ * and fClockwise, so it may run on any thread. */
+static unsigned char *
+DrawBoardImage(renderimages * pri, renderdata * prd,
+               const TanBoard anBoard, const int nSize,
+               const int fMove, const int fTurn, const int fCube,
+               const unsigned int anDice[2], const int nCube, const int fDoubled, const int fCubeOwner,
+               const int fPlaying)
 {
     TanBoard anBoardTemp;
     unsigned char *puch;
@@ -586,10 +634,7 @@ GenerateImage(renderimages * pri, renderdata * prd,
 
     /* allocate memory for board */
 
-    if (!(puch = (unsigned char *) malloc(BOARD_WIDTH * BOARD_HEIGHT * nSize * nSize * 3))) {
-        outputerr("malloc");
-        return -1;
-    }
+    puch = g_malloc(BOARD_WIDTH * BOARD_HEIGHT * nSize * nSize * 3);
 
     /* calculate cube position */
 
@@ -636,7 +681,22 @@ GenerateImage(renderimages * pri, renderdata * prd,
                   LogCube(nCube) + (doubled != 0),
                   nOrient,
                   anResignPosition, fResign, nResignOrientation,
-                  anArrowPosition, ms.gs != GAME_NONE, fMove == 1, 0, 0, BOARD_WIDTH * nSize, BOARD_HEIGHT * nSize);
+                  anArrowPosition, fPlaying, fMove == 1, 0, 0, BOARD_WIDTH * nSize, BOARD_HEIGHT * nSize);
+
+    return puch;
+}
+
+static int
+GenerateImage(renderimages * pri, renderdata * prd,
+              const TanBoard anBoard,
+              const char *szName,
+              const int nSize, const int nSizeX, const int nSizeY,
+              const int nOffsetX, const int nOffsetY,
+              const int fMove, const int fTurn, const int fCube,
+              const unsigned int anDice[2], const int nCube, const int fDoubled, const int fCubeOwner)
+{
+    unsigned char *puch = DrawBoardImage(pri, prd, anBoard, nSize, fMove, fTurn, fCube, anDice,
+                                         nCube, fDoubled, fCubeOwner, ms.gs != GAME_NONE);
 
     /* crop */
 
@@ -660,11 +720,125 @@ GenerateImage(renderimages * pri, renderdata * prd,
 
     WritePNG(szName, puch, nSizeX * nSize * 3, nSizeX * nSize, nSizeY * nSize);
 
-    free(puch);
+    g_free(puch);
 
     return 0;
 }
 
+typedef struct {
+    renderimages *pri;
+    renderdata *prd;
+    const boardimage *pbi;
+    char *szFile;
+    int n;                      /* result of WritePNGFile() */
+} boardimagejob;
+
+/* Draw one board picture and write it under a temporary name first, so
+ * that an interrupted export never leaves a truncated picture behind */
+static void
+WriteBoardImage(boardimagejob * pbij)
+{
+    const boardimage *pbi = pbij->pbi;
+    int nSize = pbij->prd->nSize;
+    char *szTemp = g_strconcat(pbij->szFile, ".tmp", NULL);
+    unsigned char *puch = DrawBoardImage(pbij->pri, pbij->prd, pbi->anBoard, nSize,
+                                         pbi->fMove, pbi->fTurn, pbi->fCube, pbi->anDice,
+                                         pbi->nCube, pbi->fDoubled, pbi->fCubeOwner, TRUE);
+
+    pbij->n = WritePNGFile(szTemp, puch, BOARD_WIDTH * nSize * 3, BOARD_WIDTH * nSize, BOARD_HEIGHT * nSize);
+    if (!pbij->n && g_rename(szTemp, pbij->szFile))
+        pbij->n = -1;
+    if (pbij->n)
+        g_unlink(szTemp);
+
+    g_free(puch);
+    g_free(szTemp);
+}
+
+#if defined(USE_MULTITHREAD)
+typedef struct {
+    Task task;
+    boardimagejob *pbij;
+} BoardImageTask;
+
+static void
+WriteBoardImageMT(BoardImageTask * pbit)
+{
+    WriteBoardImage(pbit->pbij);
+}
+#endif
+
+/* Write the pictures in pht (names to boardimages) that szDir does not
+ * have yet. The board images are rendered once, and the pictures are
+ * drawn and compressed on the thread pool. */
+extern void
+WriteBoardImages(const char *szDir, GHashTable * pht)
+{
+    renderdata rd;
+    renderimages ri;
+    GHashTableIter iter;
+    gpointer pKey, pValue;
+    boardimagejob *abij = g_new(boardimagejob, g_hash_table_size(pht));
+    unsigned int i, c = 0;
+
+    g_hash_table_iter_init(&iter, pht);
+    while (g_hash_table_iter_next(&iter, &pKey, &pValue)) {
+        char *szName = g_strconcat((const char *) pKey, ".png", NULL);
+        char *szFile = g_build_filename(szDir, szName, NULL);
+
+        g_free(szName);
+
+        if (g_file_test(szFile, G_FILE_TEST_EXISTS)) {
+            g_free(szFile);
+            continue;
+        }
+
+        abij[c].pri = &ri;
+        abij[c].prd = &rd;
+        abij[c].pbi = pValue;
+        abij[c].szFile = szFile;
+        abij[c++].n = 0;
+    }
+
+    if (c && g_mkdir_with_parents(szDir, 0777)) {
+        outputerr(szDir);
+        c = 0;
+    }
+
+    if (c) {
+        BoardImageAppearance(&rd);
+        RenderImages(&rd, &ri);
+
+#if defined(USE_MULTITHREAD)
+        if (MT_Idle()) {
+            for (i = 0; i < c; ++i) {
+                BoardImageTask *pbit = (BoardImageTask *) malloc(sizeof(BoardImageTask));
+
+                pbit->task.fun = (AsyncFun) WriteBoardImageMT;
+                pbit->task.data = pbit;
+                pbit->task.pLinkedTask = NULL;
+                pbit->pbij = &abij[i];
+
+                MT_AddTask((Task *) pbit, TRUE);
+            }
+
+            (void) MT_WaitForTasks(NULL, 0, FALSE);
+        } else
+#endif
+            for (i = 0; i < c; ++i)
+                WriteBoardImage(&abij[i]);
+
+        FreeImages(&ri);
+    }
+
+    for (i = 0; i < c; ++i) {
+        if (abij[i].n)
+            outputf(_("Error creating image file %s\n"), abij[i].szFile);
+        g_free(abij[i].szFile);
+    }
+    g_free(abij);
+}
+
 extern void
 CommandExportPositionPNG(char *sz)
 {
@@ -708,6 +882,14 @@ CommandExportPositionPNG(char *sz)
 }
 
 
+#else                           /* HAVE_LIBPNG */
+
+extern void
+WriteBoardImages(const char *UNUSED(szDir), GHashTable * UNUSED(pht))
+{
+    outputl(_("This installation of GNU Backgammon was compiled without\n" "support for writing HTML images."));
+}
+
 #endif                          /* HAVE_LIBPNG */
 
 
@@ -33,6 +33,7 @@ typedef enum {
     HTML_EXPORT_TYPE_GNU,
     HTML_EXPORT_TYPE_BBS,
     HTML_EXPORT_TYPE_FIBS2HTML,
+    HTML_EXPORT_TYPE_BOARDS,
     NUM_HTML_EXPORT_TYPES
 } htmlexporttype;
 
@@ -94,6 +95,19 @@ extern char *filename_from_iGame(const char *szBase, const int iGame);
 extern int WritePNG(const char *sz, unsigned char *puch,
                     unsigned int nStride, unsigned int nSizeX, unsigned int nSizeY);
 
+/* A board picture of the "boards" HTML export type. Pictures are named
+ * after a hash of this and of the appearance, so identical boards share
+ * one file, also across exports to the same directory. */
+typedef struct {
+    TanBoard anBoard;
+    unsigned int anDice[2];
+    int fMove, fTurn, fCube, nCube, fDoubled, fCubeOwner;
+} boardimage;
+
+extern char *BoardImageKey(void);
+extern char *BoardImageName(const char *szKey, const boardimage * pbi);
+extern void WriteBoardImages(const char *szDir, GHashTable * pht);
+
 #if defined(USE_BOARD3D)
 void GenerateImage3d(const char *szName, unsigned int nSize, unsigned int nSizeX, unsigned int nSizeY);
 #endif
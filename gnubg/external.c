@@ -25,6 +25,7 @@
 #define DEBUG_PREFIX "DBG: "
 
 #include <stdlib.h>
+#include <stddef.h>
 #include <signal.h>
 #include <glib.h>
 #include <glib/gstdio.h>
@@ -47,6 +48,8 @@
 #include <arpa/inet.h>
 #include <netdb.h>
 #include <sys/un.h>
+#include <fcntl.h>
+#include <poll.h>
 #endif                          /* #if HAVE_SYS_SOCKET_H */
 
 #else                           /* #ifndef WIN32 */
@@ -121,6 +124,10 @@
 #include "eval.h"
 #include "matchid.h"
 #include "lib/gnubg-types.h"
+#include "multithread.h"
+
+int fExternalConcurrent = FALSE;
+int nExternalBatchWindow = 0;
 
 #if HAVE_SOCKETS
 
@@ -565,6 +572,915 @@ ExtFIBSBoard(scancontext * pec)
 
     return szResponse;
 }
+
+static char *
+ExtSet(scancontext * pScanCtx)
+{
+    char *szResponse;
+    gchar *szOptStr = g_value_get_gstring_gchar(g_list_nth_data(pScanCtx->pCmdData, 0));
+
+    if (g_ascii_strcasecmp(szOptStr, KEY_STR_DEBUG) == 0) {
+        pScanCtx->fDebug = g_value_get_int(g_list_nth_data(pScanCtx->pCmdData, 1));
+        szResponse = g_strdup_printf("Debug output %s\n", pScanCtx->fDebug ? "ON" : "OFF");
+    } else if (g_ascii_strcasecmp(szOptStr, KEY_STR_NEWINTERFACE) == 0) {
+        pScanCtx->fNewInterface = g_value_get_int(g_list_nth_data(pScanCtx->pCmdData, 1));
+        szResponse = g_strdup_printf("New interface %s\n", pScanCtx->fNewInterface ? "ON" : "OFF");
+    } else {
+        szResponse = g_strdup_printf("Error: set option '%s' not supported\n", szOptStr);
+    }
+    g_list_gv_boxed_free(pScanCtx->pCmdData);
+
+    return szResponse;
+}
+
+/* Debug output for a board or evaluation command. Must be called before
+ * the command data is freed. */
+static void
+ExtDebugBoard(scancontext * pScanCtx, GString * dbgStr)
+{
+    GValue *optionsmapgv;
+    GValue *boarddatagv;
+    ProcessedFIBSBoard processedBoard;
+    int anScore[2];
+    int fcrawford, fjacoby;
+    char *asz[7] = { NULL, NULL, NULL, NULL, NULL, NULL, NULL };
+    char szBoard[10000];
+    char **aszLines, **aszLinesOrig;
+    char *szMatchID;
+
+    optionsmapgv = (GValue *) g_list_nth_data(g_value_get_boxed(pScanCtx->pCmdData), 1);
+    boarddatagv = (GValue *) g_list_nth_data(g_value_get_boxed(pScanCtx->pCmdData), 0);
+    g_string_append(dbgStr, DEBUG_PREFIX);
+    g_value_tostring(dbgStr, optionsmapgv, 0);
+    g_string_append(dbgStr, "\n" DEBUG_PREFIX);
+    g_value_tostring(dbgStr, boarddatagv, 0);
+    g_string_append(dbgStr, "\n" DEBUG_PREFIX "\n");
+    ProcessFIBSBoardInfo(&pScanCtx->bi, &processedBoard);
+
+    anScore[0] = processedBoard.nScoreOpp;
+    anScore[1] = processedBoard.nScore;
+    /* If the session isn't using Crawford rule, set Crawford flag to false */
+    fcrawford = pScanCtx->fCrawfordRule ? processedBoard.fCrawford : FALSE;
+    /* Set the Jacoby flag appropriately from the external interface settings */
+    fjacoby = pScanCtx->fJacobyRule;
+
+    szMatchID = MatchID((unsigned int *) processedBoard.anDice, 1, processedBoard.nResignation,
+                        processedBoard.fDoubled, 1, processedBoard.fCubeOwner, fcrawford,
+                        processedBoard.nMatchTo, anScore, processedBoard.nCube, fjacoby, GAME_PLAYING);
+
+    DrawBoard(szBoard, (ConstTanBoard) & processedBoard.anBoard, 1, asz, szMatchID, 15);
+
+    aszLines = g_strsplit(&szBoard[0], "\n", 32);
+    aszLinesOrig = aszLines;
+    while (*aszLines) {
+        g_string_append(dbgStr, DEBUG_PREFIX);
+        g_string_append(dbgStr, *aszLines);
+        g_string_append(dbgStr, "\n");
+        aszLines++;
+    }
+
+    g_string_append_printf(dbgStr, DEBUG_PREFIX "X is %s, O is %s\n", processedBoard.szPlayer, processedBoard.szOpp);
+    if (processedBoard.nMatchTo) {
+        g_string_append_printf(dbgStr, DEBUG_PREFIX "Match Play %s Crawford Rule\n",
+                               pScanCtx->fCrawfordRule ? "with" : "without");
+        g_string_append_printf(dbgStr, DEBUG_PREFIX "Score: %d-%d/%d%s, ", processedBoard.nScore,
+                               processedBoard.nScoreOpp, processedBoard.nMatchTo, fcrawford ? "*" : "");
+    } else {
+        g_string_append_printf(dbgStr, DEBUG_PREFIX "Money Session %s Jacoby Rule, %s Beavers\n",
+                               pScanCtx->fJacobyRule ? "with" : "without", pScanCtx->fBeavers ? "with" : "without");
+        g_string_append_printf(dbgStr, DEBUG_PREFIX "Score: %d-%d, ", processedBoard.nScore,
+                               processedBoard.nScoreOpp);
+    }
+    g_string_append_printf(dbgStr, "Roll: %d%d\n", processedBoard.anDice[0], processedBoard.anDice[1]);
+    g_string_append_printf(dbgStr,
+                           DEBUG_PREFIX
+                           "CubeOwner: %d, Cube: %d, Turn: %c, Doubled: %d, Resignation: %d\n",
+                           processedBoard.fCubeOwner, processedBoard.nCube, 'X',
+                           processedBoard.fDoubled, processedBoard.nResignation);
+    g_string_append(dbgStr, DEBUG_PREFIX "\n");
+
+    g_strfreev(aszLinesOrig);
+}
+
+/*
+ * Requests, batching and coalescing.
+ *
+ * Board and evaluation requests are copied into an ExtRequest and
+ * evaluated in groups by ExtDispatch(): the requests of a "batch" command,
+ * or everything the concurrent server received within its batching window.
+ * Identical requests in a group are evaluated only once, and the rest are
+ * split into a few tasks per thread, so the cost of the thread pool is paid
+ * per group rather than per request.
+ */
+
+#define EXT_MAX_BATCH 4096
+
+typedef struct {
+    scancontext sc;             /* private copy of the parsed request */
+    int fEvaluate;              /* board or evaluation request */
+    char *szDebug;              /* debug output sent ahead of the answer */
+    char *szResponse;
+    int fDone;
+    gint64 tQueued;
+    gint64 tDone;
+    GPtrArray *apreqSame;       /* identical requests answered with this one */
+} ExtRequest;
+
+/* the part of the scan context that determines the answer */
+#define EXT_KEY_START offsetof(scancontext, nPlies)
+#define EXT_KEY_END offsetof(scancontext, bi.gsName)
+
+#ifndef WIN32
+/* written to by the workers when a request completes */
+static int afdWake[2] = { -1, -1 };
+#endif
+
+static ExtRequest *
+ExtRequestNew(void)
+{
+    ExtRequest *preq = g_new0(ExtRequest, 1);
+
+    preq->tQueued = g_get_monotonic_time();
+
+    return preq;
+}
+
+/* The request takes over a parsed board or evaluation command */
+static void
+ExtRequestSet(ExtRequest * preq, scancontext * pScanCtx)
+{
+    preq->fEvaluate = TRUE;
+
+    if (pScanCtx->fDebug) {
+        GString *dbgStr = g_string_new(NULL);
+
+        ExtDebugBoard(pScanCtx, dbgStr);
+        preq->szDebug = g_string_free(dbgStr, FALSE);
+    }
+    g_value_unsetfree(pScanCtx->pCmdData);
+    pScanCtx->pCmdData = NULL;
+
+    memcpy(&preq->sc, pScanCtx, sizeof(scancontext));
+    preq->sc.scanner = NULL;
+    pScanCtx->bi.gsName = NULL;
+    pScanCtx->bi.gsOpp = NULL;
+}
+
+static void
+ExtRequestDone(ExtRequest * preq, const char *szResponse)
+{
+    preq->szResponse = g_strdup(szResponse);
+    preq->tDone = g_get_monotonic_time();
+    unset_scan_context(&preq->sc, FALSE);
+
+    MT_SafeSet(&preq->fDone, TRUE);
+}
+
+static void
+ExtRequestRun(ExtRequest * preq)
+{
+    char *sz = preq->sc.ct == COMMAND_EVALUATION ? ExtEvaluation(&preq->sc) : ExtFIBSBoard(&preq->sc);
+    guint i;
+
+    /* every request gets an answer, or pipelined replies get out of step */
+    if (!sz)
+        sz = g_strdup("Error: evaluation failed\n");
+
+    /* the copies first, as preq may be freed as soon as it is done */
+    if (preq->apreqSame) {
+        for (i = 0; i < preq->apreqSame->len; i++)
+            ExtRequestDone(g_ptr_array_index(preq->apreqSame, i), sz);
+        g_ptr_array_free(preq->apreqSame, TRUE);
+        preq->apreqSame = NULL;
+    }
+    ExtRequestDone(preq, sz);
+    g_free(sz);
+
+#ifndef WIN32
+    if (afdWake[1] >= 0 && write(afdWake[1], "", 1) < 0) {
+        /* pipe full: the server will wake up anyway */
+    }
+#endif
+}
+
+static void
+ExtRequestFree(ExtRequest * preq)
+{
+    unset_scan_context(&preq->sc, FALSE);
+    g_free(preq->szDebug);
+    g_free(preq->szResponse);
+    g_free(preq);
+}
+
+static guint
+ExtRequestHash(gconstpointer p)
+{
+    const unsigned char *pch = (const unsigned char *) &((const ExtRequest *) p)->sc;
+    guint h = 2166136261u;
+    size_t i;
+
+    for (i = EXT_KEY_START; i < EXT_KEY_END; i++)
+        h = (h ^ pch[i]) * 16777619u;
+
+    return h;
+}
+
+static int
+ExtSameName(const GString * gs0, const GString * gs1)
+{
+    return gs0 && gs1 ? g_string_equal(gs0, gs1) : gs0 == gs1;
+}
+
+static gboolean
+ExtRequestEqual(gconstpointer p0, gconstpointer p1)
+{
+    const scancontext *psc0 = &((const ExtRequest *) p0)->sc;
+    const scancontext *psc1 = &((const ExtRequest *) p1)->sc;
+
+    return psc0->ct == psc1->ct
+        && !memcmp((const char *) psc0 + EXT_KEY_START, (const char *) psc1 + EXT_KEY_START,
+                   EXT_KEY_END - EXT_KEY_START)
+        && ExtSameName(psc0->bi.gsName, psc1->bi.gsName) && ExtSameName(psc0->bi.gsOpp, psc1->bi.gsOpp);
+}
+
+static void
+ExtRunRequests(GPtrArray * apreq)
+{
+    guint i;
+
+    for (i = 0; i < apreq->len; i++)
+        ExtRequestRun(g_ptr_array_index(apreq, i));
+
+    g_ptr_array_free(apreq, TRUE);
+}
+
+/* Evaluate a group of requests. Returns the number of tasks added to the
+ * thread pool, or 0 if the requests were evaluated before returning. */
+static unsigned int
+ExtDispatch(GPtrArray * apreq)
+{
+    GHashTable *phRequests = g_hash_table_new(ExtRequestHash, ExtRequestEqual);
+    GPtrArray *apreqRun = g_ptr_array_sized_new(apreq->len);
+    guint i;
+
+    for (i = 0; i < apreq->len; i++) {
+        ExtRequest *preq = g_ptr_array_index(apreq, i);
+        ExtRequest *preqSame = g_hash_table_lookup(phRequests, preq);
+
+        if (preqSame) {
+            if (!preqSame->apreqSame)
+                preqSame->apreqSame = g_ptr_array_new();
+            g_ptr_array_add(preqSame->apreqSame, preq);
+        } else {
+            g_hash_table_insert(phRequests, preq, preq);
+            g_ptr_array_add(apreqRun, preq);
+        }
+    }
+
+    g_hash_table_destroy(phRequests);
+
+#if defined(USE_MULTITHREAD)
+    /* rollouts use the thread pool themselves */
+    if (apreqRun->len && GetEvalCube()->et != EVAL_ROLLOUT) {
+        unsigned int cTasks = 0;
+        guint cChunk = (apreqRun->len + 4 * MT_GetNumThreads() - 1) / (4 * MT_GetNumThreads());
+
+        for (i = 0; i < apreqRun->len; i += cChunk) {
+            Task *pt = (Task *) g_malloc(sizeof(Task));
+            GPtrArray *apreqChunk = g_ptr_array_sized_new(cChunk);
+            guint j;
+
+            for (j = i; j < apreqRun->len && j < i + cChunk; j++)
+                g_ptr_array_add(apreqChunk, g_ptr_array_index(apreqRun, j));
+
+            pt->fun = (AsyncFun) ExtRunRequests;
+            pt->data = apreqChunk;
+            pt->pLinkedTask = NULL;
+            MT_AddTask(pt, TRUE);
+            cTasks++;
+        }
+
+        g_ptr_array_free(apreqRun, TRUE);
+        return cTasks;
+    }
+#endif
+
+    ExtRunRequests(apreqRun);
+    return 0;
+}
+
+/* Parse one line of a batch into preq. Returns TRUE if the request is to
+ * be evaluated, FALSE if it has been answered already. */
+static int
+ExtParseBatchRequest(ExtRequest * preq, scancontext * pScanCtx, const char *szCommand)
+{
+    int fEvaluate = FALSE;
+
+    if (ExtParse(pScanCtx, szCommand) == 0) {
+        /* parse error */
+        preq->szResponse = pScanCtx->szError;
+        pScanCtx->szError = NULL;
+    } else if (pScanCtx->ct == COMMAND_FIBSBOARD || pScanCtx->ct == COMMAND_EVALUATION) {
+        ExtRequestSet(preq, pScanCtx);
+        fEvaluate = TRUE;
+    } else {
+        if (pScanCtx->ct == COMMAND_SET)
+            g_list_gv_boxed_free(pScanCtx->pCmdData);
+        preq->szResponse = g_strdup("Error: only board and evaluation commands are allowed in a batch\n");
+    }
+
+    unset_scan_context(pScanCtx, FALSE);
+
+    if (!fEvaluate) {
+        preq->tDone = preq->tQueued;
+        preq->fDone = TRUE;
+    }
+
+    return fEvaluate;
+}
+
+/* Read the n requests following a "batch" command and answer them
+ * as one block */
+static int
+ExtBatch(int hPeer, scancontext * pScanCtx, int n, GString * gsOut)
+{
+    GPtrArray *apreq = g_ptr_array_new();
+    GPtrArray *apreqEval = g_ptr_array_new();
+    char szCommand[256];
+    int retval = 0;
+    guint i;
+
+    while (apreq->len < (guint) n && !(retval = ExternalRead(hPeer, szCommand, sizeof(szCommand)))) {
+        ExtRequest *preq = ExtRequestNew();
+
+        /* To keep lexer happy terminate each line with \n */
+        if (szCommand[strlen(szCommand) - 1] != '\n')
+            strcat(szCommand, "\n");
+
+        g_ptr_array_add(apreq, preq);
+        if (ExtParseBatchRequest(preq, pScanCtx, szCommand))
+            g_ptr_array_add(apreqEval, preq);
+    }
+
+    if (!retval) {
+#if defined(USE_MULTITHREAD)
+        if (ExtDispatch(apreqEval))
+            MT_WaitForTasks(NULL, UI_UPDATETIME, FALSE);
+#else
+        ExtDispatch(apreqEval);
+#endif
+
+        for (i = 0; i < apreq->len; i++) {
+            ExtRequest *preq = g_ptr_array_index(apreq, i);
+
+            if (preq->szDebug)
+                g_string_append(gsOut, preq->szDebug);
+            g_string_append(gsOut, preq->szResponse);
+        }
+    }
+
+    for (i = 0; i < apreq->len; i++)
+        ExtRequestFree(g_ptr_array_index(apreq, i));
+    g_ptr_array_free(apreq, TRUE);
+    g_ptr_array_free(apreqEval, TRUE);
+
+    return retval;
+}
+
+static char *
+ExtBatchSizeError(void)
+{
+    return g_strdup_printf("Error: batch size must be between 1 and %d\n", EXT_MAX_BATCH);
+}
+
+/*
+ * Concurrent server ("set external concurrent on").
+ *
+ * One thread multiplexes the listening socket and every client with
+ * poll(). Each client has its own parser state and a queue of requests;
+ * board and evaluation requests from all clients are collected for
+ * "set external batchwindow" milliseconds, evaluated as one group on the
+ * thread pool, and the answers are written back in the order the requests
+ * arrived, so a client may pipeline requests without waiting for each
+ * answer.
+ */
+
+#define EXT_MAX_LINE 65536
+
+typedef struct {
+    int h;
+    scancontext scanctx;
+    GString *gsIn;
+    GString *gsOut;
+    GQueue qRequests;           /* ExtRequest *, in arrival order */
+    int nBatch;                 /* requests of the current batch still to come */
+    int fExit;                  /* the client sent "exit" */
+    int fClosing;               /* stop reading: exit, EOF or error */
+    int fError;                 /* socket unusable */
+    char szPeer[INET_ADDRSTRLEN];
+    unsigned int cRequests;
+    gint64 tLatency;
+    gint64 tLatencyMax;
+} ExtConnection;
+
+typedef struct {
+    GPtrArray *apreqPending;    /* requests waiting for the batching window */
+    gint64 tPending;            /* arrival of the oldest of them */
+    unsigned int cRequests;
+    unsigned int cGroups;
+    gint64 tLatency;
+    gint64 tLatencyMax;
+    gint64 tStart;
+} ExtServer;
+
+#ifdef WIN32
+#define poll WSAPoll
+#endif
+
+static int
+ExtWouldBlock(void)
+{
+#ifdef WIN32
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+}
+
+static int
+ExtSetNonBlocking(int h)
+{
+#ifdef WIN32
+    u_long f = 1;
+
+    return ioctlsocket((SOCKET) h, FIONBIO, &f);
+#else
+    int f = fcntl(h, F_GETFL, 0);
+
+    return f < 0 ? -1 : fcntl(h, F_SETFL, f | O_NONBLOCK);
+#endif
+}
+
+static ExtRequest *
+ExtQueueRequest(ExtConnection * pc)
+{
+    ExtRequest *preq = ExtRequestNew();
+
+    g_queue_push_tail(&pc->qRequests, preq);
+
+    return preq;
+}
+
+/* Queue an answer that needs no evaluation; it still waits its turn */
+static void
+ExtQueueResponse(ExtConnection * pc, char *szResponse)
+{
+    ExtRequest *preq = ExtQueueRequest(pc);
+
+    preq->szResponse = szResponse;
+    preq->tDone = preq->tQueued;
+    preq->fDone = TRUE;
+}
+
+static void
+ExtServerPend(ExtServer * ps, ExtRequest * preq)
+{
+    if (!ps->apreqPending->len)
+        ps->tPending = preq->tQueued;
+    g_ptr_array_add(ps->apreqPending, preq);
+}
+
+static void
+ExtServerFlush(ExtServer * ps)
+{
+    if (!ps->apreqPending->len)
+        return;
+
+    ExtDispatch(ps->apreqPending);
+    g_ptr_array_set_size(ps->apreqPending, 0);
+    ps->cGroups++;
+}
+
+static void
+ExtServerCommand(ExtServer * ps, ExtConnection * pc, char *szCommand)
+{
+    ExtRequest *preq;
+
+    if (pc->nBatch > 0) {
+        pc->nBatch--;
+        preq = ExtQueueRequest(pc);
+        if (ExtParseBatchRequest(preq, &pc->scanctx, szCommand))
+            ExtServerPend(ps, preq);
+        return;
+    }
+
+    if (ExtParse(&pc->scanctx, szCommand) == 0) {
+        /* parse error */
+        ExtQueueResponse(pc, pc->scanctx.szError);
+        pc->scanctx.szError = NULL;
+        unset_scan_context(&pc->scanctx, FALSE);
+        return;
+    }
+
+    switch (pc->scanctx.ct) {
+    case COMMAND_HELP:
+        ExtQueueResponse(pc, g_strdup("\tNo help information available\n"));
+        break;
+
+    case COMMAND_SET:
+        ExtQueueResponse(pc, ExtSet(&pc->scanctx));
+        break;
+
+    case COMMAND_VERSION:
+        ExtQueueResponse(pc, g_strdup("Interface: " EXTERNAL_INTERFACE_VERSION "\n"
+                                      "RFBF: " RFBF_VERSION_SUPPORTED "\n"
+                                      "Engine: " WEIGHTS_VERSION "\n" "Software: " VERSION "\n"));
+        break;
+
+    case COMMAND_NONE:
+        ExtQueueResponse(pc, g_strdup("Error: no command given\n"));
+        break;
+
+    case COMMAND_BATCH:
+        if (pc->scanctx.nBatch < 1 || pc->scanctx.nBatch > EXT_MAX_BATCH)
+            ExtQueueResponse(pc, ExtBatchSizeError());
+        else
+            pc->nBatch = pc->scanctx.nBatch;
+        break;
+
+    case COMMAND_FIBSBOARD:
+    case COMMAND_EVALUATION:
+        preq = ExtQueueRequest(pc);
+        ExtRequestSet(preq, &pc->scanctx);
+        ExtServerPend(ps, preq);
+        break;
+
+    case COMMAND_EXIT:
+        pc->fExit = pc->fClosing = TRUE;
+        break;
+
+    default:
+        ExtQueueResponse(pc, g_strdup("Unsupported Command\n"));
+    }
+
+    unset_scan_context(&pc->scanctx, FALSE);
+}
+
+static void
+ExtServerRead(ExtServer * ps, ExtConnection * pc)
+{
+    char ach[4096];
+    char *pch;
+    int n;
+
+    for (;;) {
+#ifdef WIN32
+        n = recv((SOCKET) pc->h, ach, sizeof(ach), 0);
+#else
+        n = (int) read(pc->h, ach, sizeof(ach));
+#endif
+        if (n == 0) {
+            pc->fClosing = TRUE;
+            break;
+        } else if (n < 0) {
+            if (!ExtWouldBlock())
+                pc->fClosing = pc->fError = TRUE;
+            break;
+        }
+        g_string_append_len(pc->gsIn, ach, n);
+    }
+
+    /* complete lines only; the lexer wants the trailing \n */
+    while (!pc->fError && (pch = memchr(pc->gsIn->str, '\n', pc->gsIn->len))) {
+        size_t cch = (size_t) (pch - pc->gsIn->str) + 1;
+        char *szCommand = g_strndup(pc->gsIn->str, cch);
+
+        g_string_erase(pc->gsIn, 0, (gssize) cch);
+        ExtServerCommand(ps, pc, szCommand);
+        g_free(szCommand);
+
+        if (pc->fExit)
+            break;
+    }
+
+    if (pc->gsIn->len > EXT_MAX_LINE) {
+        ExtQueueResponse(pc, g_strdup("Error: line too long\n"));
+        pc->fClosing = TRUE;
+    }
+}
+
+/* Move finished requests, in order, to the output buffer */
+static void
+ExtServerCollect(ExtServer * ps, ExtConnection * pc)
+{
+    ExtRequest *preq;
+
+    while ((preq = g_queue_peek_head(&pc->qRequests)) && MT_SafeGet(&preq->fDone)) {
+        g_queue_pop_head(&pc->qRequests);
+
+        if (preq->szDebug)
+            g_string_append(pc->gsOut, preq->szDebug);
+        if (preq->szResponse)
+            g_string_append(pc->gsOut, preq->szResponse);
+
+        if (preq->fEvaluate) {
+            gint64 t = preq->tDone - preq->tQueued;
+
+            pc->cRequests++;
+            pc->tLatency += t;
+            pc->tLatencyMax = MAX(pc->tLatencyMax, t);
+            ps->cRequests++;
+            ps->tLatency += t;
+            ps->tLatencyMax = MAX(ps->tLatencyMax, t);
+        }
+
+        ExtRequestFree(preq);
+    }
+}
+
+static void
+ExtServerWrite(ExtConnection * pc)
+{
+    int n;
+
+    while (pc->gsOut->len && !pc->fError) {
+#ifdef WIN32
+        n = send((SOCKET) pc->h, pc->gsOut->str, (int) pc->gsOut->len, 0);
+#else
+        n = (int) write(pc->h, pc->gsOut->str, pc->gsOut->len);
+#endif
+        if (n < 0) {
+            if (!ExtWouldBlock())
+                pc->fClosing = pc->fError = TRUE;
+            break;
+        }
+        g_string_erase(pc->gsOut, 0, n);
+    }
+}
+
+static void
+ExtLatencyReport(const char *sz, unsigned int cRequests, gint64 tLatency, gint64 tLatencyMax)
+{
+    if (cRequests)
+        outputf(_("%s: %u evaluations, latency mean %.2f ms, max %.2f ms\n"), sz, cRequests,
+                tLatency / 1000.0 / cRequests, tLatencyMax / 1000.0);
+    else
+        outputf(_("%s: no evaluations\n"), sz);
+    outputx();
+}
+
+static ExtConnection *
+ExtServerAccept(int h)
+{
+    ExtConnection *pc;
+    struct sockaddr_in saRemote;
+    socklen_t saLen = sizeof(saRemote);
+    int hPeer;
+
+    memset(&saRemote, 0, sizeof(saRemote));
+    if ((hPeer = accept(h, (struct sockaddr *) &saRemote, &saLen)) < 0) {
+        if (!ExtWouldBlock())
+            SockErr("accept");
+        return NULL;
+    }
+
+    if (ExtSetNonBlocking(hPeer) < 0) {
+        SockErr("accept");
+        closesocket(hPeer);
+        return NULL;
+    }
+
+    pc = g_new0(ExtConnection, 1);
+    pc->h = hPeer;
+    pc->gsIn = g_string_new(NULL);
+    pc->gsOut = g_string_new(NULL);
+    g_queue_init(&pc->qRequests);
+    ExtInitParse(&pc->scanctx.scanner);
+    /* unix domain sockets have no address to show */
+    g_strlcpy(pc->szPeer, saRemote.sin_family == AF_INET ? inet_ntoa(saRemote.sin_addr) : "local",
+              sizeof(pc->szPeer));
+
+    outputf(_("Accepted connection from %s.\n"), pc->szPeer);
+    outputx();
+
+    return pc;
+}
+
+/* Free a connection once nothing of it is left to evaluate.
+ * Returns FALSE if requests are still pending. */
+static int
+ExtServerClose(ExtConnection * pc)
+{
+    ExtRequest *preq;
+    GList *pl;
+
+    if (pc->h >= 0) {
+        closesocket(pc->h);
+        pc->h = -1;
+        ExtLatencyReport(pc->szPeer, pc->cRequests, pc->tLatency, pc->tLatencyMax);
+    }
+
+    for (pl = pc->qRequests.head; pl; pl = pl->next) {
+        preq = pl->data;
+        if (!MT_SafeGet(&preq->fDone))
+            return FALSE;
+    }
+
+    while ((preq = g_queue_pop_head(&pc->qRequests)))
+        ExtRequestFree(preq);
+
+    unset_scan_context(&pc->scanctx, TRUE);
+    g_string_free(pc->gsIn, TRUE);
+    g_string_free(pc->gsOut, TRUE);
+    g_free(pc);
+
+    return TRUE;
+}
+
+/* Milliseconds to wait before the pending group must be evaluated */
+static int
+ExtServerTimeout(ExtServer * ps, GList * plConnections)
+{
+    gint64 tWait, tWindow = nExternalBatchWindow * 1000;
+    GList *pl;
+
+    if (!ps->apreqPending->len)
+        return UI_UPDATETIME;
+
+    /* hold the group back a little while a client is half-way through a batch */
+    for (pl = plConnections; pl; pl = pl->next)
+        if (((ExtConnection *) pl->data)->nBatch > 0) {
+            tWindow += UI_UPDATETIME * 1000;
+            break;
+        }
+
+    tWait = g_get_monotonic_time() - ps->tPending;
+
+    return tWait >= tWindow ? 0 : (int) MIN((tWindow - tWait + 999) / 1000, UI_UPDATETIME);
+}
+
+static void
+ExternalServer(char *sz)
+{
+    int h;
+    socklen_t cb;
+    struct sockaddr *psa;
+    GList *plConnections = NULL, *pl, *plNext;
+    GArray *aPoll;
+    ExtServer es;
+    double rElapsed;
+#ifndef WIN32
+    psighandler sh;
+#endif
+
+    if ((h = ExternalSocket(&psa, &cb, sz)) < 0) {
+        SockErr(sz);
+        return;
+    }
+
+    if (bind(h, psa, cb) < 0) {
+        SockErr(sz);
+        closesocket(h);
+        g_free(psa);
+        return;
+    }
+
+    g_free(psa);
+
+    if (listen(h, SOMAXCONN) < 0 || ExtSetNonBlocking(h) < 0) {
+        SockErr("listen");
+        closesocket(h);
+        return;
+    }
+#ifndef WIN32
+    if (pipe(afdWake) < 0) {
+        SockErr("pipe");
+        closesocket(h);
+        return;
+    }
+    ExtSetNonBlocking(afdWake[0]);
+    ExtSetNonBlocking(afdWake[1]);
+
+    PortableSignal(SIGPIPE, SIG_IGN, &sh, FALSE);
+#endif
+
+    memset(&es, 0, sizeof(es));
+    es.apreqPending = g_ptr_array_new();
+    es.tStart = g_get_monotonic_time();
+    aPoll = g_array_new(FALSE, TRUE, sizeof(struct pollfd));
+
+    outputf(_("Waiting for connections from %s...\n"), sz);
+    outputx();
+    ProcessEvents();
+
+    while (!fInterrupt) {
+        struct pollfd pfd;
+        guint i, cFixed;
+        int nTimeout;
+
+        g_array_set_size(aPoll, 0);
+
+        pfd.fd = h;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        g_array_append_val(aPoll, pfd);
+#ifndef WIN32
+        pfd.fd = afdWake[0];
+        g_array_append_val(aPoll, pfd);
+#endif
+        cFixed = aPoll->len;
+
+        for (pl = plConnections; pl; pl = pl->next) {
+            ExtConnection *pc = pl->data;
+
+            pfd.fd = pc->h;
+            pfd.events = (short) ((pc->fClosing ? 0 : POLLIN) | (pc->gsOut->len ? POLLOUT : 0));
+            g_array_append_val(aPoll, pfd);
+        }
+
+        nTimeout = ExtServerTimeout(&es, plConnections);
+#ifdef WIN32
+        /* without a wake-up pipe poll often to notice finished requests */
+        nTimeout = MIN(nTimeout, 1);
+#endif
+
+        if (poll((struct pollfd *) (void *) aPoll->data, aPoll->len, nTimeout) < 0 && !ExtWouldBlock()) {
+            SockErr("poll");
+            break;
+        }
+
+        ProcessEvents();
+
+#ifndef WIN32
+        if (g_array_index(aPoll, struct pollfd, 1).revents & POLLIN) {
+            char ach[256];
+
+            while (read(afdWake[0], ach, sizeof(ach)) > 0);
+        }
+#endif
+
+        for (pl = plConnections, i = cFixed; pl; pl = pl->next, i++) {
+            ExtConnection *pc = pl->data;
+
+            if (!pc->fClosing && (g_array_index(aPoll, struct pollfd, i).revents & (POLLIN | POLLHUP | POLLERR)))
+                ExtServerRead(&es, pc);
+        }
+
+        if (!ExtServerTimeout(&es, plConnections))
+            ExtServerFlush(&es);
+
+        for (pl = plConnections; pl; pl = plNext) {
+            ExtConnection *pc = pl->data;
+
+            plNext = pl->next;
+
+            ExtServerCollect(&es, pc);
+            ExtServerWrite(pc);
+
+            /* a closing client still gets the answers already queued */
+            if (pc->fClosing && (pc->fError || (!pc->gsOut->len && g_queue_is_empty(&pc->qRequests))))
+                if (ExtServerClose(pc))
+                    plConnections = g_list_delete_link(plConnections, pl);
+        }
+
+        if (g_array_index(aPoll, struct pollfd, 0).revents & POLLIN) {
+            ExtConnection *pc;
+
+            while ((pc = ExtServerAccept(h)))
+                plConnections = g_list_append(plConnections, pc);
+        }
+    }
+
+    closesocket(h);
+
+    /* requests still pending or in the pool refer to the connections */
+    ExtServerFlush(&es);
+#if defined(USE_MULTITHREAD)
+    MT_WaitForTasks(NULL, UI_UPDATETIME, FALSE);
+#endif
+
+    for (pl = plConnections; pl; pl = pl->next)
+        ExtServerClose(pl->data);
+    g_list_free(plConnections);
+    g_array_free(aPoll, TRUE);
+    g_ptr_array_free(es.apreqPending, TRUE);
+
+#ifndef WIN32
+    PortableSignalRestore(SIGPIPE, &sh);
+    close(afdWake[0]);
+    close(afdWake[1]);
+    afdWake[0] = afdWake[1] = -1;
+#endif
+
+    rElapsed = (g_get_monotonic_time() - es.tStart) / 1000000.0;
+    ExtLatencyReport(_("Server"), es.cRequests, es.tLatency, es.tLatencyMax);
+    if (es.cGroups)
+        outputf(_("%u groups of %.1f evaluations on average\n"), es.cGroups,
+                (double) es.cRequests / es.cGroups);
+    if (rElapsed > 0)
+        outputf(_("%.1f evaluations per second over %.1f s\n"), es.cRequests / rElapsed, rElapsed);
+    outputx();
+}
 #endif
 
 extern void
@@ -595,6 +1511,11 @@ CommandExternal(char *sz)
         return;
     }
 
+    if (fExternalConcurrent) {
+        ExternalServer(sz);
+        return;
+    }
+
     memset(&scanctx, 0, sizeof(scanctx));
     ExtInitParse(&scanctx.scanner);
 
@@ -668,27 +1589,13 @@ CommandExternal(char *sz)
                 /* parse error */
                 szResponse = scanctx.szError;
             } else {
-                ProcessedFIBSBoard processedBoard;
-                gchar *szOptStr;
-
                 switch (scanctx.ct) {
                 case COMMAND_HELP:
                     szResponse = g_strdup("\tNo help information available\n");
                     break;
 
                 case COMMAND_SET:
-                    szOptStr = g_value_get_gstring_gchar(g_list_nth_data(scanctx.pCmdData, 0));
-                    if (g_ascii_strcasecmp(szOptStr, KEY_STR_DEBUG) == 0) {
-                        scanctx.fDebug = g_value_get_int(g_list_nth_data(scanctx.pCmdData, 1));
-                        szResponse = g_strdup_printf("Debug output %s\n", scanctx.fDebug ? "ON" : "OFF");
-                    } else if (g_ascii_strcasecmp(szOptStr, KEY_STR_NEWINTERFACE) == 0) {
-                        scanctx.fNewInterface = g_value_get_int(g_list_nth_data(scanctx.pCmdData, 1));
-                        szResponse = g_strdup_printf("New interface %s\n", scanctx.fNewInterface ? "ON" : "OFF");
-                    } else {
-                        szResponse = g_strdup_printf("Error: set option '%s' not supported\n", szOptStr);
-                    }
-                    g_list_gv_boxed_free(scanctx.pCmdData);
-
+                    szResponse = ExtSet(&scanctx);
                     break;
 
                 case COMMAND_VERSION:
@@ -702,80 +1609,25 @@ CommandExternal(char *sz)
                     szResponse = g_strdup("Error: no command given\n");
                     break;
 
+                case COMMAND_BATCH:
+                    if (scanctx.nBatch < 1 || scanctx.nBatch > EXT_MAX_BATCH) {
+                        szResponse = ExtBatchSizeError();
+                    } else {
+                        GString *gsBatch = g_string_new(NULL);
+
+                        retval = ExtBatch(hPeer, &scanctx, scanctx.nBatch, gsBatch);
+                        szResponse = g_string_free(gsBatch, retval != 0);
+                    }
+                    break;
+
                 case COMMAND_FIBSBOARD:
                 case COMMAND_EVALUATION:
                     if (scanctx.fDebug) {
-                        GValue *optionsmapgv;
-                        GValue *boarddatagv;
-                        GString *dbgStr;
-                        int anScore[2];
-                        int fcrawford, fjacoby;
-                        char *asz[7] = { NULL, NULL, NULL, NULL, NULL, NULL, NULL };
-                        char szBoard[10000];
-                        char **aszLines, **aszLinesOrig;
-                        char *szMatchID;
-
-                        optionsmapgv = (GValue *) g_list_nth_data(g_value_get_boxed(scanctx.pCmdData), 1);
-                        boarddatagv = (GValue *) g_list_nth_data(g_value_get_boxed(scanctx.pCmdData), 0);
-                        dbgStr = g_string_new(DEBUG_PREFIX);
-                        g_value_tostring(dbgStr, optionsmapgv, 0);
-                        g_string_append(dbgStr, "\n" DEBUG_PREFIX);
-                        g_value_tostring(dbgStr, boarddatagv, 0);
-                        g_string_append(dbgStr, "\n" DEBUG_PREFIX "\n");
-                        ExternalWrite(hPeer, dbgStr->str, strlen(dbgStr->str));
-                        ProcessFIBSBoardInfo(&scanctx.bi, &processedBoard);
-
-                        anScore[0] = processedBoard.nScoreOpp;
-                        anScore[1] = processedBoard.nScore;
-                        /* If the session isn't using Crawford rule, set Crawford flag to false */
-                        fcrawford = scanctx.fCrawfordRule ? processedBoard.fCrawford : FALSE;
-                        /* Set the Jacoby flag appropriately from the external interface settings */
-                        fjacoby = scanctx.fJacobyRule;
-
-                        szMatchID = MatchID((unsigned int *) processedBoard.anDice, 1, processedBoard.nResignation,
-                                            processedBoard.fDoubled, 1, processedBoard.fCubeOwner, fcrawford,
-                                            processedBoard.nMatchTo, anScore, processedBoard.nCube, fjacoby,
-                                            GAME_PLAYING);
-
-                        DrawBoard(szBoard, (ConstTanBoard) & processedBoard.anBoard, 1, asz, szMatchID, 15);
-
-                        aszLines = g_strsplit(&szBoard[0], "\n", 32);
-                        aszLinesOrig = aszLines;
-                        while (*aszLines) {
-                            ExternalWrite(hPeer, DEBUG_PREFIX, strlen(DEBUG_PREFIX));
-                            ExternalWrite(hPeer, *aszLines, strlen(*aszLines));
-                            ExternalWrite(hPeer, "\n", 1);
-                            aszLines++;
-                        }
-
-                        dbgStr = g_string_assign(dbgStr, "");
-                        g_string_append_printf(dbgStr, DEBUG_PREFIX "X is %s, O is %s\n", processedBoard.szPlayer,
-                                               processedBoard.szOpp);
-                        if (processedBoard.nMatchTo) {
-                            g_string_append_printf(dbgStr, DEBUG_PREFIX "Match Play %s Crawford Rule\n",
-                                                   scanctx.fCrawfordRule ? "with" : "without");
-                            g_string_append_printf(dbgStr, DEBUG_PREFIX "Score: %d-%d/%d%s, ", processedBoard.nScore,
-                                                   processedBoard.nScoreOpp, processedBoard.nMatchTo,
-                                                   fcrawford ? "*" : "");
-                        } else {
-                            g_string_append_printf(dbgStr, DEBUG_PREFIX "Money Session %s Jacoby Rule, %s Beavers\n",
-                                                   scanctx.fJacobyRule ? "with" : "without",
-                                                   scanctx.fBeavers ? "with" : "without");
-                            g_string_append_printf(dbgStr, DEBUG_PREFIX "Score: %d-%d, ", processedBoard.nScore,
-                                                   processedBoard.nScoreOpp);
-                        }
-                        g_string_append_printf(dbgStr, "Roll: %d%d\n",
-                                               processedBoard.anDice[0], processedBoard.anDice[1]);
-                        g_string_append_printf(dbgStr,
-                                               DEBUG_PREFIX
-                                               "CubeOwner: %d, Cube: %d, Turn: %c, Doubled: %d, Resignation: %d\n",
-                                               processedBoard.fCubeOwner, processedBoard.nCube, 'X',
-                                               processedBoard.fDoubled, processedBoard.nResignation);
-                        g_string_append(dbgStr, DEBUG_PREFIX "\n");
-                        ExternalWrite(hPeer, dbgStr->str, strlen(dbgStr->str));
+                        GString *dbgStr = g_string_new(NULL);
 
+                        ExtDebugBoard(&scanctx, dbgStr);
+                        ExternalWrite(hPeer, dbgStr->str, dbgStr->len);
                         g_string_free(dbgStr, TRUE);
-                        g_strfreev(aszLinesOrig);
                     }
                     g_value_unsetfree(scanctx.pCmdData);
 
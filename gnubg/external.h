@@ -56,7 +56,8 @@ typedef enum {
     COMMAND_VERSION = 4,
     COMMAND_SET = 5,
     COMMAND_HELP = 6,
-    COMMAND_LIST = 7
+    COMMAND_LIST = 7,
+    COMMAND_BATCH = 8
 } cmdtype;
 
 typedef struct {
@@ -167,6 +168,7 @@ typedef struct scancontext {
     /* command type */
     cmdtype ct;
     void *pCmdData;
+    int nBatch;                 /* number of requests following "batch" */
 
     /* evalcontext */
     int nPlies;
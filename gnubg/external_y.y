@@ -128,7 +128,7 @@ void yyerror(scancontext *scanner, const char *str)
 %token EOL EXIT DISABLED INTERFACEVERSION 
 %token DEBUG SET NEW OLD OUTPUT E_INTERFACE HELP PROMPT
 %token E_STRING E_CHARACTER E_INTEGER E_FLOAT E_BOOLEAN
-%token FIBSBOARD FIBSBOARDEND EVALUATION
+%token FIBSBOARD FIBSBOARDEND EVALUATION BATCH
 %token CRAWFORDRULE JACOBYRULE RESIGNATION BEAVERS
 %token CUBE CUBEFUL CUBELESS DETERMINISTIC NOISE PLIES PRUNE
 
@@ -201,6 +201,13 @@ commands:
             YYACCEPT;
         }
     |
+    BATCH E_INTEGER EOL
+        {
+            extcmd->ct = COMMAND_BATCH;
+            extcmd->nBatch = $2;
+            YYACCEPT;
+        }
+    |
     command EOL
         {
             if ($1->cmdType == COMMAND_LIST) {
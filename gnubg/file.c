@@ -22,7 +22,9 @@
 #include "backgammon.h"
 #include <glib/gstdio.h>
 #include "file.h"
+#include "multithread.h"
 #include <stdlib.h>
+#include <string.h>
 
 ExportFormat export_format[] = {
     {EXPORT_SGF, ".sgf", N_("GNU Backgammon File"), "sgf", {TRUE, TRUE, TRUE}
@@ -496,3 +498,127 @@ GetFilename(int CheckForCurrent, ExportType type, int extens)
 
     return sz;
 }
+
+static gint
+CompareFileNames(gconstpointer p0, gconstpointer p1)
+{
+    return strcmp(*(const char *const *) p0, *(const char *const *) p1);
+}
+
+/* The regular files in szDir, sorted by name, or NULL if it cannot be
+ * read */
+extern GPtrArray *
+ListFolderFiles(const char *szDir)
+{
+    GDir *dir;
+    const gchar *szName;
+    GPtrArray *aszFiles;
+
+    if (!(dir = g_dir_open(szDir, 0, NULL)))
+        return NULL;
+
+    aszFiles = g_ptr_array_new_with_free_func(g_free);
+    while ((szName = g_dir_read_name(dir))) {
+        gchar *szPath = g_build_filename(szDir, szName, NULL);
+
+        if (g_file_test(szPath, G_FILE_TEST_IS_REGULAR))
+            g_ptr_array_add(aszFiles, szPath);
+        else
+            g_free(szPath);
+    }
+    g_dir_close(dir);
+
+    g_ptr_array_sort(aszFiles, CompareFileNames);
+
+    return aszFiles;
+}
+
+extern int
+SameFolder(const char *sz0, const char *sz1)
+{
+#ifdef WIN32
+    return !g_ascii_strcasecmp(sz0, sz1);
+#else
+    GStatBuf st0, st1;
+
+    return !g_stat(sz0, &st0) && !g_stat(sz1, &st1) && st0.st_dev == st1.st_dev && st0.st_ino == st1.st_ino;
+#endif
+}
+
+/* TRUE if szOutput exists and is not older than szInput */
+extern int
+OutputUpToDate(const char *szInput, const char *szOutput)
+{
+    GStatBuf stIn, stOut;
+
+    return !g_stat(szInput, &stIn) && !g_stat(szOutput, &stOut) && stOut.st_mtime >= stIn.st_mtime;
+}
+
+static ImportType
+FileImportType(const char *szFile)
+{
+    FilePreviewData *fdp = ReadFilePreview(szFile);
+    ImportType type = fdp ? fdp->type : N_IMPORT_TYPES;
+
+    g_free(fdp);
+
+    return type;
+}
+
+#if defined(USE_MULTITHREAD)
+/* ReadFilePreview() only reads its file, so a folder of files can be
+ * probed on the thread pool, IMPORT_TYPE_CHUNK files per task */
+#define IMPORT_TYPE_CHUNK 64
+
+typedef struct {
+    Task task;
+    GPtrArray *aszFiles;
+    ImportType *atype;
+    guint i, c;
+} ImportTypeTask;
+
+static void
+ImportTypesMT(ImportTypeTask * pitt)
+{
+    guint i;
+
+    for (i = pitt->i; i < pitt->i + pitt->c; i++)
+        pitt->atype[i] = FileImportType(g_ptr_array_index(pitt->aszFiles, i));
+}
+#endif
+
+/* The format of each file in aszFiles, N_IMPORT_TYPES for the files that
+ * are not recognised. The caller must g_free() the array. */
+extern ImportType *
+ReadImportTypes(GPtrArray * aszFiles)
+{
+    ImportType *atype = g_new(ImportType, aszFiles->len ? aszFiles->len : 1);
+    guint i;
+
+#if defined(USE_MULTITHREAD)
+    if (MT_Idle() && aszFiles->len > IMPORT_TYPE_CHUNK) {
+        for (i = 0; i < aszFiles->len; i += IMPORT_TYPE_CHUNK) {
+            ImportTypeTask *pitt = (ImportTypeTask *) malloc(sizeof(ImportTypeTask));
+
+            pitt->task.fun = (AsyncFun) ImportTypesMT;
+            pitt->task.data = pitt;
+            pitt->task.pLinkedTask = NULL;
+            pitt->aszFiles = aszFiles;
+            pitt->atype = atype;
+            pitt->i = i;
+            pitt->c = MIN(IMPORT_TYPE_CHUNK, aszFiles->len - i);
+
+            MT_AddTask((Task *) pitt, TRUE);
+        }
+
+        (void) MT_WaitForTasks(NULL, 0, FALSE);
+
+        return atype;
+    }
+#endif
+
+    for (i = 0; i < aszFiles->len; i++)
+        atype[i] = FileImportType(g_ptr_array_index(aszFiles, i));
+
+    return atype;
+}
@@ -75,5 +75,10 @@ typedef struct {
 
 extern char *GetFilename(int CheckForCurrent, ExportType type, int extens);
 extern FilePreviewData *ReadFilePreview(const char *filename);
+extern ImportType *ReadImportTypes(GPtrArray * aszFiles);
+extern GPtrArray *ListFolderFiles(const char *szDir);
+extern int SameFolder(const char *sz0, const char *sz1);
+extern int OutputUpToDate(const char *szInput, const char *szOutput);
+extern gchar *ImportCommand(ImportType type, const char *szFile);
 
 #endif
@@ -351,7 +351,9 @@ OutputRolloutContext(const char *szIndent, const rolloutcontext * prc)
     else
         sprintf(strchr(sz, 0), prc->fCubeful ? _("Full cubeful rollout") : _("Full cubeless rollout"));
 
-    if (prc->fTruncBearoffOS && !prc->fCubeful)
+    if (prc->fTruncOSR && !prc->fCubeful)
+        sprintf(strchr(sz, 0), " (%s)", _("truncated at races with one-sided rollouts"));
+    else if (prc->fTruncBearoffOS && !prc->fCubeful)
         sprintf(strchr(sz, 0), " (%s)", _("truncated at one-sided bearoff"));
     else if (prc->fTruncBearoff2 && !prc->fCubeful)
         sprintf(strchr(sz, 0), " (%s)", _("truncated at exact bearoff"));
@@ -1048,8 +1050,8 @@ static int
 DumpBearoff1(const TanBoard anBoard, char *szOutput, const bgvariation UNUSED(bgv))
 {
 
-    g_assert(pbc1);
-    return BearoffDump(pbc1, anBoard, szOutput);
+    g_assert(GetBearoff(BDB_1));
+    return BearoffDump(GetBearoff(BDB_1), anBoard, szOutput);
 
 }
 
@@ -1057,13 +1059,13 @@ static int
 DumpBearoff2(const TanBoard anBoard, char *szOutput, const bgvariation UNUSED(bgv))
 {
 
-    g_assert(pbc2);
+    g_assert(GetBearoff(BDB_2));
 
-    if (BearoffDump(pbc2, anBoard, szOutput))
+    if (BearoffDump(GetBearoff(BDB_2), anBoard, szOutput))
         return -1;
 
-    if (pbc1)
-        if (BearoffDump(pbc1, anBoard, szOutput))
+    if (GetBearoff(BDB_1))
+        if (BearoffDump(GetBearoff(BDB_1), anBoard, szOutput))
             return -1;
 
     return 0;
@@ -1075,8 +1077,8 @@ static int
 DumpBearoffOS(const TanBoard anBoard, char *szOutput, const bgvariation UNUSED(bgv))
 {
 
-    g_assert(pbcOS);
-    return BearoffDump(pbcOS, anBoard, szOutput);
+    g_assert(GetBearoff(BDB_OS));
+    return BearoffDump(GetBearoff(BDB_OS), anBoard, szOutput);
 
 }
 
@@ -1085,8 +1087,8 @@ static int
 DumpBearoffTS(const TanBoard anBoard, char *szOutput, const bgvariation UNUSED(bgv))
 {
 
-    g_assert(pbcTS);
-    return BearoffDump(pbcTS, anBoard, szOutput);
+    g_assert(GetBearoff(BDB_TS));
+    return BearoffDump(GetBearoff(BDB_TS), anBoard, szOutput);
 
 }
 
@@ -1125,8 +1127,8 @@ static int
 DumpHypergammon1(const TanBoard anBoard, char *szOutput, const bgvariation UNUSED(bgv))
 {
 
-    g_assert(apbcHyper[0]);
-    return BearoffDump(apbcHyper[0], anBoard, szOutput);
+    g_assert(GetBearoff(BDB_HYPER1));
+    return BearoffDump(GetBearoff(BDB_HYPER1), anBoard, szOutput);
 
 }
 
@@ -1134,8 +1136,8 @@ static int
 DumpHypergammon2(const TanBoard anBoard, char *szOutput, const bgvariation UNUSED(bgv))
 {
 
-    g_assert(apbcHyper[1]);
-    return BearoffDump(apbcHyper[1], anBoard, szOutput);
+    g_assert(GetBearoff(BDB_HYPER2));
+    return BearoffDump(GetBearoff(BDB_HYPER2), anBoard, szOutput);
 
 }
 
@@ -1143,8 +1145,8 @@ static int
 DumpHypergammon3(const TanBoard anBoard, char *szOutput, const bgvariation UNUSED(bgv))
 {
 
-    g_assert(apbcHyper[2]);
-    return BearoffDump(apbcHyper[2], anBoard, szOutput);
+    g_assert(GetBearoff(BDB_HYPER3));
+    return BearoffDump(GetBearoff(BDB_HYPER3), anBoard, szOutput);
 
 }
 
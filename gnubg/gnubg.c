@@ -87,6 +87,7 @@ static char szCommandSeparators[] = " \t\n\r\v\f";
 #include "sound.h"
 #include "progress.h"
 #include "osr.h"
+#include "openingbook.h"
 #include "format.h"
 #include "relational.h"
 #include "credits.h"
@@ -190,6 +191,7 @@ matchinfo mi;
 float rRatingOffset = 2050;
 int fAnalyseCube = TRUE;
 int fAnalyseDice = TRUE;
+int fAnalyseIncremental = FALSE;
 int fAnalyseMove = TRUE;
 int fAutoBearoff = FALSE;
 int fAutoCrawford = 1;
@@ -222,6 +224,7 @@ int fGotoFirstGame = TRUE;
 int fInvertMET = FALSE;
 int fJacoby = TRUE;
 int fOutputRawboard = FALSE;
+int fOSRPersist = FALSE;
 int fPlayersAreSame = TRUE;
 int fRecord = TRUE;
 int fShowProgress;
@@ -368,10 +371,11 @@ rolloutcontext rcRollout = {
     FALSE,                      /* no stop on STD */
     FALSE,                      /* no stop on JSD */
     FALSE,                      /* no move stop on JSD */
+    FALSE,                      /* no truncation with one-sided rollouts */
     10,                         /* truncation */
     1296,                       /* number of trials */
     5,                          /* late evals start here */
-    RNG_MERSENNE,               /* RNG */
+    RNG_PHILOX,                 /* RNG */
     0,                          /* seed */
     324,                        /* minimum games  */
     0.01f,                      /* stop when std's are lower than 0.01 */
@@ -422,10 +426,11 @@ rolloutcontext rcRollout = {
   FALSE,  /* no stop on STD */ \
   FALSE,  /* no stop on JSD */ \
   FALSE,  /* no move stop on JSD */ \
+  FALSE,  /* no truncation with one-sided rollouts */ \
   10, /* truncation */ \
   1296, /* number of trials */ \
   5,  /* late evals start here */ \
-  RNG_MERSENNE, /* RNG */ \
+  RNG_PHILOX, /* RNG */ \
   0,  /* seed */ \
   324,    /* minimum games  */ \
   0.01f,  /* stop when std's are lower than 0.01 */ \
@@ -477,10 +482,11 @@ rolloutcontext rcRollout = {
   FALSE,  /* no stop on STD */ \
   FALSE,  /* no stop on JSD */ \
   FALSE,  /* no move stop on JSD */ \
+  FALSE,  /* no truncation with one-sided rollouts */ \
   10, /* truncation */ \
   1296, /* number of trials */ \
   5,  /* late evals start here */ \
-  RNG_MERSENNE, /* RNG */ \
+  RNG_PHILOX, /* RNG */ \
   0,  /* seed */ \
   324,    /* minimum games  */ \
   0.01f,  /* stop when std's are lower than 0.01 */ \
@@ -591,6 +597,7 @@ static char szDICE[] = N_("<die> <die>"),
                                "[seed]"),
     szOPTNAME[] = N_("[name]"),
     szOPTPOSITION[] = N_("[position]"),
+    szOPTSCOREMAP[] = N_("[=move] [length]"),
     szOPTSEED[] = N_("[seed]"),
     szOPTVALUE[] = N_("[value]"),
     szPLAYER[] = N_("<player>"),
@@ -609,6 +616,9 @@ static char szDICE[] = N_("<die> <die>"),
     szXGID[] = N_("<xgid>"),
     szURL[] = "<URL>",
     szMAXERR[] = N_("<fraction>"), szMINGAMES[] = N_("<minimum games to rollout>"), szFOLDER[] = N_("<folder>"),
+    szFOLDERS[] = N_("<input folder> <output folder>"),
+    szIMPORTFOLDERS[] = N_("<input folder> [output folder]"),
+    szOPENINGBOOK[] = N_("<filename> [rolls]"),
 #if defined(USE_GTK)
     szWARN[] = N_("[<warning>]"), szWARNYN[] = N_("<warning> on|off"),
 #endif
@@ -2554,7 +2564,7 @@ hint_move(char *sz, gboolean show, procrecorddata * procdatarec)
             show = FALSE;
             fShowProgress = (procdatarec->avInputData[PROCREC_HINT_ARGIN_SHOWPROGRESS] != NULL);
         }
-        if ((RunAsyncProcess((AsyncFun) asyncFindMove, &fd, _("Considering move...")) != 0) || fInterrupt) {
+        if ((RunAsyncProcess((AsyncFun) asyncFindBookMove, &fd, _("Considering move...")) != 0) || fInterrupt) {
             fShowProgress = fSaveShowProg;
             return;
         }
@@ -2571,7 +2581,7 @@ hint_move(char *sz, gboolean show, procrecorddata * procdatarec)
         pmr->n.stMove = SKILL_NONE;
     } else {
         pmr->n.iMove = locateMove(msBoard(), pmr->n.anMove, &pmr->ml);
-        /* Tutor mode may have called asyncFindMove() above before
+        /* Tutor mode may have called asyncFindBookMove() above before
          * n.iMove was known. Do it again, ensuring that the actual
          * move is evaluated at the best ply. */
         fd.pml = &ml;
@@ -2581,7 +2591,7 @@ hint_move(char *sz, gboolean show, procrecorddata * procdatarec)
         fd.pci = &ci;
         fd.pec = &GetEvalChequer()->ec;
         fd.aamf = *GetEvalMoveFilter();
-        asyncFindMove(&fd);
+        asyncFindBookMove(&fd);
         pmr_movelist_set(pmr, GetEvalChequer(), &ml);
         find_skills(pmr, &ms, FALSE, -1);
     }
@@ -2706,6 +2716,14 @@ Shutdown(void)
 
     EvalShutdown();
 
+    if (fOSRPersist) {
+        char *sz = OSRCacheFile();
+
+        if (OSRCacheSave(sz) < 0)
+            outputerr(sz);
+        g_free(sz);
+    }
+
 #if defined(USE_PYTHON)
     PythonShutdown();
 #endif
@@ -3111,6 +3129,9 @@ SaveRNGSettings(FILE * pf, const char *sz, rng rngCurrent, rngcontext * rngctx)
     case RNG_MERSENNE:
         fprintf(pf, "%s rng mersenne\n", sz);
         break;
+    case RNG_PHILOX:
+        fprintf(pf, "%s rng philox\n", sz);
+        break;
     case RNG_RANDOM_DOT_ORG:
         fprintf(pf, "%s rng random.org\n", sz);
         break;
@@ -3186,6 +3207,7 @@ SaveRolloutSettings(FILE * pf, const char *sz, rolloutcontext * prc)
             "%s truncation plies %u\n"
             "%s bearofftruncation exact %s\n"
             "%s bearofftruncation onesided %s\n"
+            "%s osrtruncation %s\n"
             "%s later enable %s\n"
             "%s later plies %u\n"
             "%s trials %u\n"
@@ -3206,6 +3228,7 @@ SaveRolloutSettings(FILE * pf, const char *sz, rolloutcontext * prc)
             sz, prc->nTruncate,
             sz, prc->fTruncBearoff2 ? "on" : "off",
             sz, prc->fTruncBearoffOS ? "on" : "off",
+            sz, prc->fTruncOSR ? "on" : "off",
             sz, prc->fLateEvals ? "on" : "off",
             sz, prc->nLate,
             sz, prc->nTrials,
@@ -3308,6 +3331,7 @@ SaveAnalysisSettings(FILE * pf)
     fprintf(pf, "set analysis threshold verylucky %s\n", aszThr[5]);
     fprintf(pf, "set analysis threshold veryunlucky %s\n", aszThr[6]);
     fprintf(pf, "set analysis cube %s\n", fAnalyseCube ? "on" : "off");
+    fprintf(pf, "set analysis incremental %s\n", fAnalyseIncremental ? "on" : "off");
     fprintf(pf, "set analysis luck %s\n", fAnalyseDice ? "on" : "off");
     fprintf(pf, "set analysis moves %s\n", fAnalyseMove ? "on" : "off");
     fprintf(pf, "set analysis player 0 analyse %s\n", afAnalysePlayers[0] ? "yes" : "no");
@@ -3526,6 +3550,8 @@ SaveEvaluationSettings(FILE * pf)
     SaveEvalSetupSettings(pf, "set evaluation cubedecision", &esEvalCube);
     SaveMoveFilterSettings(pf, "set evaluation movefilter", aamfEval);
     fprintf(pf, "set cache %u\n", GetEvalCacheEntries());
+    fprintf(pf, "set osr persist %s\n", fOSRPersist ? "on" : "off");
+    fprintf(pf, "set openingbook %s\n", fUseOpeningBook ? "on" : "off");
     fprintf(pf, "set matchequitytable \"%s\"\n", miCurrent.szFileName);
     fprintf(pf, "set invert matchequitytable %s\n", fInvertMET ? "on" : "off");
 #if defined(USE_MULTITHREAD)
@@ -3563,6 +3589,8 @@ SaveMiscSettings(FILE * pf)
 
     fprintf(pf, "set cube use %s\n", fCubeUse ? "on" : "off");
     fprintf(pf, "set display %s\n", fDisplay ? "on" : "off");
+    fprintf(pf, "set external batchwindow %d\n", nExternalBatchWindow);
+    fprintf(pf, "set external concurrent %s\n", fExternalConcurrent ? "on" : "off");
     fprintf(pf, "set firsttimeupdates %d\n", fFirstTimeUpdates);    
     fprintf(pf, "set gotofirstgame %s\n", fGotoFirstGame ? "on" : "off");
     fprintf(pf, "set nextupdatetime %jd\n", (nextUpdateTime)); /* <- following a compiler report */
@@ -4682,11 +4710,111 @@ PushSplash(char *UNUSED(unused), char *UNUSED(heading), char *UNUSED(message))
 }
 #endif
 
+/* how long each step of the start-up took, for "show version" */
+typedef struct {
+    const char *szStep;         /* untranslated */
+    gint64 t;                   /* microseconds */
+} startupstep;
+
+static startupstep aStartup[10];
+static unsigned int cStartup;
+static gint64 tStartup;
+
+/* Start timing the next step of the start-up; NULL ends the last one */
+static void
+StartupStep(const char *szStep)
+{
+    gint64 t = g_get_monotonic_time();
+
+    if (cStartup) {
+        aStartup[cStartup - 1].t = t - tStartup;
+        g_debug("start-up: %s took %.3f s", aStartup[cStartup - 1].szStep, aStartup[cStartup - 1].t / 1e6);
+    }
+
+    tStartup = t;
+    if (szStep && cStartup < G_N_ELEMENTS(aStartup))
+        aStartup[cStartup++].szStep = szStep;
+}
+
+extern void
+ShowStartupTimes(void)
+{
+    unsigned int i;
+    gint64 tTotal = 0;
+
+    outputl(_("Start-up times:"));
+    for (i = 0; i < cStartup; ++i) {
+        outputf("  %-32s %7.3f s\n", gettext(aStartup[i].szStep), aStartup[i].t / 1e6);
+        tTotal += aStartup[i].t;
+    }
+    outputf("  %-32s %7.3f s\n\n", _("Total"), tTotal / 1e6);
+
+    outputl(_("Bearoff databases (opened on first use):"));
+    for (i = 0; i < NUM_BDB; ++i) {
+        gint64 t = BearoffOpenTime((bearoffdb) i);
+
+        if (t < 0)
+            outputf("  %-32s %s\n", aszBearoffFile[i], _("not used yet"));
+        else if (!apbcBearoff[i])
+            outputf("  %-32s %s\n", aszBearoffFile[i], _("not available"));
+        else
+            outputf("  %-32s %7.3f s\n", aszBearoffFile[i], t / 1e6);
+    }
+}
+
+extern char *
+OSRCacheFile(void)
+{
+    return g_build_filename(szHomeDirectory, "osrcache", NULL);
+}
+
+#if defined(USE_MULTITHREAD)
+typedef struct {
+    Task task;
+    osrchunk *poc;
+} OSRTask;
+
+static void
+OSRChunkMT(OSRTask * pot)
+{
+    OSRRunChunk(pot->poc);
+}
+
+/* Spread the chunks of a one-sided rollout over the thread pool */
+static void
+RunOSRChunksMT(osrchunk aoc[], unsigned int cChunks)
+{
+    unsigned int i;
+
+    if (!MT_Idle()) {
+        /* a rollout or analysis owns the pool; don't wait for it */
+        for (i = 0; i < cChunks; ++i)
+            OSRRunChunk(&aoc[i]);
+        return;
+    }
+
+    for (i = 0; i < cChunks; ++i) {
+        OSRTask *pot = (OSRTask *) malloc(sizeof(OSRTask));
+
+        pot->task.fun = (AsyncFun) OSRChunkMT;
+        pot->task.data = pot;
+        pot->task.pLinkedTask = NULL;
+        pot->poc = &aoc[i];
+
+        MT_AddTask((Task *) pot, TRUE);
+    }
+
+    (void) MT_WaitForTasks(NULL, 0, FALSE);
+}
+#endif
+
 static void
 init_nets(int fNoBearoff)
 {
     char *gnubg_weights = BuildFilename("gnubg.weights");
     char *gnubg_weights_binary = BuildFilename("gnubg.wd");
+
+    szHeuristicBearoff = g_build_filename(szHomeDirectory, "gnubg_os0h.bd", NULL);
     EvalInitialise(gnubg_weights, gnubg_weights_binary, fNoBearoff, fShowProgress ? BearoffProgress : NULL);
     g_free(gnubg_weights);
     g_free(gnubg_weights_binary);
@@ -5164,27 +5292,40 @@ main(int argc, char *argv[])
     }
 
     PushSplash(pwSplash, _("Initialising"), _("Random number generator"));
+    StartupStep(N_("Random number generator"));
     init_rng();
 
     PushSplash(pwSplash, _("Initialising"), _("match equity table"));
+    StartupStep(N_("match equity table"));
     met = BuildFilename2("met", "Kazaross-XG2.xml");
     InitMatchEquity(met);
     g_free(met);
 
     PushSplash(pwSplash, _("Initialising"), _("neural nets"));
+    StartupStep(N_("neural nets"));
     init_nets(fNoBearoff);
 
     PushSplash(pwSplash, _("Initialising"), _("initialising thread data"));
+    StartupStep(N_("initialising thread data"));
     glib_ext_init();
     MT_InitThreads();
+#if defined(USE_MULTITHREAD)
+    OSRRunChunks = RunOSRChunksMT;
+#endif
+
+    PushSplash(pwSplash, _("Initialising"), _("opening book"));
+    StartupStep(N_("opening book"));
+    BookInit();
 
 #if defined(WIN32) && defined(HAVE_SOCKETS)
     PushSplash(pwSplash, _("Initialising"), _("Windows sockets"));
+    StartupStep(N_("Windows sockets"));
     init_winsock();
 #endif
 
 #if defined(USE_PYTHON)
     PushSplash(pwSplash, _("Initialising"), "Python");
+    StartupStep("Python");
     PythonInitialise(argv[0]);
 #endif
 
@@ -5193,8 +5334,10 @@ main(int argc, char *argv[])
     /* -r option given */
     if (!fNoRC) {
         PushSplash(pwSplash, _("Loading"), _("User Settings"));
+        StartupStep(N_("User Settings"));
         LoadRCFiles();
     }
+    StartupStep(NULL);
 
     strcpy(ap[0].szName, default_names[0]);
     strcpy(ap[1].szName, default_names[1]);
@@ -5828,15 +5971,16 @@ EPC(const TanBoard anBoard, float *arEPC, float *arMu, float *arSigma, int *pfSo
     const float x = (2 * 3 + 3 * 4 + 4 * 5 + 4 * 6 + 6 * 7 +
                      5 * 8 + 4 * 9 + 2 * 10 + 2 * 11 + 1 * 12 + 1 * 16 + 1 * 20 + 1 * 24) / 36.0f;
 
-    if (isBearoff(pbc1, anBoard)) {
+    if (isBearoff(GetBearoff(BDB_1), anBoard)) {
         /* one sided in-memory database */
+        bearoffcontext *pbc = GetBearoff(BDB_1);
         float ar[4];
         int i;
 
         for (i = 0; i < 2; ++i) {
-            unsigned int n = PositionBearoff(anBoard[i], pbc1->nPoints, pbc1->nChequers);
+            unsigned int n = PositionBearoff(anBoard[i], pbc->nPoints, pbc->nChequers);
 
-            if (BearoffDist(pbc1, n, NULL, NULL, ar, NULL, NULL))
+            if (BearoffDist(pbc, n, NULL, NULL, ar, NULL, NULL))
                 return -1;
 
             if (arEPC)
@@ -5853,15 +5997,16 @@ EPC(const TanBoard anBoard, float *arEPC, float *arMu, float *arSigma, int *pfSo
 
         return 0;
 
-    } else if (isBearoff(pbcOS, anBoard)) {
+    } else if (isBearoff(GetBearoff(BDB_OS), anBoard)) {
         /* one sided in-memory database */
+        bearoffcontext *pbc = GetBearoff(BDB_OS);
         float ar[4];
         int i;
 
         for (i = 0; i < 2; ++i) {
-            unsigned int n = PositionBearoff(anBoard[i], pbcOS->nPoints, pbcOS->nChequers);
+            unsigned int n = PositionBearoff(anBoard[i], pbc->nPoints, pbc->nChequers);
 
-            if (BearoffDist(pbcOS, n, NULL, NULL, ar, NULL, NULL))
+            if (BearoffDist(pbc, n, NULL, NULL, ar, NULL, NULL))
                 return -1;
 
             if (arEPC)
@@ -5970,6 +6115,14 @@ asyncFindMove(findData * pfd)
         MT_SetResultFailed();
 }
 
+void
+asyncFindBookMove(findData * pfd)
+{
+    if (BookFindnSaveBestMoves(pfd->pml, ms.anDice[0], ms.anDice[1], pfd->pboard,
+                               pfd->keyMove, pfd->rThr, pfd->pci, pfd->pec, pfd->aamf) < 0)
+        MT_SetResultFailed();
+}
+
 void
 asyncDumpDecision(decisionData * pdd)
 {
@@ -6034,6 +6187,8 @@ RunAsyncProcess(AsyncFun fun, void *data, const char *msg)
 #if defined(USE_MULTITHREAD)
     Task *pt = (Task *) g_malloc(sizeof(Task));
 
+    EvalInFlightReset();
+
     pt->pLinkedTask = NULL;
     pt->fun = fun;
     pt->data = data;
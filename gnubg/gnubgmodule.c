@@ -34,6 +34,7 @@
 #include "matchequity.h"
 #include "positionid.h"
 #include "matchid.h"
+#include "multithread.h"
 #include "util.h"
 #include "lib/gnubg-types.h"
 #include "lib/simd.h"
@@ -1426,6 +1427,377 @@ PythonFindBestMove(PyObject * UNUSED(self), PyObject * args)
     }
 }
 
+/*
+ * Batch evaluation.
+ *
+ * The boards are split into chunks, each chunk is evaluated as one task on
+ * the thread pool and the results are written into a flat array, so the
+ * per-position cost is the evaluation itself and not the Python call
+ * overhead. The GIL is released while the tasks run.
+ */
+
+typedef struct {
+    Task task;
+    unsigned int iStart;
+    unsigned int iEnd;
+    TanBoard *aBoards;
+    int (*aanDice)[2];          /* NULL when evaluating */
+    cubeinfo ci;                /* private copy: the evaluator flips fMove */
+    const evalcontext *pec;
+    movefilter(*aamf)[MAX_FILTER_PLIES];
+    float *arOutput;            /* 6 floats per board, or 1 equity per board */
+    int *anMoves;               /* 8 ints per board when finding moves */
+} BatchTask;
+
+/* Convert a buffer of unsigned ints (50 per board), or a sequence of
+ * boards and/or position IDs, to a freshly allocated board array */
+static int
+PyToBoards(PyObject * p, TanBoard ** paBoards, unsigned int *pcBoards)
+{
+    TanBoard *aBoards;
+    Py_ssize_t i, n;
+
+    if (PyObject_CheckBuffer(p) && !PyUnicode_Check(p) && !PyBytes_Check(p)) {
+        Py_buffer view;
+
+        if (PyObject_GetBuffer(p, &view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) < 0)
+            return 0;
+
+        if (view.itemsize != sizeof(unsigned int) ||
+            (view.format && !strchr("iI", view.format[0])) || view.len % sizeof(TanBoard)) {
+            PyBuffer_Release(&view);
+            PyErr_SetString(PyExc_ValueError, _("board buffer must hold 50 ints per board"));
+            return 0;
+        }
+
+        n = view.len / (Py_ssize_t) sizeof(TanBoard);
+        aBoards = g_new(TanBoard, n ? n : 1);
+        memcpy(aBoards, view.buf, view.len);
+        PyBuffer_Release(&view);
+
+        *paBoards = aBoards;
+        *pcBoards = (unsigned int) n;
+        return 1;
+    }
+
+    if (!PySequence_Check(p)) {
+        PyErr_SetString(PyExc_TypeError, _("boards must be a buffer or a sequence"));
+        return 0;
+    }
+
+    n = PySequence_Size(p);
+    aBoards = g_new(TanBoard, n ? n : 1);
+
+    for (i = 0; i < n; ++i) {
+        PyObject *py = PySequence_GetItem(p, i);
+        int ok;
+
+        if (!py) {
+            g_free(aBoards);
+            return 0;
+        }
+
+        if (PyUnicode_Check(py) || PyBytes_Check(py)) {
+            char *sz;
+
+            ok = PyArg_Parse(py, "s", &sz) && PositionFromID(aBoards[i], sz);
+        } else
+            ok = PyToBoard(py, aBoards[i]);
+
+        Py_DECREF(py);
+
+        if (!ok) {
+            g_free(aBoards);
+            PyErr_Clear();
+            PyErr_Format(PyExc_ValueError, _("invalid board or position id at index %d"), (int) i);
+            return 0;
+        }
+    }
+
+    *paBoards = aBoards;
+    *pcBoards = (unsigned int) n;
+    return 1;
+}
+
+/* Wrap raw C data in an array.array of the given type code */
+static PyObject *
+DataToPyArray(const char *szTypeCode, const void *p, size_t cb)
+{
+    PyObject *pyModule, *pyData, *pyArray;
+
+    if (!(pyModule = PyImport_ImportModule("array")))
+        return NULL;
+
+    if (!(pyData = PyBytes_FromStringAndSize((const char *) p, (Py_ssize_t) cb))) {
+        Py_DECREF(pyModule);
+        return NULL;
+    }
+
+    pyArray = PyObject_CallMethod(pyModule, "array", "sO", szTypeCode, pyData);
+
+    Py_DECREF(pyData);
+    Py_DECREF(pyModule);
+
+    return pyArray;
+}
+
+static void
+BatchEvaluateMT(BatchTask * pbt)
+{
+    unsigned int i;
+
+    for (i = pbt->iStart; i < pbt->iEnd && !fInterrupt; ++i) {
+        float arOutput[NUM_ROLLOUT_OUTPUTS];
+
+        if (GeneralEvaluationE(arOutput, (ConstTanBoard) pbt->aBoards[i], &pbt->ci, pbt->pec) < 0) {
+            MT_SetResultFailed();
+            return;
+        }
+        memcpy(pbt->arOutput + 6 * i, arOutput, 6 * sizeof(float));
+    }
+}
+
+static void
+BatchFindBestMoveMT(BatchTask * pbt)
+{
+    unsigned int i, k;
+
+    for (i = pbt->iStart; i < pbt->iEnd && !fInterrupt; ++i) {
+        movelist ml;
+        int *anMove = pbt->anMoves + 8 * i;
+
+        if (FindnSaveBestMoves(&ml, pbt->aanDice[i][0], pbt->aanDice[i][1], (ConstTanBoard) pbt->aBoards[i],
+                               NULL, 0.0f, &pbt->ci, pbt->pec, pbt->aamf) < 0) {
+            g_free(ml.amMoves);
+            MT_SetResultFailed();
+            return;
+        }
+
+        /* same encoding as findbestmove, but padded with zeroes */
+        for (k = 0; k < 8; ++k)
+            anMove[k] = 0;
+        pbt->arOutput[i] = 0.0f;
+
+        if (ml.cMoves) {
+            for (k = 0; k < 8 && ml.amMoves[ml.iMoveBest].anMove[k] != -1; ++k)
+                anMove[k] = ml.amMoves[ml.iMoveBest].anMove[k] + 1;
+            pbt->arOutput[i] = ml.amMoves[ml.iMoveBest].rScore;
+        }
+
+        g_free(ml.amMoves);
+    }
+}
+
+static gboolean
+BatchProgress(gpointer UNUSED(unused))
+{
+    return TRUE;
+}
+
+/* Queue the boards as one task per chunk and wait for the pool to finish */
+static int
+RunBatch(AsyncFun fun, TanBoard * aBoards, unsigned int cBoards, int (*aanDice)[2],
+         const cubeinfo * pci, const evalcontext * pec, movefilter(*aamf)[MAX_FILTER_PLIES],
+         float *arOutput, int *anMoves)
+{
+    unsigned int cChunk, iStart;
+    int ret;
+
+    if (cBoards == 0)
+        return 0;
+
+    /* a few chunks per thread keeps the threads busy when positions
+     * differ in cost (race vs. contact, forced moves, ...) */
+    cChunk = (cBoards + 4 * MT_GetNumThreads() - 1) / (4 * MT_GetNumThreads());
+
+    for (iStart = 0; iStart < cBoards; iStart += cChunk) {
+        BatchTask *pbt = (BatchTask *) malloc(sizeof(BatchTask));
+
+        pbt->task.fun = fun;
+        pbt->task.data = pbt;
+        pbt->task.pLinkedTask = NULL;
+        pbt->iStart = iStart;
+        pbt->iEnd = MIN(iStart + cChunk, cBoards);
+        pbt->aBoards = aBoards;
+        pbt->aanDice = aanDice;
+        pbt->ci = *pci;
+        pbt->pec = pec;
+        pbt->aamf = aamf;
+        pbt->arOutput = arOutput;
+        pbt->anMoves = anMoves;
+
+        MT_AddTask((Task *) pbt, TRUE);
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    ret = MT_WaitForTasks(BatchProgress, 1000, FALSE);
+    Py_END_ALLOW_THREADS
+
+    if (ret != 0 || fInterrupt) {
+        ResetInterrupt();
+        return -1;
+    }
+
+    return 0;
+}
+
+SIMD_STACKALIGN static PyObject *
+PythonEvaluateBatch(PyObject * UNUSED(self), PyObject * args)
+{
+    PyObject *pyBoards = NULL;
+    PyObject *pyCubeInfo = NULL;
+    PyObject *pyEvalContext = NULL;
+    PyObject *pyResult;
+
+    TanBoard *aBoards;
+    unsigned int cBoards;
+    float *arOutput;
+    cubeinfo ci;
+    evalcontext ec;
+
+    memcpy(&ec, &GetEvalChequer()->ec, sizeof(evalcontext));
+    GetMatchStateCubeInfo(&ci, &ms);
+
+    if (!PyArg_ParseTuple(args, "O|OO:evaluate_batch", &pyBoards, &pyCubeInfo, &pyEvalContext))
+        return NULL;
+
+    if (pyCubeInfo && PyToCubeInfo(pyCubeInfo, &ci))
+        return NULL;
+
+    if (pyEvalContext && PyToEvalContext(pyEvalContext, &ec))
+        return NULL;
+
+    if (!PyToBoards(pyBoards, &aBoards, &cBoards))
+        return NULL;
+
+    arOutput = g_new0(float, 6 * (cBoards ? cBoards : 1));
+
+    if (RunBatch((AsyncFun) BatchEvaluateMT, aBoards, cBoards, NULL, &ci, &ec, NULL, arOutput, NULL) < 0) {
+        g_free(aBoards);
+        g_free(arOutput);
+        PyErr_SetString(PyExc_StandardError, _("interrupted/errno in evaluate_batch"));
+        return NULL;
+    }
+
+    pyResult = DataToPyArray("f", arOutput, 6 * cBoards * sizeof(float));
+
+    g_free(aBoards);
+    g_free(arOutput);
+
+    return pyResult;
+}
+
+SIMD_STACKALIGN static PyObject *
+PythonFindBestMoveBatch(PyObject * UNUSED(self), PyObject * args)
+{
+    PyObject *pyBoards = NULL;
+    PyObject *pyDice = NULL;
+    PyObject *pyCubeInfo = NULL;
+    PyObject *pyEvalContext = NULL;
+    PyObject *pyMoveFilters = NULL;
+    PyObject *pyMoves, *pyEquities;
+
+    TanBoard *aBoards;
+    unsigned int cBoards, i;
+    int (*aanDice)[2];
+    int anDice[2];
+    int *anMoves;
+    float *arEquity;
+    cubeinfo ci;
+    evalcontext ec;
+    movefilter(*aamf)[MAX_FILTER_PLIES] = *GetEvalMoveFilter();
+    TmoveFilter aamfLocal;
+
+    memcpy(&ec, &GetEvalChequer()->ec, sizeof(evalcontext));
+    GetMatchStateCubeInfo(&ci, &ms);
+
+    if (!PyArg_ParseTuple(args, "OO|OOO:findbestmove_batch",
+                          &pyBoards, &pyDice, &pyCubeInfo, &pyEvalContext, &pyMoveFilters))
+        return NULL;
+
+    if (pyCubeInfo && PyToCubeInfo(pyCubeInfo, &ci))
+        return NULL;
+
+    if (pyEvalContext && PyToEvalContext(pyEvalContext, &ec))
+        return NULL;
+
+    if (pyMoveFilters) {
+        memcpy(aamfLocal, aamf, sizeof(TmoveFilter));
+        if (PyToMoveFilters(pyMoveFilters, aamfLocal))
+            return NULL;
+        aamf = aamfLocal;
+    }
+
+    if (!PyToBoards(pyBoards, &aBoards, &cBoards))
+        return NULL;
+
+    /* dice: either one roll for all boards or one roll per board */
+    aanDice = (int (*)[2]) g_malloc(sizeof(int[2]) * (cBoards ? cBoards : 1));
+    if (PyToDice(pyDice, anDice) && !PyErr_Occurred()) {
+        for (i = 0; i < cBoards; ++i) {
+            aanDice[i][0] = anDice[0];
+            aanDice[i][1] = anDice[1];
+        }
+    } else {
+        PyErr_Clear();
+        if (!PySequence_Check(pyDice) || PySequence_Size(pyDice) != (Py_ssize_t) cBoards) {
+            g_free(aBoards);
+            g_free(aanDice);
+            PyErr_SetString(PyExc_ValueError, _("dice must be one roll or one roll per board"));
+            return NULL;
+        }
+        for (i = 0; i < cBoards; ++i) {
+            PyObject *py = PySequence_GetItem(pyDice, i);
+            int ok = py && PyToDice(py, aanDice[i]) && !PyErr_Occurred();
+
+            Py_XDECREF(py);
+            if (!ok) {
+                g_free(aBoards);
+                g_free(aanDice);
+                PyErr_Clear();
+                PyErr_Format(PyExc_ValueError, _("invalid dice at index %d"), (int) i);
+                return NULL;
+            }
+        }
+    }
+
+    for (i = 0; i < cBoards; ++i)
+        if (aanDice[i][0] < 1 || aanDice[i][0] > 6 || aanDice[i][1] < 1 || aanDice[i][1] > 6) {
+            g_free(aBoards);
+            g_free(aanDice);
+            PyErr_SetString(PyExc_StandardError, _("What? No dice?\n"));
+            return NULL;
+        }
+
+    anMoves = g_new0(int, 8 * (cBoards ? cBoards : 1));
+    arEquity = g_new0(float, cBoards ? cBoards : 1);
+
+    if (RunBatch((AsyncFun) BatchFindBestMoveMT, aBoards, cBoards, aanDice, &ci, &ec, aamf, arEquity, anMoves) < 0) {
+        g_free(aBoards);
+        g_free(aanDice);
+        g_free(anMoves);
+        g_free(arEquity);
+        PyErr_SetString(PyExc_StandardError, _("interrupted/errno in findbestmove_batch"));
+        return NULL;
+    }
+
+    pyMoves = DataToPyArray("i", anMoves, 8 * cBoards * sizeof(int));
+    pyEquities = DataToPyArray("f", arEquity, cBoards * sizeof(float));
+
+    g_free(aBoards);
+    g_free(aanDice);
+    g_free(anMoves);
+    g_free(arEquity);
+
+    if (!pyMoves || !pyEquities) {
+        Py_XDECREF(pyMoves);
+        Py_XDECREF(pyEquities);
+        return NULL;
+    }
+
+    return Py_BuildValue("(NN)", pyMoves, pyEquities);
+}
+
 static PyObject *
 METRow(float ar[MAXSCORE], const int n)
 {
@@ -3218,6 +3590,15 @@ static PyMethodDef gnubgMethods[] = {
      "    returns tuple(floats P(win), P(win gammon), P(win backgammnon)\n"
      "         P(lose gammon), P(lose backgammon), cubeless equity)"}
     ,
+    {"evaluate_batch", PythonEvaluateBatch, METH_VARARGS,
+     "Cubeless evaluation of many positions on the thread pool\n"
+     "    arguments: boards [cube-info] [eval context]\n"
+     "         boards = sequence of boards and/or position ids, or a\n"
+     "             buffer (e.g. array('I')) of 50 ints per board\n"
+     "         see 'cfevaluate' for the others\n"
+     "    returns array('f') with 6 floats per board, in the order\n"
+     "         returned by 'evaluate'"}
+    ,
     {"evalcontext", PythonEvalContext, METH_VARARGS,
      "make an evalcontext\n"
      "    argument: [tuple ( 5 int, float )]\n" "    returns:  eval-context ( see 'cfevaluate' )"}
@@ -3241,6 +3622,15 @@ static PyMethodDef gnubgMethods[] = {
      "        see 'cfevaluate'\n"
      "    returns: tuple( ints point from, point to, \n" "        unused moves are set to zero"}
     ,
+    {"findbestmove_batch", PythonFindBestMoveBatch, METH_VARARGS,
+     "Find the best move for many positions on the thread pool\n"
+     "    arguments: boards dice [cube-info] [eval-context] [move-filters]\n"
+     "        boards = see 'evaluate_batch'\n"
+     "        dice = one roll for all boards or a sequence of rolls\n"
+     "    returns: tuple( array('i') with 8 ints per board, as\n"
+     "        returned by 'findbestmove' padded with zeroes,\n"
+     "        array('f') with the equity of each best move )"}
+    ,
     {"hint", PythonHint, METH_VARARGS,
      "    arguments: [max moves]\n" "    returns: hint dictionary\n"}
     ,
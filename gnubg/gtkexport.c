@@ -824,6 +824,7 @@ GTKShowExport(exportsetup * pexs)
     gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(pew->pwHTMLType), _("GNU Backgammon"));
     gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(pew->pwHTMLType), _("BBS"));
     gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(pew->pwHTMLType), _("fibs2html"));
+    gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(pew->pwHTMLType), _("Board pictures"));
     gtk_combo_box_set_active(GTK_COMBO_BOX(pew->pwHTMLType), 0);
 
     gtk_container_set_border_width(GTK_CONTAINER(pwHBox), 4);
@@ -6058,7 +6058,7 @@ typedef struct {
     GtkWidget *pwCubeful, *pwVarRedn, *pwInitial, *pwRotate, *pwDoLate;
     GtkWidget *pwDoTrunc, *pwCubeEqualChequer, *pwPlayersAreSame;
     GtkWidget *pwTruncEqualPlayer0;
-    GtkWidget *pwTruncBearoff2, *pwTruncBearoffOS, *pwTruncBearoffOpts;
+    GtkWidget *pwTruncBearoff2, *pwTruncBearoffOS, *pwTruncOSR, *pwTruncBearoffOpts;
     GtkWidget *pwAdjLatePlies, *pwAdjTruncPlies, *pwAdjMinGames;
     GtkWidget *pwDoSTDStop, *pwAdjMaxError;
     GtkWidget *pwJsdDoStop;
@@ -6113,6 +6113,8 @@ GetRolloutSettings(GtkWidget * pw, rolloutwidget * prw)
 
     prw->rcRollout.fTruncBearoffOS = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(prw->prwGeneral->pwTruncBearoffOS));
 
+    prw->rcRollout.fTruncOSR = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(prw->prwGeneral->pwTruncOSR));
+
     prw->rcRollout.nLate = (unsigned short) gtk_adjustment_get_value(prw->prwGeneral->padjLatePlies);
 
     prw->rcRollout.fLateEvals = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(prw->prwGeneral->pwDoLate));
@@ -6275,6 +6277,7 @@ CubefulToggled(GtkWidget * UNUSED(pw), rolloutwidget * prw)
     int f = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(prw->prwGeneral->pwCubeful));
 
     gtk_widget_set_sensitive(GTK_WIDGET(prw->prwGeneral->pwTruncBearoffOS), !f);
+    gtk_widget_set_sensitive(GTK_WIDGET(prw->prwGeneral->pwTruncOSR), !f);
 
 }
 
@@ -6539,6 +6542,11 @@ RolloutPageGeneral(rolloutpagegeneral * prpw, rolloutwidget * prw)
     gtk_box_pack_start(GTK_BOX(pwv), prpw->pwTruncBearoffOS, FALSE, FALSE, 0);
     gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(prpw->pwTruncBearoffOS), prw->rcRollout.fTruncBearoffOS);
 
+    prpw->pwTruncOSR = gtk_check_button_new_with_label(_("Truncate cubeless at races with a one-sided rollout"));
+
+    gtk_box_pack_start(GTK_BOX(pwv), prpw->pwTruncOSR, FALSE, FALSE, 0);
+    gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(prpw->pwTruncOSR), prw->rcRollout.fTruncOSR);
+
 #if GTK_CHECK_VERSION(3,0,0)
     pwGrid = gtk_grid_new();
     gtk_grid_set_column_homogeneous(GTK_GRID(pwGrid), TRUE);
@@ -7058,6 +7066,11 @@ SetRollouts(gpointer UNUSED(p), guint UNUSED(n), GtkWidget * UNUSED(pwIgnore))
                 UserCommand(sz);
             }
 
+            if (rw.rcRollout.fTruncOSR != rcRollout.fTruncOSR) {
+                sprintf(sz, "set rollout osrtruncation %s", rw.rcRollout.fTruncOSR ? "on" : "off");
+                UserCommand(sz);
+            }
+
             if (rw.fCubeEqualChequer != fCubeEqualChequer) {
                 sprintf(sz, "set rollout cube-equal-chequer %s", rw.fCubeEqualChequer ? "on" : "off");
                 UserCommand(sz);
@@ -522,6 +522,76 @@ In Move ScoreMap: Calculates the ordered best moves and their equities.
     }
 }
 
+static void
+CalcQuadrantEquitiesMulti(quadrantdata * apq[], int n, const scoremap * psm) {
+/* Same as CalcQuadrantEquities() with recomputeFully, for n quadrants that need an evaluation. The scores are evaluated
+together in one walk of the ply tree (GeneralCubeDecisionEMulti/FindnSaveBestMovesMulti from eval.c), which shares the
+evaluations below the moves the scores agree on instead of recomputing them at every score. The results are the same.
+*/
+    cubeinfo aci[MULTI_SCORE_CHUNK];
+    int i;
+
+    g_assert(n <= MULTI_SCORE_CHUNK);
+
+    for (i = 0; i < n; i++)
+        aci[i] = apq[i]->ci;
+
+    if (psm->cubeScoreMap) {
+        float aaarOutput[MULTI_SCORE_CHUNK][2][NUM_ROLLOUT_OUTPUTS];
+        int failed = GeneralCubeDecisionEMulti(aaarOutput, psm->pms->anBoard, aci, n, &psm->ec) < 0;
+
+        for (i = 0; i < n; i++) {
+            quadrantdata *pq = apq[i];
+            if (failed) { // e.g. the user stopped the computation in the middle
+                pq->ndEquity=-1000;
+                pq->dtEquity=-1000;
+                strcpy(pq->decisionString,"");
+                continue;
+            }
+            pq->ndEquity= mmwc2eq(aaarOutput[i][0][OUTPUT_CUBEFUL_EQUITY], & pq->ci);
+            pq->dtEquity= mmwc2eq(aaarOutput[i][1][OUTPUT_CUBEFUL_EQUITY], & pq->ci);
+            pq->dec=DecisionVal(pq->ndEquity,pq->dtEquity);
+            strcpy(pq->decisionString,CUBE_DECISION_TEXT[pq->dec]);
+        }
+    } else {  //move scoremap
+        movelist aml[MULTI_SCORE_CHUNK];
+
+        // on failure, all the movelists are empty (cMoves=0, amMoves=NULL, also used for DestroyDialog)
+        FindnSaveBestMovesMulti(aml, n, psm->pms->anDice[0], psm->pms->anDice[1], (ConstTanBoard) psm->pms->anBoard,
+                                aci, &psm->ec, aamfAnalysis);
+
+        for (i = 0; i < n; i++) {
+            apq[i]->ml = aml[i];
+            if (apq[i]->ml.cMoves > 0)
+                FormatMove(apq[i]->decisionString, (ConstTanBoard) psm->pms->anBoard, apq[i]->ml.amMoves[0].anMove);
+            else
+                strcpy(apq[i]->decisionString,"");
+        }
+    }
+}
+
+static void
+QueueQuadrantEquities(quadrantdata * pq, const scoremap * psm, int recomputeFully, quadrantdata * apq[], int *pn) {
+/* Same as CalcQuadrantEquities(), except that the quadrants that need an evaluation are queued in apq and evaluated
+MULTI_SCORE_CHUNK at a time. Call with pq=NULL to evaluate what is left in the queue.
+*/
+    if (pq && psm->cubeScoreMap && !(recomputeFully && GetDPEq(NULL, NULL, & pq->ci))) {
+        // nothing to evaluate
+        CalcQuadrantEquities(pq, psm, recomputeFully);
+        ProgressValueAdd(1);
+        return;
+    }
+
+    if (pq)
+        apq[(*pn)++] = pq;
+
+    if (*pn > 0 && (!pq || *pn == MULTI_SCORE_CHUNK)) {
+        CalcQuadrantEquitiesMulti(apq, *pn, psm);
+        ProgressValueAdd(*pn);
+        *pn = 0;
+    }
+}
+
 static int
 CompareDecisionFrequencies (const void *a, const void *b)
 {
@@ -1682,6 +1752,10 @@ CalcEquities(scoremap * psm, int oldSize, int updateMoneyOnly, int calcOnly)
             //     psm->pmsTemp->fCubeOwner = (psm->signednCube > 0) ? (psm->pmsTemp->fMove) : (1 - psm->pmsTemp->fMove);
 
         }
+        /* The quadrants that need an evaluation are queued and evaluated MULTI_SCORE_CHUNK scores at a time,
+        still in the order of the growing squares. */
+        quadrantdata *apqQueue[MULTI_SCORE_CHUNK];
+        int nQueue = 0;
         for (int aux=oldSize; aux<psm->tableSize; aux++) {
             for (int aux2=aux; aux2>=0; aux2--) {
                 /* first we free the malloc with the equity that may have been provided previously
@@ -1701,11 +1775,9 @@ CalcEquities(scoremap * psm, int oldSize, int updateMoneyOnly, int calcOnly)
                     //Only running the line below when (i >= oldSize || j >= oldSize) 
                     // [now aux>=oldSize] yields a bug with grey squares on resize
                     // if(aux>=oldSize) {
-                        CalcQuadrantEquities(&psm->aaQuadrantData[aux2][aux], psm, (aux >= oldSize));
+                        QueueQuadrantEquities(&psm->aaQuadrantData[aux2][aux], psm, (aux >= oldSize), apqQueue, &nQueue);
                     // if (myDebug)
                     //     g_print("i=%d,j=%d,FindnSaveBestMoves returned %d, %1.3f; decision: %s\n",i,j,psm->aaQuadrantData[i][j].ml.cMoves,psm->aaQuadrantData[i][j].ml.rBestScore,psm->aaQuadrantData[i][j].decisionString);
-                    // if (aux >= oldSize) // Only count the ones where equities are recomputed (other ones occur near-instantly)
-                        ProgressValueAdd(1);
                     // }
                 }
                 else {
@@ -1723,9 +1795,7 @@ CalcEquities(scoremap * psm, int oldSize, int updateMoneyOnly, int calcOnly)
                         InitQuadrantCubeInfo(psm, aux, aux2);
                     if (psm->aaQuadrantData[aux][aux2].isAllowedScore == ALLOWED || psm->cubeScoreMap) {
                         // if(aux>=oldSize) {
-                            CalcQuadrantEquities(&psm->aaQuadrantData[aux][aux2], psm, (aux >= oldSize));
-                        // if (aux >= oldSize)
-                            ProgressValueAdd(1);
+                            QueueQuadrantEquities(&psm->aaQuadrantData[aux][aux2], psm, (aux >= oldSize), apqQueue, &nQueue);
                         // }
                     }
                     else {
@@ -1735,6 +1805,7 @@ CalcEquities(scoremap * psm, int oldSize, int updateMoneyOnly, int calcOnly)
                 }
             }
         }
+        QueueQuadrantEquities(NULL, psm, TRUE, apqQueue, &nQueue); // evaluate the rest of the queue
         /* if we show the true score in the axes and not the away score: when we scale up a table, a "current" score in a 5-point match becomes a "similar" score
                 in a 7-pt match; but we don't currently check that, as DMP, GG, GS etc don't change => check this case only */
         for (int i = 0; i < psm->tableSize; i++) {
@@ -29,6 +29,9 @@
 #include "analysis.h"
 #include "backgammon.h"
 #include "drawboard.h"
+#if USE_GTK
+#include "gtkgame.h"
+#endif
 #include "format.h"
 #include "export.h"
 #include "eval.h"
@@ -36,6 +39,7 @@
 #include "matchid.h"
 #include "formatgs.h"
 #include "relational.h"
+#include "file.h"
 
 #include <glib.h>
 #include <glib/gstdio.h>
@@ -122,7 +126,8 @@ static const char *aaszStyleSheetClasses[NUM_CLASSES][2] = {
 const char *aszHTMLExportType[NUM_HTML_EXPORT_TYPES] = {
     "gnu",
     "bbs",
-    "fibs2html"
+    "fibs2html",
+    "boards"
 };
 
 const char *aszHTMLExportCSS[NUM_HTML_EXPORT_CSS] = {
@@ -414,7 +419,8 @@ printImageClass(FILE * pf, const char *szImageDir, const char *szImage,
             (szImageDir) ? szImageDir : "",
             (!szImageDir || szImageDir[strlen(szImageDir) - 1] == '/') ? "" : "/",
             szImage, szExtension,
-            (het == HTML_EXPORT_TYPE_GNU || (het == HTML_EXPORT_TYPE_BBS && ssc != CLASS_BLOCK)) ?
+            (het == HTML_EXPORT_TYPE_GNU || het == HTML_EXPORT_TYPE_BOARDS
+             || (het == HTML_EXPORT_TYPE_BBS && ssc != CLASS_BLOCK)) ?
             GetStyle(ssc, hecss) : "", (szAlt) ? szAlt : "");
 
 }
@@ -1381,6 +1387,58 @@ printHTMLBoardGNU(FILE * pf, matchstate * pms, int fTurn,
 }
 
 
+/* Pictures of the "boards" export type, from their names to their
+ * boards. The export commands write them when they are done. */
+static GHashTable *phtBoardImages;
+static char *szBoardImageKey;
+
+/*
+ * Print the board as a single picture, named after the position
+ *
+ * Input:
+ *    pf : write to file
+ *    pms: the match state
+ *    fTurn: the player on roll
+ *    szImageDir: path (URI) to images
+ *    szExtension: extension of the image (png)
+ *
+ */
+
+static void
+printHTMLBoardImage(FILE * pf, matchstate * pms, int fTurn,
+                    const char *szImageDir, const char *szExtension, const htmlexportcss hecss)
+{
+    boardimage bi;
+    char *szName;
+
+    memset(&bi, 0, sizeof(bi));
+    memcpy(bi.anBoard, pms->anBoard, sizeof(bi.anBoard));
+    bi.anDice[0] = pms->anDice[0];
+    bi.anDice[1] = pms->anDice[1];
+    bi.fMove = pms->fMove;
+    bi.fTurn = fTurn;
+    bi.fCube = pms->fCubeUse;
+    bi.nCube = pms->nCube;
+    bi.fDoubled = pms->fDoubled;
+    bi.fCubeOwner = pms->fCubeOwner;
+
+    szName = BoardImageName(szBoardImageKey ? szBoardImageKey : "", &bi);
+
+    fputs("<p>\n", pf);
+    printImageClass(pf, szImageDir, szName, szExtension, PositionID((ConstTanBoard) pms->anBoard), hecss,
+                    HTML_EXPORT_TYPE_BOARDS, CLASS_BOARD_IMG);
+    fputs("\n</p>\n", pf);
+
+    if (phtBoardImages && !g_hash_table_lookup(phtBoardImages, szName)) {
+        boardimage *pbi = g_new(boardimage, 1);
+
+        *pbi = bi;
+        g_hash_table_insert(phtBoardImages, szName, pbi);
+    } else
+        g_free(szName);
+}
+
+
 static void
 printHTMLBoard(FILE * pf, matchstate * pms, int fTurn,
                const char *szImageDir, const char *szExtension, const htmlexporttype het, const htmlexportcss hecss)
@@ -1398,6 +1456,9 @@ printHTMLBoard(FILE * pf, matchstate * pms, int fTurn,
     case HTML_EXPORT_TYPE_GNU:
         printHTMLBoardGNU(pf, pms, fTurn, szImageDir, szExtension, hecss);
         break;
+    case HTML_EXPORT_TYPE_BOARDS:
+        printHTMLBoardImage(pf, pms, fTurn, szImageDir, szExtension, hecss);
+        break;
     default:
         printf(_("unknown board type\n"));
         break;
@@ -2879,25 +2940,75 @@ OpenCSS(const char *sz)
 }
 
 
-static void
-check_for_html_images(gchar * path)
+/*
+ * The folder the pictures for the html file path go to
+ *
+ * Garbage collect:
+ *   Caller must g_free returned pointer
+ *
+ */
+
+static gchar *
+html_image_folder(const gchar * path)
 {
     char *url = exsExport.szHTMLPictureURL;
 
-    if (url && g_path_is_absolute(url)) {
-        if (!g_file_test(url, G_FILE_TEST_EXISTS))
-            CommandExportHTMLImages(url);
-    } else {
+    if (url && g_path_is_absolute(url))
+        return g_strdup(url);
+    else {
         gchar *folder = g_path_get_dirname(path);
         gchar *img = g_build_filename(folder, url, NULL);
 
-        if (!g_file_test(img, G_FILE_TEST_EXISTS))
-            CommandExportHTMLImages(img);
-        g_free(img);
+        g_free(folder);
+        return img;
+    }
+}
+
+static void
+check_for_html_images(gchar * path)
+{
+    gchar *img = html_image_folder(path);
+
+    if (!g_file_test(img, G_FILE_TEST_EXISTS))
+        CommandExportHTMLImages(img);
+    g_free(img);
+}
+
+/* Collect the board pictures of the "boards" export type from here on */
+static void
+start_board_images(void)
+{
+    if (exsExport.het != HTML_EXPORT_TYPE_BOARDS)
+        return;
+
+    phtBoardImages = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+    szBoardImageKey = BoardImageKey();
+}
+
+/* Write the board pictures collected for the html file path, or drop
+ * them if path is NULL */
+static void
+end_board_images(const gchar * path)
+{
+    if (!phtBoardImages)
+        return;
+
+    if (path) {
+        gchar *folder = html_image_folder(path);
+
+        WriteBoardImages(folder, phtBoardImages);
         g_free(folder);
     }
+
+    g_hash_table_destroy(phtBoardImages);
+    phtBoardImages = NULL;
+    g_free(szBoardImageKey);
+    szBoardImageKey = NULL;
 }
 
+/* The games are written with many small writes */
+#define HTML_BUFFER_SIZE 65536
+
 
 extern void
 CommandExportGameHtml(char *sz)
@@ -2929,9 +3040,14 @@ CommandExportGameHtml(char *sz)
         return;
     }
 
+    if (!fDontClose)
+        setvbuf(pf, NULL, _IOFBF, HTML_BUFFER_SIZE);
+
     if (exsExport.het == HTML_EXPORT_TYPE_GNU)
         check_for_html_images(sz);
 
+    start_board_images();
+
     ExportGameHTML(pf, plGame,
                    exsExport.szHTMLPictureURL, exsExport.szHTMLExtension,
                    exsExport.het, exsExport.hecss, getGameNumber(plGame), FALSE, NULL);
@@ -2940,6 +3056,8 @@ CommandExportGameHtml(char *sz)
     if (!fDontClose)
         fclose(pf);
 
+    end_board_images(sz);
+
     setDefaultFileName(sz);
 
     /* external stylesheet */
@@ -2952,31 +3070,23 @@ CommandExportGameHtml(char *sz)
 }
 
 
-extern void
-CommandExportMatchHtml(char *sz)
+/* Write the games of the current match to sz and the files named after
+ * it, collecting the pictures of the "boards" export type. Returns -1 if
+ * a file cannot be opened. */
+static int
+ExportMatchHTMLFiles(const char *sz)
 {
-
     FILE *pf;
     listOLD *pl;
     int nGames;
     char *aszLinks[4], *filenames[4];
-    int i, j;
-
-    sz = NextToken(&sz);
-
-    if (!sz || !*sz) {
-        outputl(_("You must specify a file to export to (see `help export " "match html')."));
-        return;
-    }
-
-    if (exsExport.het == HTML_EXPORT_TYPE_GNU)
-        check_for_html_images(sz);
+    int i, j, n = 0;
 
     /* Find number of games in match */
 
     for (pl = lMatch.plNext, nGames = 0; pl != &lMatch; pl = pl->plNext, nGames++);
 
-    for (pl = lMatch.plNext, i = 0; pl != &lMatch; pl = pl->plNext, i++) {
+    for (pl = lMatch.plNext, i = 0; pl != &lMatch && !n; pl = pl->plNext, i++) {
         char *szCurrent = filename_from_iGame(sz, i);
 
         filenames[0] = filename_from_iGame(sz, 0);
@@ -2995,49 +3105,68 @@ CommandExportMatchHtml(char *sz)
 
         filenames[3] = filename_from_iGame(sz, nGames - 1);
         aszLinks[3] = g_path_get_basename(filenames[3]);
-        if (!i) {
-
-            if (!confirmOverwrite(sz, fConfirmSave)) {
-                for (j = 0; j < 4; j++) {
-                    g_free(aszLinks[j]);
-                    g_free(filenames[j]);
-                }
-                g_free(szCurrent);
-                return;
-            }
-
-            setDefaultFileName(sz);
-
-        }
-
 
         if (!strcmp(szCurrent, "-"))
             pf = stdout;
-        else if (!(pf = g_fopen(szCurrent, "w"))) {
+        else if ((pf = g_fopen(szCurrent, "w")) != NULL)
+            setvbuf(pf, NULL, _IOFBF, HTML_BUFFER_SIZE);
+        else {
             outputerr(szCurrent);
-            for (j = 0; j < 4; j++) {
-                g_free(aszLinks[j]);
-                g_free(filenames[j]);
-            }
-            g_free(szCurrent);
-            return;
+            n = -1;
         }
 
-        ExportGameHTML(pf, pl->p,
-                       exsExport.szHTMLPictureURL, exsExport.szHTMLExtension,
-                       exsExport.het, exsExport.hecss, i, i == nGames - 1, aszLinks);
+        if (pf) {
+            ExportGameHTML(pf, pl->p,
+                           exsExport.szHTMLPictureURL, exsExport.szHTMLExtension,
+                           exsExport.het, exsExport.hecss, i, i == nGames - 1, aszLinks);
+
+            if (pf != stdout)
+                fclose(pf);
+        }
 
         for (j = 0; j < 4; j++) {
             g_free(aszLinks[j]);
             g_free(filenames[j]);
         }
         g_free(szCurrent);
+    }
 
-        if (pf != stdout)
-            fclose(pf);
+    return n;
+}
+
+extern void
+CommandExportMatchHtml(char *sz)
+{
+
+    FILE *pf;
+    int n;
+
+    sz = NextToken(&sz);
+
+    if (!sz || !*sz) {
+        outputl(_("You must specify a file to export to (see `help export " "match html')."));
+        return;
+    }
+
+    if (exsExport.het == HTML_EXPORT_TYPE_GNU)
+        check_for_html_images(sz);
 
+    if (!ListEmpty(&lMatch)) {
+        if (!confirmOverwrite(sz, fConfirmSave))
+            return;
+
+        setDefaultFileName(sz);
     }
 
+    start_board_images();
+
+    n = ExportMatchHTMLFiles(sz);
+
+    end_board_images(sz);
+
+    if (n < 0)
+        return;
+
     /* external stylesheet */
 
     if (exsExport.hecss == HTML_EXPORT_CSS_EXTERNAL)
@@ -3047,6 +3176,146 @@ CommandExportMatchHtml(char *sz)
         }
 }
 
+/*
+ * Export every match in a folder to HTML, one set of files per match
+ * named after the match file. The pictures of the "boards" export type
+ * are collected over all the matches and written once at the end, so a
+ * board that occurs in several matches is drawn once. Matches whose HTML
+ * is newer than the match file are skipped.
+ */
+
+extern void
+CommandExportDirectoryHtml(char *sz)
+{
+    char *szIn = NextToken(&sz);
+    char *szOut = NextToken(&sz);
+    gchar *szLast = NULL;
+    GPtrArray *aszFiles;
+    ImportType *atype;
+    FILE *pf;
+    unsigned int i, cExported = 0, cSkipped = 0, cFailed = 0;
+    gint64 tStart = g_get_monotonic_time();
+    double rElapsed;
+
+    if (!szIn || !*szIn || !szOut || !*szOut) {
+        outputl(_("You must specify an input and an output folder (see `help export directory html')."));
+        return;
+    }
+#if defined(USE_GTK)
+    if (fX) {
+        outputl(_("`export directory' is only available in the command line interface."));
+        return;
+    }
+#endif
+
+    if (!(aszFiles = ListFolderFiles(szIn))) {
+        outputerrf(_("Cannot read folder `%s'"), szIn);
+        return;
+    }
+
+    if (g_mkdir_with_parents(szOut, 0755) < 0) {
+        outputerr(szOut);
+        g_ptr_array_free(aszFiles, TRUE);
+        return;
+    }
+
+    if (SameFolder(szIn, szOut)) {
+        outputl(_("The output folder must be different from the input folder."));
+        g_ptr_array_free(aszFiles, TRUE);
+        return;
+    }
+
+    if (!get_input_discard()) {
+        g_ptr_array_free(aszFiles, TRUE);
+        return;
+    }
+
+    atype = ReadImportTypes(aszFiles);
+
+    start_board_images();
+
+    for (i = 0; i < aszFiles->len && !fInterrupt; i++) {
+        const char *szInput = g_ptr_array_index(aszFiles, i);
+        gchar *szBase, *szOutput, *szCommand;
+        gchar *pch;
+
+        if (atype[i] == N_IMPORT_TYPES || atype[i] == IMPORT_POS)
+            /* not a match file */
+            continue;
+
+        szBase = g_path_get_basename(szInput);
+        if ((pch = strrchr(szBase, '.')) != NULL && pch != szBase)
+            *pch = 0;
+        szOutput = g_strdup_printf("%s" G_DIR_SEPARATOR_S "%s.html", szOut, szBase);
+        g_free(szBase);
+
+        if (OutputUpToDate(szInput, szOutput)) {
+            cSkipped++;
+            g_free(szOutput);
+            continue;
+        }
+
+        FreeMatch();
+        ClearMatch();
+        plGame = plLastMove = NULL;
+
+        szCommand = ImportCommand(atype[i], szInput);
+        HandleCommand(szCommand, acTop);
+        g_free(szCommand);
+
+        if (!plGame || ListEmpty(&lMatch)) {
+            outputf(_("Could not import `%s'\n"), szInput);
+            cFailed++;
+            g_free(szOutput);
+            continue;
+        }
+
+        if (exsExport.het == HTML_EXPORT_TYPE_GNU)
+            check_for_html_images(szOutput);
+
+        if (ExportMatchHTMLFiles(szOutput) < 0)
+            cFailed++;
+        else
+            cExported++;
+
+        g_free(szLast);
+        szLast = szOutput;
+
+        if ((cExported + cFailed) % 100 == 0) {
+            rElapsed = (g_get_monotonic_time() - tStart) / 1000000.0;
+            outputf(_("[%u/%u] %.1f matches/s\n"), i + 1, aszFiles->len,
+                    rElapsed > 0 ? cExported / rElapsed : 0.0);
+            outputx();
+        }
+    }
+
+    FreeMatch();
+    ClearMatch();
+    plGame = plLastMove = NULL;
+
+    /* all the pictures and the stylesheet go to the same folders */
+
+    end_board_images(szLast);
+
+    if (szLast && exsExport.hecss == HTML_EXPORT_CSS_EXTERNAL)
+        if ((pf = OpenCSS(szLast))) {
+            WriteStyleSheet(pf, exsExport.hecss);
+            fclose(pf);
+        }
+
+    g_free(szLast);
+
+    rElapsed = (g_get_monotonic_time() - tStart) / 1000000.0;
+    outputf(_("Exported %u matches in %.1f s: %.1f matches/s.\n"
+              "%u skipped as up to date, %u failed%s.\n"),
+            cExported, rElapsed, rElapsed > 0 ? cExported / rElapsed : 0.0,
+            cSkipped, cFailed, fInterrupt ? _(", interrupted") : "");
+    outputx();
+
+    g_free(atype);
+    g_ptr_array_free(aszFiles, TRUE);
+}
+
 
 extern void
 CommandExportPositionHtml(char *sz)
@@ -3082,6 +3351,8 @@ CommandExportPositionHtml(char *sz)
     if (exsExport.het == HTML_EXPORT_TYPE_GNU)
         check_for_html_images(sz);
 
+    start_board_images();
+
     HTMLPrologue(pf, &ms, getGameNumber(plGame), NULL, exsExport.het, exsExport.hecss);
 
     if (exsExport.fIncludeMatchInfo)
@@ -3114,6 +3385,8 @@ CommandExportPositionHtml(char *sz)
     if (pf != stdout)
         fclose(pf);
 
+    end_board_images(sz);
+
     setDefaultFileName(sz);
 
     /* external stylesheet */
@@ -35,8 +35,10 @@
 #include "gtkgame.h"
 #endif
 #include "file.h"
+#include "relational.h"
 #include "positionid.h"
 #include "matchequity.h"
+#include "sgf.h"
 
 #if !GLIB_CHECK_VERSION (2,26,0)
 #ifdef WIN32
@@ -3618,6 +3620,16 @@ CommandImportParty(char *sz)
     fclose(gamf);
 }
 
+/* The command that imports szFile of the given format */
+extern gchar *
+ImportCommand(ImportType type, const char *szFile)
+{
+    if (type == IMPORT_SGF)
+        return g_strdup_printf("load match \"%s\"", szFile);
+    else
+        return g_strdup_printf("import %s \"%s\"", import_format[type].clname, szFile);
+}
+
 extern void
 CommandImportAuto(char *sz)
 {
@@ -3645,16 +3657,198 @@ CommandImportAuto(char *sz)
         outputf(_("The format of '%s' is not recognized"), sz);
         g_free(fdp);
         return;
-    } else if (fdp->type == IMPORT_SGF)
-        cmd = g_strdup_printf("load match \"%s\"", sz);
-    else
-        cmd = g_strdup_printf("import %s \"%s\"", import_format[fdp->type].clname, sz);
+    }
 
+    cmd = ImportCommand(fdp->type, sz);
     HandleCommand(cmd, acTop);
     g_free(cmd);
     g_free(fdp);
 }
 
+/* Save the current match as SGF, through a temporary file so that a
+ * partial output never looks complete to a later run */
+static int
+SaveImportedMatch(const char *szOutput)
+{
+    gchar *szTemp = g_strconcat(szOutput, ".tmp", NULL);
+    FILE *pf;
+    listOLD *pl;
+    int fOK;
+
+    if (!(pf = g_fopen(szTemp, "w"))) {
+        outputerr(szTemp);
+        g_free(szTemp);
+        return -1;
+    }
+    setvbuf(pf, NULL, _IOFBF, SGF_WRITE_BUFFER);
+
+    for (pl = lMatch.plNext; pl != &lMatch; pl = pl->plNext)
+        SaveGame(pf, pl->p);
+
+    fOK = !ferror(pf);
+    fOK = !fclose(pf) && fOK;
+
+    if (fOK) {
+        g_unlink(szOutput);
+        fOK = !g_rename(szTemp, szOutput);
+    }
+    if (!fOK) {
+        outputerr(szOutput);
+        g_unlink(szTemp);
+    }
+
+    g_free(szTemp);
+
+    return fOK ? 0 : -1;
+}
+
+/*
+ * "import directory": import every match file in a folder and save it as
+ * SGF in the output folder, or add it to the relational database when no
+ * output folder is given.
+ *
+ * The formats of all the files are detected on the thread pool first.
+ * The parsing itself stays on the main thread, one file after the other:
+ * the importers build the global match (ms, lMatch, plGame) and would
+ * have to fill separate match objects to run on the thread pool. SGF files that are newer than their
+ * input are skipped, so an interrupted run can simply be restarted.
+ */
+
+extern void
+CommandImportDirectory(char *sz)
+{
+    char *szIn = NextToken(&sz);
+    char *szOut = NextToken(&sz);
+    GPtrArray *aszFiles;
+    ImportType *atype;
+    DBProvider *pdb = NULL;
+    unsigned int i, cImported = 0, cSkipped = 0, cFailed = 0, cOther = 0;
+    gint64 tStart = g_get_monotonic_time();
+    double rElapsed;
+
+    if (!szIn || !*szIn) {
+        outputl(_("You must specify a folder to import (see `help import directory')."));
+        return;
+    }
+#if defined(USE_GTK)
+    if (fX) {
+        outputl(_("`import directory' is only available in the command line interface."));
+        return;
+    }
+#endif
+
+    if (!(aszFiles = ListFolderFiles(szIn))) {
+        outputerrf(_("Cannot read folder `%s'"), szIn);
+        return;
+    }
+
+    if (szOut && *szOut) {
+        if (g_mkdir_with_parents(szOut, 0755) < 0) {
+            outputerr(szOut);
+            g_ptr_array_free(aszFiles, TRUE);
+            return;
+        }
+
+        if (SameFolder(szIn, szOut)) {
+            outputl(_("The output folder must be different from the input folder."));
+            g_ptr_array_free(aszFiles, TRUE);
+            return;
+        }
+    } else
+        szOut = NULL;
+
+    if (!get_input_discard()) {
+        g_ptr_array_free(aszFiles, TRUE);
+        return;
+    }
+
+    /* one connection for the whole folder */
+    if (!szOut && (pdb = ConnectToDB(dbProviderType)) == NULL) {
+        outputerrf(_("Error opening database"));
+        g_ptr_array_free(aszFiles, TRUE);
+        return;
+    }
+
+    atype = ReadImportTypes(aszFiles);
+
+    for (i = 0; i < aszFiles->len && !fInterrupt; i++) {
+        const char *szInput = g_ptr_array_index(aszFiles, i);
+        gchar *szOutput = NULL;
+        gchar *szCommand;
+
+        if (atype[i] == N_IMPORT_TYPES || atype[i] == IMPORT_POS) {
+            /* not a match file */
+            cOther++;
+            continue;
+        }
+
+        if (szOut) {
+            gchar *szBase = g_path_get_basename(szInput);
+            gchar *pch = strrchr(szBase, '.');
+
+            if (pch && pch != szBase)
+                *pch = 0;
+            szOutput = g_strdup_printf("%s" G_DIR_SEPARATOR_S "%s.sgf", szOut, szBase);
+            g_free(szBase);
+
+            if (OutputUpToDate(szInput, szOutput)) {
+                cSkipped++;
+                g_free(szOutput);
+                continue;
+            }
+        }
+
+        FreeMatch();
+        ClearMatch();
+        plGame = plLastMove = NULL;
+
+        szCommand = ImportCommand(atype[i], szInput);
+        HandleCommand(szCommand, acTop);
+        g_free(szCommand);
+
+        if (!plGame || ListEmpty(&lMatch)) {
+            outputf(_("Could not import `%s'\n"), szInput);
+            cFailed++;
+        } else if (szOutput) {
+            if (SaveImportedMatch(szOutput) < 0)
+                cFailed++;
+            else
+                cImported++;
+        } else {
+            if (RelationalAddMatch(pdb, TRUE) < 0)
+                cFailed++;
+            else
+                cImported++;
+        }
+
+        g_free(szOutput);
+
+        if ((cImported + cFailed) % 100 == 0) {
+            rElapsed = (g_get_monotonic_time() - tStart) / 1000000.0;
+            outputf(_("[%u/%u] %.1f matches/s\n"), i + 1, aszFiles->len,
+                    rElapsed > 0 ? cImported / rElapsed : 0.0);
+            outputx();
+        }
+    }
+
+    FreeMatch();
+    ClearMatch();
+    plGame = plLastMove = NULL;
+
+    if (pdb)
+        pdb->Disconnect();
+
+    rElapsed = (g_get_monotonic_time() - tStart) / 1000000.0;
+    outputf(_("Imported %u matches in %.1f s: %.1f matches/s.\n"
+              "%u skipped as up to date, %u failed, %u not match files%s.\n"),
+            cImported, rElapsed, rElapsed > 0 ? cImported / rElapsed : 0.0,
+            cSkipped, cFailed, cOther, fInterrupt ? _(", interrupted") : "");
+    outputx();
+
+    g_free(atype);
+    g_ptr_array_free(aszFiles, TRUE);
+}
+
 #define BGR_STRING "BGF version"
 static int moveNumBGR;
 
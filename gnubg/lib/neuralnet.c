@@ -42,6 +42,7 @@ NeuralNetCreate(neuralnet * pnn, unsigned int cInput, unsigned int cHidden,
     pnn->rBetaHidden = rBetaHidden;
     pnn->rBetaOutput = rBetaOutput;
     pnn->nTrained = 0;
+    pnn->fMapped = FALSE;
 
     if ((pnn->arHiddenWeight = sse_malloc(cHidden * cInput * sizeof(float))) == NULL)
         return -1;
@@ -70,6 +71,14 @@ NeuralNetCreate(neuralnet * pnn, unsigned int cInput, unsigned int cHidden,
 extern void
 NeuralNetDestroy(neuralnet * pnn)
 {
+    if (pnn->fMapped) {
+        /* the file is unmapped by the caller */
+        pnn->arHiddenWeight = pnn->arOutputWeight = NULL;
+        pnn->arHiddenThreshold = pnn->arOutputThreshold = NULL;
+        pnn->fMapped = FALSE;
+        return;
+    }
+
     sse_free(pnn->arHiddenWeight);
     pnn->arHiddenWeight = 0;
     sse_free(pnn->arOutputWeight);
@@ -359,6 +368,115 @@ NeuralNetSaveBinary(const neuralnet * pnn, FILE * pf)
     return 0;
 }
 
+/* Header of each net in the mapped format. The weights follow in the
+ * layout NeuralNetLoadBinary() reads them in, which is the one the
+ * evaluation code works on, but each array starts at a multiple of
+ * NN_MAPPED_ALIGN bytes. */
+typedef struct {
+    unsigned int cInput;
+    unsigned int cHidden;
+    unsigned int cOutput;
+    int nTrained;
+    float rBetaHidden;
+    float rBetaOutput;
+} nnmappedheader;
+
+static inline size_t
+MappedSize(size_t cb)
+{
+    return (cb + NN_MAPPED_ALIGN - 1) / NN_MAPPED_ALIGN * NN_MAPPED_ALIGN;
+}
+
+static float *
+MappedArray(const char **pp, const char *pEnd, size_t c)
+{
+    const char *p = *pp;
+    size_t cb = MappedSize(c * sizeof(float));
+
+    if ((size_t) (pEnd - p) < cb)
+        return NULL;
+
+    *pp = p + cb;
+
+    /* the nets are never written to */
+    return (float *) (size_t) p;
+}
+
+/* Point pnn at the net starting at *pp in a mapped weights file, and move
+ * *pp past it. The file must stay mapped while the net is in use. */
+extern int
+NeuralNetLoadMapped(neuralnet * pnn, const char **pp, const char *pEnd)
+{
+    nnmappedheader h;
+
+    if ((size_t) *pp % NN_MAPPED_ALIGN || (size_t) (pEnd - *pp) < MappedSize(sizeof(h))) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    memcpy(&h, *pp, sizeof(h));
+    *pp += MappedSize(sizeof(h));
+
+    if (h.cInput < 1 || h.cHidden < 1 || h.cOutput < 1 || h.rBetaHidden <= 0.0f || h.rBetaOutput <= 0.0f) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    pnn->cInput = h.cInput;
+    pnn->cHidden = h.cHidden;
+    pnn->cOutput = h.cOutput;
+    pnn->nTrained = 1;
+    pnn->rBetaHidden = h.rBetaHidden;
+    pnn->rBetaOutput = h.rBetaOutput;
+
+    if (!(pnn->arHiddenWeight = MappedArray(pp, pEnd, h.cInput * h.cHidden)) ||
+        !(pnn->arOutputWeight = MappedArray(pp, pEnd, h.cHidden * h.cOutput)) ||
+        !(pnn->arHiddenThreshold = MappedArray(pp, pEnd, h.cHidden)) ||
+        !(pnn->arOutputThreshold = MappedArray(pp, pEnd, h.cOutput))) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    pnn->fMapped = TRUE;
+
+    return 0;
+}
+
+static int
+WriteMapped(const void *p, size_t cb, FILE * pf)
+{
+    static const char achPad[NN_MAPPED_ALIGN] = { 0 };
+    size_t cbPad = MappedSize(cb) - cb;
+
+    if (fwrite(p, 1, cb, pf) < cb || fwrite(achPad, 1, cbPad, pf) < cbPad)
+        return -1;
+
+    return 0;
+}
+
+extern int
+NeuralNetSaveMapped(const neuralnet * pnn, FILE * pf)
+{
+    nnmappedheader h;
+
+    memset(&h, 0, sizeof(h));
+    h.cInput = pnn->cInput;
+    h.cHidden = pnn->cHidden;
+    h.cOutput = pnn->cOutput;
+    h.nTrained = pnn->nTrained;
+    h.rBetaHidden = pnn->rBetaHidden;
+    h.rBetaOutput = pnn->rBetaOutput;
+
+    if (WriteMapped(&h, sizeof(h), pf)
+        || WriteMapped(pnn->arHiddenWeight, pnn->cInput * pnn->cHidden * sizeof(float), pf)
+        || WriteMapped(pnn->arOutputWeight, pnn->cHidden * pnn->cOutput * sizeof(float), pf)
+        || WriteMapped(pnn->arHiddenThreshold, pnn->cHidden * sizeof(float), pf)
+        || WriteMapped(pnn->arOutputThreshold, pnn->cOutput * sizeof(float), pf))
+        return -1;
+
+    return 0;
+}
+
 
 #if defined(USE_SIMD_INSTRUCTIONS)
 
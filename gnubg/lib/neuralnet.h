@@ -35,8 +35,14 @@ typedef struct {
     float *arOutputWeight;
     float *arHiddenThreshold;
     float *arOutputThreshold;
+    int fMapped;                /* arrays point into a mapped weights file */
 } neuralnet;
 
+/* In the mapped weights format (see NeuralNetSaveMapped()), the file
+ * header, each net's header and each array are padded to a multiple of
+ * this many bytes, so that the arrays can be used in place */
+#define NN_MAPPED_ALIGN 32
+
 typedef enum {
     NNEVAL_NONE,
     NNEVAL_SAVE,
@@ -67,6 +73,8 @@ extern int NeuralNetEvaluateSSE(const neuralnet * pnn, float arInput[], float ar
 extern int NeuralNetLoad(neuralnet * pnn, FILE * pf);
 extern int NeuralNetLoadBinary(neuralnet * pnn, FILE * pf);
 extern int NeuralNetSaveBinary(const neuralnet * pnn, FILE * pf);
+extern int NeuralNetLoadMapped(neuralnet * pnn, const char **pp, const char *pEnd);
+extern int NeuralNetSaveMapped(const neuralnet * pnn, FILE * pf);
 extern int SIMD_Supported(void);
 
 /* Try to determine whether we are 64-bit or 32-bit */
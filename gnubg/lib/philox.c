@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2026 the AUTHORS
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * $Id$
+ */
+
+#include "philox.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define PHILOX_M0 0xD2511F53U
+#define PHILOX_M1 0xCD9E8D57U
+#define PHILOX_W0 0x9E3779B9U     /* golden ratio */
+#define PHILOX_W1 0xBB67AE85U     /* sqrt(3) - 1 */
+#define PHILOX_ROUNDS 10
+
+extern void
+philox4x32(uint32_t ctr[4], const uint32_t key[2])
+{
+    uint32_t k0 = key[0], k1 = key[1];
+    int r;
+
+    for (r = 0; r < PHILOX_ROUNDS; r++) {
+        uint64_t p0 = (uint64_t) PHILOX_M0 * ctr[0];
+        uint64_t p1 = (uint64_t) PHILOX_M1 * ctr[2];
+
+        ctr[0] = (uint32_t) (p1 >> 32) ^ ctr[1] ^ k0;
+        ctr[1] = (uint32_t) p1;
+        ctr[2] = (uint32_t) (p0 >> 32) ^ ctr[3] ^ k1;
+        ctr[3] = (uint32_t) p0;
+
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+}
+
+#if defined(__SSE2__)
+/* 32x32 -> 64 bit products of the four lanes of a by m */
+static inline void
+mulhilo4(__m128i a, __m128i m, __m128i * phi, __m128i * plo)
+{
+    __m128i pEven = _mm_mul_epu32(a, m);
+    __m128i pOdd = _mm_mul_epu32(_mm_srli_epi64(a, 32), m);
+
+    *plo = _mm_unpacklo_epi32(_mm_shuffle_epi32(pEven, _MM_SHUFFLE(3, 1, 2, 0)),
+                              _mm_shuffle_epi32(pOdd, _MM_SHUFFLE(3, 1, 2, 0)));
+    *phi = _mm_unpacklo_epi32(_mm_shuffle_epi32(pEven, _MM_SHUFFLE(2, 0, 3, 1)),
+                              _mm_shuffle_epi32(pOdd, _MM_SHUFFLE(2, 0, 3, 1)));
+}
+#endif
+
+/* The rounds are done on PHILOX_LANES counters at a time, one array per
+ * word, with SSE2 where available and otherwise in a loop that the
+ * compiler may vectorise. */
+
+extern void
+philox4x32_fill(uint32_t aan[][4], unsigned int n, const uint32_t ctr[4], const uint32_t key[2])
+{
+    uint64_t nStart = ((uint64_t) ctr[1] << 32) | ctr[0];
+    unsigned int i, j;
+
+    for (i = 0; i < n; i += PHILOX_LANES) {
+        uint32_t c0[PHILOX_LANES], c1[PHILOX_LANES], c2[PHILOX_LANES], c3[PHILOX_LANES];
+        uint32_t k0 = key[0], k1 = key[1];
+        int r;
+
+        for (j = 0; j < PHILOX_LANES; j++) {
+            uint64_t nCount = nStart + i + j;
+
+            c0[j] = (uint32_t) nCount;
+            c1[j] = (uint32_t) (nCount >> 32);
+            c2[j] = ctr[2];
+            c3[j] = ctr[3];
+        }
+
+#if defined(__SSE2__)
+        for (j = 0; j < PHILOX_LANES; j += 4) {
+            __m128i v0 = _mm_loadu_si128((const __m128i *) (c0 + j));
+            __m128i v1 = _mm_loadu_si128((const __m128i *) (c1 + j));
+            __m128i v2 = _mm_loadu_si128((const __m128i *) (c2 + j));
+            __m128i v3 = _mm_loadu_si128((const __m128i *) (c3 + j));
+            const __m128i m0 = _mm_set1_epi32((int) PHILOX_M0);
+            const __m128i m1 = _mm_set1_epi32((int) PHILOX_M1);
+            uint32_t kk0 = k0, kk1 = k1;
+
+            for (r = 0; r < PHILOX_ROUNDS; r++) {
+                __m128i hi0, lo0, hi1, lo1;
+
+                mulhilo4(v0, m0, &hi0, &lo0);
+                mulhilo4(v2, m1, &hi1, &lo1);
+
+                v0 = _mm_xor_si128(_mm_xor_si128(hi1, v1), _mm_set1_epi32((int) kk0));
+                v1 = lo1;
+                v2 = _mm_xor_si128(_mm_xor_si128(hi0, v3), _mm_set1_epi32((int) kk1));
+                v3 = lo0;
+
+                kk0 += PHILOX_W0;
+                kk1 += PHILOX_W1;
+            }
+
+            _mm_storeu_si128((__m128i *) (c0 + j), v0);
+            _mm_storeu_si128((__m128i *) (c1 + j), v1);
+            _mm_storeu_si128((__m128i *) (c2 + j), v2);
+            _mm_storeu_si128((__m128i *) (c3 + j), v3);
+        }
+#else
+        for (r = 0; r < PHILOX_ROUNDS; r++) {
+            for (j = 0; j < PHILOX_LANES; j++) {
+                uint32_t hi0 = (uint32_t) (((uint64_t) PHILOX_M0 * c0[j]) >> 32);
+                uint32_t hi1 = (uint32_t) (((uint64_t) PHILOX_M1 * c2[j]) >> 32);
+                uint32_t lo0 = PHILOX_M0 * c0[j];
+                uint32_t lo1 = PHILOX_M1 * c2[j];
+
+                c0[j] = hi1 ^ c1[j] ^ k0;
+                c1[j] = lo1;
+                c2[j] = hi0 ^ c3[j] ^ k1;
+                c3[j] = lo0;
+            }
+
+            k0 += PHILOX_W0;
+            k1 += PHILOX_W1;
+        }
+#endif
+
+        for (j = 0; j < PHILOX_LANES && i + j < n; j++) {
+            aan[i + j][0] = c0[j];
+            aan[i + j][1] = c1[j];
+            aan[i + j][2] = c2[j];
+            aan[i + j][3] = c3[j];
+        }
+    }
+}
+
+extern void
+philox_dice(unsigned int anDice[2], const uint32_t key[2], uint32_t nTrial, uint32_t nTurn, uint32_t nDraw)
+{
+    const uint32_t exp232_q = 715827882;
+    const uint32_t exp232_l = 4294967292U;
+    uint32_t n = 1;
+    int i = 0, j;
+
+    anDice[0] = anDice[1] = 0;
+
+    while (!anDice[1]) {
+        uint32_t anBlock[4];
+
+        anBlock[0] = nTurn;
+        anBlock[1] = nTrial;
+        anBlock[2] = nDraw;
+        anBlock[3] = n++;
+        philox4x32(anBlock, key);
+
+        /* use the first two words below 6 * 715827882 */
+        for (j = 0; j < 4 && i < 2; j++)
+            if (anBlock[j] < exp232_l)
+                anDice[i++] = 1 + anBlock[j] / exp232_q;
+    }
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2026 the AUTHORS
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * $Id$
+ */
+
+/*
+ * Philox4x32-10 counter-based generator (Salmon, Moraes, Dror and Shaw,
+ * "Parallel random numbers: as easy as 1, 2, 3", SC11). Each 128 bit
+ * counter is mapped to 128 random bits by ten rounds keyed by 64 bits,
+ * so any block of the stream can be computed directly.
+ */
+
+#ifndef PHILOX_H
+#define PHILOX_H
+
+#include <stdint.h>
+
+/* counters computed side by side by philox4x32_fill() */
+#define PHILOX_LANES 8
+
+/* Replace ctr by its random block */
+extern void philox4x32(uint32_t ctr[4], const uint32_t key[2]);
+
+/* The n blocks of the counters ctr, ctr + 1, ..., ctr + n - 1, where
+ * ctr[0] and ctr[1] hold the low and high words of a 64 bit count */
+extern void philox4x32_fill(uint32_t aan[][4], unsigned int n, const uint32_t ctr[4], const uint32_t key[2]);
+
+/* Dice number nDraw of turn nTurn of rollout trial nTrial: the first two
+ * unbiased words of the blocks of the counters (nTurn, nTrial, nDraw, 1..) */
+extern void philox_dice(unsigned int anDice[2], const uint32_t key[2], uint32_t nTrial, uint32_t nTurn,
+                        uint32_t nDraw);
+
+#endif
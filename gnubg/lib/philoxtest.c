@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2026 the AUTHORS
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * $Id$
+ */
+
+/*
+ * Checks of the Philox rollout dice: known answers of the generator, the
+ * buffered generator against the plain one, and the same dice for every
+ * trial whatever the order the trials are rolled in and the number of
+ * threads rolling them, as rollouts with "set rollout rng philox" rely on.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <glib.h>
+
+#include "philox.h"
+
+#define TRIALS 256
+#define TURNS 64
+#define DRAWS 2
+#define THREADS 4
+
+typedef unsigned int trialdice[TURNS][DRAWS][2];
+
+static const uint32_t anKey[2] = { 0x2B7E1516U, 0x28AED2A6U };
+
+static int cFailed;
+
+static void
+Check(int f, const char *sz)
+{
+    if (!f) {
+        fprintf(stderr, "FAIL: %s\n", sz);
+        cFailed++;
+    }
+}
+
+/* Philox4x32-10 answers of the Random123 kat_vectors */
+static void
+CheckKnownAnswers(void)
+{
+    static const uint32_t aanIn[3][6] = {
+        {0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U},
+        {0xFFFFFFFFU, 0xFFFFFFFFU, 0xFFFFFFFFU, 0xFFFFFFFFU, 0xFFFFFFFFU, 0xFFFFFFFFU},
+        {0x243F6A88U, 0x85A308D3U, 0x13198A2EU, 0x03707344U, 0xA4093822U, 0x299F31D0U}
+    };
+    static const uint32_t aanOut[3][4] = {
+        {0x6627E8D5U, 0xE169C58DU, 0xBC57AC4CU, 0x9B00DBD8U},
+        {0x408F276DU, 0x41C83B0EU, 0xA20BC7C6U, 0x6D5451FDU},
+        {0xD16CFE09U, 0x94FDCCEBU, 0x5001E420U, 0x24126EA1U}
+    };
+    int i;
+
+    for (i = 0; i < 3; i++) {
+        uint32_t an[4];
+
+        memcpy(an, aanIn[i], sizeof(an));
+        philox4x32(an, aanIn[i] + 4);
+        Check(!memcmp(an, aanOut[i], sizeof(an)), "philox4x32 known answer");
+    }
+}
+
+/* philox4x32_fill() against philox4x32(), across a carry of the count */
+static void
+CheckFill(void)
+{
+    uint32_t anCounter[4] = { 0xFFFFFFF0U, 7, 11, 13 };
+    uint32_t aan[3 * PHILOX_LANES + 5][4];
+    unsigned int i, n = G_N_ELEMENTS(aan);
+
+    philox4x32_fill(aan, n, anCounter, anKey);
+
+    for (i = 0; i < n; i++) {
+        uint64_t c = ((uint64_t) anCounter[1] << 32 | anCounter[0]) + i;
+        uint32_t an[4];
+
+        an[0] = (uint32_t) c;
+        an[1] = (uint32_t) (c >> 32);
+        an[2] = anCounter[2];
+        an[3] = anCounter[3];
+        philox4x32(an, anKey);
+        Check(!memcmp(an, aan[i], sizeof(an)), "philox4x32_fill block");
+    }
+}
+
+static void
+RollTrial(trialdice ad, unsigned int iTrial)
+{
+    unsigned int iTurn, iDraw;
+
+    for (iTurn = 0; iTurn < TURNS; iTurn++)
+        for (iDraw = 0; iDraw < DRAWS; iDraw++)
+            philox_dice(ad[iTurn][iDraw], anKey, iTrial, iTurn, iDraw);
+}
+
+typedef struct {
+    trialdice *aad;
+    gint iNext;
+} rollthreaddata;
+
+/* Roll trials as rollout threads take them, from a shared count */
+static gpointer
+RollThread(gpointer p)
+{
+    rollthreaddata *prtd = p;
+    gint i;
+
+    while ((i = g_atomic_int_add(&prtd->iNext, 1)) < TRIALS)
+        RollTrial(prtd->aad[i], (unsigned int) i);
+
+    return NULL;
+}
+
+static void
+CheckDice(void)
+{
+    trialdice *aadForward = g_new0(trialdice, TRIALS);
+    trialdice *aadBackward = g_new0(trialdice, TRIALS);
+    trialdice *aadThreads = g_new0(trialdice, TRIALS);
+    unsigned int anFaces[7] = { 0 };
+    unsigned int *pn;
+    GThread *apt[THREADS];
+    rollthreaddata rtd;
+    double rChi2 = 0.0;
+    int i, c = TRIALS * TURNS * DRAWS * 2;
+
+    for (i = 0; i < TRIALS; i++)
+        RollTrial(aadForward[i], (unsigned int) i);
+
+    for (i = TRIALS - 1; i >= 0; i--)
+        RollTrial(aadBackward[i], (unsigned int) i);
+
+    rtd.aad = aadThreads;
+    rtd.iNext = 0;
+    for (i = 0; i < THREADS; i++)
+        apt[i] = g_thread_new("philoxtest", RollThread, &rtd);
+    for (i = 0; i < THREADS; i++)
+        g_thread_join(apt[i]);
+
+    Check(!memcmp(aadForward, aadBackward, TRIALS * sizeof(trialdice)), "dice depend on the trial order");
+    Check(!memcmp(aadForward, aadThreads, TRIALS * sizeof(trialdice)), "dice depend on the number of threads");
+
+    for (pn = (unsigned int *) aadForward, i = 0; i < c; i++, pn++) {
+        Check(*pn >= 1 && *pn <= 6, "die out of range");
+        if (*pn >= 1 && *pn <= 6)
+            anFaces[*pn]++;
+    }
+
+    /* 5 degrees of freedom; 20.5 is the 0.1% point */
+    for (i = 1; i <= 6; i++)
+        rChi2 += (anFaces[i] - c / 6.0) * (anFaces[i] - c / 6.0) / (c / 6.0);
+    Check(rChi2 < 20.5, "dice are not uniform");
+
+    g_free(aadForward);
+    g_free(aadBackward);
+    g_free(aadThreads);
+}
+
+extern int
+main(void)
+{
+    CheckKnownAnswers();
+    CheckFill();
+    CheckDice();
+
+    if (cFailed)
+        fprintf(stderr, "%d checks failed\n", cFailed);
+
+    return cFailed ? 1 : 0;
+}
@@ -43,7 +43,8 @@ main(int argc, /*lint -e{818} */ char *argv[])
 {
     neuralnet nn;
     char szFileVersion[16];
-    static float ar[2] = { WEIGHTS_MAGIC_BINARY, WEIGHTS_VERSION_BINARY };
+    /* file header, padded for the nets that follow */
+    static float ar[NN_MAPPED_ALIGN / sizeof(float)] = { WEIGHTS_MAGIC_MAPPED, WEIGHTS_VERSION_BINARY };
     int c;
     FILE *in = stdin, *out = stdout;
 
@@ -91,7 +92,7 @@ main(int argc, /*lint -e{818} */ char *argv[])
         return EXIT_FAILURE;
     }
 
-    if (fwrite(ar, sizeof(ar[0]), 2, out) != 2) {
+    if (fwrite(ar, sizeof(ar), 1, out) != 1) {
         g_printerr(_("Failed to write neural net!"));
         fclose(in);
         fclose(out);
@@ -105,7 +106,7 @@ main(int argc, /*lint -e{818} */ char *argv[])
             fclose(out);
             return EXIT_FAILURE;
         }
-        if (NeuralNetSaveBinary(&nn, out) == -1) {
+        if (NeuralNetSaveMapped(&nn, out) == -1) {
             g_printerr(_("Failed to save neural net!"));
             fclose(in);
             fclose(out);
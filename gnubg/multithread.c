@@ -203,18 +203,22 @@ MT_SetNumThreads(unsigned int num)
         if (num == 1) {         /* No locking in evals */
             EvaluatePosition = EvaluatePositionNoLocking;
             GeneralCubeDecisionE = GeneralCubeDecisionENoLocking;
+            GeneralCubeDecisionEMulti = GeneralCubeDecisionEMultiNoLocking;
             GeneralEvaluationE = GeneralEvaluationENoLocking;
             ScoreMove = ScoreMoveNoLocking;
             FindBestMove = FindBestMoveNoLocking;
             FindnSaveBestMoves = FindnSaveBestMovesNoLocking;
+            FindnSaveBestMovesMulti = FindnSaveBestMovesMultiNoLocking;
             BasicCubefulRollout = BasicCubefulRolloutNoLocking;
         } else {                /* Locking version of evals */
             EvaluatePosition = EvaluatePositionWithLocking;
             GeneralCubeDecisionE = GeneralCubeDecisionEWithLocking;
+            GeneralCubeDecisionEMulti = GeneralCubeDecisionEMultiWithLocking;
             GeneralEvaluationE = GeneralEvaluationEWithLocking;
             ScoreMove = ScoreMoveWithLocking;
             FindBestMove = FindBestMoveWithLocking;
             FindnSaveBestMoves = FindnSaveBestMovesWithLocking;
+            FindnSaveBestMovesMulti = FindnSaveBestMovesMultiWithLocking;
             BasicCubefulRollout = BasicCubefulRolloutWithLocking;
         }
     }
@@ -454,6 +458,15 @@ MT_GetDoneTasks(void)
     return MT_SafeGet(&td.doneTasks);
 }
 
+/* TRUE if the pool may be used for a batch of short tasks. While a
+ * rollout or an analysis is running the pool is busy, and waiting on it
+ * from code reached through its progress callbacks would deadlock. */
+extern int
+MT_Idle(void)
+{
+    return td.numThreads > 1 && td.addedTasks == 0 && !fBackgroundAnalysisRunning;
+}
+
 /* Code below used in calibrate to try and get a resonable figure for multiple threads */
 
 static double start;            /* used for timekeeping */
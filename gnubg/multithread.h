@@ -57,6 +57,8 @@ typedef struct {
     listOLD *plGame;
     statcontext *psc;
     matchstate ms;
+    int *pnDone;                /* incremented when the task has run, or NULL */
+    float rCost;                /* estimated relative cost, for scheduling */
 } AnalyseMoveTask;
 
 typedef struct {
@@ -146,6 +148,7 @@ extern double MT_SyncEnd(void);
 extern void MT_SetResultFailed(void);
 extern void TLSCreate(TLSItem * pItem);
 extern unsigned int MT_GetNumThreads(void);
+extern int MT_Idle(void);
 
 #define MT_GetTLD() ((ThreadLocalData *)TLSGet(td.tlsItem))
 #define MT_GetThreadID() ((ThreadLocalData *)TLSGet(td.tlsItem))->id
@@ -179,6 +182,7 @@ extern int asyncRet;
 #define MT_Exclusive() {}
 #define MT_Release() {}
 #define MT_GetNumThreads() 1
+#define MT_Idle() FALSE
 #define MT_SetResultFailed() asyncRet = -1
 #define MT_SafeInc(x) (++(*x))
 #define MT_SafeIncValue(x) (++(*x))
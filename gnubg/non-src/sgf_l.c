@@ -1,2475 +0,0 @@
-#line 1 "sgf_l.c"
-
-#line 3 "sgf_l.c"
-
-#define  YY_INT_ALIGNED short int
-
-/* A lexical scanner generated by flex */
-
-#define yy_create_buffer sgf_create_buffer
-#define yy_delete_buffer sgf_delete_buffer
-#define yy_scan_buffer sgf_scan_buffer
-#define yy_scan_string sgf_scan_string
-#define yy_scan_bytes sgf_scan_bytes
-#define yy_init_buffer sgf_init_buffer
-#define yy_flush_buffer sgf_flush_buffer
-#define yy_load_buffer_state sgf_load_buffer_state
-#define yy_switch_to_buffer sgf_switch_to_buffer
-#define yypush_buffer_state sgfpush_buffer_state
-#define yypop_buffer_state sgfpop_buffer_state
-#define yyensure_buffer_stack sgfensure_buffer_stack
-#define yy_flex_debug sgf_flex_debug
-#define yyin sgfin
-#define yyleng sgfleng
-#define yylex sgflex
-#define yylineno sgflineno
-#define yyout sgfout
-#define yyrestart sgfrestart
-#define yytext sgftext
-#define yywrap sgfwrap
-#define yyalloc sgfalloc
-#define yyrealloc sgfrealloc
-#define yyfree sgffree
-
-#define FLEX_SCANNER
-#define YY_FLEX_MAJOR_VERSION 2
-#define YY_FLEX_MINOR_VERSION 6
-#define YY_FLEX_SUBMINOR_VERSION 4
-#if YY_FLEX_SUBMINOR_VERSION > 0
-#define FLEX_BETA
-#endif
-
-#ifdef yy_create_buffer
-#define sgf_create_buffer_ALREADY_DEFINED
-#else
-#define yy_create_buffer sgf_create_buffer
-#endif
-
-#ifdef yy_delete_buffer
-#define sgf_delete_buffer_ALREADY_DEFINED
-#else
-#define yy_delete_buffer sgf_delete_buffer
-#endif
-
-#ifdef yy_scan_buffer
-#define sgf_scan_buffer_ALREADY_DEFINED
-#else
-#define yy_scan_buffer sgf_scan_buffer
-#endif
-
-#ifdef yy_scan_string
-#define sgf_scan_string_ALREADY_DEFINED
-#else
-#define yy_scan_string sgf_scan_string
-#endif
-
-#ifdef yy_scan_bytes
-#define sgf_scan_bytes_ALREADY_DEFINED
-#else
-#define yy_scan_bytes sgf_scan_bytes
-#endif
-
-#ifdef yy_init_buffer
-#define sgf_init_buffer_ALREADY_DEFINED
-#else
-#define yy_init_buffer sgf_init_buffer
-#endif
-
-#ifdef yy_flush_buffer
-#define sgf_flush_buffer_ALREADY_DEFINED
-#else
-#define yy_flush_buffer sgf_flush_buffer
-#endif
-
-#ifdef yy_load_buffer_state
-#define sgf_load_buffer_state_ALREADY_DEFINED
-#else
-#define yy_load_buffer_state sgf_load_buffer_state
-#endif
-
-#ifdef yy_switch_to_buffer
-#define sgf_switch_to_buffer_ALREADY_DEFINED
-#else
-#define yy_switch_to_buffer sgf_switch_to_buffer
-#endif
-
-#ifdef yypush_buffer_state
-#define sgfpush_buffer_state_ALREADY_DEFINED
-#else
-#define yypush_buffer_state sgfpush_buffer_state
-#endif
-
-#ifdef yypop_buffer_state
-#define sgfpop_buffer_state_ALREADY_DEFINED
-#else
-#define yypop_buffer_state sgfpop_buffer_state
-#endif
-
-#ifdef yyensure_buffer_stack
-#define sgfensure_buffer_stack_ALREADY_DEFINED
-#else
-#define yyensure_buffer_stack sgfensure_buffer_stack
-#endif
-
-#ifdef yylex
-#define sgflex_ALREADY_DEFINED
-#else
-#define yylex sgflex
-#endif
-
-#ifdef yyrestart
-#define sgfrestart_ALREADY_DEFINED
-#else
-#define yyrestart sgfrestart
-#endif
-
-#ifdef yylex_init
-#define sgflex_init_ALREADY_DEFINED
-#else
-#define yylex_init sgflex_init
-#endif
-
-#ifdef yylex_init_extra
-#define sgflex_init_extra_ALREADY_DEFINED
-#else
-#define yylex_init_extra sgflex_init_extra
-#endif
-
-#ifdef yylex_destroy
-#define sgflex_destroy_ALREADY_DEFINED
-#else
-#define yylex_destroy sgflex_destroy
-#endif
-
-#ifdef yyget_debug
-#define sgfget_debug_ALREADY_DEFINED
-#else
-#define yyget_debug sgfget_debug
-#endif
-
-#ifdef yyset_debug
-#define sgfset_debug_ALREADY_DEFINED
-#else
-#define yyset_debug sgfset_debug
-#endif
-
-#ifdef yyget_extra
-#define sgfget_extra_ALREADY_DEFINED
-#else
-#define yyget_extra sgfget_extra
-#endif
-
-#ifdef yyset_extra
-#define sgfset_extra_ALREADY_DEFINED
-#else
-#define yyset_extra sgfset_extra
-#endif
-
-#ifdef yyget_in
-#define sgfget_in_ALREADY_DEFINED
-#else
-#define yyget_in sgfget_in
-#endif
-
-#ifdef yyset_in
-#define sgfset_in_ALREADY_DEFINED
-#else
-#define yyset_in sgfset_in
-#endif
-
-#ifdef yyget_out
-#define sgfget_out_ALREADY_DEFINED
-#else
-#define yyget_out sgfget_out
-#endif
-
-#ifdef yyset_out
-#define sgfset_out_ALREADY_DEFINED
-#else
-#define yyset_out sgfset_out
-#endif
-
-#ifdef yyget_leng
-#define sgfget_leng_ALREADY_DEFINED
-#else
-#define yyget_leng sgfget_leng
-#endif
-
-#ifdef yyget_text
-#define sgfget_text_ALREADY_DEFINED
-#else
-#define yyget_text sgfget_text
-#endif
-
-#ifdef yyget_lineno
-#define sgfget_lineno_ALREADY_DEFINED
-#else
-#define yyget_lineno sgfget_lineno
-#endif
-
-#ifdef yyset_lineno
-#define sgfset_lineno_ALREADY_DEFINED
-#else
-#define yyset_lineno sgfset_lineno
-#endif
-
-#ifdef yywrap
-#define sgfwrap_ALREADY_DEFINED
-#else
-#define yywrap sgfwrap
-#endif
-
-#ifdef yyalloc
-#define sgfalloc_ALREADY_DEFINED
-#else
-#define yyalloc sgfalloc
-#endif
-
-#ifdef yyrealloc
-#define sgfrealloc_ALREADY_DEFINED
-#else
-#define yyrealloc sgfrealloc
-#endif
-
-#ifdef yyfree
-#define sgffree_ALREADY_DEFINED
-#else
-#define yyfree sgffree
-#endif
-
-#ifdef yytext
-#define sgftext_ALREADY_DEFINED
-#else
-#define yytext sgftext
-#endif
-
-#ifdef yyleng
-#define sgfleng_ALREADY_DEFINED
-#else
-#define yyleng sgfleng
-#endif
-
-#ifdef yyin
-#define sgfin_ALREADY_DEFINED
-#else
-#define yyin sgfin
-#endif
-
-#ifdef yyout
-#define sgfout_ALREADY_DEFINED
-#else
-#define yyout sgfout
-#endif
-
-#ifdef yy_flex_debug
-#define sgf_flex_debug_ALREADY_DEFINED
-#else
-#define yy_flex_debug sgf_flex_debug
-#endif
-
-#ifdef yylineno
-#define sgflineno_ALREADY_DEFINED
-#else
-#define yylineno sgflineno
-#endif
-
-/* First, we deal with  platform-specific or compiler-specific issues. */
-
-/* begin standard C headers. */
-#include <stdio.h>
-#include <string.h>
-#include <errno.h>
-#include <stdlib.h>
-
-/* end standard C headers. */
-
-/* flex integer type definitions */
-
-#ifndef FLEXINT_H
-#define FLEXINT_H
-
-/* C99 systems have <inttypes.h>. Non-C99 systems may or may not. */
-
-#if defined(__FreeBSD__) || \
-    (defined (__STDC_VERSION__) && __STDC_VERSION__ >= 199901L)
-
-/* C99 says to define __STDC_LIMIT_MACROS before including stdint.h,
- * if you want the limit (max/min) macros for int types. 
- */
-#ifndef __STDC_LIMIT_MACROS
-#define __STDC_LIMIT_MACROS 1
-#endif
-
-#include <inttypes.h>
-typedef int8_t flex_int8_t;
-typedef uint8_t flex_uint8_t;
-typedef int16_t flex_int16_t;
-typedef uint16_t flex_uint16_t;
-typedef int32_t flex_int32_t;
-typedef uint32_t flex_uint32_t;
-#else
-typedef signed char flex_int8_t;
-typedef short int flex_int16_t;
-typedef int flex_int32_t;
-typedef unsigned char flex_uint8_t; 
-typedef unsigned short int flex_uint16_t;
-typedef unsigned int flex_uint32_t;
-
-/* Limits of integral types. */
-#ifndef INT8_MIN
-#define INT8_MIN               (-128)
-#endif
-#ifndef INT16_MIN
-#define INT16_MIN              (-32767-1)
-#endif
-#ifndef INT32_MIN
-#define INT32_MIN              (-2147483647-1)
-#endif
-#ifndef INT8_MAX
-#define INT8_MAX               (127)
-#endif
-#ifndef INT16_MAX
-#define INT16_MAX              (32767)
-#endif
-#ifndef INT32_MAX
-#define INT32_MAX              (2147483647)
-#endif
-#ifndef UINT8_MAX
-#define UINT8_MAX              (255U)
-#endif
-#ifndef UINT16_MAX
-#define UINT16_MAX             (65535U)
-#endif
-#ifndef UINT32_MAX
-#define UINT32_MAX             (4294967295U)
-#endif
-
-#ifndef SIZE_MAX
-#define SIZE_MAX               (~(size_t)0)
-#endif
-
-#endif /* ! C99 */
-
-#endif /* ! FLEXINT_H */
-
-/* begin standard C++ headers. */
-
-/* TODO: this is always defined, so inline it */
-#define yyconst const
-
-#if defined(__GNUC__) && __GNUC__ >= 3
-#define yynoreturn __attribute__((__noreturn__))
-#else
-#define yynoreturn
-#endif
-
-/* Returned upon end-of-file. */
-#define YY_NULL 0
-
-/* Promotes a possibly negative, possibly signed char to an
- *   integer in range [0..255] for use as an array index.
- */
-#define YY_SC_TO_UI(c) ((YY_CHAR) (c))
-
-/* Enter a start condition.  This macro really ought to take a parameter,
- * but we do it the disgusting crufty way forced on us by the ()-less
- * definition of BEGIN.
- */
-#define BEGIN (yy_start) = 1 + 2 *
-/* Translate the current start state into a value that can be later handed
- * to BEGIN to return to the state.  The YYSTATE alias is for lex
- * compatibility.
- */
-#define YY_START (((yy_start) - 1) / 2)
-#define YYSTATE YY_START
-/* Action number for EOF rule of a given start state. */
-#define YY_STATE_EOF(state) (YY_END_OF_BUFFER + state + 1)
-/* Special action meaning "start processing a new file". */
-#define YY_NEW_FILE yyrestart( yyin  )
-#define YY_END_OF_BUFFER_CHAR 0
-
-/* Size of default input buffer. */
-#ifndef YY_BUF_SIZE
-#ifdef __ia64__
-/* On IA-64, the buffer size is 16k, not 8k.
- * Moreover, YY_BUF_SIZE is 2*YY_READ_BUF_SIZE in the general case.
- * Ditto for the __ia64__ case accordingly.
- */
-#define YY_BUF_SIZE 32768
-#else
-#define YY_BUF_SIZE 16384
-#endif /* __ia64__ */
-#endif
-
-/* The state buf must be large enough to hold one state per character in the main buffer.
- */
-#define YY_STATE_BUF_SIZE   ((YY_BUF_SIZE + 2) * sizeof(yy_state_type))
-
-#ifndef YY_TYPEDEF_YY_BUFFER_STATE
-#define YY_TYPEDEF_YY_BUFFER_STATE
-typedef struct yy_buffer_state *YY_BUFFER_STATE;
-#endif
-
-#ifndef YY_TYPEDEF_YY_SIZE_T
-#define YY_TYPEDEF_YY_SIZE_T
-typedef size_t yy_size_t;
-#endif
-
-extern int yyleng;
-
-extern FILE *yyin, *yyout;
-
-#define EOB_ACT_CONTINUE_SCAN 0
-#define EOB_ACT_END_OF_FILE 1
-#define EOB_ACT_LAST_MATCH 2
-    
-    #define YY_LESS_LINENO(n)
-    #define YY_LINENO_REWIND_TO(ptr)
-    
-/* Return all but the first "n" matched characters back to the input stream. */
-#define yyless(n) \
-	do \
-		{ \
-		/* Undo effects of setting up yytext. */ \
-        int yyless_macro_arg = (n); \
-        YY_LESS_LINENO(yyless_macro_arg);\
-		*yy_cp = (yy_hold_char); \
-		YY_RESTORE_YY_MORE_OFFSET \
-		(yy_c_buf_p) = yy_cp = yy_bp + yyless_macro_arg - YY_MORE_ADJ; \
-		YY_DO_BEFORE_ACTION; /* set up yytext again */ \
-		} \
-	while ( 0 )
-#define unput(c) yyunput( c, (yytext_ptr)  )
-
-#ifndef YY_STRUCT_YY_BUFFER_STATE
-#define YY_STRUCT_YY_BUFFER_STATE
-struct yy_buffer_state
-	{
-	FILE *yy_input_file;
-
-	char *yy_ch_buf;		/* input buffer */
-	char *yy_buf_pos;		/* current position in input buffer */
-
-	/* Size of input buffer in bytes, not including room for EOB
-	 * characters.
-	 */
-	int yy_buf_size;
-
-	/* Number of characters read into yy_ch_buf, not including EOB
-	 * characters.
-	 */
-	int yy_n_chars;
-
-	/* Whether we "own" the buffer - i.e., we know we created it,
-	 * and can realloc() it to grow it, and should free() it to
-	 * delete it.
-	 */
-	int yy_is_our_buffer;
-
-	/* Whether this is an "interactive" input source; if so, and
-	 * if we're using stdio for input, then we want to use getc()
-	 * instead of fread(), to make sure we stop fetching input after
-	 * each newline.
-	 */
-	int yy_is_interactive;
-
-	/* Whether we're considered to be at the beginning of a line.
-	 * If so, '^' rules will be active on the next match, otherwise
-	 * not.
-	 */
-	int yy_at_bol;
-
-    int yy_bs_lineno; /**< The line count. */
-    int yy_bs_column; /**< The column count. */
-
-	/* Whether to try to fill the input buffer when we reach the
-	 * end of it.
-	 */
-	int yy_fill_buffer;
-
-	int yy_buffer_status;
-
-#define YY_BUFFER_NEW 0
-#define YY_BUFFER_NORMAL 1
-	/* When an EOF's been seen but there's still some text to process
-	 * then we mark the buffer as YY_EOF_PENDING, to indicate that we
-	 * shouldn't try reading from the input source any more.  We might
-	 * still have a bunch of tokens to match, though, because of
-	 * possible backing-up.
-	 *
-	 * When we actually see the EOF, we change the status to "new"
-	 * (via yyrestart()), so that the user can continue scanning by
-	 * just pointing yyin at a new input file.
-	 */
-#define YY_BUFFER_EOF_PENDING 2
-
-	};
-#endif /* !YY_STRUCT_YY_BUFFER_STATE */
-
-/* Stack of input buffers. */
-static size_t yy_buffer_stack_top = 0; /**< index of top of stack. */
-static size_t yy_buffer_stack_max = 0; /**< capacity of stack. */
-static YY_BUFFER_STATE * yy_buffer_stack = NULL; /**< Stack as an array. */
-
-/* We provide macros for accessing buffer states in case in the
- * future we want to put the buffer states in a more general
- * "scanner state".
- *
- * Returns the top of the stack, or NULL.
- */
-#define YY_CURRENT_BUFFER ( (yy_buffer_stack) \
-                          ? (yy_buffer_stack)[(yy_buffer_stack_top)] \
-                          : NULL)
-#define yy_current_buffer YY_CURRENT_BUFFER
-/* Same as previous macro, but useful when we know that the buffer stack is not
- * NULL or when we need an lvalue. For internal use only.
- */
-#define YY_CURRENT_BUFFER_LVALUE (yy_buffer_stack)[(yy_buffer_stack_top)]
-
-/* yy_hold_char holds the character lost when yytext is formed. */
-static char yy_hold_char;
-static int yy_n_chars;		/* number of characters read into yy_ch_buf */
-int yyleng;
-
-/* Points to current character in buffer. */
-static char *yy_c_buf_p = NULL;
-static int yy_init = 0;		/* whether we need to initialize */
-static int yy_start = 0;	/* start state number */
-
-/* Flag which is used to allow yywrap()'s to do buffer switches
- * instead of setting up a fresh yyin.  A bit of a hack ...
- */
-static int yy_did_buffer_switch_on_eof;
-
-void yyrestart ( FILE *input_file  );
-void yy_switch_to_buffer ( YY_BUFFER_STATE new_buffer  );
-YY_BUFFER_STATE yy_create_buffer ( FILE *file, int size  );
-void yy_delete_buffer ( YY_BUFFER_STATE b  );
-void yy_flush_buffer ( YY_BUFFER_STATE b  );
-void yypush_buffer_state ( YY_BUFFER_STATE new_buffer  );
-void yypop_buffer_state ( void );
-
-static void yyensure_buffer_stack ( void );
-static void yy_load_buffer_state ( void );
-static void yy_init_buffer ( YY_BUFFER_STATE b, FILE *file  );
-#define YY_FLUSH_BUFFER yy_flush_buffer( YY_CURRENT_BUFFER )
-
-YY_BUFFER_STATE yy_scan_buffer ( char *base, yy_size_t size  );
-YY_BUFFER_STATE yy_scan_string ( const char *yy_str  );
-YY_BUFFER_STATE yy_scan_bytes ( const char *bytes, int len  );
-
-void *yyalloc ( yy_size_t  );
-void *yyrealloc ( void *, yy_size_t  );
-void yyfree ( void *  );
-
-#define yy_new_buffer yy_create_buffer
-#define yy_set_interactive(is_interactive) \
-	{ \
-	if ( ! YY_CURRENT_BUFFER ){ \
-        yyensure_buffer_stack (); \
-		YY_CURRENT_BUFFER_LVALUE =    \
-            yy_create_buffer( yyin, YY_BUF_SIZE ); \
-	} \
-	YY_CURRENT_BUFFER_LVALUE->yy_is_interactive = is_interactive; \
-	}
-#define yy_set_bol(at_bol) \
-	{ \
-	if ( ! YY_CURRENT_BUFFER ){\
-        yyensure_buffer_stack (); \
-		YY_CURRENT_BUFFER_LVALUE =    \
-            yy_create_buffer( yyin, YY_BUF_SIZE ); \
-	} \
-	YY_CURRENT_BUFFER_LVALUE->yy_at_bol = at_bol; \
-	}
-#define YY_AT_BOL() (YY_CURRENT_BUFFER_LVALUE->yy_at_bol)
-
-/* Begin user sect3 */
-
-#define sgfwrap() (/*CONSTCOND*/1)
-#define YY_SKIP_YYWRAP
-typedef flex_uint8_t YY_CHAR;
-
-FILE *yyin = NULL, *yyout = NULL;
-
-typedef const struct yy_trans_info *yy_state_type;
-
-extern int yylineno;
-int yylineno = 1;
-
-extern char *yytext;
-#ifdef yytext_ptr
-#undef yytext_ptr
-#endif
-#define yytext_ptr yytext
-
-static yy_state_type yy_get_previous_state ( void );
-static yy_state_type yy_try_NUL_trans ( yy_state_type current_state  );
-static int yy_get_next_buffer ( void );
-static void yynoreturn yy_fatal_error ( const char* msg  );
-
-/* Done after the current pattern has been matched and before the
- * corresponding action - sets up yytext.
- */
-#define YY_DO_BEFORE_ACTION \
-	(yytext_ptr) = yy_bp; \
-	yyleng = (int) (yy_cp - yy_bp); \
-	(yy_hold_char) = *yy_cp; \
-	*yy_cp = '\0'; \
-	(yy_c_buf_p) = yy_cp;
-#define YY_NUM_RULES 13
-#define YY_END_OF_BUFFER 14
-struct yy_trans_info
-	{
-	flex_int16_t yy_verify;
-	flex_int16_t yy_nxt;
-	};
-static const struct yy_trans_info yy_transition[2845] =
-    {
- {   0,   0 }, {   0,2589 }, {   0,   0 }, {   0,2587 }, {   1,1032 },
- {   2,1032 }, {   3,1032 }, {   4,1032 }, {   5,1032 }, {   6,1032 },
- {   7,1032 }, {   8,1032 }, {   9,1034 }, {  10,1039 }, {  11,1034 },
- {  12,1034 }, {  13,1034 }, {  14,1032 }, {  15,1032 }, {  16,1032 },
- {  17,1032 }, {  18,1032 }, {  19,1032 }, {  20,1032 }, {  21,1032 },
- {  22,1032 }, {  23,1032 }, {  24,1032 }, {  25,1032 }, {  26,1032 },
- {  27,1032 }, {  28,1032 }, {  29,1032 }, {  30,1032 }, {  31,1032 },
- {  32,1034 }, {  33,1032 }, {  34,1032 }, {  35,1032 }, {  36,1032 },
- {  37,1032 }, {  38,1032 }, {  39,1032 }, {  40,1036 }, {  41,1036 },
- {  42,1032 }, {  43,1032 }, {  44,1032 }, {  45,1032 }, {  46,1032 },
-
- {  47,1032 }, {  48,1032 }, {  49,1032 }, {  50,1032 }, {  51,1032 },
- {  52,1032 }, {  53,1032 }, {  54,1032 }, {  55,1032 }, {  56,1032 },
- {  57,1032 }, {  58,1032 }, {  59,1036 }, {  60,1032 }, {  61,1032 },
- {  62,1032 }, {  63,1032 }, {  64,1032 }, {  65,1041 }, {  66,1041 },
- {  67,1041 }, {  68,1041 }, {  69,1041 }, {  70,1041 }, {  71,1041 },
- {  72,1041 }, {  73,1041 }, {  74,1041 }, {  75,1041 }, {  76,1041 },
- {  77,1041 }, {  78,1041 }, {  79,1041 }, {  80,1041 }, {  81,1041 },
- {  82,1041 }, {  83,1041 }, {  84,1041 }, {  85,1041 }, {  86,1041 },
- {  87,1041 }, {  88,1041 }, {  89,1041 }, {  90,1041 }, {  91,1054 },
- {  92,1032 }, {  93,1032 }, {  94,1032 }, {  95,1032 }, {  96,1032 },
-
- {  97,1099 }, {  98,1099 }, {  99,1099 }, { 100,1099 }, { 101,1099 },
- { 102,1099 }, { 103,1099 }, { 104,1099 }, { 105,1099 }, { 106,1099 },
- { 107,1099 }, { 108,1099 }, { 109,1099 }, { 110,1099 }, { 111,1099 },
- { 112,1099 }, { 113,1099 }, { 114,1099 }, { 115,1099 }, { 116,1099 },
- { 117,1099 }, { 118,1099 }, { 119,1099 }, { 120,1099 }, { 121,1099 },
- { 122,1099 }, { 123,1032 }, { 124,1032 }, { 125,1032 }, { 126,1032 },
- { 127,1032 }, { 128,1032 }, { 129,1032 }, { 130,1032 }, { 131,1032 },
- { 132,1032 }, { 133,1032 }, { 134,1032 }, { 135,1032 }, { 136,1032 },
- { 137,1032 }, { 138,1032 }, { 139,1032 }, { 140,1032 }, { 141,1032 },
- { 142,1032 }, { 143,1032 }, { 144,1032 }, { 145,1032 }, { 146,1032 },
-
- { 147,1032 }, { 148,1032 }, { 149,1032 }, { 150,1032 }, { 151,1032 },
- { 152,1032 }, { 153,1032 }, { 154,1032 }, { 155,1032 }, { 156,1032 },
- { 157,1032 }, { 158,1032 }, { 159,1032 }, { 160,1032 }, { 161,1032 },
- { 162,1032 }, { 163,1032 }, { 164,1032 }, { 165,1032 }, { 166,1032 },
- { 167,1032 }, { 168,1032 }, { 169,1032 }, { 170,1032 }, { 171,1032 },
- { 172,1032 }, { 173,1032 }, { 174,1032 }, { 175,1032 }, { 176,1032 },
- { 177,1032 }, { 178,1032 }, { 179,1032 }, { 180,1032 }, { 181,1032 },
- { 182,1032 }, { 183,1032 }, { 184,1032 }, { 185,1032 }, { 186,1032 },
- { 187,1032 }, { 188,1032 }, { 189,1032 }, { 190,1032 }, { 191,1032 },
- { 192,1032 }, { 193,1032 }, { 194,1032 }, { 195,1032 }, { 196,1032 },
-
- { 197,1032 }, { 198,1032 }, { 199,1032 }, { 200,1032 }, { 201,1032 },
- { 202,1032 }, { 203,1032 }, { 204,1032 }, { 205,1032 }, { 206,1032 },
- { 207,1032 }, { 208,1032 }, { 209,1032 }, { 210,1032 }, { 211,1032 },
- { 212,1032 }, { 213,1032 }, { 214,1032 }, { 215,1032 }, { 216,1032 },
- { 217,1032 }, { 218,1032 }, { 219,1032 }, { 220,1032 }, { 221,1032 },
- { 222,1032 }, { 223,1032 }, { 224,1032 }, { 225,1032 }, { 226,1032 },
- { 227,1032 }, { 228,1032 }, { 229,1032 }, { 230,1032 }, { 231,1032 },
- { 232,1032 }, { 233,1032 }, { 234,1032 }, { 235,1032 }, { 236,1032 },
- { 237,1032 }, { 238,1032 }, { 239,1032 }, { 240,1032 }, { 241,1032 },
- { 242,1032 }, { 243,1032 }, { 244,1032 }, { 245,1032 }, { 246,1032 },
-
- { 247,1032 }, { 248,1032 }, { 249,1032 }, { 250,1032 }, { 251,1032 },
- { 252,1032 }, { 253,1032 }, { 254,1032 }, { 255,1032 }, { 256,1032 },
- {   0,   0 }, {   0,2329 }, {   1, 774 }, {   2, 774 }, {   3, 774 },
- {   4, 774 }, {   5, 774 }, {   6, 774 }, {   7, 774 }, {   8, 774 },
- {   9, 776 }, {  10, 781 }, {  11, 776 }, {  12, 776 }, {  13, 776 },
- {  14, 774 }, {  15, 774 }, {  16, 774 }, {  17, 774 }, {  18, 774 },
- {  19, 774 }, {  20, 774 }, {  21, 774 }, {  22, 774 }, {  23, 774 },
- {  24, 774 }, {  25, 774 }, {  26, 774 }, {  27, 774 }, {  28, 774 },
- {  29, 774 }, {  30, 774 }, {  31, 774 }, {  32, 776 }, {  33, 774 },
- {  34, 774 }, {  35, 774 }, {  36, 774 }, {  37, 774 }, {  38, 774 },
-
- {  39, 774 }, {  40, 778 }, {  41, 778 }, {  42, 774 }, {  43, 774 },
- {  44, 774 }, {  45, 774 }, {  46, 774 }, {  47, 774 }, {  48, 774 },
- {  49, 774 }, {  50, 774 }, {  51, 774 }, {  52, 774 }, {  53, 774 },
- {  54, 774 }, {  55, 774 }, {  56, 774 }, {  57, 774 }, {  58, 774 },
- {  59, 778 }, {  60, 774 }, {  61, 774 }, {  62, 774 }, {  63, 774 },
- {  64, 774 }, {  65, 783 }, {  66, 783 }, {  67, 783 }, {  68, 783 },
- {  69, 783 }, {  70, 783 }, {  71, 783 }, {  72, 783 }, {  73, 783 },
- {  74, 783 }, {  75, 783 }, {  76, 783 }, {  77, 783 }, {  78, 783 },
- {  79, 783 }, {  80, 783 }, {  81, 783 }, {  82, 783 }, {  83, 783 },
- {  84, 783 }, {  85, 783 }, {  86, 783 }, {  87, 783 }, {  88, 783 },
-
- {  89, 783 }, {  90, 783 }, {  91, 796 }, {  92, 774 }, {  93, 774 },
- {  94, 774 }, {  95, 774 }, {  96, 774 }, {  97, 841 }, {  98, 841 },
- {  99, 841 }, { 100, 841 }, { 101, 841 }, { 102, 841 }, { 103, 841 },
- { 104, 841 }, { 105, 841 }, { 106, 841 }, { 107, 841 }, { 108, 841 },
- { 109, 841 }, { 110, 841 }, { 111, 841 }, { 112, 841 }, { 113, 841 },
- { 114, 841 }, { 115, 841 }, { 116, 841 }, { 117, 841 }, { 118, 841 },
- { 119, 841 }, { 120, 841 }, { 121, 841 }, { 122, 841 }, { 123, 774 },
- { 124, 774 }, { 125, 774 }, { 126, 774 }, { 127, 774 }, { 128, 774 },
- { 129, 774 }, { 130, 774 }, { 131, 774 }, { 132, 774 }, { 133, 774 },
- { 134, 774 }, { 135, 774 }, { 136, 774 }, { 137, 774 }, { 138, 774 },
-
- { 139, 774 }, { 140, 774 }, { 141, 774 }, { 142, 774 }, { 143, 774 },
- { 144, 774 }, { 145, 774 }, { 146, 774 }, { 147, 774 }, { 148, 774 },
- { 149, 774 }, { 150, 774 }, { 151, 774 }, { 152, 774 }, { 153, 774 },
- { 154, 774 }, { 155, 774 }, { 156, 774 }, { 157, 774 }, { 158, 774 },
- { 159, 774 }, { 160, 774 }, { 161, 774 }, { 162, 774 }, { 163, 774 },
- { 164, 774 }, { 165, 774 }, { 166, 774 }, { 167, 774 }, { 168, 774 },
- { 169, 774 }, { 170, 774 }, { 171, 774 }, { 172, 774 }, { 173, 774 },
- { 174, 774 }, { 175, 774 }, { 176, 774 }, { 177, 774 }, { 178, 774 },
- { 179, 774 }, { 180, 774 }, { 181, 774 }, { 182, 774 }, { 183, 774 },
- { 184, 774 }, { 185, 774 }, { 186, 774 }, { 187, 774 }, { 188, 774 },
-
- { 189, 774 }, { 190, 774 }, { 191, 774 }, { 192, 774 }, { 193, 774 },
- { 194, 774 }, { 195, 774 }, { 196, 774 }, { 197, 774 }, { 198, 774 },
- { 199, 774 }, { 200, 774 }, { 201, 774 }, { 202, 774 }, { 203, 774 },
- { 204, 774 }, { 205, 774 }, { 206, 774 }, { 207, 774 }, { 208, 774 },
- { 209, 774 }, { 210, 774 }, { 211, 774 }, { 212, 774 }, { 213, 774 },
- { 214, 774 }, { 215, 774 }, { 216, 774 }, { 217, 774 }, { 218, 774 },
- { 219, 774 }, { 220, 774 }, { 221, 774 }, { 222, 774 }, { 223, 774 },
- { 224, 774 }, { 225, 774 }, { 226, 774 }, { 227, 774 }, { 228, 774 },
- { 229, 774 }, { 230, 774 }, { 231, 774 }, { 232, 774 }, { 233, 774 },
- { 234, 774 }, { 235, 774 }, { 236, 774 }, { 237, 774 }, { 238, 774 },
-
- { 239, 774 }, { 240, 774 }, { 241, 774 }, { 242, 774 }, { 243, 774 },
- { 244, 774 }, { 245, 774 }, { 246, 774 }, { 247, 774 }, { 248, 774 },
- { 249, 774 }, { 250, 774 }, { 251, 774 }, { 252, 774 }, { 253, 774 },
- { 254, 774 }, { 255, 774 }, { 256, 774 }, {   0,   0 }, {   0,2071 },
- {   1, 707 }, {   2, 707 }, {   3, 707 }, {   4, 707 }, {   5, 707 },
- {   6, 707 }, {   7, 707 }, {   8, 707 }, {   9, 707 }, {  10, 707 },
- {  11, 707 }, {  12, 707 }, {  13, 707 }, {  14, 707 }, {  15, 707 },
- {  16, 707 }, {  17, 707 }, {  18, 707 }, {  19, 707 }, {  20, 707 },
- {  21, 707 }, {  22, 707 }, {  23, 707 }, {  24, 707 }, {  25, 707 },
- {  26, 707 }, {  27, 707 }, {  28, 707 }, {  29, 707 }, {  30, 707 },
-
- {  31, 707 }, {  32, 707 }, {  33, 707 }, {  34, 707 }, {  35, 707 },
- {  36, 707 }, {  37, 707 }, {  38, 707 }, {  39, 707 }, {  40, 707 },
- {  41, 707 }, {  42, 707 }, {  43, 707 }, {  44, 707 }, {  45, 707 },
- {  46, 707 }, {  47, 707 }, {  48, 707 }, {  49, 707 }, {  50, 707 },
- {  51, 707 }, {  52, 707 }, {  53, 707 }, {  54, 707 }, {  55, 707 },
- {  56, 707 }, {  57, 707 }, {  58, 707 }, {  59, 707 }, {  60, 707 },
- {  61, 707 }, {  62, 707 }, {  63, 707 }, {  64, 707 }, {  65, 707 },
- {  66, 707 }, {  67, 707 }, {  68, 707 }, {  69, 707 }, {  70, 707 },
- {  71, 707 }, {  72, 707 }, {  73, 707 }, {  74, 707 }, {  75, 707 },
- {  76, 707 }, {  77, 707 }, {  78, 707 }, {  79, 707 }, {  80, 707 },
-
- {  81, 707 }, {  82, 707 }, {  83, 707 }, {  84, 707 }, {  85, 707 },
- {  86, 707 }, {  87, 707 }, {  88, 707 }, {  89, 707 }, {  90, 707 },
- {  91, 707 }, {  92, 964 }, {  93, 540 }, {  94, 707 }, {  95, 707 },
- {  96, 707 }, {  97, 707 }, {  98, 707 }, {  99, 707 }, { 100, 707 },
- { 101, 707 }, { 102, 707 }, { 103, 707 }, { 104, 707 }, { 105, 707 },
- { 106, 707 }, { 107, 707 }, { 108, 707 }, { 109, 707 }, { 110, 707 },
- { 111, 707 }, { 112, 707 }, { 113, 707 }, { 114, 707 }, { 115, 707 },
- { 116, 707 }, { 117, 707 }, { 118, 707 }, { 119, 707 }, { 120, 707 },
- { 121, 707 }, { 122, 707 }, { 123, 707 }, { 124, 707 }, { 125, 707 },
- { 126, 707 }, { 127, 707 }, { 128, 707 }, { 129, 707 }, { 130, 707 },
-
- { 131, 707 }, { 132, 707 }, { 133, 707 }, { 134, 707 }, { 135, 707 },
- { 136, 707 }, { 137, 707 }, { 138, 707 }, { 139, 707 }, { 140, 707 },
- { 141, 707 }, { 142, 707 }, { 143, 707 }, { 144, 707 }, { 145, 707 },
- { 146, 707 }, { 147, 707 }, { 148, 707 }, { 149, 707 }, { 150, 707 },
- { 151, 707 }, { 152, 707 }, { 153, 707 }, { 154, 707 }, { 155, 707 },
- { 156, 707 }, { 157, 707 }, { 158, 707 }, { 159, 707 }, { 160, 707 },
- { 161, 707 }, { 162, 707 }, { 163, 707 }, { 164, 707 }, { 165, 707 },
- { 166, 707 }, { 167, 707 }, { 168, 707 }, { 169, 707 }, { 170, 707 },
- { 171, 707 }, { 172, 707 }, { 173, 707 }, { 174, 707 }, { 175, 707 },
- { 176, 707 }, { 177, 707 }, { 178, 707 }, { 179, 707 }, { 180, 707 },
-
- { 181, 707 }, { 182, 707 }, { 183, 707 }, { 184, 707 }, { 185, 707 },
- { 186, 707 }, { 187, 707 }, { 188, 707 }, { 189, 707 }, { 190, 707 },
- { 191, 707 }, { 192, 707 }, { 193, 707 }, { 194, 707 }, { 195, 707 },
- { 196, 707 }, { 197, 707 }, { 198, 707 }, { 199, 707 }, { 200, 707 },
- { 201, 707 }, { 202, 707 }, { 203, 707 }, { 204, 707 }, { 205, 707 },
- { 206, 707 }, { 207, 707 }, { 208, 707 }, { 209, 707 }, { 210, 707 },
- { 211, 707 }, { 212, 707 }, { 213, 707 }, { 214, 707 }, { 215, 707 },
- { 216, 707 }, { 217, 707 }, { 218, 707 }, { 219, 707 }, { 220, 707 },
- { 221, 707 }, { 222, 707 }, { 223, 707 }, { 224, 707 }, { 225, 707 },
- { 226, 707 }, { 227, 707 }, { 228, 707 }, { 229, 707 }, { 230, 707 },
-
- { 231, 707 }, { 232, 707 }, { 233, 707 }, { 234, 707 }, { 235, 707 },
- { 236, 707 }, { 237, 707 }, { 238, 707 }, { 239, 707 }, { 240, 707 },
- { 241, 707 }, { 242, 707 }, { 243, 707 }, { 244, 707 }, { 245, 707 },
- { 246, 707 }, { 247, 707 }, { 248, 707 }, { 249, 707 }, { 250, 707 },
- { 251, 707 }, { 252, 707 }, { 253, 707 }, { 254, 707 }, { 255, 707 },
- { 256, 542 }, {   0,   0 }, {   0,1813 }, {   1, 449 }, {   2, 449 },
- {   3, 449 }, {   4, 449 }, {   5, 449 }, {   6, 449 }, {   7, 449 },
- {   8, 449 }, {   9, 449 }, {  10, 449 }, {  11, 449 }, {  12, 449 },
- {  13, 449 }, {  14, 449 }, {  15, 449 }, {  16, 449 }, {  17, 449 },
- {  18, 449 }, {  19, 449 }, {  20, 449 }, {  21, 449 }, {  22, 449 },
-
- {  23, 449 }, {  24, 449 }, {  25, 449 }, {  26, 449 }, {  27, 449 },
- {  28, 449 }, {  29, 449 }, {  30, 449 }, {  31, 449 }, {  32, 449 },
- {  33, 449 }, {  34, 449 }, {  35, 449 }, {  36, 449 }, {  37, 449 },
- {  38, 449 }, {  39, 449 }, {  40, 449 }, {  41, 449 }, {  42, 449 },
- {  43, 449 }, {  44, 449 }, {  45, 449 }, {  46, 449 }, {  47, 449 },
- {  48, 449 }, {  49, 449 }, {  50, 449 }, {  51, 449 }, {  52, 449 },
- {  53, 449 }, {  54, 449 }, {  55, 449 }, {  56, 449 }, {  57, 449 },
- {  58, 449 }, {  59, 449 }, {  60, 449 }, {  61, 449 }, {  62, 449 },
- {  63, 449 }, {  64, 449 }, {  65, 449 }, {  66, 449 }, {  67, 449 },
- {  68, 449 }, {  69, 449 }, {  70, 449 }, {  71, 449 }, {  72, 449 },
-
- {  73, 449 }, {  74, 449 }, {  75, 449 }, {  76, 449 }, {  77, 449 },
- {  78, 449 }, {  79, 449 }, {  80, 449 }, {  81, 449 }, {  82, 449 },
- {  83, 449 }, {  84, 449 }, {  85, 449 }, {  86, 449 }, {  87, 449 },
- {  88, 449 }, {  89, 449 }, {  90, 449 }, {  91, 449 }, {  92, 706 },
- {  93, 282 }, {  94, 449 }, {  95, 449 }, {  96, 449 }, {  97, 449 },
- {  98, 449 }, {  99, 449 }, { 100, 449 }, { 101, 449 }, { 102, 449 },
- { 103, 449 }, { 104, 449 }, { 105, 449 }, { 106, 449 }, { 107, 449 },
- { 108, 449 }, { 109, 449 }, { 110, 449 }, { 111, 449 }, { 112, 449 },
- { 113, 449 }, { 114, 449 }, { 115, 449 }, { 116, 449 }, { 117, 449 },
- { 118, 449 }, { 119, 449 }, { 120, 449 }, { 121, 449 }, { 122, 449 },
-
- { 123, 449 }, { 124, 449 }, { 125, 449 }, { 126, 449 }, { 127, 449 },
- { 128, 449 }, { 129, 449 }, { 130, 449 }, { 131, 449 }, { 132, 449 },
- { 133, 449 }, { 134, 449 }, { 135, 449 }, { 136, 449 }, { 137, 449 },
- { 138, 449 }, { 139, 449 }, { 140, 449 }, { 141, 449 }, { 142, 449 },
- { 143, 449 }, { 144, 449 }, { 145, 449 }, { 146, 449 }, { 147, 449 },
- { 148, 449 }, { 149, 449 }, { 150, 449 }, { 151, 449 }, { 152, 449 },
- { 153, 449 }, { 154, 449 }, { 155, 449 }, { 156, 449 }, { 157, 449 },
- { 158, 449 }, { 159, 449 }, { 160, 449 }, { 161, 449 }, { 162, 449 },
- { 163, 449 }, { 164, 449 }, { 165, 449 }, { 166, 449 }, { 167, 449 },
- { 168, 449 }, { 169, 449 }, { 170, 449 }, { 171, 449 }, { 172, 449 },
-
- { 173, 449 }, { 174, 449 }, { 175, 449 }, { 176, 449 }, { 177, 449 },
- { 178, 449 }, { 179, 449 }, { 180, 449 }, { 181, 449 }, { 182, 449 },
- { 183, 449 }, { 184, 449 }, { 185, 449 }, { 186, 449 }, { 187, 449 },
- { 188, 449 }, { 189, 449 }, { 190, 449 }, { 191, 449 }, { 192, 449 },
- { 193, 449 }, { 194, 449 }, { 195, 449 }, { 196, 449 }, { 197, 449 },
- { 198, 449 }, { 199, 449 }, { 200, 449 }, { 201, 449 }, { 202, 449 },
- { 203, 449 }, { 204, 449 }, { 205, 449 }, { 206, 449 }, { 207, 449 },
- { 208, 449 }, { 209, 449 }, { 210, 449 }, { 211, 449 }, { 212, 449 },
- { 213, 449 }, { 214, 449 }, { 215, 449 }, { 216, 449 }, { 217, 449 },
- { 218, 449 }, { 219, 449 }, { 220, 449 }, { 221, 449 }, { 222, 449 },
-
- { 223, 449 }, { 224, 449 }, { 225, 449 }, { 226, 449 }, { 227, 449 },
- { 228, 449 }, { 229, 449 }, { 230, 449 }, { 231, 449 }, { 232, 449 },
- { 233, 449 }, { 234, 449 }, { 235, 449 }, { 236, 449 }, { 237, 449 },
- { 238, 449 }, { 239, 449 }, { 240, 449 }, { 241, 449 }, { 242, 449 },
- { 243, 449 }, { 244, 449 }, { 245, 449 }, { 246, 449 }, { 247, 449 },
- { 248, 449 }, { 249, 449 }, { 250, 449 }, { 251, 449 }, { 252, 449 },
- { 253, 449 }, { 254, 449 }, { 255, 449 }, { 256, 284 }, {   0,   6 },
- {   0,1555 }, {   0,   1 }, {   0,1553 }, {   0,   2 }, {   0,1551 },
- {   0,   0 }, {   0,   1 }, {   0,1548 }, {   0,   3 }, {   0,1546 },
- {   0,   0 }, {   9, 704 }, {  10, 704 }, {  11, 704 }, {  12, 704 },
-
- {  13, 704 }, {   9, 699 }, {  10, 699 }, {  11, 699 }, {  12, 699 },
- {  13, 699 }, {   0,   5 }, {   0,1533 }, {   0,  10 }, {   0,1531 },
- {   0,   7 }, {   0,1529 }, {   0,  12 }, {   0,1527 }, {   0,   9 },
- {   0,1525 }, {   0,   8 }, {   0,1523 }, {   0,   0 }, {  32, 704 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {  32, 699 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
-
- {   0,   0 }, {   0,   4 }, {   0,1488 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {  65, 699 },
- {  66, 699 }, {  67, 699 }, {  68, 699 }, {  69, 699 }, {  70, 699 },
- {  71, 699 }, {  72, 699 }, {  73, 699 }, {  74, 699 }, {  75, 699 },
- {  76, 699 }, {  77, 699 }, {  78, 699 }, {  79, 699 }, {  80, 699 },
- {  81, 699 }, {  82, 699 }, {  83, 699 }, {  84, 699 }, {  85, 699 },
- {  86, 699 }, {  87, 699 }, {  88, 699 }, {  89, 699 }, {  90, 699 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {  97, 757 }, {  98, 757 }, {  99, 757 }, { 100, 757 },
- { 101, 757 }, { 102, 757 }, { 103, 757 }, { 104, 757 }, { 105, 757 },
-
- { 106, 757 }, { 107, 757 }, { 108, 757 }, { 109, 757 }, { 110, 757 },
- { 111, 757 }, { 112, 757 }, { 113, 757 }, { 114, 757 }, { 115, 757 },
- { 116, 757 }, { 117, 757 }, { 118, 757 }, { 119, 757 }, { 120, 757 },
- { 121, 757 }, { 122, 757 }, {  65, 791 }, {  66, 791 }, {  67, 791 },
- {  68, 791 }, {  69, 791 }, {  70, 791 }, {  71, 791 }, {  72, 791 },
- {  73, 791 }, {  74, 791 }, {  75, 791 }, {  76, 791 }, {  77, 791 },
- {  78, 791 }, {  79, 791 }, {  80, 791 }, {  81, 791 }, {  82, 791 },
- {  83, 791 }, {  84, 791 }, {  85, 791 }, {  86, 791 }, {  87, 791 },
- {  88, 791 }, {  89, 791 }, {  90, 791 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {  97, 849 },
-
- {  98, 849 }, {  99, 849 }, { 100, 849 }, { 101, 849 }, { 102, 849 },
- { 103, 849 }, { 104, 849 }, { 105, 849 }, { 106, 849 }, { 107, 849 },
- { 108, 849 }, { 109, 849 }, { 110, 849 }, { 111, 849 }, { 112, 849 },
- { 113, 849 }, { 114, 849 }, { 115, 849 }, { 116, 849 }, { 117, 849 },
- { 118, 849 }, { 119, 849 }, { 120, 849 }, { 121, 849 }, { 122, 849 },
- {   0,  11 }, {   0,1364 }, {   1, 849 }, {   2, 849 }, {   3, 849 },
- {   4, 849 }, {   5, 849 }, {   6, 849 }, {   7, 849 }, {   8, 849 },
- {   9, 849 }, {  10, 849 }, {  11, 849 }, {  12, 849 }, {  13, 849 },
- {  14, 849 }, {  15, 849 }, {  16, 849 }, {  17, 849 }, {  18, 849 },
- {  19, 849 }, {  20, 849 }, {  21, 849 }, {  22, 849 }, {  23, 849 },
-
- {  24, 849 }, {  25, 849 }, {  26, 849 }, {  27, 849 }, {  28, 849 },
- {  29, 849 }, {  30, 849 }, {  31, 849 }, {  32, 849 }, {  33, 849 },
- {  34, 849 }, {  35, 849 }, {  36, 849 }, {  37, 849 }, {  38, 849 },
- {  39, 849 }, {  40, 849 }, {  41, 849 }, {  42, 849 }, {  43, 849 },
- {  44, 849 }, {  45, 849 }, {  46, 849 }, {  47, 849 }, {  48, 849 },
- {  49, 849 }, {  50, 849 }, {  51, 849 }, {  52, 849 }, {  53, 849 },
- {  54, 849 }, {  55, 849 }, {  56, 849 }, {  57, 849 }, {  58, 849 },
- {  59, 849 }, {  60, 849 }, {  61, 849 }, {  62, 849 }, {  63, 849 },
- {  64, 849 }, {  65, 849 }, {  66, 849 }, {  67, 849 }, {  68, 849 },
- {  69, 849 }, {  70, 849 }, {  71, 849 }, {  72, 849 }, {  73, 849 },
-
- {  74, 849 }, {  75, 849 }, {  76, 849 }, {  77, 849 }, {  78, 849 },
- {  79, 849 }, {  80, 849 }, {  81, 849 }, {  82, 849 }, {  83, 849 },
- {  84, 849 }, {  85, 849 }, {  86, 849 }, {  87, 849 }, {  88, 849 },
- {  89, 849 }, {  90, 849 }, {  91, 849 }, {   0,   0 }, {   0,   0 },
- {  94, 849 }, {  95, 849 }, {  96, 849 }, {  97, 849 }, {  98, 849 },
- {  99, 849 }, { 100, 849 }, { 101, 849 }, { 102, 849 }, { 103, 849 },
- { 104, 849 }, { 105, 849 }, { 106, 849 }, { 107, 849 }, { 108, 849 },
- { 109, 849 }, { 110, 849 }, { 111, 849 }, { 112, 849 }, { 113, 849 },
- { 114, 849 }, { 115, 849 }, { 116, 849 }, { 117, 849 }, { 118, 849 },
- { 119, 849 }, { 120, 849 }, { 121, 849 }, { 122, 849 }, { 123, 849 },
-
- { 124, 849 }, { 125, 849 }, { 126, 849 }, { 127, 849 }, { 128, 849 },
- { 129, 849 }, { 130, 849 }, { 131, 849 }, { 132, 849 }, { 133, 849 },
- { 134, 849 }, { 135, 849 }, { 136, 849 }, { 137, 849 }, { 138, 849 },
- { 139, 849 }, { 140, 849 }, { 141, 849 }, { 142, 849 }, { 143, 849 },
- { 144, 849 }, { 145, 849 }, { 146, 849 }, { 147, 849 }, { 148, 849 },
- { 149, 849 }, { 150, 849 }, { 151, 849 }, { 152, 849 }, { 153, 849 },
- { 154, 849 }, { 155, 849 }, { 156, 849 }, { 157, 849 }, { 158, 849 },
- { 159, 849 }, { 160, 849 }, { 161, 849 }, { 162, 849 }, { 163, 849 },
- { 164, 849 }, { 165, 849 }, { 166, 849 }, { 167, 849 }, { 168, 849 },
- { 169, 849 }, { 170, 849 }, { 171, 849 }, { 172, 849 }, { 173, 849 },
-
- { 174, 849 }, { 175, 849 }, { 176, 849 }, { 177, 849 }, { 178, 849 },
- { 179, 849 }, { 180, 849 }, { 181, 849 }, { 182, 849 }, { 183, 849 },
- { 184, 849 }, { 185, 849 }, { 186, 849 }, { 187, 849 }, { 188, 849 },
- { 189, 849 }, { 190, 849 }, { 191, 849 }, { 192, 849 }, { 193, 849 },
- { 194, 849 }, { 195, 849 }, { 196, 849 }, { 197, 849 }, { 198, 849 },
- { 199, 849 }, { 200, 849 }, { 201, 849 }, { 202, 849 }, { 203, 849 },
- { 204, 849 }, { 205, 849 }, { 206, 849 }, { 207, 849 }, { 208, 849 },
- { 209, 849 }, { 210, 849 }, { 211, 849 }, { 212, 849 }, { 213, 849 },
- { 214, 849 }, { 215, 849 }, { 216, 849 }, { 217, 849 }, { 218, 849 },
- { 219, 849 }, { 220, 849 }, { 221, 849 }, { 222, 849 }, { 223, 849 },
-
- { 224, 849 }, { 225, 849 }, { 226, 849 }, { 227, 849 }, { 228, 849 },
- { 229, 849 }, { 230, 849 }, { 231, 849 }, { 232, 849 }, { 233, 849 },
- { 234, 849 }, { 235, 849 }, { 236, 849 }, { 237, 849 }, { 238, 849 },
- { 239, 849 }, { 240, 849 }, { 241, 849 }, { 242, 849 }, { 243, 849 },
- { 244, 849 }, { 245, 849 }, { 246, 849 }, { 247, 849 }, { 248, 849 },
- { 249, 849 }, { 250, 849 }, { 251, 849 }, { 252, 849 }, { 253, 849 },
- { 254, 849 }, { 255, 849 }, {   0,  12 }, {   0,1107 }, {   1,-420 },
- {   2,-420 }, {   3,-420 }, {   4,-420 }, {   5,-420 }, {   6,-420 },
- {   7,-420 }, {   8,-420 }, {   9,-420 }, {  10,-418 }, {  11,-420 },
- {  12,-420 }, {  13,-420 }, {  14,-420 }, {  15,-420 }, {  16,-420 },
-
- {  17,-420 }, {  18,-420 }, {  19,-420 }, {  20,-420 }, {  21,-420 },
- {  22,-420 }, {  23,-420 }, {  24,-420 }, {  25,-420 }, {  26,-420 },
- {  27,-420 }, {  28,-420 }, {  29,-420 }, {  30,-420 }, {  31,-420 },
- {  32,-420 }, {  33,-420 }, {  34,-420 }, {  35,-420 }, {  36,-420 },
- {  37,-420 }, {  38,-420 }, {  39,-420 }, {  40,-420 }, {  41,-420 },
- {  42,-420 }, {  43,-420 }, {  44,-420 }, {  45,-420 }, {  46,-420 },
- {  47,-420 }, {  48,-420 }, {  49,-420 }, {  50,-420 }, {  51,-420 },
- {  52,-420 }, {  53,-420 }, {  54,-420 }, {  55,-420 }, {  56,-420 },
- {  57,-420 }, {  58,-420 }, {  59,-420 }, {  60,-420 }, {  61,-420 },
- {  62,-420 }, {  63,-420 }, {  64,-420 }, {  65,-420 }, {  66,-420 },
-
- {  67,-420 }, {  68,-420 }, {  69,-420 }, {  70,-420 }, {  71,-420 },
- {  72,-420 }, {  73,-420 }, {  74,-420 }, {  75,-420 }, {  76,-420 },
- {  77,-420 }, {  78,-420 }, {  79,-420 }, {  80,-420 }, {  81,-420 },
- {  82,-420 }, {  83,-420 }, {  84,-420 }, {  85,-420 }, {  86,-420 },
- {  87,-420 }, {  88,-420 }, {  89,-420 }, {  90,-420 }, {  91,-420 },
- {  92,-420 }, {  93,-416 }, {  94,-420 }, {  95,-420 }, {  96,-420 },
- {  97,-420 }, {  98,-420 }, {  99,-420 }, { 100,-420 }, { 101,-420 },
- { 102,-420 }, { 103,-420 }, { 104,-420 }, { 105,-420 }, { 106,-420 },
- { 107,-420 }, { 108,-420 }, { 109,-420 }, { 110,-420 }, { 111,-420 },
- { 112,-420 }, { 113,-420 }, { 114,-420 }, { 115,-420 }, { 116,-420 },
-
- { 117,-420 }, { 118,-420 }, { 119,-420 }, { 120,-420 }, { 121,-420 },
- { 122,-420 }, { 123,-420 }, { 124,-420 }, { 125,-420 }, { 126,-420 },
- { 127,-420 }, { 128,-420 }, { 129,-420 }, { 130,-420 }, { 131,-420 },
- { 132,-420 }, { 133,-420 }, { 134,-420 }, { 135,-420 }, { 136,-420 },
- { 137,-420 }, { 138,-420 }, { 139,-420 }, { 140,-420 }, { 141,-420 },
- { 142,-420 }, { 143,-420 }, { 144,-420 }, { 145,-420 }, { 146,-420 },
- { 147,-420 }, { 148,-420 }, { 149,-420 }, { 150,-420 }, { 151,-420 },
- { 152,-420 }, { 153,-420 }, { 154,-420 }, { 155,-420 }, { 156,-420 },
- { 157,-420 }, { 158,-420 }, { 159,-420 }, { 160,-420 }, { 161,-420 },
- { 162,-420 }, { 163,-420 }, { 164,-420 }, { 165,-420 }, { 166,-420 },
-
- { 167,-420 }, { 168,-420 }, { 169,-420 }, { 170,-420 }, { 171,-420 },
- { 172,-420 }, { 173,-420 }, { 174,-420 }, { 175,-420 }, { 176,-420 },
- { 177,-420 }, { 178,-420 }, { 179,-420 }, { 180,-420 }, { 181,-420 },
- { 182,-420 }, { 183,-420 }, { 184,-420 }, { 185,-420 }, { 186,-420 },
- { 187,-420 }, { 188,-420 }, { 189,-420 }, { 190,-420 }, { 191,-420 },
- { 192,-420 }, { 193,-420 }, { 194,-420 }, { 195,-420 }, { 196,-420 },
- { 197,-420 }, { 198,-420 }, { 199,-420 }, { 200,-420 }, { 201,-420 },
- { 202,-420 }, { 203,-420 }, { 204,-420 }, { 205,-420 }, { 206,-420 },
- { 207,-420 }, { 208,-420 }, { 209,-420 }, { 210,-420 }, { 211,-420 },
- { 212,-420 }, { 213,-420 }, { 214,-420 }, { 215,-420 }, { 216,-420 },
-
- { 217,-420 }, { 218,-420 }, { 219,-420 }, { 220,-420 }, { 221,-420 },
- { 222,-420 }, { 223,-420 }, { 224,-420 }, { 225,-420 }, { 226,-420 },
- { 227,-420 }, { 228,-420 }, { 229,-420 }, { 230,-420 }, { 231,-420 },
- { 232,-420 }, { 233,-420 }, { 234,-420 }, { 235,-420 }, { 236,-420 },
- { 237,-420 }, { 238,-420 }, { 239,-420 }, { 240,-420 }, { 241,-420 },
- { 242,-420 }, { 243,-420 }, { 244,-420 }, { 245,-420 }, { 246,-420 },
- { 247,-420 }, { 248,-420 }, { 249,-420 }, { 250,-420 }, { 251,-420 },
- { 252,-420 }, { 253,-420 }, { 254,-420 }, { 255,-420 }, { 256,-420 },
- {   0,   1 }, {   0, 849 }, {   0,   3 }, {   0, 847 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
-
- {   9,   0 }, {  10,   0 }, {  11,   0 }, {  12,   0 }, {  13,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {  32,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
-
- {   0,   3 }, {   0, 789 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {  97, 589 }, {  98, 589 }, {  99, 589 }, { 100, 589 }, { 101, 589 },
- { 102, 589 }, { 103, 589 }, { 104, 589 }, { 105, 589 }, { 106, 589 },
-
- { 107, 589 }, { 108, 589 }, { 109, 589 }, { 110, 589 }, { 111, 589 },
- { 112, 589 }, { 113, 589 }, { 114, 589 }, { 115, 589 }, { 116, 589 },
- { 117, 589 }, { 118, 589 }, { 119, 589 }, { 120, 589 }, { 121, 589 },
- { 122, 589 }, {  65, -58 }, {  66, -58 }, {  67, -58 }, {  68, -58 },
- {  69, -58 }, {  70, -58 }, {  71, -58 }, {  72, -58 }, {  73, -58 },
- {  74, -58 }, {  75, -58 }, {  76, -58 }, {  77, -58 }, {  78, -58 },
- {  79, -58 }, {  80, -58 }, {  81, -58 }, {  82, -58 }, {  83, -58 },
- {  84, -58 }, {  85, -58 }, {  86, -58 }, {  87, -58 }, {  88, -58 },
- {  89, -58 }, {  90, -58 }, {   0,   3 }, {   0, 697 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {  97,   0 }, {  98,   0 },
-
- {  99,   0 }, { 100,   0 }, { 101,   0 }, { 102,   0 }, { 103,   0 },
- { 104,   0 }, { 105,   0 }, { 106,   0 }, { 107,   0 }, { 108,   0 },
- { 109,   0 }, { 110,   0 }, { 111,   0 }, { 112,   0 }, { 113,   0 },
- { 114,   0 }, { 115,   0 }, { 116,   0 }, { 117,   0 }, { 118,   0 },
- { 119,   0 }, { 120,   0 }, { 121,   0 }, { 122,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
-
- {   0,   4 }, {   0, 639 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {  65,-150 }, {  66,-150 },
- {  67,-150 }, {  68,-150 }, {  69,-150 }, {  70,-150 }, {  71,-150 },
- {  72,-150 }, {  73,-150 }, {  74,-150 }, {  75,-150 }, {  76,-150 },
- {  77,-150 }, {  78,-150 }, {  79,-150 }, {  80,-150 }, {  81,-150 },
- {  82,-150 }, {  83,-150 }, {  84,-150 }, {  85,-150 }, {  86,-150 },
- {  87,-150 }, {  88,-150 }, {  89,-150 }, {  90,-150 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {  97, -92 }, {  98, -92 }, {  99, -92 }, { 100, -92 }, { 101, -92 },
- { 102, -92 }, { 103, -92 }, { 104, -92 }, { 105, -92 }, { 106, -92 },
-
- { 107, -92 }, { 108, -92 }, { 109, -92 }, { 110, -92 }, { 111, -92 },
- { 112, -92 }, { 113, -92 }, { 114, -92 }, { 115, -92 }, { 116, -92 },
- { 117, -92 }, { 118, -92 }, { 119, -92 }, { 120, -92 }, { 121, -92 },
- { 122, -92 }, {  65, -58 }, {  66, -58 }, {  67, -58 }, {  68, -58 },
- {  69, -58 }, {  70, -58 }, {  71, -58 }, {  72, -58 }, {  73, -58 },
- {  74, -58 }, {  75, -58 }, {  76, -58 }, {  77, -58 }, {  78, -58 },
- {  79, -58 }, {  80, -58 }, {  81, -58 }, {  82, -58 }, {  83, -58 },
- {  84, -58 }, {  85, -58 }, {  86, -58 }, {  87, -58 }, {  88, -58 },
- {  89, -58 }, {  90, -58 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {  97,   0 }, {  98,   0 },
-
- {  99,   0 }, { 100,   0 }, { 101,   0 }, { 102,   0 }, { 103,   0 },
- { 104,   0 }, { 105,   0 }, { 106,   0 }, { 107,   0 }, { 108,   0 },
- { 109,   0 }, { 110,   0 }, { 111,   0 }, { 112,   0 }, { 113,   0 },
- { 114,   0 }, { 115,   0 }, { 116,   0 }, { 117,   0 }, { 118,   0 },
- { 119,   0 }, { 120,   0 }, { 121,   0 }, { 122,   0 }, {   0,  11 },
- {   0, 515 }, {   1,   0 }, {   2,   0 }, {   3,   0 }, {   4,   0 },
- {   5,   0 }, {   6,   0 }, {   7,   0 }, {   8,   0 }, {   9,   0 },
- {  10,   0 }, {  11,   0 }, {  12,   0 }, {  13,   0 }, {  14,   0 },
- {  15,   0 }, {  16,   0 }, {  17,   0 }, {  18,   0 }, {  19,   0 },
- {  20,   0 }, {  21,   0 }, {  22,   0 }, {  23,   0 }, {  24,   0 },
-
- {  25,   0 }, {  26,   0 }, {  27,   0 }, {  28,   0 }, {  29,   0 },
- {  30,   0 }, {  31,   0 }, {  32,   0 }, {  33,   0 }, {  34,   0 },
- {  35,   0 }, {  36,   0 }, {  37,   0 }, {  38,   0 }, {  39,   0 },
- {  40,   0 }, {  41,   0 }, {  42,   0 }, {  43,   0 }, {  44,   0 },
- {  45,   0 }, {  46,   0 }, {  47,   0 }, {  48,   0 }, {  49,   0 },
- {  50,   0 }, {  51,   0 }, {  52,   0 }, {  53,   0 }, {  54,   0 },
- {  55,   0 }, {  56,   0 }, {  57,   0 }, {  58,   0 }, {  59,   0 },
- {  60,   0 }, {  61,   0 }, {  62,   0 }, {  63,   0 }, {  64,   0 },
- {  65,   0 }, {  66,   0 }, {  67,   0 }, {  68,   0 }, {  69,   0 },
- {  70,   0 }, {  71,   0 }, {  72,   0 }, {  73,   0 }, {  74,   0 },
-
- {  75,   0 }, {  76,   0 }, {  77,   0 }, {  78,   0 }, {  79,   0 },
- {  80,   0 }, {  81,   0 }, {  82,   0 }, {  83,   0 }, {  84,   0 },
- {  85,   0 }, {  86,   0 }, {  87,   0 }, {  88,   0 }, {  89,   0 },
- {  90,   0 }, {  91,   0 }, {   0,   0 }, {   0,   0 }, {  94,   0 },
- {  95,   0 }, {  96,   0 }, {  97,   0 }, {  98,   0 }, {  99,   0 },
- { 100,   0 }, { 101,   0 }, { 102,   0 }, { 103,   0 }, { 104,   0 },
- { 105,   0 }, { 106,   0 }, { 107,   0 }, { 108,   0 }, { 109,   0 },
- { 110,   0 }, { 111,   0 }, { 112,   0 }, { 113,   0 }, { 114,   0 },
- { 115,   0 }, { 116,   0 }, { 117,   0 }, { 118,   0 }, { 119,   0 },
- { 120,   0 }, { 121,   0 }, { 122,   0 }, { 123,   0 }, { 124,   0 },
-
- { 125,   0 }, { 126,   0 }, { 127,   0 }, { 128,   0 }, { 129,   0 },
- { 130,   0 }, { 131,   0 }, { 132,   0 }, { 133,   0 }, { 134,   0 },
- { 135,   0 }, { 136,   0 }, { 137,   0 }, { 138,   0 }, { 139,   0 },
- { 140,   0 }, { 141,   0 }, { 142,   0 }, { 143,   0 }, { 144,   0 },
- { 145,   0 }, { 146,   0 }, { 147,   0 }, { 148,   0 }, { 149,   0 },
- { 150,   0 }, { 151,   0 }, { 152,   0 }, { 153,   0 }, { 154,   0 },
- { 155,   0 }, { 156,   0 }, { 157,   0 }, { 158,   0 }, { 159,   0 },
- { 160,   0 }, { 161,   0 }, { 162,   0 }, { 163,   0 }, { 164,   0 },
- { 165,   0 }, { 166,   0 }, { 167,   0 }, { 168,   0 }, { 169,   0 },
- { 170,   0 }, { 171,   0 }, { 172,   0 }, { 173,   0 }, { 174,   0 },
-
- { 175,   0 }, { 176,   0 }, { 177,   0 }, { 178,   0 }, { 179,   0 },
- { 180,   0 }, { 181,   0 }, { 182,   0 }, { 183,   0 }, { 184,   0 },
- { 185,   0 }, { 186,   0 }, { 187,   0 }, { 188,   0 }, { 189,   0 },
- { 190,   0 }, { 191,   0 }, { 192,   0 }, { 193,   0 }, { 194,   0 },
- { 195,   0 }, { 196,   0 }, { 197,   0 }, { 198,   0 }, { 199,   0 },
- { 200,   0 }, { 201,   0 }, { 202,   0 }, { 203,   0 }, { 204,   0 },
- { 205,   0 }, { 206,   0 }, { 207,   0 }, { 208,   0 }, { 209,   0 },
- { 210,   0 }, { 211,   0 }, { 212,   0 }, { 213,   0 }, { 214,   0 },
- { 215,   0 }, { 216,   0 }, { 217,   0 }, { 218,   0 }, { 219,   0 },
- { 220,   0 }, { 221,   0 }, { 222,   0 }, { 223,   0 }, { 224,   0 },
-
- { 225,   0 }, { 226,   0 }, { 227,   0 }, { 228,   0 }, { 229,   0 },
- { 230,   0 }, { 231,   0 }, { 232,   0 }, { 233,   0 }, { 234,   0 },
- { 235,   0 }, { 236,   0 }, { 237,   0 }, { 238,   0 }, { 239,   0 },
- { 240,   0 }, { 241,   0 }, { 242,   0 }, { 243,   0 }, { 244,   0 },
- { 245,   0 }, { 246,   0 }, { 247,   0 }, { 248,   0 }, { 249,   0 },
- { 250,   0 }, { 251,   0 }, { 252,   0 }, { 253,   0 }, { 254,   0 },
- { 255,   0 }, {   0,   3 }, {   0, 258 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
-
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
-
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {  97,   0 },
- {  98,   0 }, {  99,   0 }, { 100,   0 }, { 101,   0 }, { 102,   0 },
- { 103,   0 }, { 104,   0 }, { 105,   0 }, { 106,   0 }, { 107,   0 },
- { 108,   0 }, { 109,   0 }, { 110,   0 }, { 111,   0 }, { 112,   0 },
- { 113,   0 }, { 114,   0 }, { 115,   0 }, { 116,   0 }, { 117,   0 },
-
- { 118,   0 }, { 119,   0 }, { 120,   0 }, { 121,   0 }, { 122,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
-
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
-
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 },
- {   0,   0 }, {   0,   0 }, {   0,   0 }, {   0,   0 }, { 257,  14 },
- {   1,   0 },    };
-
-static const struct yy_trans_info *yy_start_state_list[5] =
-    {
-    &yy_transition[1],
-    &yy_transition[3],
-    &yy_transition[261],
-    &yy_transition[519],
-    &yy_transition[777],
-
-    } ;
-
-extern int yy_flex_debug;
-int yy_flex_debug = 0;
-
-/* The intent behind this definition is that it'll catch
- * any uses of REJECT which flex missed.
- */
-#define REJECT reject_used_but_not_detected
-#define yymore() yymore_used_but_not_detected
-#define YY_MORE_ADJ 0
-#define YY_RESTORE_YY_MORE_OFFSET
-char *yytext;
-#line 1 "sgf_l.l"
-/*
- * Copyright (C) 2000 Gary Wong <gtw@gnu.org>
- * Copyright (C) 2002-2015 the AUTHORS
- *
- * This program is free software: you can redistribute it and/or modify
- * it under the terms of the GNU General Public License as published by
- * the Free Software Foundation, either version 3 of the License, or
- * (at your option) any later version.
- *
- * This program is distributed in the hope that it will be useful,
- * but WITHOUT ANY WARRANTY; without even the implied warranty of
- * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
- * GNU General Public License for more details.
- *
- * You should have received a copy of the GNU General Public License
- * along with this program.  If not, see <https://www.gnu.org/licenses/>.
- *
- * $Id: sgf_l.c,v 1.16 2024/01/22 20:49:37 plm Exp $
- */
-#line 22 "sgf_l.l"
-#include "common.h"
-#include <ctype.h>
-#include "list.h"
-
-#include "sgf.h"
-#include "sgf_y.h"
-#include <glib/gi18n.h>
-
-static int error( char *s ) {
-
-    /* refer to yy_fatal_error, to shut up the compiler */
-    (void) yy_fatal_error;
-
-    if( SGFErrorHandler )
-	SGFErrorHandler( s, 0 );
-    else
-	fprintf( stderr, "%s\n", s );
-    
-    return 0;
-}
-
-#define YY_FATAL_ERROR(m) error(m)
-#line 1263 "sgf_l.c"
-#define YY_NO_INPUT 1
-
-#line 1266 "sgf_l.c"
-
-#define INITIAL 0
-#define value 1
-
-#ifndef YY_NO_UNISTD_H
-/* Special case for "unistd.h", since it is non-ANSI. We include it way
- * down here because we want the user's section 1 to have been scanned first.
- * The user has a chance to override it with an option.
- */
-#include <unistd.h>
-#endif
-
-#ifndef YY_EXTRA_TYPE
-#define YY_EXTRA_TYPE void *
-#endif
-
-static int yy_init_globals ( void );
-
-/* Accessor methods to globals.
-   These are made visible to non-reentrant scanners for convenience. */
-
-int yylex_destroy ( void );
-
-int yyget_debug ( void );
-
-void yyset_debug ( int debug_flag  );
-
-YY_EXTRA_TYPE yyget_extra ( void );
-
-void yyset_extra ( YY_EXTRA_TYPE user_defined  );
-
-FILE *yyget_in ( void );
-
-void yyset_in  ( FILE * _in_str  );
-
-FILE *yyget_out ( void );
-
-void yyset_out  ( FILE * _out_str  );
-
-			int yyget_leng ( void );
-
-char *yyget_text ( void );
-
-int yyget_lineno ( void );
-
-void yyset_lineno ( int _line_number  );
-
-/* Macros after this point can all be overridden by user definitions in
- * section 1.
- */
-
-#ifndef YY_SKIP_YYWRAP
-#ifdef __cplusplus
-extern "C" int yywrap ( void );
-#else
-extern int yywrap ( void );
-#endif
-#endif
-
-#ifndef YY_NO_UNPUT
-    
-#endif
-
-#ifndef yytext_ptr
-static void yy_flex_strncpy ( char *, const char *, int );
-#endif
-
-#ifdef YY_NEED_STRLEN
-static int yy_flex_strlen ( const char * );
-#endif
-
-#ifndef YY_NO_INPUT
-#ifdef __cplusplus
-static int yyinput ( void );
-#else
-static int input ( void );
-#endif
-
-#endif
-
-/* Amount of stuff to slurp up with each read. */
-#ifndef YY_READ_BUF_SIZE
-#ifdef __ia64__
-/* On IA-64, the buffer size is 16k, not 8k */
-#define YY_READ_BUF_SIZE 16384
-#else
-#define YY_READ_BUF_SIZE 8192
-#endif /* __ia64__ */
-#endif
-
-/* Copy whatever the last rule matched to the standard output. */
-#ifndef ECHO
-/* This used to be an fputs(), but since the string might contain NUL's,
- * we now use fwrite().
- */
-#define ECHO do { if (fwrite( yytext, (size_t) yyleng, 1, yyout )) {} } while (0)
-#endif
-
-/* Gets input and stuffs it into "buf".  number of characters read, or YY_NULL,
- * is returned in "result".
- */
-#ifndef YY_INPUT
-#define YY_INPUT(buf,result,max_size) \
-	if ( YY_CURRENT_BUFFER_LVALUE->yy_is_interactive ) \
-		{ \
-		int c = '*'; \
-		int n; \
-		for ( n = 0; n < max_size && \
-			     (c = getc( yyin )) != EOF && c != '\n'; ++n ) \
-			buf[n] = (char) c; \
-		if ( c == '\n' ) \
-			buf[n++] = (char) c; \
-		if ( c == EOF && ferror( yyin ) ) \
-			YY_FATAL_ERROR( "input in flex scanner failed" ); \
-		result = n; \
-		} \
-	else \
-		{ \
-		errno=0; \
-		while ( (result = (int) fread(buf, 1, (yy_size_t) max_size, yyin)) == 0 && ferror(yyin)) \
-			{ \
-			if( errno != EINTR) \
-				{ \
-				YY_FATAL_ERROR( "input in flex scanner failed" ); \
-				break; \
-				} \
-			errno=0; \
-			clearerr(yyin); \
-			} \
-		}\
-\
-
-#endif
-
-/* No semi-colon after return; correct usage is to write "yyterminate();" -
- * we don't want an extra ';' after the "return" because that will cause
- * some compilers to complain about unreachable statements.
- */
-#ifndef yyterminate
-#define yyterminate() return YY_NULL
-#endif
-
-/* Number of entries by which start-condition stack grows. */
-#ifndef YY_START_STACK_INCR
-#define YY_START_STACK_INCR 25
-#endif
-
-/* Report a fatal error. */
-#ifndef YY_FATAL_ERROR
-#define YY_FATAL_ERROR(msg) yy_fatal_error( msg )
-#endif
-
-/* end tables serialization structures and prototypes */
-
-/* Default declaration of generated scanner - a define so the user can
- * easily add parameters.
- */
-#ifndef YY_DECL
-#define YY_DECL_IS_OURS 1
-
-extern int yylex (void);
-
-#define YY_DECL int yylex (void)
-#endif /* !YY_DECL */
-
-/* Code executed at the beginning of each rule, after yytext and yyleng
- * have been set up.
- */
-#ifndef YY_USER_ACTION
-#define YY_USER_ACTION
-#endif
-
-/* Code executed at the end of each rule. */
-#ifndef YY_BREAK
-#define YY_BREAK /*LINTED*/break;
-#endif
-
-#define YY_RULE_SETUP \
-	YY_USER_ACTION
-
-/** The main scanner function which does all the work.
- */
-YY_DECL
-{
-	yy_state_type yy_current_state;
-	char *yy_cp, *yy_bp;
-	int yy_act;
-    
-	if ( !(yy_init) )
-		{
-		(yy_init) = 1;
-
-#ifdef YY_USER_INIT
-		YY_USER_INIT;
-#endif
-
-		if ( ! (yy_start) )
-			(yy_start) = 1;	/* first start state */
-
-		if ( ! yyin )
-			yyin = stdin;
-
-		if ( ! yyout )
-			yyout = stdout;
-
-		if ( ! YY_CURRENT_BUFFER ) {
-			yyensure_buffer_stack ();
-			YY_CURRENT_BUFFER_LVALUE =
-				yy_create_buffer( yyin, YY_BUF_SIZE );
-		}
-
-		yy_load_buffer_state(  );
-		}
-
-	{
-#line 63 "sgf_l.l"
-
-#line 1484 "sgf_l.c"
-
-	while ( /*CONSTCOND*/1 )		/* loops until end-of-file is reached */
-		{
-		yy_cp = (yy_c_buf_p);
-
-		/* Support of yytext. */
-		*yy_cp = (yy_hold_char);
-
-		/* yy_bp points to the position in yy_ch_buf of the start of
-		 * the current run.
-		 */
-		yy_bp = yy_cp;
-
-		yy_current_state = yy_start_state_list[(yy_start)];
-yy_match:
-		{
-		const struct yy_trans_info *yy_trans_info;
-
-		YY_CHAR yy_c;
-
-		for ( yy_c = YY_SC_TO_UI(*yy_cp);
-		      (yy_trans_info = &yy_current_state[yy_c])->
-		yy_verify == yy_c;
-		      yy_c = YY_SC_TO_UI(*++yy_cp) )
-			yy_current_state += yy_trans_info->yy_nxt;
-		}
-
-yy_find_action:
-		yy_act = yy_current_state[-1].yy_nxt;
-
-		YY_DO_BEFORE_ACTION;
-
-do_action:	/* This label is used only to access EOF actions. */
-
-		switch ( yy_act )
-	{ /* beginning of action switch */
-case 1:
-/* rule 1 can match eol */
-YY_RULE_SETUP
-#line 64 "sgf_l.l"
-/* ignore */
-	YY_BREAK
-case 2:
-YY_RULE_SETUP
-#line 65 "sgf_l.l"
-return *yytext;
-	YY_BREAK
-case 3:
-YY_RULE_SETUP
-#line 66 "sgf_l.l"
-{
-			    char *pch;
-
-			    sgflval.ach[ 1 ] = 0;
-
-			    for( pch = yytext; *pch; pch++ )
-			        if( isupper( *pch ) ) {
-				    sgflval.ach[ 0 ] = *pch;    
-				    break;
-				}
-
-			    for( pch++; *pch; pch++ )
-			        if( isupper( *pch ) ) {
-				    sgflval.ach[ 1 ] = *pch;
-				    break;
-				}
-
-			    return PROPERTY;
-			}
-	YY_BREAK
-case 4:
-YY_RULE_SETUP
-#line 85 "sgf_l.l"
-/* ignore -- this rule avoids making flex back up */
-	YY_BREAK
-case 5:
-YY_RULE_SETUP
-#line 86 "sgf_l.l"
-BEGIN(value); return '[';
-	YY_BREAK
-case 6:
-YY_RULE_SETUP
-#line 87 "sgf_l.l"
-{ error( _("illegal character in SGF file" )); }
-	YY_BREAK
-case 7:
-YY_RULE_SETUP
-#line 89 "sgf_l.l"
-/* ignore -- we want value strings null-terminated */
-	YY_BREAK
-case 8:
-YY_RULE_SETUP
-#line 90 "sgf_l.l"
-{ sgflval.pch = strdup( "]" ); return VALUETEXT; }
-	YY_BREAK
-case 9:
-/* rule 9 can match eol */
-YY_RULE_SETUP
-#line 91 "sgf_l.l"
-/* ignore */
-	YY_BREAK
-case 10:
-YY_RULE_SETUP
-#line 92 "sgf_l.l"
-BEGIN(INITIAL); return ']';
-	YY_BREAK
-case 11:
-/* rule 11 can match eol */
-YY_RULE_SETUP
-#line 93 "sgf_l.l"
-{ sgflval.pch = strdup( yytext ); return VALUETEXT; }
-	YY_BREAK
-case 12:
-YY_RULE_SETUP
-#line 94 "sgf_l.l"
-{ sgflval.pch = strdup( yytext ); return VALUETEXT; }
-	YY_BREAK
-case 13:
-YY_RULE_SETUP
-#line 96 "sgf_l.l"
-YY_FATAL_ERROR( "flex scanner jammed" );
-	YY_BREAK
-#line 1607 "sgf_l.c"
-			case YY_STATE_EOF(INITIAL):
-			case YY_STATE_EOF(value):
-				yyterminate();
-
-	case YY_END_OF_BUFFER:
-		{
-		/* Amount of text matched not including the EOB char. */
-		int yy_amount_of_matched_text = (int) (yy_cp - (yytext_ptr)) - 1;
-
-		/* Undo the effects of YY_DO_BEFORE_ACTION. */
-		*yy_cp = (yy_hold_char);
-		YY_RESTORE_YY_MORE_OFFSET
-
-		if ( YY_CURRENT_BUFFER_LVALUE->yy_buffer_status == YY_BUFFER_NEW )
-			{
-			/* We're scanning a new file or input source.  It's
-			 * possible that this happened because the user
-			 * just pointed yyin at a new source and called
-			 * yylex().  If so, then we have to assure
-			 * consistency between YY_CURRENT_BUFFER and our
-			 * globals.  Here is the right place to do so, because
-			 * this is the first action (other than possibly a
-			 * back-up) that will match for the new input source.
-			 */
-			(yy_n_chars) = YY_CURRENT_BUFFER_LVALUE->yy_n_chars;
-			YY_CURRENT_BUFFER_LVALUE->yy_input_file = yyin;
-			YY_CURRENT_BUFFER_LVALUE->yy_buffer_status = YY_BUFFER_NORMAL;
-			}
-
-		/* Note that here we test for yy_c_buf_p "<=" to the position
-		 * of the first EOB in the buffer, since yy_c_buf_p will
-		 * already have been incremented past the NUL character
-		 * (since all states make transitions on EOB to the
-		 * end-of-buffer state).  Contrast this with the test
-		 * in input().
-		 */
-		if ( (yy_c_buf_p) <= &YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[(yy_n_chars)] )
-			{ /* This was really a NUL. */
-			yy_state_type yy_next_state;
-
-			(yy_c_buf_p) = (yytext_ptr) + yy_amount_of_matched_text;
-
-			yy_current_state = yy_get_previous_state(  );
-
-			/* Okay, we're now positioned to make the NUL
-			 * transition.  We couldn't have
-			 * yy_get_previous_state() go ahead and do it
-			 * for us because it doesn't know how to deal
-			 * with the possibility of jamming (and we don't
-			 * want to build jamming into it because then it
-			 * will run more slowly).
-			 */
-
-			yy_next_state = yy_try_NUL_trans( yy_current_state );
-
-			yy_bp = (yytext_ptr) + YY_MORE_ADJ;
-
-			if ( yy_next_state )
-				{
-				/* Consume the NUL. */
-				yy_cp = ++(yy_c_buf_p);
-				yy_current_state = yy_next_state;
-				goto yy_match;
-				}
-
-			else
-				{
-				yy_cp = (yy_c_buf_p);
-				goto yy_find_action;
-				}
-			}
-
-		else switch ( yy_get_next_buffer(  ) )
-			{
-			case EOB_ACT_END_OF_FILE:
-				{
-				(yy_did_buffer_switch_on_eof) = 0;
-
-				if ( yywrap(  ) )
-					{
-					/* Note: because we've taken care in
-					 * yy_get_next_buffer() to have set up
-					 * yytext, we can now set up
-					 * yy_c_buf_p so that if some total
-					 * hoser (like flex itself) wants to
-					 * call the scanner after we return the
-					 * YY_NULL, it'll still work - another
-					 * YY_NULL will get returned.
-					 */
-					(yy_c_buf_p) = (yytext_ptr) + YY_MORE_ADJ;
-
-					yy_act = YY_STATE_EOF(YY_START);
-					goto do_action;
-					}
-
-				else
-					{
-					if ( ! (yy_did_buffer_switch_on_eof) )
-						YY_NEW_FILE;
-					}
-				break;
-				}
-
-			case EOB_ACT_CONTINUE_SCAN:
-				(yy_c_buf_p) =
-					(yytext_ptr) + yy_amount_of_matched_text;
-
-				yy_current_state = yy_get_previous_state(  );
-
-				yy_cp = (yy_c_buf_p);
-				yy_bp = (yytext_ptr) + YY_MORE_ADJ;
-				goto yy_match;
-
-			case EOB_ACT_LAST_MATCH:
-				(yy_c_buf_p) =
-				&YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[(yy_n_chars)];
-
-				yy_current_state = yy_get_previous_state(  );
-
-				yy_cp = (yy_c_buf_p);
-				yy_bp = (yytext_ptr) + YY_MORE_ADJ;
-				goto yy_find_action;
-			}
-		break;
-		}
-
-	default:
-		YY_FATAL_ERROR(
-			"fatal flex scanner internal error--no action found" );
-	} /* end of action switch */
-		} /* end of scanning one token */
-	} /* end of user's declarations */
-} /* end of yylex */
-
-/* yy_get_next_buffer - try to read in a new buffer
- *
- * Returns a code representing an action:
- *	EOB_ACT_LAST_MATCH -
- *	EOB_ACT_CONTINUE_SCAN - continue scanning from current position
- *	EOB_ACT_END_OF_FILE - end of file
- */
-static int yy_get_next_buffer (void)
-{
-    	char *dest = YY_CURRENT_BUFFER_LVALUE->yy_ch_buf;
-	char *source = (yytext_ptr);
-	int number_to_move, i;
-	int ret_val;
-
-	if ( (yy_c_buf_p) > &YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[(yy_n_chars) + 1] )
-		YY_FATAL_ERROR(
-		"fatal flex scanner internal error--end of buffer missed" );
-
-	if ( YY_CURRENT_BUFFER_LVALUE->yy_fill_buffer == 0 )
-		{ /* Don't try to fill the buffer, so this is an EOF. */
-		if ( (yy_c_buf_p) - (yytext_ptr) - YY_MORE_ADJ == 1 )
-			{
-			/* We matched a single character, the EOB, so
-			 * treat this as a final EOF.
-			 */
-			return EOB_ACT_END_OF_FILE;
-			}
-
-		else
-			{
-			/* We matched some text prior to the EOB, first
-			 * process it.
-			 */
-			return EOB_ACT_LAST_MATCH;
-			}
-		}
-
-	/* Try to read more data. */
-
-	/* First move last chars to start of buffer. */
-	number_to_move = (int) ((yy_c_buf_p) - (yytext_ptr) - 1);
-
-	for ( i = 0; i < number_to_move; ++i )
-		*(dest++) = *(source++);
-
-	if ( YY_CURRENT_BUFFER_LVALUE->yy_buffer_status == YY_BUFFER_EOF_PENDING )
-		/* don't do the read, it's not guaranteed to return an EOF,
-		 * just force an EOF
-		 */
-		YY_CURRENT_BUFFER_LVALUE->yy_n_chars = (yy_n_chars) = 0;
-
-	else
-		{
-			int num_to_read =
-			YY_CURRENT_BUFFER_LVALUE->yy_buf_size - number_to_move - 1;
-
-		while ( num_to_read <= 0 )
-			{ /* Not enough room in the buffer - grow it. */
-
-			/* just a shorter name for the current buffer */
-			YY_BUFFER_STATE b = YY_CURRENT_BUFFER_LVALUE;
-
-			int yy_c_buf_p_offset =
-				(int) ((yy_c_buf_p) - b->yy_ch_buf);
-
-			if ( b->yy_is_our_buffer )
-				{
-				int new_size = b->yy_buf_size * 2;
-
-				if ( new_size <= 0 )
-					b->yy_buf_size += b->yy_buf_size / 8;
-				else
-					b->yy_buf_size *= 2;
-
-				b->yy_ch_buf = (char *)
-					/* Include room in for 2 EOB chars. */
-					yyrealloc( (void *) b->yy_ch_buf,
-							 (yy_size_t) (b->yy_buf_size + 2)  );
-				}
-			else
-				/* Can't grow it, we don't own it. */
-				b->yy_ch_buf = NULL;
-
-			if ( ! b->yy_ch_buf )
-				YY_FATAL_ERROR(
-				"fatal error - scanner input buffer overflow" );
-
-			(yy_c_buf_p) = &b->yy_ch_buf[yy_c_buf_p_offset];
-
-			num_to_read = YY_CURRENT_BUFFER_LVALUE->yy_buf_size -
-						number_to_move - 1;
-
-			}
-
-		if ( num_to_read > YY_READ_BUF_SIZE )
-			num_to_read = YY_READ_BUF_SIZE;
-
-		/* Read in more data. */
-		YY_INPUT( (&YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[number_to_move]),
-			(yy_n_chars), num_to_read );
-
-		YY_CURRENT_BUFFER_LVALUE->yy_n_chars = (yy_n_chars);
-		}
-
-	if ( (yy_n_chars) == 0 )
-		{
-		if ( number_to_move == YY_MORE_ADJ )
-			{
-			ret_val = EOB_ACT_END_OF_FILE;
-			yyrestart( yyin  );
-			}
-
-		else
-			{
-			ret_val = EOB_ACT_LAST_MATCH;
-			YY_CURRENT_BUFFER_LVALUE->yy_buffer_status =
-				YY_BUFFER_EOF_PENDING;
-			}
-		}
-
-	else
-		ret_val = EOB_ACT_CONTINUE_SCAN;
-
-	if (((yy_n_chars) + number_to_move) > YY_CURRENT_BUFFER_LVALUE->yy_buf_size) {
-		/* Extend the array by 50%, plus the number we really need. */
-		int new_size = (yy_n_chars) + number_to_move + ((yy_n_chars) >> 1);
-		YY_CURRENT_BUFFER_LVALUE->yy_ch_buf = (char *) yyrealloc(
-			(void *) YY_CURRENT_BUFFER_LVALUE->yy_ch_buf, (yy_size_t) new_size  );
-		if ( ! YY_CURRENT_BUFFER_LVALUE->yy_ch_buf )
-			YY_FATAL_ERROR( "out of dynamic memory in yy_get_next_buffer()" );
-		/* "- 2" to take care of EOB's */
-		YY_CURRENT_BUFFER_LVALUE->yy_buf_size = (int) (new_size - 2);
-	}
-
-	(yy_n_chars) += number_to_move;
-	YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[(yy_n_chars)] = YY_END_OF_BUFFER_CHAR;
-	YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[(yy_n_chars) + 1] = YY_END_OF_BUFFER_CHAR;
-
-	(yytext_ptr) = &YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[0];
-
-	return ret_val;
-}
-
-/* yy_get_previous_state - get the state just before the EOB char was reached */
-
-    static yy_state_type yy_get_previous_state (void)
-{
-	yy_state_type yy_current_state;
-	char *yy_cp;
-    
-	yy_current_state = yy_start_state_list[(yy_start)];
-
-	for ( yy_cp = (yytext_ptr) + YY_MORE_ADJ; yy_cp < (yy_c_buf_p); ++yy_cp )
-		{
-		yy_current_state += yy_current_state[(*yy_cp ? YY_SC_TO_UI(*yy_cp) : 256)].yy_nxt;
-		}
-
-	return yy_current_state;
-}
-
-/* yy_try_NUL_trans - try to make a transition on the NUL character
- *
- * synopsis
- *	next_state = yy_try_NUL_trans( current_state );
- */
-    static yy_state_type yy_try_NUL_trans  (yy_state_type yy_current_state )
-{
-	int yy_is_jam;
-    
-	int yy_c = 256;
-	const struct yy_trans_info *yy_trans_info;
-
-	yy_trans_info = &yy_current_state[(unsigned int) yy_c];
-	yy_current_state += yy_trans_info->yy_nxt;
-	yy_is_jam = (yy_trans_info->yy_verify != yy_c);
-
-		return yy_is_jam ? 0 : yy_current_state;
-}
-
-#ifndef YY_NO_UNPUT
-
-#endif
-
-#ifndef YY_NO_INPUT
-#ifdef __cplusplus
-    static int yyinput (void)
-#else
-    static int input  (void)
-#endif
-
-{
-	int c;
-    
-	*(yy_c_buf_p) = (yy_hold_char);
-
-	if ( *(yy_c_buf_p) == YY_END_OF_BUFFER_CHAR )
-		{
-		/* yy_c_buf_p now points to the character we want to return.
-		 * If this occurs *before* the EOB characters, then it's a
-		 * valid NUL; if not, then we've hit the end of the buffer.
-		 */
-		if ( (yy_c_buf_p) < &YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[(yy_n_chars)] )
-			/* This was really a NUL. */
-			*(yy_c_buf_p) = '\0';
-
-		else
-			{ /* need more input */
-			int offset = (int) ((yy_c_buf_p) - (yytext_ptr));
-			++(yy_c_buf_p);
-
-			switch ( yy_get_next_buffer(  ) )
-				{
-				case EOB_ACT_LAST_MATCH:
-					/* This happens because yy_g_n_b()
-					 * sees that we've accumulated a
-					 * token and flags that we need to
-					 * try matching the token before
-					 * proceeding.  But for input(),
-					 * there's no matching to consider.
-					 * So convert the EOB_ACT_LAST_MATCH
-					 * to EOB_ACT_END_OF_FILE.
-					 */
-
-					/* Reset buffer status. */
-					yyrestart( yyin );
-
-					/*FALLTHROUGH*/
-
-				case EOB_ACT_END_OF_FILE:
-					{
-					if ( yywrap(  ) )
-#ifdef YY_FLEX_LEX_COMPAT
-						return 0;
-#else
-						return EOF;
-#endif
-
-					if ( ! (yy_did_buffer_switch_on_eof) )
-						YY_NEW_FILE;
-#ifdef __cplusplus
-					return yyinput();
-#else
-					return input();
-#endif
-					}
-
-				case EOB_ACT_CONTINUE_SCAN:
-					(yy_c_buf_p) = (yytext_ptr) + offset;
-					break;
-				}
-			}
-		}
-
-	c = *(unsigned char *) (yy_c_buf_p);	/* cast for 8-bit char's */
-	*(yy_c_buf_p) = '\0';	/* preserve yytext */
-	(yy_hold_char) = *++(yy_c_buf_p);
-
-	return c;
-}
-#endif	/* ifndef YY_NO_INPUT */
-
-/** Immediately switch to a different input stream.
- * @param input_file A readable stream.
- * 
- * @note This function does not reset the start condition to @c INITIAL .
- */
-    void yyrestart  (FILE * input_file )
-{
-    
-	if ( ! YY_CURRENT_BUFFER ){
-        yyensure_buffer_stack ();
-		YY_CURRENT_BUFFER_LVALUE =
-            yy_create_buffer( yyin, YY_BUF_SIZE );
-	}
-
-	yy_init_buffer( YY_CURRENT_BUFFER, input_file );
-	yy_load_buffer_state(  );
-}
-
-/** Switch to a different input buffer.
- * @param new_buffer The new input buffer.
- * 
- */
-    void yy_switch_to_buffer  (YY_BUFFER_STATE  new_buffer )
-{
-    
-	/* TODO. We should be able to replace this entire function body
-	 * with
-	 *		yypop_buffer_state();
-	 *		yypush_buffer_state(new_buffer);
-     */
-	yyensure_buffer_stack ();
-	if ( YY_CURRENT_BUFFER == new_buffer )
-		return;
-
-	if ( YY_CURRENT_BUFFER )
-		{
-		/* Flush out information for old buffer. */
-		*(yy_c_buf_p) = (yy_hold_char);
-		YY_CURRENT_BUFFER_LVALUE->yy_buf_pos = (yy_c_buf_p);
-		YY_CURRENT_BUFFER_LVALUE->yy_n_chars = (yy_n_chars);
-		}
-
-	YY_CURRENT_BUFFER_LVALUE = new_buffer;
-	yy_load_buffer_state(  );
-
-	/* We don't actually know whether we did this switch during
-	 * EOF (yywrap()) processing, but the only time this flag
-	 * is looked at is after yywrap() is called, so it's safe
-	 * to go ahead and always set it.
-	 */
-	(yy_did_buffer_switch_on_eof) = 1;
-}
-
-static void yy_load_buffer_state  (void)
-{
-    	(yy_n_chars) = YY_CURRENT_BUFFER_LVALUE->yy_n_chars;
-	(yytext_ptr) = (yy_c_buf_p) = YY_CURRENT_BUFFER_LVALUE->yy_buf_pos;
-	yyin = YY_CURRENT_BUFFER_LVALUE->yy_input_file;
-	(yy_hold_char) = *(yy_c_buf_p);
-}
-
-/** Allocate and initialize an input buffer state.
- * @param file A readable stream.
- * @param size The character buffer size in bytes. When in doubt, use @c YY_BUF_SIZE.
- * 
- * @return the allocated buffer state.
- */
-    YY_BUFFER_STATE yy_create_buffer  (FILE * file, int  size )
-{
-	YY_BUFFER_STATE b;
-    
-	b = (YY_BUFFER_STATE) yyalloc( sizeof( struct yy_buffer_state )  );
-	if ( ! b )
-		YY_FATAL_ERROR( "out of dynamic memory in yy_create_buffer()" );
-
-	b->yy_buf_size = size;
-
-	/* yy_ch_buf has to be 2 characters longer than the size given because
-	 * we need to put in 2 end-of-buffer characters.
-	 */
-	b->yy_ch_buf = (char *) yyalloc( (yy_size_t) (b->yy_buf_size + 2)  );
-	if ( ! b->yy_ch_buf )
-		YY_FATAL_ERROR( "out of dynamic memory in yy_create_buffer()" );
-
-	b->yy_is_our_buffer = 1;
-
-	yy_init_buffer( b, file );
-
-	return b;
-}
-
-/** Destroy the buffer.
- * @param b a buffer created with yy_create_buffer()
- * 
- */
-    void yy_delete_buffer (YY_BUFFER_STATE  b )
-{
-    
-	if ( ! b )
-		return;
-
-	if ( b == YY_CURRENT_BUFFER ) /* Not sure if we should pop here. */
-		YY_CURRENT_BUFFER_LVALUE = (YY_BUFFER_STATE) 0;
-
-	if ( b->yy_is_our_buffer )
-		yyfree( (void *) b->yy_ch_buf  );
-
-	yyfree( (void *) b  );
-}
-
-/* Initializes or reinitializes a buffer.
- * This function is sometimes called more than once on the same buffer,
- * such as during a yyrestart() or at EOF.
- */
-    static void yy_init_buffer  (YY_BUFFER_STATE  b, FILE * file )
-
-{
-	int oerrno = errno;
-    
-	yy_flush_buffer( b );
-
-	b->yy_input_file = file;
-	b->yy_fill_buffer = 1;
-
-    /* If b is the current buffer, then yy_init_buffer was _probably_
-     * called from yyrestart() or through yy_get_next_buffer.
-     * In that case, we don't want to reset the lineno or column.
-     */
-    if (b != YY_CURRENT_BUFFER){
-        b->yy_bs_lineno = 1;
-        b->yy_bs_column = 0;
-    }
-
-        b->yy_is_interactive = file ? (isatty( fileno(file) ) > 0) : 0;
-    
-	errno = oerrno;
-}
-
-/** Discard all buffered characters. On the next scan, YY_INPUT will be called.
- * @param b the buffer state to be flushed, usually @c YY_CURRENT_BUFFER.
- * 
- */
-    void yy_flush_buffer (YY_BUFFER_STATE  b )
-{
-    	if ( ! b )
-		return;
-
-	b->yy_n_chars = 0;
-
-	/* We always need two end-of-buffer characters.  The first causes
-	 * a transition to the end-of-buffer state.  The second causes
-	 * a jam in that state.
-	 */
-	b->yy_ch_buf[0] = YY_END_OF_BUFFER_CHAR;
-	b->yy_ch_buf[1] = YY_END_OF_BUFFER_CHAR;
-
-	b->yy_buf_pos = &b->yy_ch_buf[0];
-
-	b->yy_at_bol = 1;
-	b->yy_buffer_status = YY_BUFFER_NEW;
-
-	if ( b == YY_CURRENT_BUFFER )
-		yy_load_buffer_state(  );
-}
-
-/** Pushes the new state onto the stack. The new state becomes
- *  the current state. This function will allocate the stack
- *  if necessary.
- *  @param new_buffer The new state.
- *  
- */
-void yypush_buffer_state (YY_BUFFER_STATE new_buffer )
-{
-    	if (new_buffer == NULL)
-		return;
-
-	yyensure_buffer_stack();
-
-	/* This block is copied from yy_switch_to_buffer. */
-	if ( YY_CURRENT_BUFFER )
-		{
-		/* Flush out information for old buffer. */
-		*(yy_c_buf_p) = (yy_hold_char);
-		YY_CURRENT_BUFFER_LVALUE->yy_buf_pos = (yy_c_buf_p);
-		YY_CURRENT_BUFFER_LVALUE->yy_n_chars = (yy_n_chars);
-		}
-
-	/* Only push if top exists. Otherwise, replace top. */
-	if (YY_CURRENT_BUFFER)
-		(yy_buffer_stack_top)++;
-	YY_CURRENT_BUFFER_LVALUE = new_buffer;
-
-	/* copied from yy_switch_to_buffer. */
-	yy_load_buffer_state(  );
-	(yy_did_buffer_switch_on_eof) = 1;
-}
-
-/** Removes and deletes the top of the stack, if present.
- *  The next element becomes the new top.
- *  
- */
-void yypop_buffer_state (void)
-{
-    	if (!YY_CURRENT_BUFFER)
-		return;
-
-	yy_delete_buffer(YY_CURRENT_BUFFER );
-	YY_CURRENT_BUFFER_LVALUE = NULL;
-	if ((yy_buffer_stack_top) > 0)
-		--(yy_buffer_stack_top);
-
-	if (YY_CURRENT_BUFFER) {
-		yy_load_buffer_state(  );
-		(yy_did_buffer_switch_on_eof) = 1;
-	}
-}
-
-/* Allocates the stack if it does not exist.
- *  Guarantees space for at least one push.
- */
-static void yyensure_buffer_stack (void)
-{
-	yy_size_t num_to_alloc;
-    
-	if (!(yy_buffer_stack)) {
-
-		/* First allocation is just for 2 elements, since we don't know if this
-		 * scanner will even need a stack. We use 2 instead of 1 to avoid an
-		 * immediate realloc on the next call.
-         */
-      num_to_alloc = 1; /* After all that talk, this was set to 1 anyways... */
-		(yy_buffer_stack) = (struct yy_buffer_state**)yyalloc
-								(num_to_alloc * sizeof(struct yy_buffer_state*)
-								);
-		if ( ! (yy_buffer_stack) )
-			YY_FATAL_ERROR( "out of dynamic memory in yyensure_buffer_stack()" );
-
-		memset((yy_buffer_stack), 0, num_to_alloc * sizeof(struct yy_buffer_state*));
-
-		(yy_buffer_stack_max) = num_to_alloc;
-		(yy_buffer_stack_top) = 0;
-		return;
-	}
-
-	if ((yy_buffer_stack_top) >= ((yy_buffer_stack_max)) - 1){
-
-		/* Increase the buffer to prepare for a possible push. */
-		yy_size_t grow_size = 8 /* arbitrary grow size */;
-
-		num_to_alloc = (yy_buffer_stack_max) + grow_size;
-		(yy_buffer_stack) = (struct yy_buffer_state**)yyrealloc
-								((yy_buffer_stack),
-								num_to_alloc * sizeof(struct yy_buffer_state*)
-								);
-		if ( ! (yy_buffer_stack) )
-			YY_FATAL_ERROR( "out of dynamic memory in yyensure_buffer_stack()" );
-
-		/* zero only the new slots.*/
-		memset((yy_buffer_stack) + (yy_buffer_stack_max), 0, grow_size * sizeof(struct yy_buffer_state*));
-		(yy_buffer_stack_max) = num_to_alloc;
-	}
-}
-
-#ifndef YY_EXIT_FAILURE
-#define YY_EXIT_FAILURE 2
-#endif
-
-static void yynoreturn yy_fatal_error (const char* msg )
-{
-			fprintf( stderr, "%s\n", msg );
-	exit( YY_EXIT_FAILURE );
-}
-
-/* Redefine yyless() so it works in section 3 code. */
-
-#undef yyless
-#define yyless(n) \
-	do \
-		{ \
-		/* Undo effects of setting up yytext. */ \
-        int yyless_macro_arg = (n); \
-        YY_LESS_LINENO(yyless_macro_arg);\
-		yytext[yyleng] = (yy_hold_char); \
-		(yy_c_buf_p) = yytext + yyless_macro_arg; \
-		(yy_hold_char) = *(yy_c_buf_p); \
-		*(yy_c_buf_p) = '\0'; \
-		yyleng = yyless_macro_arg; \
-		} \
-	while ( 0 )
-
-/* Accessor  methods (get/set functions) to struct members. */
-
-/** Get the current line number.
- * 
- */
-int yyget_lineno  (void)
-{
-    
-    return yylineno;
-}
-
-/** Get the input stream.
- * 
- */
-FILE *yyget_in  (void)
-{
-        return yyin;
-}
-
-/** Get the output stream.
- * 
- */
-FILE *yyget_out  (void)
-{
-        return yyout;
-}
-
-/** Get the length of the current token.
- * 
- */
-int yyget_leng  (void)
-{
-        return yyleng;
-}
-
-/** Get the current token.
- * 
- */
-
-char *yyget_text  (void)
-{
-        return yytext;
-}
-
-/** Set the current line number.
- * @param _line_number line number
- * 
- */
-void yyset_lineno (int  _line_number )
-{
-    
-    yylineno = _line_number;
-}
-
-/** Set the input stream. This does not discard the current
- * input buffer.
- * @param _in_str A readable stream.
- * 
- * @see yy_switch_to_buffer
- */
-void yyset_in (FILE *  _in_str )
-{
-        yyin = _in_str ;
-}
-
-void yyset_out (FILE *  _out_str )
-{
-        yyout = _out_str ;
-}
-
-int yyget_debug  (void)
-{
-        return yy_flex_debug;
-}
-
-void yyset_debug (int  _bdebug )
-{
-        yy_flex_debug = _bdebug ;
-}
-
-static int yy_init_globals (void)
-{
-        /* Initialization is the same as for the non-reentrant scanner.
-     * This function is called from yylex_destroy(), so don't allocate here.
-     */
-
-    (yy_buffer_stack) = NULL;
-    (yy_buffer_stack_top) = 0;
-    (yy_buffer_stack_max) = 0;
-    (yy_c_buf_p) = NULL;
-    (yy_init) = 0;
-    (yy_start) = 0;
-
-/* Defined in main.c */
-#ifdef YY_STDINIT
-    yyin = stdin;
-    yyout = stdout;
-#else
-    yyin = NULL;
-    yyout = NULL;
-#endif
-
-    /* For future reference: Set errno on error, since we are called by
-     * yylex_init()
-     */
-    return 0;
-}
-
-/* yylex_destroy is for both reentrant and non-reentrant scanners. */
-int yylex_destroy  (void)
-{
-    
-    /* Pop the buffer stack, destroying each element. */
-	while(YY_CURRENT_BUFFER){
-		yy_delete_buffer( YY_CURRENT_BUFFER  );
-		YY_CURRENT_BUFFER_LVALUE = NULL;
-		yypop_buffer_state();
-	}
-
-	/* Destroy the stack itself. */
-	yyfree((yy_buffer_stack) );
-	(yy_buffer_stack) = NULL;
-
-    /* Reset the globals. This is important in a non-reentrant scanner so the next time
-     * yylex() is called, initialization will occur. */
-    yy_init_globals( );
-
-    return 0;
-}
-
-/*
- * Internal utility routines.
- */
-
-#ifndef yytext_ptr
-static void yy_flex_strncpy (char* s1, const char * s2, int n )
-{
-		
-	int i;
-	for ( i = 0; i < n; ++i )
-		s1[i] = s2[i];
-}
-#endif
-
-#ifdef YY_NEED_STRLEN
-static int yy_flex_strlen (const char * s )
-{
-	int n;
-	for ( n = 0; s[n]; ++n )
-		;
-
-	return n;
-}
-#endif
-
-void *yyalloc (yy_size_t  size )
-{
-			return malloc(size);
-}
-
-void *yyrealloc  (void * ptr, yy_size_t  size )
-{
-		
-	/* The cast to (char *) in the following accommodates both
-	 * implementations that use char* generic pointers, and those
-	 * that use void* generic pointers.  It works with the latter
-	 * because both ANSI C and C++ allow castless assignment from
-	 * any pointer type to void*, and deal with argument conversions
-	 * as though doing an assignment.
-	 */
-	return realloc(ptr, size);
-}
-
-void yyfree (void * ptr )
-{
-			free( (char *) ptr );	/* see yyrealloc() for (char *) cast */
-}
-
-#define YYTABLES_NAME "yytables"
-
-#line 96 "sgf_l.l"
-
-
@@ -0,0 +1,603 @@
+/*
+ * Copyright (C) 2026 the AUTHORS
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * $Id$
+ */
+
+/*
+ * Opening book: rolled out chequer plays for the first rolls of a game.
+ *
+ * For each position, roll and score, the book keeps the best few moves
+ * with their rollout results. Move analysis and hints find the moves with
+ * BookFindnSaveBestMoves(), which gives the book moves their rollout
+ * results; everywhere else, inside evaluations and in rollouts, the moves
+ * are evaluated as usual.
+ *
+ * "save openingbook" builds the book: starting from the opening position,
+ * it finds the candidates of each roll with the analysis settings, rolls
+ * them out with the rollout settings and follows the candidates to the
+ * next roll. The book is kept for the score of the current match, so
+ * running it at several scores (see scripts/make_opening_book.py) adds
+ * them all to the same file.
+ */
+
+#include "config.h"
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "backgammon.h"
+#include "drawboard.h"
+#include "openingbook.h"
+#include "positionid.h"
+#include "progress.h"
+#include "rollout.h"
+#include "util.h"
+
+#define BOOK_CRAWFORD 1
+#define BOOK_JACOBY 2
+#define BOOK_BEAVERS 4
+
+typedef int (*cfunc) (const void *, const void *);
+
+typedef struct {
+    positionkey key;            /* position, player on roll */
+    unsigned char anDice[2];    /* larger die first */
+    unsigned char bgv;
+    unsigned char nMatchTo;     /* 0 for money */
+    unsigned char anScore[2];   /* player on roll first */
+    unsigned char fFlags;       /* BOOK_CRAWFORD, BOOK_JACOBY, BOOK_BEAVERS */
+} bookkey;
+
+typedef struct {
+    positionkey key;            /* position after the move */
+    int anMove[8];
+    float rScore, rScore2;
+    float arEvalMove[NUM_ROLLOUT_OUTPUTS];
+    float arEvalStdDev[NUM_ROLLOUT_OUTPUTS];
+    evalsetup esMove;
+} bookmove;
+
+typedef struct {
+    bookkey bk;
+    unsigned int nPly;          /* rolls played since the opening position */
+    unsigned int cMoves;
+    bookmove abm[BOOK_MAX_MOVES];       /* best move first */
+} bookentry;
+
+int fUseOpeningBook = TRUE;
+
+static GHashTable *phBook = NULL;
+static char *szBookFile = NULL;
+
+static guint
+BookKeyHash(gconstpointer p)
+{
+    const bookkey *pbk = p;
+    guint h = 0;
+    int i;
+
+    for (i = 0; i < 7; i++)
+        h = h * 31 + pbk->key.data[i];
+
+    return h ^ (guint) (pbk->anDice[0] << 28 | pbk->anDice[1] << 24 | pbk->nMatchTo << 16 |
+                        pbk->anScore[0] << 8 | pbk->anScore[1]);
+}
+
+/* the keys are cleared before they are filled in, so the padding compares
+ * equal too */
+static gboolean
+BookKeyEqual(gconstpointer p0, gconstpointer p1)
+{
+    return !memcmp(p0, p1, sizeof(bookkey));
+}
+
+static GHashTable *
+BookNew(void)
+{
+    return g_hash_table_new_full(BookKeyHash, BookKeyEqual, NULL, g_free);
+}
+
+static void
+BookKey(bookkey * pbk, const TanBoard anBoard, int nDice0, int nDice1, const cubeinfo * pci)
+{
+    memset(pbk, 0, sizeof(bookkey));
+
+    PositionKey(anBoard, &pbk->key);
+    pbk->anDice[0] = (unsigned char) MAX(nDice0, nDice1);
+    pbk->anDice[1] = (unsigned char) MIN(nDice0, nDice1);
+    pbk->bgv = (unsigned char) pci->bgv;
+
+    if (pci->nMatchTo) {
+        pbk->nMatchTo = (unsigned char) pci->nMatchTo;
+        pbk->anScore[0] = (unsigned char) pci->anScore[pci->fMove];
+        pbk->anScore[1] = (unsigned char) pci->anScore[!pci->fMove];
+        if (pci->fCrawford)
+            pbk->fFlags |= BOOK_CRAWFORD;
+    } else {
+        if (pci->fJacoby)
+            pbk->fFlags |= BOOK_JACOBY;
+        if (pci->fBeavers)
+            pbk->fFlags |= BOOK_BEAVERS;
+    }
+}
+
+/* As the one-sided rollout cache, the file is a header followed by the
+ * entries as they are in memory, so a book is only meant to be used on
+ * the kind of machine that built it. */
+
+static const char szBookMagic[] = "GNUBG-BOOK 1";
+
+static GHashTable *
+BookRead(const char *szFile)
+{
+    FILE *pf;
+    char sz[sizeof(szBookMagic)];
+    guint32 cb;
+    bookentry be;
+    GHashTable *ph;
+
+    if ((pf = g_fopen(szFile, "rb")) == NULL)
+        return NULL;
+
+    if (fread(sz, sizeof(sz), 1, pf) != 1 || memcmp(sz, szBookMagic, sizeof(sz)) ||
+        fread(&cb, sizeof(cb), 1, pf) != 1 || cb != sizeof(bookentry)) {
+        fclose(pf);
+        errno = EINVAL;
+        return NULL;
+    }
+
+    ph = BookNew();
+
+    while (fread(&be, sizeof(be), 1, pf) == 1 && be.cMoves <= BOOK_MAX_MOVES) {
+        bookentry *pbe = g_new(bookentry, 1);
+
+        *pbe = be;
+        /* the key lives in the entry, so a duplicate must replace the key
+         * along with the entry it frees; the last one in the file wins */
+        g_hash_table_replace(ph, &pbe->bk, pbe);
+    }
+
+    fclose(pf);
+
+    return ph;
+}
+
+static void
+WriteBookEntry(gpointer UNUSED(key), gpointer p, gpointer pf)
+{
+    fwrite(p, sizeof(bookentry), 1, (FILE *) pf);
+}
+
+/* Write through a temporary file, so that an interrupted save never
+ * leaves half a book behind */
+static int
+BookWrite(GHashTable * ph, const char *szFile)
+{
+    gchar *szTemp = g_strconcat(szFile, ".tmp", NULL);
+    FILE *pf;
+    guint32 cb = sizeof(bookentry);
+    int ok;
+
+    if ((pf = g_fopen(szTemp, "wb")) == NULL) {
+        g_free(szTemp);
+        return -1;
+    }
+
+    fwrite(szBookMagic, sizeof(szBookMagic), 1, pf);
+    fwrite(&cb, sizeof(cb), 1, pf);
+    g_hash_table_foreach(ph, WriteBookEntry, pf);
+
+    ok = !ferror(pf);
+    ok = !fclose(pf) && ok;
+
+    if (ok) {
+        g_unlink(szFile);
+        ok = !g_rename(szTemp, szFile);
+    }
+    if (!ok)
+        g_unlink(szTemp);
+
+    g_free(szTemp);
+
+    return ok ? 0 : -1;
+}
+
+static void
+BookReplace(GHashTable * ph, const char *szFile)
+{
+    if (phBook)
+        g_hash_table_destroy(phBook);
+    g_free(szBookFile);
+
+    phBook = ph;
+    szBookFile = g_strdup(szFile);
+}
+
+/* Make szFile the book in use. This must not be called while moves are
+ * being evaluated. */
+extern int
+BookLoad(const char *szFile)
+{
+    GHashTable *ph = BookRead(szFile);
+
+    if (!ph)
+        return -1;
+
+    BookReplace(ph, szFile);
+
+    return 0;
+}
+
+extern void
+BookInit(void)
+{
+    char *sz = g_build_filename(szHomeDirectory, BOOK_FILE, NULL);
+
+    /* a book built by the user comes before the one installed with gnubg */
+    if (BookLoad(sz) < 0) {
+        if (errno != ENOENT)
+            outputerr(sz);
+        g_free(sz);
+
+        sz = BuildFilename(BOOK_FILE);
+        if (BookLoad(sz) < 0 && errno != ENOENT)
+            outputerr(sz);
+    }
+    g_free(sz);
+}
+
+extern unsigned int
+BookEntries(void)
+{
+    return phBook ? g_hash_table_size(phBook) : 0;
+}
+
+extern const char *
+BookFile(void)
+{
+    return szBookFile;
+}
+
+/* Give the book moves of pml, as found by FindnSaveBestMoves(), their
+ * rollout results and sort them in with the moves evaluated at the
+ * deepest ply */
+static void
+BookMoves(movelist * pml, const TanBoard anBoard, int nDice0, int nDice1,
+          const cubeinfo * pci, const evalcontext * pec, const positionkey * keyMove)
+{
+    const bookentry *pbe;
+    bookkey bk;
+    unsigned int i, j, cTop;
+
+    /* the book is rolled out with the cube in the centre, and moves played
+     * with noise are meant to differ from the best ones */
+    if (!fUseOpeningBook || !phBook || pci->nCube != 1 || pci->fCubeOwner != -1 || pec->rNoise > 0.0f)
+        return;
+
+    BookKey(&bk, anBoard, nDice0, nDice1, pci);
+
+    if (!(pbe = g_hash_table_lookup(phBook, &bk)) || !pbe->cMoves)
+        return;
+
+    /* a cubeful book answers for cubeless evaluations too, but not the
+     * other way round */
+    if (pec->fCubeful && !pbe->abm[0].esMove.rc.fCubeful)
+        return;
+
+    /* a move played outside the book is analysed as usual */
+    if (keyMove) {
+        for (i = 0; i < pbe->cMoves && !EqualKeys(*keyMove, pbe->abm[i].key); i++);
+        if (i == pbe->cMoves)
+            return;
+    }
+
+    /* the moves evaluated at the deepest ply come first */
+    for (cTop = 1; cTop < pml->cMoves && pml->amMoves[cTop].esMove.et == pml->amMoves[0].esMove.et
+         && pml->amMoves[cTop].esMove.ec.nPlies == pml->amMoves[0].esMove.ec.nPlies; cTop++);
+
+    for (i = 0; i < pbe->cMoves; i++) {
+        const bookmove *pbm = &pbe->abm[i];
+        move m;
+
+        for (j = 0; j < pml->cMoves && !EqualKeys(pml->amMoves[j].key, pbm->key); j++);
+        if (j == pml->cMoves)
+            continue;
+
+        m = pml->amMoves[j];
+
+        memcpy(m.arEvalMove, pbm->arEvalMove, sizeof(m.arEvalMove));
+        memcpy(m.arEvalStdDev, pbm->arEvalStdDev, sizeof(m.arEvalStdDev));
+        m.esMove = pbm->esMove;
+        m.rScore = pec->fCubeful ? pbm->rScore : pbm->rScore2;
+        m.rScore2 = pbm->rScore2;
+
+        if (j >= cTop) {
+            /* filtered out at a lower ply; move it up */
+            memmove(pml->amMoves + cTop + 1, pml->amMoves + cTop, (j - cTop) * sizeof(move));
+            j = cTop++;
+        }
+
+        pml->amMoves[j] = m;
+    }
+
+    qsort(pml->amMoves, cTop, sizeof(move), (cfunc) CompareMoves);
+    pml->iMoveBest = 0;
+    pml->rBestScore = pml->amMoves[0].rScore;
+}
+
+extern int
+BookFindnSaveBestMoves(movelist * pml, int nDice0, int nDice1, const TanBoard anBoard,
+                       positionkey * keyMove, const float rThr, const cubeinfo * pci, const evalcontext * pec,
+                       movefilter aamf[MAX_FILTER_PLIES][MAX_FILTER_PLIES])
+{
+    if (FindnSaveBestMoves(pml, nDice0, nDice1, anBoard, keyMove, rThr, pci, pec, aamf) < 0)
+        return -1;
+
+    if (pml->cMoves)
+        BookMoves(pml, anBoard, nDice0, nDice1, pci, pec, keyMove);
+
+    return 0;
+}
+
+/* Find the candidates for the roll with the analysis settings and roll them
+ * out. Returns NULL if interrupted. */
+static bookentry *
+BookRollout(const TanBoard anBoard, int nDice0, int nDice1, const cubeinfo * pci, unsigned int nPly)
+{
+    bookentry *pbe;
+    movelist ml;
+    cubeinfo ci = *pci;
+    move *apm[BOOK_MAX_MOVES];
+    cubeinfo *apci[BOOK_MAX_MOVES];
+    char asz[BOOK_MAX_MOVES][FORMATEDMOVESIZE];
+    unsigned int i, c;
+
+    if (FindnSaveBestMoves(&ml, nDice0, nDice1, anBoard, NULL, 0.0f, pci,
+                           &esAnalysisChequer.ec, aamfAnalysis) < 0 || fInterrupt) {
+        g_free(ml.amMoves);
+        return NULL;
+    }
+
+    for (c = 0; c < ml.cMoves && c < BOOK_MAX_MOVES; c++) {
+        if (ml.amMoves[0].rScore - ml.amMoves[c].rScore > BOOK_THRESHOLD)
+            break;
+
+        apm[c] = &ml.amMoves[c];
+        apci[c] = &ci;
+        FormatMove(asz[c], anBoard, ml.amMoves[c].anMove);
+    }
+
+    if (c) {
+        void *p;
+        int r;
+
+        RolloutProgressStart(&ci, (int) c, NULL, &rcRollout, asz, TRUE, &p);
+        r = ScoreMoveRollout(apm, apci, (int) c, RolloutProgress, p);
+        RolloutProgressEnd(&p, TRUE);
+
+        if (r < 0 || fInterrupt) {
+            g_free(ml.amMoves);
+            return NULL;
+        }
+
+        qsort(ml.amMoves, c, sizeof(move), (cfunc) CompareMoves);
+    }
+
+    pbe = g_new0(bookentry, 1);
+    BookKey(&pbe->bk, anBoard, nDice0, nDice1, pci);
+    pbe->nPly = nPly;
+    pbe->cMoves = c;
+
+    for (i = 0; i < c; i++) {
+        const move *pm = &ml.amMoves[i];
+        bookmove *pbm = &pbe->abm[i];
+
+        CopyKey(pm->key, pbm->key);
+        memcpy(pbm->anMove, pm->anMove, sizeof(pbm->anMove));
+        pbm->rScore = pm->rScore;
+        pbm->rScore2 = pm->rScore2;
+        memcpy(pbm->arEvalMove, pm->arEvalMove, sizeof(pbm->arEvalMove));
+        memcpy(pbm->arEvalStdDev, pm->arEvalStdDev, sizeof(pbm->arEvalStdDev));
+        pbm->esMove = pm->esMove;
+    }
+
+    g_free(ml.amMoves);
+
+    return pbe;
+}
+
+static guint
+PositionKeyHash(gconstpointer p)
+{
+    const positionkey *pkey = p;
+    guint h = 0;
+    int i;
+
+    for (i = 0; i < 7; i++)
+        h = h * 31 + pkey->data[i];
+
+    return h;
+}
+
+static gboolean
+PositionKeyEqual(gconstpointer p0, gconstpointer p1)
+{
+    return EqualKeys(*(const positionkey *) p0, *(const positionkey *) p1);
+}
+
+/* Add the rolls of the first nPlies turns of a game that fFirst starts to
+ * ph, at the score of the current match. Positions already in ph are kept,
+ * so that an interrupted build carries on where it stopped. Returns -1 if
+ * interrupted. */
+static int
+BookBuild(GHashTable * ph, int fFirst, unsigned int nPlies)
+{
+    GArray *akey = g_array_new(FALSE, FALSE, sizeof(positionkey));
+    TanBoard anBoard;
+    positionkey key;
+    unsigned int iPly, i, j;
+    int n0, n1, r = 0;
+
+    InitBoard(anBoard, ms.bgv);
+    PositionKey((ConstTanBoard) anBoard, &key);
+    g_array_append_val(akey, key);
+
+    for (iPly = 0; iPly < nPlies && !r; iPly++) {
+        GArray *akeyNext = g_array_new(FALSE, FALSE, sizeof(positionkey));
+        GHashTable *phSeen = g_hash_table_new_full(PositionKeyHash, PositionKeyEqual, g_free, NULL);
+        cubeinfo ci;
+
+        SetCubeInfo(&ci, 1, -1, fFirst ^ (int) (iPly & 1), ms.nMatchTo, ms.anScore, ms.fCrawford,
+                    ms.fJacoby, nBeavers, ms.bgv);
+
+        for (i = 0; i < akey->len && !r; i++) {
+            PositionFromKey(anBoard, &g_array_index(akey, positionkey, i));
+
+            outputf(_("Opening book: roll %u, position %u of %u\n"), iPly + 1, i + 1, akey->len);
+            outputx();
+
+            for (n0 = 1; n0 <= 6 && !r; n0++)
+                for (n1 = 1; n1 <= n0 && !r; n1++) {
+                    bookkey bk;
+                    bookentry *pbe;
+
+                    /* the opening roll is never a double */
+                    if (iPly == 0 && n0 == n1)
+                        continue;
+
+                    BookKey(&bk, (ConstTanBoard) anBoard, n0, n1, &ci);
+
+                    if (!(pbe = g_hash_table_lookup(ph, &bk))) {
+                        if (!(pbe = BookRollout((ConstTanBoard) anBoard, n0, n1, &ci, iPly))) {
+                            r = -1;
+                            break;
+                        }
+                        g_hash_table_insert(ph, &pbe->bk, pbe);
+                    }
+
+                    if (iPly + 1 == nPlies)
+                        continue;
+
+                    for (j = 0; j < pbe->cMoves; j++) {
+                        TanBoard anNext;
+
+                        PositionFromKeySwapped(anNext, &pbe->abm[j].key);
+                        PositionKey((ConstTanBoard) anNext, &key);
+
+                        if (!g_hash_table_lookup(phSeen, &key)) {
+                            positionkey *pkey = g_new(positionkey, 1);
+
+                            *pkey = key;
+                            g_hash_table_insert(phSeen, pkey, pkey);
+                            g_array_append_val(akeyNext, key);
+                        }
+                    }
+                }
+        }
+
+        g_hash_table_destroy(phSeen);
+        g_array_free(akey, TRUE);
+        akey = akeyNext;
+    }
+
+    g_array_free(akey, TRUE);
+
+    return r;
+}
+
+extern void
+CommandLoadOpeningBook(char *sz)
+{
+    sz = NextToken(&sz);
+
+    if (!sz || !*sz) {
+        outputl(_("You must specify a file to load from (see `help load " "openingbook')."));
+        return;
+    }
+
+    if (BookLoad(sz) < 0) {
+        if (errno == EINVAL)
+            outputerrf(_("`%s' is not an opening book of this version of GNU Backgammon"), sz);
+        else
+            outputerr(sz);
+        return;
+    }
+
+    outputf(_("Opening book `%s' loaded (%u positions).\n"), sz, BookEntries());
+}
+
+extern void
+CommandSaveOpeningBook(char *sz)
+{
+    char *szFile = NextToken(&sz);
+    int nPlies = 2;
+    int fUse = fUseOpeningBook;
+    int fFirst, r = 0;
+    unsigned int cOld;
+    GHashTable *ph;
+
+    if (!szFile || !*szFile) {
+        outputl(_("You must specify a file to save to (see `help save " "openingbook')."));
+        return;
+    }
+
+    if (sz && *sz && ((nPlies = ParseNumber(&sz)) < 1 || nPlies > BOOK_MAX_PLIES)) {
+        outputf(_("The number of rolls must be between 1 and %d (see `help save openingbook').\n"), BOOK_MAX_PLIES);
+        return;
+    }
+
+    /* add to the book if there is one already */
+    if (!(ph = BookRead(szFile))) {
+        if (errno != ENOENT) {
+            outputerr(szFile);
+            return;
+        }
+        ph = BookNew();
+    }
+    cOld = g_hash_table_size(ph);
+
+    /* the book must not answer for the positions it is rolling out */
+    fUseOpeningBook = FALSE;
+
+    for (fFirst = 0; fFirst < 2 && !r; fFirst++) {
+        /* at money and at equal scores both players have the same book */
+        if (fFirst && (!ms.nMatchTo || ms.anScore[0] == ms.anScore[1]))
+            break;
+
+        r = BookBuild(ph, fFirst, (unsigned int) nPlies);
+    }
+
+    fUseOpeningBook = fUse;
+
+    if (BookWrite(ph, szFile) < 0) {
+        outputerr(szFile);
+        g_hash_table_destroy(ph);
+        return;
+    }
+
+    outputf(_("%u positions added to the opening book `%s' (%u in all).\n"),
+            g_hash_table_size(ph) - cOld, szFile, g_hash_table_size(ph));
+    if (r < 0)
+        outputl(_("The book is not complete; save it again to carry on."));
+    outputx();
+
+    BookReplace(ph, szFile);
+}
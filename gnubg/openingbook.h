@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2026 the AUTHORS
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * $Id$
+ */
+
+#ifndef OPENINGBOOK_H
+#define OPENINGBOOK_H
+
+#include "eval.h"
+
+/* candidate moves rolled out for each roll */
+#define BOOK_MAX_MOVES 4
+
+/* moves further than this behind the best one are not rolled out */
+#define BOOK_THRESHOLD 0.10f
+
+/* deepest book that "save openingbook" builds */
+#define BOOK_MAX_PLIES 4
+
+/* name of the book in the user's and in the data directory */
+#define BOOK_FILE "gnubg.obk"
+
+extern int fUseOpeningBook;
+
+extern int BookLoad(const char *szFile);
+extern void BookInit(void);
+extern unsigned int BookEntries(void);
+extern const char *BookFile(void);
+
+/* FindnSaveBestMoves() for move analysis and hints, with the rollout
+ * results of the book moves */
+extern int BookFindnSaveBestMoves(movelist * pml, int nDice0, int nDice1, const TanBoard anBoard,
+                                  positionkey * keyMove, const float rThr, const cubeinfo * pci,
+                                  const evalcontext * pec, movefilter aamf[MAX_FILTER_PLIES][MAX_FILTER_PLIES]);
+
+#endif                          /* OPENINGBOOK_H */
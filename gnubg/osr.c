@@ -26,17 +26,28 @@
 #include "config.h"
 
 #include <glib.h>
+#include <glib/gstdio.h>
+#include <errno.h>
+#include <stdio.h>
 #include <string.h>
 
 #include "eval.h"
 #include "positionid.h"
-#include "SFMT.h"
+#include "philox.h"
 #include "osr.h"
 
-#define MAX_PROBS        32
-#define MAX_GAMMON_PROBS 15
+#define MAX_PROBS        OSR_MAX_PROBS
+#define MAX_GAMMON_PROBS OSR_MAX_GAMMON_PROBS
 
-static sfmt_t sfmt;
+/* distributions kept before the cache is emptied */
+#define OSR_CACHE_SIZE 65536
+
+void (*OSRRunChunks) (osrchunk aoc[], unsigned int cChunks) = NULL;
+
+/* Dice after the quasi-random turns come from Philox keyed with "OSR",
+ * so that a side's distribution depends only on its own chequers and
+ * not on how many dice the other side or other threads used. */
+static const uint32_t anOSRKey[2] = { 0x4f5352, 0 };
 
 static void
 OSRQuasiRandomDice(const unsigned int iTurn, const unsigned int iGame, const unsigned int cGames, unsigned int anDice[2])
@@ -48,18 +59,28 @@ OSRQuasiRandomDice(const unsigned int iTurn, const unsigned int iGame, const uns
         anDice[0] = ((iGame / 36) % 6) + 1;
         anDice[1] = ((iGame / 216) % 6) + 1;
     } else {
-        anDice[0] = (unsigned int) (sfmt_genrand_uint32(&sfmt) % 6) + 1;
-        anDice[1] = (unsigned int) (sfmt_genrand_uint32(&sfmt) % 6) + 1;
+        uint32_t an[4];
+
+        an[0] = iGame;
+        an[1] = iTurn;
+        an[2] = an[3] = 0;
+        philox4x32(an, anOSRKey);
+
+        anDice[0] = (unsigned int) (an[0] % 6) + 1;
+        anDice[1] = (unsigned int) (an[1] % 6) + 1;
     }
 }
 
-/* Fill aaProb with one sided bearoff probabilities for position with */
-/* bearoff id n.                                                      */
+/* Fill aaProb with one sided bearoff probabilities for the position */
+/* of the chequers in anBoard.                                        */
 
 static void
-getBearoffProbs(const unsigned int n, unsigned short int aaProb[32])
+getBearoffProbs(const unsigned int anBoard[], unsigned short int aaProb[32])
 {
-    if (BearoffDist(pbc1, n, NULL, NULL, NULL, aaProb, NULL))
+    bearoffcontext *pbc = GetBearoff(BDB_1);
+    unsigned int n = PositionBearoff(anBoard, pbc->nPoints, pbc->nChequers);
+
+    if (BearoffDist(pbc, n, NULL, NULL, NULL, aaProb, NULL))
         g_assert_not_reached();
 }
 
@@ -579,22 +600,20 @@ osr(unsigned int anBoard[25], const unsigned int iGame, const unsigned int nGame
 
 
 /*
- * RollOSR: perform onesided rollout
+ * OSRRunChunk: roll out one chunk of a one sided rollout
  *
  * Input:
- *   nGames: number of simulations
- *   anBoard: the board 
- *   nOut: number of chequers outside home quadrant
+ *   poc: the side, the number of chequers outside home quadrant
+ *        and the games to roll out
  *
  * Output:
- *   arProbs[ nMaxProbs ]: probabilities
- *   arGammonProbs[ nMaxGammonProbs ]: gammon probabilities
+ *   poc->arProbs: sum over the games of the bear off probabilities
+ *   poc->anCounts: number of games getting home in i rolls
  *
  */
 
-static void
-rollOSR(const unsigned int nGames, const unsigned int anBoard[25], const unsigned int nOut,
-        float arProbs[], const unsigned int nMaxProbs, float arGammonProbs[], const unsigned int nMaxGammonProbs)
+extern void
+OSRRunChunk(osrchunk * poc)
 {
 
     unsigned int an[25];
@@ -602,23 +621,19 @@ rollOSR(const unsigned int nGames, const unsigned int anBoard[25], const unsigne
     unsigned int i;
     unsigned int iGame;
 
-    int *anCounts = (int *) g_alloca(nMaxGammonProbs * sizeof(int));
-
-    memset(anCounts, 0, sizeof(int) * nMaxGammonProbs);
-
-    for (i = 0; i < nMaxProbs; ++i)
-        arProbs[i] = 0.0f;
+    memset(poc->arProbs, 0, sizeof(poc->arProbs));
+    memset(poc->anCounts, 0, sizeof(poc->anCounts));
 
     /* perform rollouts */
 
-    for (iGame = 0; iGame < nGames; ++iGame) {
+    for (iGame = poc->iGame; iGame < poc->iGame + poc->cGames; ++iGame) {
         unsigned int n, m;
 
-        memcpy(an, anBoard, sizeof(an));
+        memcpy(an, poc->anBoard, sizeof(an));
 
         /* do actual rollout */
 
-        n = osr(an, iGame, nGames, nOut);
+        n = osr(an, iGame, poc->nGames, poc->nOut);
 
         /* number of chequers in home quadrant */
 
@@ -628,20 +643,78 @@ rollOSR(const unsigned int nGames, const unsigned int anBoard[25], const unsigne
 
         /* update counts */
 
-        ++anCounts[MIN(m == 15 ? n + 1 : n, nMaxGammonProbs - 1)];
+        ++poc->anCounts[MIN(m == 15 ? n + 1 : n, MAX_GAMMON_PROBS - 1)];
 
         /* get prob. from bearoff1 */
 
-        getBearoffProbs(PositionBearoff(an, pbc1->nPoints, pbc1->nChequers), anProb);
+        getBearoffProbs(an, anProb);
 
         for (i = 0; i < 32; ++i)
-            arProbs[MIN(n + i, nMaxProbs - 1)] += anProb[i] / 65535.0f;
+            poc->arProbs[MIN(n + i, MAX_PROBS - 1)] += anProb[i] / 65535.0f;
+
+    }
+
+}
 
+
+/*
+ * RollOSR: perform onesided rollout
+ *
+ * Input:
+ *   nGames: number of simulations
+ *   anBoard: the board 
+ *   nOut: number of chequers outside home quadrant
+ *   fParallel: whether the chunks may be handed to OSRRunChunks
+ *
+ * Output:
+ *   arProbs[ MAX_PROBS ]: probabilities
+ *   arGammonProbs[ MAX_GAMMON_PROBS ]: gammon probabilities
+ *
+ * The games are split in chunks of OSR_CHUNK games and the chunks are
+ * summed in order, so the result does not depend on the number of threads.
+ */
+
+static void
+rollOSR(const unsigned int nGames, const unsigned int anBoard[25], const unsigned int nOut,
+        float arProbs[MAX_PROBS], float arGammonProbs[MAX_GAMMON_PROBS], const int fParallel)
+{
+
+    unsigned int cChunks = (nGames + OSR_CHUNK - 1) / OSR_CHUNK;
+    osrchunk *aoc = g_new(osrchunk, cChunks ? cChunks : 1);
+    unsigned int anCounts[MAX_GAMMON_PROBS];
+    unsigned int i, j;
+
+    for (i = 0; i < cChunks; ++i) {
+        aoc[i].anBoard = anBoard;
+        aoc[i].nOut = nOut;
+        aoc[i].iGame = i * OSR_CHUNK;
+        aoc[i].cGames = MIN(OSR_CHUNK, nGames - aoc[i].iGame);
+        aoc[i].nGames = nGames;
     }
 
+    if (fParallel && OSRRunChunks && cChunks > 1)
+        OSRRunChunks(aoc, cChunks);
+    else
+        for (i = 0; i < cChunks; ++i)
+            OSRRunChunk(&aoc[i]);
+
+    memset(anCounts, 0, sizeof(anCounts));
+
+    for (i = 0; i < MAX_PROBS; ++i)
+        arProbs[i] = 0.0f;
+
+    for (j = 0; j < cChunks; ++j) {
+        for (i = 0; i < MAX_PROBS; ++i)
+            arProbs[i] += aoc[j].arProbs[i];
+        for (i = 0; i < MAX_GAMMON_PROBS; ++i)
+            anCounts[i] += aoc[j].anCounts[i];
+    }
+
+    g_free(aoc);
+
     /* scale resulting probabilities */
 
-    for (i = 0; i < (unsigned int) nMaxProbs; ++i) {
+    for (i = 0; i < MAX_PROBS; ++i) {
         arProbs[i] /= (float)nGames;
         /* printf ( "arProbs[%d]=%f\n", i, arProbs[ i ] ); */
     }
@@ -649,7 +722,7 @@ rollOSR(const unsigned int nGames, const unsigned int anBoard[25], const unsigne
     /* calculate gammon probs. 
      * (prob. of getting inside home quadrant in i rolls */
 
-    for (i = 0; i < nMaxGammonProbs; ++i) {
+    for (i = 0; i < MAX_GAMMON_PROBS; ++i) {
         arGammonProbs[i] = (float)anCounts[i] / (float)nGames;
         /* printf ( "arGammonProbs[%d]=%f\n", i, arGammonProbs[ i ] ); */
     }
@@ -657,6 +730,208 @@ rollOSR(const unsigned int nGames, const unsigned int anBoard[25], const unsigne
 }
 
 
+/*
+ * Cache of one sided rollout distributions, keyed by one side of the
+ * board and the number of games. It is shared by all threads.
+ */
+
+typedef struct {
+    unsigned char anBoard[25];
+    unsigned int nGames;
+    float arProbs[MAX_PROBS];
+    float arGammonProbs[MAX_GAMMON_PROBS];
+} osrentry;
+
+static GHashTable *phOSRCache = NULL;
+G_LOCK_DEFINE_STATIC(osrcache);
+
+static guint
+OSREntryHash(gconstpointer p)
+{
+    const osrentry *poe = (const osrentry *) p;
+    guint h = poe->nGames;
+    unsigned int i;
+
+    for (i = 0; i < 25; ++i)
+        h = h * 31 + poe->anBoard[i];
+
+    return h;
+}
+
+static gboolean
+OSREntryEqual(gconstpointer p0, gconstpointer p1)
+{
+    const osrentry *poe0 = (const osrentry *) p0;
+    const osrentry *poe1 = (const osrentry *) p1;
+
+    return poe0->nGames == poe1->nGames && !memcmp(poe0->anBoard, poe1->anBoard, sizeof(poe0->anBoard));
+}
+
+static void
+OSRCacheCreate(void)
+{
+    if (!phOSRCache)
+        phOSRCache = g_hash_table_new_full(OSREntryHash, OSREntryEqual, g_free, NULL);
+}
+
+/* Add an entry, which the cache then owns. Call with the lock held. */
+static void
+OSRCacheInsert(osrentry * poe)
+{
+    OSRCacheCreate();
+
+    if (g_hash_table_lookup(phOSRCache, poe)) {
+        /* another thread got there first */
+        g_free(poe);
+        return;
+    }
+
+    if (g_hash_table_size(phOSRCache) >= OSR_CACHE_SIZE)
+        g_hash_table_remove_all(phOSRCache);
+
+    g_hash_table_insert(phOSRCache, poe, poe);
+}
+
+static void
+OSRKey(osrentry * poe, const unsigned int anBoard[25], const unsigned int nGames)
+{
+    unsigned int i;
+
+    memset(poe, 0, sizeof(osrentry));
+
+    for (i = 0; i < 25; ++i)
+        poe->anBoard[i] = (unsigned char) anBoard[i];
+    poe->nGames = nGames;
+}
+
+static int
+OSRCacheLookup(const unsigned int anBoard[25], const unsigned int nGames,
+               float arProbs[MAX_PROBS], float arGammonProbs[MAX_GAMMON_PROBS])
+{
+    osrentry oe;
+    const osrentry *poe = NULL;
+
+    OSRKey(&oe, anBoard, nGames);
+
+    G_LOCK(osrcache);
+
+    if (phOSRCache && (poe = g_hash_table_lookup(phOSRCache, &oe)) != NULL) {
+        memcpy(arProbs, poe->arProbs, sizeof(poe->arProbs));
+        memcpy(arGammonProbs, poe->arGammonProbs, sizeof(poe->arGammonProbs));
+    }
+
+    G_UNLOCK(osrcache);
+
+    return poe != NULL;
+}
+
+static void
+OSRCacheAdd(const unsigned int anBoard[25], const unsigned int nGames,
+            const float arProbs[MAX_PROBS], const float arGammonProbs[MAX_GAMMON_PROBS])
+{
+    osrentry *poe = g_new(osrentry, 1);
+
+    OSRKey(poe, anBoard, nGames);
+    memcpy(poe->arProbs, arProbs, sizeof(poe->arProbs));
+    memcpy(poe->arGammonProbs, arGammonProbs, sizeof(poe->arGammonProbs));
+
+    G_LOCK(osrcache);
+    OSRCacheInsert(poe);
+    G_UNLOCK(osrcache);
+}
+
+extern void
+OSRCacheFlush(void)
+{
+    G_LOCK(osrcache);
+    if (phOSRCache)
+        g_hash_table_remove_all(phOSRCache);
+    G_UNLOCK(osrcache);
+}
+
+extern unsigned int
+OSRCacheEntries(void)
+{
+    unsigned int n;
+
+    G_LOCK(osrcache);
+    n = phOSRCache ? g_hash_table_size(phOSRCache) : 0;
+    G_UNLOCK(osrcache);
+
+    return n;
+}
+
+/* The file is a header followed by the entries as they are in memory, so
+ * it is only meant to be read back on the same machine. */
+
+static const char szOSRCacheMagic[] = "GNUBG-OSR 1";
+
+extern int
+OSRCacheLoad(const char *szFile)
+{
+    FILE *pf;
+    char sz[sizeof(szOSRCacheMagic)];
+    guint32 cb;
+    osrentry oe;
+
+    if ((pf = g_fopen(szFile, "rb")) == NULL)
+        return -1;
+
+    if (fread(sz, sizeof(sz), 1, pf) != 1 || memcmp(sz, szOSRCacheMagic, sizeof(sz)) ||
+        fread(&cb, sizeof(cb), 1, pf) != 1 || cb != sizeof(osrentry)) {
+        fclose(pf);
+        errno = EINVAL;
+        return -1;
+    }
+
+    G_LOCK(osrcache);
+
+    while (fread(&oe, sizeof(oe), 1, pf) == 1) {
+        osrentry *poe = g_new(osrentry, 1);
+
+        memcpy(poe, &oe, sizeof(oe));
+        OSRCacheInsert(poe);
+    }
+
+    G_UNLOCK(osrcache);
+
+    fclose(pf);
+
+    return 0;
+}
+
+static void
+WriteOSREntry(gpointer p, gpointer UNUSED(value), gpointer pf)
+{
+    fwrite(p, sizeof(osrentry), 1, (FILE *) pf);
+}
+
+extern int
+OSRCacheSave(const char *szFile)
+{
+    FILE *pf;
+    guint32 cb = sizeof(osrentry);
+    int ok;
+
+    if ((pf = g_fopen(szFile, "wb")) == NULL)
+        return -1;
+
+    fwrite(szOSRCacheMagic, sizeof(szOSRCacheMagic), 1, pf);
+    fwrite(&cb, sizeof(cb), 1, pf);
+
+    G_LOCK(osrcache);
+    if (phOSRCache)
+        g_hash_table_foreach(phOSRCache, WriteOSREntry, pf);
+    G_UNLOCK(osrcache);
+
+    ok = !ferror(pf);
+
+    if (fclose(pf) || !ok)
+        return -1;
+
+    return 0;
+}
+
 
 /*
  * OSP: one sided probabilities
@@ -675,7 +950,7 @@ rollOSR(const unsigned int nGames, const unsigned int anBoard[25], const unsigne
 
 static unsigned int
 osp(const unsigned int anBoard[25], const unsigned int nGames,
-    unsigned int an[25], float arProbs[MAX_PROBS], float arGammonProbs[MAX_GAMMON_PROBS])
+    unsigned int an[25], float arProbs[MAX_PROBS], float arGammonProbs[MAX_GAMMON_PROBS], const int fParallel)
 {
 
     int i;
@@ -696,10 +971,13 @@ osp(const unsigned int anBoard[25], const unsigned int nGames,
     }
 
 
-    if (nOut > 0)
+    if (nOut > 0) {
         /* chequers outside home: do one sided rollout */
-        rollOSR(nGames, an, nOut, arProbs, MAX_PROBS, arGammonProbs, MAX_GAMMON_PROBS);
-    else {
+        if (!OSRCacheLookup(anBoard, nGames, arProbs, arGammonProbs)) {
+            rollOSR(nGames, an, nOut, arProbs, arGammonProbs, fParallel);
+            OSRCacheAdd(anBoard, nGames, arProbs, arGammonProbs);
+        }
+    } else {
         /* chequers inside home: use BEAROFF2 */
 
         unsigned short int anProb[32];
@@ -718,7 +996,7 @@ osp(const unsigned int anBoard[25], const unsigned int nGames,
         for (i = 0; i < MAX_PROBS; ++i)
             arProbs[i] = 0.0f;
 
-        getBearoffProbs(PositionBearoff(anBoard, pbc1->nPoints, pbc1->nChequers), anProb);
+        getBearoffProbs(anBoard, anProb);
 
         for (i = 0; i < 32; ++i) {
             int n = MIN(i, MAX_PROBS - 1);
@@ -764,7 +1042,7 @@ bgProb(const unsigned int anBoard[25],
 
             /* FIXME: this ignores chequers on the bar */
 
-            getBearoffProbs(PositionBearoff(anBoard + 18, pbc1->nPoints, pbc1->nChequers), anProb);
+            getBearoffProbs(anBoard + 18, anProb);
 
             for (i = 0; i < nMaxProbs; ++i) {
 
@@ -804,13 +1082,14 @@ bgProb(const unsigned int anBoard[25],
  *
  */
 
-extern void
-raceProbs(const TanBoard anBoard, const unsigned int nGames, float arOutput[NUM_OUTPUTS], float arMu[2])
+static void
+RaceProbs(const TanBoard anBoard, const unsigned int nGames, float arOutput[NUM_OUTPUTS], float arMu[2],
+          const int fParallel)
 {
 
     TanBoard an;
     float aarProbs[2][MAX_PROBS];
-    float aarGammonProbs[2][MAX_PROBS];
+    float aarGammonProbs[2][MAX_GAMMON_PROBS];
     float arG[2] = { 0.0f, 0.0f }, arBG[2] = { 0.0f, 0.0f };
 
     unsigned int anTotal[2];
@@ -819,15 +1098,11 @@ raceProbs(const TanBoard anBoard, const unsigned int nGames, float arOutput[NUM_
 
     float w, s;
 
-    /* Seed set to ensure that OSR are reproducible */
-
-    sfmt_init_gen_rand(&sfmt, 0);
-
     for (i = 0; i < NUM_OUTPUTS; ++i)
         arOutput[i] = 0.0f;
 
     for (i = 0; i < 2; ++i)
-        anTotal[i] = osp(anBoard[i], nGames, an[i], aarProbs[i], aarGammonProbs[i]);
+        anTotal[i] = osp(anBoard[i], nGames, an[i], aarProbs[i], aarGammonProbs[i], fParallel);
 
     /* calculate OUTPUT_WIN */
 
@@ -902,3 +1177,15 @@ raceProbs(const TanBoard anBoard, const unsigned int nGames, float arOutput[NUM_
     }
 
 }
+
+extern void
+raceProbs(const TanBoard anBoard, const unsigned int nGames, float arOutput[NUM_OUTPUTS], float arMu[2])
+{
+    RaceProbs(anBoard, nGames, arOutput, arMu, TRUE);
+}
+
+extern void
+raceProbsSerial(const TanBoard anBoard, const unsigned int nGames, float arOutput[NUM_OUTPUTS], float arMu[2])
+{
+    RaceProbs(anBoard, nGames, arOutput, arMu, FALSE);
+}
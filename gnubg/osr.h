@@ -20,8 +20,45 @@
 #ifndef OSR_H
 #define OSR_H
 
+#define OSR_MAX_PROBS        32
+#define OSR_MAX_GAMMON_PROBS 15
+
+/* number of games in one chunk of a one-sided rollout */
+#define OSR_CHUNK 576
+
+/* number of games when a rollout is truncated with a one-sided rollout */
+#define OSR_LEAF_GAMES 576
+
+/* A chunk of games of a one-sided rollout. The dice of a game only depend
+ * on the game number and the turn, so chunks can be rolled out in any
+ * order and on any thread. */
+typedef struct {
+    const unsigned int *anBoard;        /* one side of the board */
+    unsigned int nOut;          /* chequers outside home quadrant */
+    unsigned int iGame;         /* first game of the chunk */
+    unsigned int cGames;        /* games in the chunk */
+    unsigned int nGames;        /* games in the whole rollout */
+    float arProbs[OSR_MAX_PROBS];       /* sum of bear off probs. */
+    unsigned int anCounts[OSR_MAX_GAMMON_PROBS];        /* games home in i rolls */
+} osrchunk;
+
+extern void OSRRunChunk(osrchunk * poc);
+
+/* If set, raceProbs() hands the chunks of a one-sided rollout to this
+ * function instead of rolling them out one by one. */
+extern void (*OSRRunChunks) (osrchunk aoc[], unsigned int cChunks);
+
 extern void
  raceProbs(const TanBoard anBoard, const unsigned int nGames, float arOutput[NUM_OUTPUTS], float arMu[2]);
 
+/* As raceProbs() but never uses OSRRunChunks, for use from worker threads */
+extern void
+ raceProbsSerial(const TanBoard anBoard, const unsigned int nGames, float arOutput[NUM_OUTPUTS], float arMu[2]);
+
+extern void OSRCacheFlush(void);
+extern unsigned int OSRCacheEntries(void);
+extern int OSRCacheLoad(const char *szFile);
+extern int OSRCacheSave(const char *szFile);
+
 
 #endif                          /* OSR_H */
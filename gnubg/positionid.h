@@ -49,6 +49,50 @@ extern unsigned short PositionIndex(unsigned int g, const unsigned int anBoard[6
 
 #define CopyKey(ks, kd) (kd).data[0]=(ks).data[0],(kd).data[1]=(ks).data[1],(kd).data[2]=(ks).data[2],(kd).data[3]=(ks).data[3],(kd).data[4]=(ks).data[4],(kd).data[5]=(ks).data[5],(kd).data[6]=(ks).data[6]
 
+/* A positionkey is also a packed board of 28 bytes instead of the 200 of a
+ * TanBoard: 4 bits for each point, data[0..2] holding points 0-23 of the
+ * player on roll (anBoard[1]), data[3..5] those of the opponent
+ * (anBoard[0]) and data[6] both bars. The functions below work on it
+ * without unpacking it. */
+
+static inline unsigned int
+KeyPoint(const positionkey * pkey, int iSide, int iPoint)
+{
+    if (iPoint == 24)
+        return (pkey->data[6] >> (iSide ? 4 : 0)) & 0x0f;
+
+    return (pkey->data[(iSide ? 0 : 3) + (iPoint >> 3)] >> ((iPoint & 7) << 2)) & 0x0f;
+}
+
+/* n may be negative, as long as the point keeps at least 0 chequers */
+static inline void
+KeyAddChequers(positionkey * pkey, int iSide, int iPoint, int n)
+{
+    if (iPoint == 24)
+        pkey->data[6] += (unsigned int) n << (iSide ? 4 : 0);
+    else
+        pkey->data[(iSide ? 0 : 3) + (iPoint >> 3)] += (unsigned int) n << ((iPoint & 7) << 2);
+}
+
+/* The highest point the player on roll has a chequer on, 24 for the bar,
+ * or 0 if there is none */
+static inline int
+KeyBackChequer(const positionkey * pkey)
+{
+    int i, j;
+
+    if (pkey->data[6] & 0xf0)
+        return 24;
+
+    for (i = 2; i >= 0; i--)
+        if (pkey->data[i]) {
+            for (j = 7; !((pkey->data[i] >> (j << 2)) & 0x0f); j--);
+            return (i << 3) + j;
+        }
+
+    return 0;
+}
+
 extern int EqualBoards(const TanBoard anBoard0, const TanBoard anBoard1);
 
 /* Return 1 for valid position, 0 for not */
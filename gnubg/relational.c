@@ -406,48 +406,26 @@ AddGames(DBProvider * pdb, int session_id, int player_id0, int player_id1)
     }
 }
 
-extern void
-CommandRelationalAddMatch(char *sz)
+/* Add the current match to the open database pdb, asking before
+ * overwriting a stored copy unless fQuiet. Returns 0 if the match was
+ * added, 1 if the user declined, or -1 on errors, leaving the database
+ * as it was: the changes are made in one transaction. */
+extern int
+RelationalAddMatch(DBProvider * pdb, int fQuiet)
 {
-    DBProvider *pdb;
     char *buf, *date;
-    char warnings[1024] = "";
     int session_id, existing_id, player_id0, player_id1;
-    char *arg = NULL;
-    gboolean quiet = FALSE;
-
-    arg = NextToken(&sz);
-    if (arg)
-        quiet = !strcmp(arg, "quiet");
-
-    if (ListEmpty(&lMatch)) {
-        outputl(_("No match is being played."));
-        return;
-    }
+    int fOK;
 
-    /* Warn if match is not finished or fully analysed */
-    if (!quiet && !GameOver())
-        strcat(warnings, _("The match is not finished\n"));
-    if (!quiet && !MatchAnalysed())
-        strcat(warnings, _("All of the match is not analysed\n"));
+    existing_id = RelationalMatchExists(pdb);
+    if (existing_id != -1 && !fQuiet && !GetInputYN(_("Match exists in database, overwrite?")))
+        return 1;
 
-    if (*warnings) {
-        strcat(warnings, _("\nAdd match anyway?"));
-        if (!GetInputYN(warnings))
-            return;
-    }
+    pdb->Begin();
 
-    if ((pdb = ConnectToDB(dbProviderType)) == NULL) {
-        outputerrf(_("Error opening database"));
-        return;
-    }
-    existing_id = RelationalMatchExists(pdb);
     if (existing_id != -1) {
         char *buf2;
 
-        if (!quiet && !GetInputYN(_("Match exists in database, overwrite?")))
-            return;
-
         /* Remove any game stats and games */
         buf2 = g_strdup_printf("FROM game WHERE session_id = %d", existing_id);
         buf = g_strdup_printf("DELETE FROM gamestat WHERE game_id in (SELECT game_id %s)", buf2);
@@ -472,7 +450,8 @@ CommandRelationalAddMatch(char *sz)
     player_id1 = AddPlayer(pdb, ap[1].szName);
     if (session_id == -1 || player_id0 == -1 || player_id1 == -1) {
         outputl(_("Error adding match."));
-        return;
+        pdb->Rollback();
+        return -1;
     }
 
     if (mi.nYear)
@@ -490,16 +469,59 @@ CommandRelationalAddMatch(char *sz)
 
     updateStatisticsMatch(&lMatch);
 
-    if (pdb->UpdateCommand(buf)) {
-        if (AddStats(pdb, session_id, player_id0, 0, "matchstat", ms.nMatchTo, &scMatch) &&
-            AddStats(pdb, session_id, player_id1, 1, "matchstat", ms.nMatchTo, &scMatch)) {
-            if (storeGameStats)
-                AddGames(pdb, session_id, player_id0, player_id1);
-            pdb->Commit();
-        }
-    }
+    fOK = pdb->UpdateCommand(buf) &&
+        AddStats(pdb, session_id, player_id0, 0, "matchstat", ms.nMatchTo, &scMatch) &&
+        AddStats(pdb, session_id, player_id1, 1, "matchstat", ms.nMatchTo, &scMatch);
+
+    if (fOK) {
+        if (storeGameStats)
+            AddGames(pdb, session_id, player_id0, player_id1);
+        pdb->Commit();
+    } else
+        pdb->Rollback();
+
     g_free(buf);
     g_free(date);
+
+    return fOK ? 0 : -1;
+}
+
+extern void
+CommandRelationalAddMatch(char *sz)
+{
+    DBProvider *pdb;
+    char warnings[1024] = "";
+    char *arg = NULL;
+    gboolean quiet = FALSE;
+
+    arg = NextToken(&sz);
+    if (arg)
+        quiet = !strcmp(arg, "quiet");
+
+    if (ListEmpty(&lMatch)) {
+        outputl(_("No match is being played."));
+        return;
+    }
+
+    /* Warn if match is not finished or fully analysed */
+    if (!quiet && !GameOver())
+        strcat(warnings, _("The match is not finished\n"));
+    if (!quiet && !MatchAnalysed())
+        strcat(warnings, _("All of the match is not analysed\n"));
+
+    if (*warnings) {
+        strcat(warnings, _("\nAdd match anyway?"));
+        if (!GetInputYN(warnings))
+            return;
+    }
+
+    if ((pdb = ConnectToDB(dbProviderType)) == NULL) {
+        outputerrf(_("Error opening database"));
+        return;
+    }
+
+    RelationalAddMatch(pdb, quiet);
+
     pdb->Disconnect();
 }
 
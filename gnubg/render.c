@@ -22,6 +22,7 @@
 #include "common.h"
 
 #include <glib.h>
+#include <glib/gstdio.h>
 #include <stdio.h>
 #include <string.h>
 #if defined(HAVE_FREETYPE)
@@ -32,12 +33,16 @@
 #include <isaac.h>
 #include <math.h>
 #include <stdlib.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 #include "render.h"
 #include "renderprefs.h"
 #include "boarddim.h"
 #include "boardpos.h"
 #include "backgammon.h"
+#include "multithread.h"
 #include "util.h"
 
 #if defined(USE_GTK)
@@ -218,6 +223,68 @@ iclamp(unsigned int u)
         return (unsigned char) u;
 }
 
+#if defined(__SSE2__)
+/* Helpers for blending two pixels at a time, with the channels in 16 bit
+ * lanes: r0 g0 b0 - r1 g1 b1 - */
+
+/* x / 0xFF rounded down, exact for x <= 0xFF * 0xFF */
+static inline __m128i
+Div255(__m128i x)
+{
+    return _mm_srli_epi16(_mm_add_epi16(x, _mm_add_epi16(_mm_srli_epi16(x, 8), _mm_set1_epi16(1))), 8);
+}
+
+/* Two RGB pixels. Reads 8 bytes, i.e. 2 bytes of the pixel after them. */
+static inline __m128i
+LoadRGB2(const unsigned char *puch)
+{
+    __m128i v = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *) puch), _mm_setzero_si128());
+
+    return _mm_unpacklo_epi64(v, _mm_srli_si128(v, 6));
+}
+
+/* Two RGB pixels from anywhere */
+static inline __m128i
+GatherRGB2(const unsigned char *puch0, const unsigned char *puch1)
+{
+    int n0 = puch0[0] | (puch0[1] << 8) | (puch0[2] << 16);
+    int n1 = puch1[0] | (puch1[1] << 8) | (puch1[2] << 16);
+
+    return _mm_unpacklo_epi8(_mm_unpacklo_epi32(_mm_cvtsi32_si128(n0), _mm_cvtsi32_si128(n1)),
+                             _mm_setzero_si128());
+}
+
+/* Two RGBA pixels, and their alpha in all the lanes of each pixel */
+static inline __m128i
+LoadRGBA2(const unsigned char *puch, __m128i * pa)
+{
+    __m128i v = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *) puch), _mm_setzero_si128());
+
+    *pa = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0xFF), 0xFF);
+
+    return v;
+}
+
+/* Store two RGB pixels, saturating as iclamp() */
+static inline void
+StoreRGB2(unsigned char *puch, __m128i v)
+{
+    unsigned int n;
+
+    v = _mm_packus_epi16(v, v);
+
+    n = (unsigned int) _mm_cvtsi128_si32(v);
+    puch[0] = (unsigned char) n;
+    puch[1] = (unsigned char) (n >> 8);
+    puch[2] = (unsigned char) (n >> 16);
+
+    n = (unsigned int) _mm_cvtsi128_si32(_mm_srli_si128(v, 4));
+    puch[3] = (unsigned char) n;
+    puch[4] = (unsigned char) (n >> 8);
+    puch[5] = (unsigned char) (n >> 16);
+}
+#endif
+
 static int
 intersects(int x0, int y0, int cx0, int cy0, int x1, int y1, int cx1, int cy1)
 {
@@ -390,20 +457,24 @@ extern void
 AlphaBlendBase(unsigned char *puchDest, int nDestStride,
                unsigned char *puchBack, int nBackStride, unsigned char *puchFore, int nForeStride, int cx, int cy)
 {
-    int x;
-
-    nDestStride -= cx * 3;
-    nBackStride -= cx * 3;
-    nForeStride -= cx * 4;
+    int x, i;
 
     for (; cy; cy--) {
-        for (x = cx; x; x--) {
-            unsigned int a = puchFore[3];
+        x = 0;
+#if defined(__SSE2__)
+        /* stop while a third pixel is left for LoadRGB2() to read into */
+        for (; x + 3 <= cx; x += 2) {
+            __m128i a, f = LoadRGBA2(puchFore + 4 * x, &a);
+            __m128i b = LoadRGB2(puchBack + 3 * x);
+
+            StoreRGB2(puchDest + 3 * x, _mm_add_epi16(Div255(_mm_mullo_epi16(b, a)), f));
+        }
+#endif
+        for (; x < cx; x++) {
+            unsigned int a = puchFore[4 * x + 3];
 
-            *puchDest++ = iclamp((*puchBack++ * a) / 0xFF + *puchFore++);
-            *puchDest++ = iclamp((*puchBack++ * a) / 0xFF + *puchFore++);
-            *puchDest++ = iclamp((*puchBack++ * a) / 0xFF + *puchFore++);
-            puchFore++;         /* skip the alpha channel */
+            for (i = 0; i < 3; i++)
+                puchDest[3 * x + i] = iclamp((puchBack[3 * x + i] * a) / 0xFF + puchFore[4 * x + i]);
         }
         puchDest += nDestStride;
         puchBack += nBackStride;
@@ -466,20 +537,25 @@ AlphaBlend2(unsigned char *puchDest, int nDestStride,
 {
     /* draw *puchFore on top of *puchBack using the alpha channel as mask into *puchDest */
 
-    int x;
-
-    nDestStride -= cx * 3;
-    nBackStride -= cx * 3;
-    nForeStride -= cx * 4;
+    int x, i;
 
     for (; cy; cy--) {
-        for (x = cx; x; x--) {
-            unsigned int a = puchFore[3];
+        x = 0;
+#if defined(__SSE2__)
+        for (; x + 3 <= cx; x += 2) {
+            __m128i a, f = LoadRGBA2(puchFore + 4 * x, &a);
+            __m128i b = LoadRGB2(puchBack + 3 * x);
 
-            *puchDest++ = iclamp((*puchBack++ * (0xFF - a)) / 0xFF + (*puchFore++ * a) / 0xFF);
-            *puchDest++ = iclamp((*puchBack++ * (0xFF - a)) / 0xFF + (*puchFore++ * a) / 0xFF);
-            *puchDest++ = iclamp((*puchBack++ * (0xFF - a)) / 0xFF + (*puchFore++ * a) / 0xFF);
-            puchFore++;         /* skip the alpha channel */
+            b = Div255(_mm_mullo_epi16(b, _mm_sub_epi16(_mm_set1_epi16(0xFF), a)));
+            StoreRGB2(puchDest + 3 * x, _mm_add_epi16(b, Div255(_mm_mullo_epi16(f, a))));
+        }
+#endif
+        for (; x < cx; x++) {
+            unsigned int a = puchFore[4 * x + 3];
+
+            for (i = 0; i < 3; i++)
+                puchDest[3 * x + i] = iclamp((puchBack[3 * x + i] * (0xFF - a)) / 0xFF
+                                             + (puchFore[4 * x + i] * a) / 0xFF);
         }
         puchDest += nDestStride;
         puchBack += nBackStride;
@@ -542,27 +618,33 @@ RefractBlend(unsigned char *puchDest, int nDestStride,
              unsigned char *puchBack, int nBackStride,
              unsigned char *puchFore, int nForeStride, unsigned short *psRefract, int nRefractStride, int cx, int cy)
 {
-    int x;
+    int x, i;
 
-    nDestStride -= cx * 3;
-    nForeStride -= cx * 4;
-    nRefractStride -= cx;
+#define REFRACT( x ) ( puchBack + (psRefract[x] >> 8) * nBackStride + (psRefract[x] & 0xFF) * 3 )
 
     for (; cy; cy--) {
-        for (x = cx; x; x--) {
-            unsigned int a = puchFore[3];
-            unsigned char *puch = puchBack + (*psRefract >> 8) * nBackStride + (*psRefract & 0xFF) * 3;
-
-            *puchDest++ = iclamp((puch[0] * a) / 0xFF + *puchFore++);
-            *puchDest++ = iclamp((puch[1] * a) / 0xFF + *puchFore++);
-            *puchDest++ = iclamp((puch[2] * a) / 0xFF + *puchFore++);
-            puchFore++;         /* skip the alpha channel */
-            psRefract++;
+        x = 0;
+#if defined(__SSE2__)
+        for (; x + 2 <= cx; x += 2) {
+            __m128i a, f = LoadRGBA2(puchFore + 4 * x, &a);
+            __m128i b = GatherRGB2(REFRACT(x), REFRACT(x + 1));
+
+            StoreRGB2(puchDest + 3 * x, _mm_add_epi16(Div255(_mm_mullo_epi16(b, a)), f));
+        }
+#endif
+        for (; x < cx; x++) {
+            unsigned int a = puchFore[4 * x + 3];
+            unsigned char *puch = REFRACT(x);
+
+            for (i = 0; i < 3; i++)
+                puchDest[3 * x + i] = iclamp((puch[i] * a) / 0xFF + puchFore[4 * x + i]);
         }
         puchDest += nDestStride;
         puchFore += nForeStride;
         psRefract += nRefractStride;
     }
+
+#undef REFRACT
 }
 
 extern void
@@ -1026,8 +1108,11 @@ WoodPixel(float x, float y, float z, unsigned char auch[3], woodtype wt)
 #endif
 }
 
+/* Render the rows yStart to yEnd - 1 of the wooden frame. Every row is
+ * written only by the call that owns it, so bands of rows can be rendered
+ * in parallel. */
 static void
-RenderFrameWood(renderdata * prd, unsigned char *puch, int nStride)
+RenderFrameWoodRows(renderdata * prd, unsigned char *puch, int nStride, int yStart, int yEnd)
 {
 
 #define BUF( y, x, i ) ( puch[ (y) * nStride + (x) * 3 + (i) ] )
@@ -1070,7 +1155,14 @@ RenderFrameWood(renderdata * prd, unsigned char *puch, int nStride)
     }
 
     /* Top and bottom edges */
-    for (y = 0; y < s * BORDER_HEIGHT; y++)
+    for (y = 0; y < s * BORDER_HEIGHT; y++) {
+        int yBottom = y + (BOARD_HEIGHT - BORDER_HEIGHT) * s;
+        int fTop = y >= yStart && y < yEnd;
+        int fBottom = yBottom >= yStart && yBottom < yEnd;
+
+        if (!fTop && !fBottom)
+            continue;
+
         for (x = 0; x < s * BOARD_WIDTH; x++) {
             if (y < s) {
                 rDiffuse = arDiffuse[3][y];
@@ -1086,19 +1178,24 @@ RenderFrameWood(renderdata * prd, unsigned char *puch, int nStride)
                 rHeight = arHeight[3 * s - y - 1];
             }
 
-            WoodPixel(100 - (float) y * 0.85f + (float) x * 0.1f, rHeight - (float) x * 0.11f, 200 + (float) x * 0.93f + (float) y * 0.16f, a, prd->wt);
+            if (fTop) {
+                WoodPixel(100 - (float) y * 0.85f + (float) x * 0.1f, rHeight - (float) x * 0.11f, 200 + (float) x * 0.93f + (float) y * 0.16f, a, prd->wt);
 
-            for (i = 0; i < 3; i++)
-                BUF(y, x, i) = clamp(a[i] * rDiffuse + (float) nSpecular);
+                for (i = 0; i < 3; i++)
+                    BUF(y, x, i) = clamp(a[i] * rDiffuse + (float) nSpecular);
+            }
 
-            WoodPixel(123 + (float) y * 0.87f - (float) x * 0.08f, rHeight + (float) x * 0.06f, -100 - (float) x * 0.94f - (float) y * 0.11f, a, prd->wt);
+            if (fBottom) {
+                WoodPixel(123 + (float) y * 0.87f - (float) x * 0.08f, rHeight + (float) x * 0.06f, -100 - (float) x * 0.94f - (float) y * 0.11f, a, prd->wt);
 
-            for (i = 0; i < 3; i++)
-                BUF(y + (BOARD_HEIGHT - BORDER_HEIGHT) * s, x, i) = clamp(a[i] * rDiffuse + (float) nSpecular);
+                for (i = 0; i < 3; i++)
+                    BUF(yBottom, x, i) = clamp(a[i] * rDiffuse + (float) nSpecular);
+            }
         }
+    }
 
     /* Left and right edges */
-    for (y = 0; y < s * BOARD_HEIGHT; y++)
+    for (y = yStart; y < MIN(yEnd, s * BOARD_HEIGHT); y++)
         for (x = 0; x < s * BORDER_WIDTH; x++) {
             if (x < s) {
                 rDiffuse = arDiffuse[2][x];
@@ -1128,7 +1225,7 @@ RenderFrameWood(renderdata * prd, unsigned char *puch, int nStride)
         }
 
     /* Bar */
-    for (y = 0; y < s * BOARD_HEIGHT; y++)
+    for (y = yStart; y < MIN(yEnd, s * BOARD_HEIGHT); y++)
         for (x = 0; x < s * BAR_WIDTH / 2; x++) {
             if (y < s && y < x && y < s * (BAR_WIDTH / 2) - x - 1) {
                 rDiffuse = arDiffuse[3][y];
@@ -1169,7 +1266,7 @@ RenderFrameWood(renderdata * prd, unsigned char *puch, int nStride)
         }
 
     /* Left and right separators (between board and bearoff tray) */
-    for (y = 0; y < s * (BOARD_HEIGHT - BORDER_HEIGHT - 1); y++)
+    for (y = MAX(yStart - 2 * s, 0); y < MIN(yEnd - 2 * s, s * (BOARD_HEIGHT - BORDER_HEIGHT - 1)); y++)
         for (x = 0; x < s * BORDER_WIDTH; x++)
             if (x + y >= s && y - x <= s * (BOARD_HEIGHT - 2 * BORDER_HEIGHT + 1) &&
                 y + s * BORDER_HEIGHT - x >= s && x + y <= s * (BOARD_HEIGHT - BORDER_HEIGHT + 1)) {
@@ -1199,7 +1296,8 @@ RenderFrameWood(renderdata * prd, unsigned char *puch, int nStride)
             }
 
     /* Left and right dividers (between the bearoff trays) */
-    for (y = 0; y < s * BEAROFF_DIVIDER_HEIGHT; y++)
+    for (y = MAX(yStart - (BOARD_HEIGHT - BEAROFF_DIVIDER_HEIGHT) / 2 * s, 0);
+         y < MIN(yEnd - (BOARD_HEIGHT - BEAROFF_DIVIDER_HEIGHT) / 2 * s, s * BEAROFF_DIVIDER_HEIGHT); y++)
         for (x = 0; x < s * (BEAROFF_WIDTH - BORDER_WIDTH - 1); x++)
             if (x + y >= s && y - x <= s * (BEAROFF_DIVIDER_HEIGHT - 1) &&
                 y + s * (BEAROFF_WIDTH - BORDER_WIDTH - 1) - x >= s && x + y <= s * (BEAROFF_WIDTH + 1)) {
@@ -1233,6 +1331,12 @@ RenderFrameWood(renderdata * prd, unsigned char *puch, int nStride)
 #undef BUF
 }
 
+static void
+RenderFrameWood(renderdata * prd, unsigned char *puch, int nStride)
+{
+    RenderFrameWoodRows(prd, puch, nStride, 0, BOARD_HEIGHT * prd->nSize);
+}
+
 static void
 HingePixel(renderdata * prd, float xNorm, float yNorm, float xEye, float yEye, unsigned char auch[3])
 {
@@ -1538,8 +1642,10 @@ BoardPixel(renderdata * prd, int i, int antialias, int j)
                 * (prd->arLight[2] * 0.8f + 0.2f) / 20);
 }
 
-extern void
-RenderBoard(renderdata * prd, unsigned char *puch, int nStride)
+/* Everything on the board image apart from the frame. BoardPixel() draws
+ * from rc, so this always runs on the calling thread. */
+static void
+RenderBoardFill(renderdata * prd, unsigned char *puch, int nStride)
 {
 
     unsigned int ix, iy;
@@ -1547,11 +1653,6 @@ RenderBoard(renderdata * prd, unsigned char *puch, int nStride)
 
 #define BUF( y, x, i ) ( puch[ (y) * nStride + (x) * 3 + (i) ] )
 
-    if (prd->wt == WOOD_PAINT)
-        RenderFramePainted(prd, puch, nStride);
-    else
-        RenderFrameWood(prd, puch, nStride);
-
     if (prd->fHinges)
         RenderHinges(prd, puch, nStride);
 
@@ -1651,6 +1752,17 @@ RenderBoard(renderdata * prd, unsigned char *puch, int nStride)
 #undef BUF
 }
 
+extern void
+RenderBoard(renderdata * prd, unsigned char *puch, int nStride)
+{
+    if (prd->wt == WOOD_PAINT)
+        RenderFramePainted(prd, puch, nStride);
+    else
+        RenderFrameWood(prd, puch, nStride);
+
+    RenderBoardFill(prd, puch, nStride);
+}
+
 extern void
 RenderChequers(renderdata * prd, unsigned char *puch0,
                unsigned char *puch1, unsigned short *psRefract0, unsigned short *psRefract1, int UNUSED(nStride))
@@ -2625,6 +2737,298 @@ RenderBoardLabels(renderdata * prd, unsigned char *achLo, unsigned char *achHi,
 
 }
 
+/* Board images are cached on disk under boardcache/ in the home
+ * directory, one file per distinct set of renderdata fields read above. */
+#define RENDER_CACHE_VERSION 1
+#define RENDER_CACHE_FILES 8
+#define RENDER_IMAGES 18
+
+static const char szRenderCacheMagic[] = "GNUBG-BOARD 1\n";
+
+static gboolean
+RenderArrowsWanted(const renderdata * prd)
+{
+#if defined(USE_GTK) && defined(HAVE_CAIRO)
+    return prd->showMoveIndicator;
+#else
+    (void) prd;
+    return FALSE;
+#endif
+}
+
+/* The buffers of pri and their sizes, in the order they are cached */
+static unsigned int
+ImageBuffers(const renderdata * prd, renderimages * pri, unsigned char *apuch[RENDER_IMAGES],
+             size_t acb[RENDER_IMAGES])
+{
+    size_t n = (size_t) prd->nSize * prd->nSize;
+    unsigned int c = 0, i;
+
+#define ADD( p, cb ) ( apuch[ c ] = (unsigned char *) (p), acb[ c++ ] = (cb) )
+    ADD(pri->ach, n * BOARD_WIDTH * BOARD_HEIGHT * 3);
+    for (i = 0; i < 2; ++i)
+        ADD(pri->achChequer[i], n * CHEQUER_WIDTH * CHEQUER_HEIGHT * 4);
+    ADD(pri->achChequerLabels, n * CHEQUER_WIDTH * CHEQUER_HEIGHT * 3 * 12);
+    for (i = 0; i < 2; ++i)
+        ADD(pri->achDice[i], n * DIE_WIDTH * DIE_HEIGHT * 4);
+    for (i = 0; i < 2; ++i)
+        ADD(pri->achPip[i], n * 3);
+    ADD(pri->achCube, n * CUBE_WIDTH * CUBE_HEIGHT * 4);
+    ADD(pri->achCubeFaces, n * CUBE_WIDTH * CUBE_HEIGHT * 3 * 12);
+    for (i = 0; i < 2; ++i)
+        ADD(pri->asRefract[i], n * CHEQUER_WIDTH * CHEQUER_HEIGHT * sizeof(unsigned short));
+    ADD(pri->achResign, n * RESIGN_WIDTH * RESIGN_HEIGHT * 4);
+    ADD(pri->achResignFaces, n * RESIGN_WIDTH * RESIGN_HEIGHT * 3 * 3);
+    for (i = 0; i < 2; ++i)
+        ADD(pri->achLabels[i], n * BOARD_WIDTH * BORDER_HEIGHT * 4);
+    if (RenderArrowsWanted(prd))
+        for (i = 0; i < 2; ++i)
+            ADD(pri->auchArrow[i], n * ARROW_WIDTH * ARROW_HEIGHT * 4);
+#undef ADD
+
+    return c;
+}
+
+/* MD5 of every field the 2D renderer reads, so equal keys give equal
+ * images. The caller must g_free() it. */
+extern char *
+RenderDataKey(const renderdata * prd)
+{
+    GChecksum *pcs;
+    char *sz;
+    int an[] = { RENDER_CACHE_VERSION, (int) prd->wt, (int) prd->nSize, prd->fHinges, prd->fLabels,
+        prd->fClockwise, prd->fDynamicLabels, RenderArrowsWanted(prd), showingGray
+    };
+
+    pcs = g_checksum_new(G_CHECKSUM_MD5);
+#define UPDATE( x ) g_checksum_update(pcs, (const guchar *) &(x), sizeof(x))
+    UPDATE(an);
+    UPDATE(prd->aarColour);
+    UPDATE(prd->aarDiceColour);
+    UPDATE(prd->afDieColour);
+    UPDATE(prd->aarDiceDotColour);
+    UPDATE(prd->arCubeColour);
+    UPDATE(prd->aanBoardColour);
+    UPDATE(prd->aSpeckle);
+    UPDATE(prd->arRefraction);
+    UPDATE(prd->arCoefficient);
+    UPDATE(prd->arExponent);
+    UPDATE(prd->arDiceCoefficient);
+    UPDATE(prd->arDiceExponent);
+    UPDATE(prd->arLight);
+    UPDATE(prd->rRound);
+#undef UPDATE
+
+    sz = g_strdup(g_checksum_get_string(pcs));
+    g_checksum_free(pcs);
+
+    return sz;
+}
+
+/* File name of the cached images for prd, or NULL if there is no home
+ * directory */
+static char *
+RenderCacheFile(const renderdata * prd)
+{
+    char *szName, *szFile;
+
+    if (!szHomeDirectory)
+        return NULL;
+
+    szName = RenderDataKey(prd);
+    szFile = g_build_filename(szHomeDirectory, "boardcache", szName, NULL);
+    g_free(szName);
+
+    return szFile;
+}
+
+static gboolean
+LoadRenderCache(const renderdata * prd, renderimages * pri)
+{
+    unsigned char *apuch[RENDER_IMAGES];
+    size_t acb[RENDER_IMAGES];
+    char ach[sizeof(szRenderCacheMagic)];
+    unsigned int i, c = ImageBuffers(prd, pri, apuch, acb);
+    char *szFile = RenderCacheFile(prd);
+    gboolean fOK;
+    FILE *pf;
+
+    if (!szFile)
+        return FALSE;
+
+    pf = g_fopen(szFile, "rb");
+    g_free(szFile);
+    if (!pf)
+        return FALSE;
+
+    fOK = fread(ach, 1, sizeof(szRenderCacheMagic) - 1, pf) == sizeof(szRenderCacheMagic) - 1
+        && !memcmp(ach, szRenderCacheMagic, sizeof(szRenderCacheMagic) - 1);
+
+    for (i = 0; fOK && i < c; ++i)
+        fOK = fread(apuch[i], 1, acb[i], pf) == acb[i];
+
+    fOK = fOK && getc(pf) == EOF;
+    fclose(pf);
+
+    return fOK;
+}
+
+/* Remove the oldest files until at most RENDER_CACHE_FILES are left */
+static void
+PruneRenderCache(const char *szDir)
+{
+    GDir *pd;
+    const char *szName;
+    GPtrArray *pa = g_ptr_array_new_with_free_func(g_free);
+
+    if (!(pd = g_dir_open(szDir, 0, NULL))) {
+        g_ptr_array_free(pa, TRUE);
+        return;
+    }
+    while ((szName = g_dir_read_name(pd)))
+        g_ptr_array_add(pa, g_build_filename(szDir, szName, NULL));
+    g_dir_close(pd);
+
+    while (pa->len > RENDER_CACHE_FILES) {
+        time_t tOldest = 0;
+        guint i, iOldest = 0;
+        GStatBuf st;
+
+        for (i = 0; i < pa->len; ++i)
+            if (!g_stat(g_ptr_array_index(pa, i), &st) && (!i || st.st_mtime < tOldest)) {
+                tOldest = st.st_mtime;
+                iOldest = i;
+            }
+
+        g_unlink(g_ptr_array_index(pa, iOldest));
+        g_ptr_array_remove_index_fast(pa, iOldest);
+    }
+
+    g_ptr_array_free(pa, TRUE);
+}
+
+static void
+SaveRenderCache(const renderdata * prd, renderimages * pri)
+{
+    unsigned char *apuch[RENDER_IMAGES];
+    size_t acb[RENDER_IMAGES];
+    unsigned int i, c = ImageBuffers(prd, pri, apuch, acb);
+    char *szFile = RenderCacheFile(prd);
+    char *szDir, *szTemp;
+    gboolean fOK;
+    FILE *pf;
+
+    if (!szFile)
+        return;
+
+    szDir = g_path_get_dirname(szFile);
+    szTemp = g_strconcat(szFile, ".tmp", NULL);
+
+    if (g_mkdir_with_parents(szDir, 0700) || !(pf = g_fopen(szTemp, "wb"))) {
+        g_free(szTemp);
+        g_free(szDir);
+        g_free(szFile);
+        return;
+    }
+
+    fOK = fwrite(szRenderCacheMagic, 1, sizeof(szRenderCacheMagic) - 1, pf) == sizeof(szRenderCacheMagic) - 1;
+    for (i = 0; fOK && i < c; ++i)
+        fOK = fwrite(apuch[i], 1, acb[i], pf) == acb[i];
+    fOK = !fclose(pf) && fOK;
+
+    /* readers only ever see a complete file */
+    if (!fOK || g_rename(szTemp, szFile))
+        g_unlink(szTemp);
+    else
+        PruneRenderCache(szDir);
+
+    g_free(szTemp);
+    g_free(szDir);
+    g_free(szFile);
+}
+
+#if defined(USE_MULTITHREAD)
+typedef enum {
+    RENDER_FRAME, RENDER_CHEQUERS, RENDER_DICE, RENDER_CUBE
+} renderpart;
+
+typedef struct {
+    Task task;
+    renderdata *prd;
+    renderimages *pri;
+    renderpart rp;
+    int y0, y1;                 /* rows of the frame */
+} RenderTask;
+
+/* The parts of RenderImages() that neither use FreeType nor draw from rc */
+static void
+RenderPartMT(RenderTask * prt)
+{
+    renderdata *prd = prt->prd;
+    renderimages *pri = prt->pri;
+    int nSize = prd->nSize;
+
+    switch (prt->rp) {
+    case RENDER_FRAME:
+        RenderFrameWoodRows(prd, pri->ach, BOARD_WIDTH * nSize * 3, prt->y0, prt->y1);
+        break;
+    case RENDER_CHEQUERS:
+        RenderChequers(prd, pri->achChequer[0], pri->achChequer[1],
+                       pri->asRefract[0], pri->asRefract[1], nSize * CHEQUER_WIDTH * 4);
+        break;
+    case RENDER_DICE:
+        RenderDice(prd, pri->achDice[0], pri->achDice[1], nSize * DIE_WIDTH * 4, TRUE);
+        RenderPips(prd, pri->achPip[0], pri->achPip[1], nSize * 3);
+        break;
+    case RENDER_CUBE:
+        RenderCube(prd, pri->achCube, nSize * CUBE_WIDTH * 4);
+        RenderResign(prd, pri->achResign, nSize * RESIGN_WIDTH * 4);
+        break;
+    }
+}
+
+static void
+AddRenderTask(renderdata * prd, renderimages * pri, renderpart rp, int y0, int y1)
+{
+    RenderTask *prt = (RenderTask *) malloc(sizeof(RenderTask));
+
+    prt->task.fun = (AsyncFun) RenderPartMT;
+    prt->task.data = prt;
+    prt->task.pLinkedTask = NULL;
+    prt->prd = prd;
+    prt->pri = pri;
+    prt->rp = rp;
+    prt->y0 = y0;
+    prt->y1 = y1;
+
+    MT_AddTask((Task *) prt, TRUE);
+}
+
+/* Render the frame in bands of rows, and the chequers, dice and cube
+ * alongside it, on the thread pool */
+static void
+RenderImagesMT(renderdata * prd, renderimages * pri)
+{
+    int nSize = prd->nSize;
+    int cy = BOARD_HEIGHT * nSize;
+    int cBands = (int) MT_GetNumThreads() * 2;
+    int i;
+
+    if (prd->wt != WOOD_PAINT)
+        for (i = 0; i < cBands; ++i)
+            AddRenderTask(prd, pri, RENDER_FRAME, cy * i / cBands, cy * (i + 1) / cBands);
+    AddRenderTask(prd, pri, RENDER_CHEQUERS, 0, 0);
+    AddRenderTask(prd, pri, RENDER_DICE, 0, 0);
+    AddRenderTask(prd, pri, RENDER_CUBE, 0, 0);
+
+    (void) MT_WaitForTasks(NULL, 0, FALSE);
+
+    if (prd->wt == WOOD_PAINT)
+        RenderFramePainted(prd, pri->ach, BOARD_WIDTH * nSize * 3);
+    RenderBoardFill(prd, pri->ach, BOARD_WIDTH * nSize * 3);
+}
+#endif
+
 extern void
 RenderImages(renderdata * prd, renderimages * pri)
 {
@@ -2660,15 +3064,27 @@ RenderImages(renderdata * prd, renderimages * pri)
     for (i = 0; i < 2; ++i)
         pri->achLabels[i] = g_malloc(nSize * nSize * BOARD_WIDTH * BORDER_HEIGHT * 4);
 
-    RenderBoard(prd, pri->ach, BOARD_WIDTH * nSize * 3);
-    RenderChequers(prd, pri->achChequer[0], pri->achChequer[1],
-                   pri->asRefract[0], pri->asRefract[1], nSize * CHEQUER_WIDTH * 4);
+    if (LoadRenderCache(prd, pri))
+        return;
+
+#if defined(USE_MULTITHREAD)
+    if (MT_Idle())
+        RenderImagesMT(prd, pri);
+    else
+#endif
+    {
+        RenderBoard(prd, pri->ach, BOARD_WIDTH * nSize * 3);
+        RenderChequers(prd, pri->achChequer[0], pri->achChequer[1],
+                       pri->asRefract[0], pri->asRefract[1], nSize * CHEQUER_WIDTH * 4);
+        RenderDice(prd, pri->achDice[0], pri->achDice[1], nSize * DIE_WIDTH * 4, TRUE);
+        RenderPips(prd, pri->achPip[0], pri->achPip[1], nSize * 3);
+        RenderCube(prd, pri->achCube, nSize * CUBE_WIDTH * 4);
+        RenderResign(prd, pri->achResign, nSize * RESIGN_WIDTH * 4);
+    }
+
+    /* FreeType is not thread safe; the labels are drawn here */
     RenderChequerLabels(prd, pri->achChequerLabels, nSize * CHEQUER_LABEL_WIDTH * 3);
-    RenderDice(prd, pri->achDice[0], pri->achDice[1], nSize * DIE_WIDTH * 4, TRUE);
-    RenderPips(prd, pri->achPip[0], pri->achPip[1], nSize * 3);
-    RenderCube(prd, pri->achCube, nSize * CUBE_WIDTH * 4);
     RenderCubeFaces(prd, pri->achCubeFaces, nSize * CUBE_LABEL_WIDTH * 3, pri->achCube, nSize * CUBE_WIDTH * 4);
-    RenderResign(prd, pri->achResign, nSize * RESIGN_WIDTH * 4);
     RenderResignFaces(prd, pri->achResignFaces, nSize * RESIGN_LABEL_WIDTH * 3,
                       pri->achResign, nSize * RESIGN_WIDTH * 4);
 #if defined(USE_GTK) && defined(HAVE_CAIRO)
@@ -2678,6 +3094,7 @@ RenderImages(renderdata * prd, renderimages * pri)
 
     RenderBoardLabels(prd, pri->achLabels[0], pri->achLabels[1], BOARD_WIDTH * nSize * 4);
 
+    SaveRenderCache(prd, pri);
 }
 
 extern void
@@ -147,6 +147,7 @@ extern void RenderCubeFaces(renderdata * prd, unsigned char *puch,
 extern void RenderDice(renderdata * prd, unsigned char *puch0, unsigned char *puch1, int nStride, int alpha);
 extern void RenderPips(renderdata * prd, unsigned char *puch0, unsigned char *puch1, int nStride);
 extern void RenderImages(renderdata * prd, renderimages * pri);
+extern char *RenderDataKey(const renderdata * prd);
 extern void RenderArrows(renderdata * prd, unsigned char *puch0, unsigned char *puch1, int nStride, int fClockwise);
 extern void
  RenderBoardLabels(renderdata * prd, unsigned char *achLo, unsigned char *achHi, int nStride);
@@ -38,6 +38,7 @@
 #include "positionid.h"
 #include "format.h"
 #include "multithread.h"
+#include "osr.h"
 #include "rollout.h"
 #include "lib/simd.h"
 
@@ -211,6 +212,19 @@ QuasiRandomSeed(perArray * pArray, int n)
 
 static int nSkip;
 
+/* Philox dice depend only on the seed, the trial and the turn, so a trial
+ * gets the same dice whichever thread rolls it out and in whatever order. */
+static int
+RolloutRollDice(int iTurn, int iGame, unsigned int nDraw, unsigned int anDice[2], rng * rngx, void *rngctx)
+{
+    if (*rngx == RNG_PHILOX) {
+        RollDiceCounter(anDice, rngctx, (unsigned int) iGame, (unsigned int) iTurn, nDraw);
+        return 0;
+    }
+
+    return RollDice(anDice, rngx, rngctx);
+}
+
 extern int
 RolloutDice(int iTurn, int iGame,
             int fInitial,
@@ -236,9 +250,11 @@ RolloutDice(int iTurn, int iGame,
 
             return 0;
         } else {
+            unsigned int nDraw = 0;
+
             do {
                 int n;
-                if ((n = RollDice(anDice, rngx, rngctx)) != 0)
+                if ((n = RolloutRollDice(iTurn, iGame, nDraw++, anDice, rngx, rngctx)) != 0)
                     return n;
             } while (anDice[0] == anDice[1]);
 
@@ -256,7 +272,7 @@ RolloutDice(int iTurn, int iGame,
         anDice[1] = j % 6 + 1;
         return 0;
     } else
-        return RollDice(anDice, rngx, rngctx);
+        return RolloutRollDice(iTurn, iGame, 0, anDice, rngx, rngctx);
 }
 
 
@@ -456,6 +472,22 @@ BasicCubefulRollout(unsigned int aanBoard[][2][25],
                 *pf = FALSE;
                 cUnfinished--;
 
+            } else if (prc->fTruncOSR && pc == CLASS_RACE && GetBearoff(BDB_1) && !prc->fCubeful && *pf) {
+
+                /* cubeless rollout, requested to truncate races with a
+                 * one-sided rollout; we are on a worker thread so the
+                 * OSR games must not go to the thread pool */
+
+                raceProbsSerial((ConstTanBoard) aanBoard[ici], OSR_LEAF_GAMES, aarOutput[ici], NULL);
+                aarOutput[ici][OUTPUT_EQUITY] = UtilityME(aarOutput[ici], pci);
+                aarOutput[ici][OUTPUT_CUBEFUL_EQUITY] = 0.0f;
+
+                if (iTurn & 1)
+                    InvertEvaluationR(aarOutput[ici], pci);
+
+                *pf = FALSE;
+                cUnfinished--;
+
             }
 
             if (*pf) {
@@ -1164,7 +1196,9 @@ RolloutLoopMT(void *UNUSED(unused))
             MT_SafeSet(&nSkip, 0);      /* not multi-thread safe do quasi random dice for initial positions */
 
             /* ... and the RNG */
-            if (prc->rngRollout != RNG_MANUAL)
+            if (prc->rngRollout == RNG_PHILOX)
+                InitRNGSeed((unsigned int) prc->nSeed, prc->rngRollout, rngctxMTRollout);
+            else if (prc->rngRollout != RNG_MANUAL)
                 InitRNGSeed((unsigned int) (prc->nSeed + (trial << 8)), prc->rngRollout, rngctxMTRollout);
 
             memcpy(&anBoardEval, ro_apBoard[alt], sizeof(anBoardEval));
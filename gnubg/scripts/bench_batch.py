@@ -0,0 +1,90 @@
+#
+# bench_batch.py -- compare the per-call and batch evaluation APIs
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#
+# Usage: gnubg -t -q -p bench_batch.py [positions]
+#
+# Evaluates the same random contact positions with gnubg.evaluate() and
+# gnubg.evaluate_batch() (and with findbestmove/findbestmove_batch) and
+# prints the throughput of each. Set the number of threads with
+# "set threads" beforehand to see the effect of the thread pool.
+#
+
+import random
+import sys
+import time
+from array import array
+
+
+def RandomBoard(rnd):
+    "Random legal board without chequers on the bar or borne off"
+    b = [[0] * 25, [0] * 25]
+    for _ in range(15):
+        while True:
+            k = rnd.randrange(24)
+            if not b[1][23 - k]:
+                break
+        b[0][k] += 1
+        while True:
+            k = rnd.randrange(24)
+            if not b[0][23 - k]:
+                break
+        b[1][k] += 1
+    return b
+
+
+def Report(name, n, t):
+    print("%-22s %8d positions %8.3f s %10.0f positions/s" % (name, n, t, n / t if t > 0 else 0.0))
+
+
+def Bench(n):
+    rnd = random.Random(42)
+    boards = [RandomBoard(rnd) for _ in range(n)]
+    flat = array('I')
+    for b in boards:
+        flat.extend(b[0])
+        flat.extend(b[1])
+
+    ci = gnubg.cubeinfo()
+    ec = gnubg.evalcontext(0, 0)
+
+    t = time.time()
+    single = [gnubg.evaluate(b, ci, ec) for b in boards]
+    Report("evaluate", n, time.time() - t)
+
+    t = time.time()
+    batch = gnubg.evaluate_batch(flat, ci, ec)
+    Report("evaluate_batch", n, time.time() - t)
+
+    for i in range(n):
+        for k in range(6):
+            if abs(single[i][k] - batch[6 * i + k]) > 1e-5:
+                print("mismatch at position %d output %d" % (i, k))
+                return
+
+    dice = [(rnd.randint(1, 6), rnd.randint(1, 6)) for _ in range(n)]
+
+    t = time.time()
+    for b, d in zip(boards, dice):
+        gnubg.findbestmove(b, ci, ec, d)
+    Report("findbestmove", n, time.time() - t)
+
+    t = time.time()
+    gnubg.findbestmove_batch(flat, dice, ci, ec)
+    Report("findbestmove_batch", n, time.time() - t)
+
+
+if __name__ == '__main__':
+    Bench(int(sys.argv[1]) if len(sys.argv) > 1 else 20000)
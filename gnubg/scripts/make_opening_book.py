@@ -0,0 +1,49 @@
+#
+# make_opening_book.py -- build an opening book at the common scores
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#
+# Usage: gnubg -t -q -p make_opening_book.py [book] [rolls]
+#
+# Runs "save openingbook" for money play and for the start of the usual
+# match lengths, adding them all to the same book (gnubg.obk in the
+# current directory by default, 2 rolls deep). The candidates are chosen
+# with the analysis settings and rolled out with the rollout settings, so
+# set those beforehand, e.g. in the settings file.
+#
+# The rollouts take a long time. The book is saved after each score, and
+# running the script again carries on where it was interrupted. Copy the
+# book to ~/.gnubg/gnubg.obk, or use "load openingbook", to use it.
+#
+
+import sys
+
+# match lengths rolled out at 0-0; 0 is money play
+MATCH_LENGTHS = [0, 1, 3, 5, 7, 9, 11]
+
+
+def MakeBook(book, rolls):
+    for n in MATCH_LENGTHS:
+        if n:
+            print("Opening book: %d point match" % n)
+            gnubg.command('new match %d' % n)
+        else:
+            print("Opening book: money play")
+            gnubg.command('new session')
+        gnubg.command('save openingbook "%s" %d' % (book, rolls))
+
+
+if __name__ == '__main__':
+    MakeBook(sys.argv[1] if len(sys.argv) > 1 else "gnubg.obk",
+             int(sys.argv[2]) if len(sys.argv) > 2 else 2)
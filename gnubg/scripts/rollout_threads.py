@@ -0,0 +1,92 @@
+#
+# rollout_threads.py -- check that Philox rollouts do not depend on threads
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#
+# Usage: gnubg -t -q -p rollout_threads.py [threads [trials]]
+#
+# Rolls out the best moves of the same position with the Philox dice
+# generator ("set rollout rng philox") and the same seed, first with one
+# thread and then with the given number of threads (4 by default), and
+# exits with status 1 unless every move has the same trials, probabilities,
+# standard deviations and equity in both rollouts.
+#
+# The threads add up the trials in the order they finish, so the results
+# may differ in the last bits; they are compared within TOLERANCE, far
+# below what other dice would change.
+#
+
+import sys
+
+POSITION = "4HPwATDgc/ABMA"
+DICE = (3, 1)
+MOVES = 3
+TOLERANCE = 1e-4
+
+
+def Rollout(threads, trials):
+    "Results of the rollout of the best MOVES moves, by move"
+    gnubg.command("set threads %d" % threads)
+    gnubg.command("set rollout rng philox")
+    gnubg.command("set rollout seed 1234")
+    gnubg.command("set rollout trials %d" % trials)
+
+    gnubg.command("new game")
+    gnubg.command("set board %s" % POSITION)
+    gnubg.command("set dice %d %d" % DICE)
+    gnubg.command("hint %d" % MOVES)
+    gnubg.command("analyse rollout move %s" % " ".join(str(i + 1) for i in range(MOVES)))
+
+    results = {}
+    for h in gnubg.hint(MOVES)["hint"]:
+        if h["type"] != "rollout":
+            continue
+        d = h["details"]
+        results[h["move"]] = (d["trials"], d["probs"], d["probs-std"], d["score"])
+    return results
+
+
+def Same(a, b):
+    "Whether the rollout results a and b agree within TOLERANCE"
+    if a is None or b is None or a[0] != b[0]:
+        return False
+    x = list(a[1]) + list(a[2]) + [a[3]]
+    y = list(b[1]) + list(b[2]) + [b[3]]
+    return len(x) == len(y) and all(abs(u - v) <= TOLERANCE for u, v in zip(x, y))
+
+
+def Main(argv):
+    threads = int(argv[0]) if argv else 4
+    trials = int(argv[1]) if len(argv) > 1 else 144
+
+    serial = Rollout(1, trials)
+    parallel = Rollout(threads, trials)
+
+    if len(serial) != MOVES:
+        print("rolled out %d moves of %d" % (len(serial), MOVES))
+        return 1
+
+    failed = 0
+    for m in sorted(serial):
+        same = Same(serial[m], parallel.get(m))
+        print("%-24s %s" % (m, "same" if same else "DIFFERENT"))
+        if not same:
+            print("  1 thread:   %s" % (serial[m],))
+            print("  %d threads: %s" % (threads, parallel.get(m)))
+            failed += 1
+
+    return 1 if failed else 0
+
+
+sys.exit(Main(sys.argv[1:]))
@@ -86,6 +86,8 @@
 #include "inc3d.h"
 #endif
 #include "multithread.h"
+#include "openingbook.h"
+#include "osr.h"
 
 static int iPlayerSet, iPlayerLateSet;
 
@@ -345,6 +347,15 @@ CommandSetAnalysisCube(char *sz)
         UpdateSetting(&fAnalyseCube);
 }
 
+extern void
+CommandSetAnalysisIncremental(char *sz)
+{
+    SetToggle("analysis incremental", &fAnalyseIncremental, sz,
+              _("Analysis will only evaluate moves whose stored analysis is missing or "
+                "weaker than the current settings."),
+              _("Analysis will evaluate every move."));
+}
+
 extern void
 CommandSetAnalysisLuck(char *sz)
 {
@@ -1851,6 +1862,12 @@ CommandSetRNGMersenne(char *sz)
     SetRNG(rngSet, rngctxSet, RNG_MERSENNE, sz);
 }
 
+extern void
+CommandSetRNGPhilox(char *sz)
+{
+    SetRNG(rngSet, rngctxSet, RNG_PHILOX, sz);
+}
+
 extern void
 CommandSetRNGRandomDotOrg(char *sz)
 {
@@ -2289,6 +2306,22 @@ CommandSetRolloutBearoffTruncationOS(char *sz)
 }
 
 
+extern void
+CommandSetRolloutOSRTruncation(char *sz)
+{
+
+    int f = prcSet->fTruncOSR;
+
+    SetToggle("rollout osrtruncation", &f, sz,
+              _("Will truncate *cubeless* rollouts at race positions"
+                " with a one-sided rollout"),
+              _("Will not truncate *cubeless* rollouts at race positions" " with a one-sided rollout"));
+
+    prcSet->fTruncOSR = f;
+
+}
+
+
 extern void
 CommandSetRolloutInitial(char *sz)
 {
@@ -3172,6 +3205,31 @@ CommandSetOutputRawboard(char *sz)
               _("TTY boards will be given in raw format."), _("TTY boards will be given in ASCII."));
 }
 
+extern void
+CommandSetOpeningBook(char *sz)
+{
+    SetToggle("openingbook", &fUseOpeningBook, sz,
+              _("The opening book will be used for move analysis and hints in the early game."),
+              _("The opening book will not be used."));
+}
+
+extern void
+CommandSetOSRPersist(char *sz)
+{
+    char *szFile;
+
+    if (SetToggle("osr persist", &fOSRPersist, sz,
+                  _("One-sided rollout distributions will be kept between sessions."),
+                  _("One-sided rollout distributions will not be kept between sessions.")) != TRUE)
+        return;
+
+    /* a missing file just means nothing was kept yet */
+    szFile = OSRCacheFile();
+    if (OSRCacheLoad(szFile) < 0 && errno != ENOENT)
+        outputerr(szFile);
+    g_free(szFile);
+}
+
 extern void
 CommandSetOutputWinPC(char *sz)
 {
@@ -3831,6 +3889,14 @@ CommandSetExportHTMLTypeBBS(char *UNUSED(sz))
 
 }
 
+extern void
+CommandSetExportHTMLTypeBoards(char *UNUSED(sz))
+{
+
+    SetExportHTMLType(HTML_EXPORT_TYPE_BOARDS, "png");
+
+}
+
 extern void
 CommandSetExportHTMLTypeFibs2html(char *UNUSED(sz))
 {
@@ -4579,6 +4645,28 @@ CommandSetVariationStandard(char *UNUSED(sz))
 }
 
 
+extern void
+CommandSetExternalBatchWindow(char *sz)
+{
+    int n = ParseNumber(&sz);
+
+    if (n < 0 || n > 1000) {
+        outputl(_("You must specify a batching window between 0 and 1000 milliseconds."));
+        return;
+    }
+
+    nExternalBatchWindow = n;
+    outputf(_("The concurrent external server will collect requests for %d ms.\n"), n);
+}
+
+extern void
+CommandSetExternalConcurrent(char *sz)
+{
+    SetToggle("external concurrent", &fExternalConcurrent, sz,
+              _("The external interface will serve several clients at once."),
+              _("The external interface will serve one client at a time."));
+}
+
 extern void
 CommandSetGotoFirstGame(char *sz)
 {
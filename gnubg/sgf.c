@@ -92,8 +92,10 @@ FreeGameTreeSeq(listOLD * pl)
     FreeList(pl, 0);
 }
 
+/* Read the SGF file sz and keep its backgammon games. With fHeaders, only
+ * the root node of each game is read (see SGFReadHeaders()). */
 static listOLD *
-LoadCollection(char *sz)
+LoadCollection(char *sz, int fHeaders)
 {
 
     listOLD *plCollection, *pl, *plRoot, *plProp;
@@ -114,7 +116,7 @@ LoadCollection(char *sz)
         szFile = "(stdin)";
     }
 
-    plCollection = SGFParse(pf);
+    plCollection = fHeaders ? SGFReadHeaders(pf) : SGFRead(pf);
 
     if (pf != stdin)
         fclose(pf);
@@ -206,7 +208,7 @@ RestoreMI(listOLD * pl, moverecord * pmr)
 }
 
 static void
-RestoreGS(listOLD * pl, statcontext * psc)
+ParseGS(listOLD * pl, statcontext * psc)
 {
 
     char *pch;
@@ -228,10 +230,10 @@ RestoreGS(listOLD * pl, statcontext * psc)
                 psc->anMoves[1][st] = (int) strtol(pch, &pch, 10);
             }
 
-            psc->arErrorCheckerplay[0][0] = (float) g_ascii_strtod(pch, &pch);
-            psc->arErrorCheckerplay[0][1] = (float) g_ascii_strtod(pch, &pch);
-            psc->arErrorCheckerplay[1][0] = (float) g_ascii_strtod(pch, &pch);
-            psc->arErrorCheckerplay[1][1] = (float) g_ascii_strtod(pch, &pch);
+            psc->arErrorCheckerplay[0][0] = SGFReadFloat(pch, &pch);
+            psc->arErrorCheckerplay[0][1] = SGFReadFloat(pch, &pch);
+            psc->arErrorCheckerplay[1][0] = SGFReadFloat(pch, &pch);
+            psc->arErrorCheckerplay[1][1] = SGFReadFloat(pch, &pch);
 
             break;
 
@@ -260,30 +262,30 @@ RestoreGS(listOLD * pl, statcontext * psc)
             psc->anCubeWrongPass[0] = (int) strtol(pch, &pch, 10);
             psc->anCubeWrongPass[1] = (int) strtol(pch, &pch, 10);
 
-            psc->arErrorMissedDoubleDP[0][0] = (float) g_ascii_strtod(pch, &pch);
-            psc->arErrorMissedDoubleDP[0][1] = (float) g_ascii_strtod(pch, &pch);
-            psc->arErrorMissedDoubleTG[0][0] = (float) g_ascii_strtod(pch, &pch);
-            psc->arErrorMissedDoubleTG[0][1] = (float) g_ascii_strtod(pch, &pch);
-            psc->arErrorWrongDoubleDP[0][0] = (float) g_ascii_strtod(pch, &pch);
-            psc->arErrorWrongDoubleDP[0][1] = (float) g_ascii_strtod(pch, &pch);
-            psc->arErrorWrongDoubleTG[0][0] = (float) g_ascii_strtod(pch, &pch);
-            psc->arErrorWrongDoubleTG[0][1] = (float) g_ascii_strtod(pch, &pch);
-            psc->arErrorWrongTake[0][0] = (float) g_ascii_strtod(pch, &pch);
-            psc->arErrorWrongTake[0][1] = (float) g_ascii_strtod(pch, &pch);
-            psc->arErrorWrongPass[0][0] = (float) g_ascii_strtod(pch, &pch);
-            psc->arErrorWrongPass[0][1] = (float) g_ascii_strtod(pch, &pch);
-            psc->arErrorMissedDoubleDP[1][0] = (float) g_ascii_strtod(pch, &pch);
-            psc->arErrorMissedDoubleDP[1][1] = (float) g_ascii_strtod(pch, &pch);
-            psc->arErrorMissedDoubleTG[1][0] = (float) g_ascii_strtod(pch, &pch);
-            psc->arErrorMissedDoubleTG[1][1] = (float) g_ascii_strtod(pch, &pch);
-            psc->arErrorWrongDoubleDP[1][0] = (float) g_ascii_strtod(pch, &pch);
-            psc->arErrorWrongDoubleDP[1][1] = (float) g_ascii_strtod(pch, &pch);
-            psc->arErrorWrongDoubleTG[1][0] = (float) g_ascii_strtod(pch, &pch);
-            psc->arErrorWrongDoubleTG[1][1] = (float) g_ascii_strtod(pch, &pch);
-            psc->arErrorWrongTake[1][0] = (float) g_ascii_strtod(pch, &pch);
-            psc->arErrorWrongTake[1][1] = (float) g_ascii_strtod(pch, &pch);
-            psc->arErrorWrongPass[1][0] = (float) g_ascii_strtod(pch, &pch);
-            psc->arErrorWrongPass[1][1] = (float) g_ascii_strtod(pch, &pch);
+            psc->arErrorMissedDoubleDP[0][0] = SGFReadFloat(pch, &pch);
+            psc->arErrorMissedDoubleDP[0][1] = SGFReadFloat(pch, &pch);
+            psc->arErrorMissedDoubleTG[0][0] = SGFReadFloat(pch, &pch);
+            psc->arErrorMissedDoubleTG[0][1] = SGFReadFloat(pch, &pch);
+            psc->arErrorWrongDoubleDP[0][0] = SGFReadFloat(pch, &pch);
+            psc->arErrorWrongDoubleDP[0][1] = SGFReadFloat(pch, &pch);
+            psc->arErrorWrongDoubleTG[0][0] = SGFReadFloat(pch, &pch);
+            psc->arErrorWrongDoubleTG[0][1] = SGFReadFloat(pch, &pch);
+            psc->arErrorWrongTake[0][0] = SGFReadFloat(pch, &pch);
+            psc->arErrorWrongTake[0][1] = SGFReadFloat(pch, &pch);
+            psc->arErrorWrongPass[0][0] = SGFReadFloat(pch, &pch);
+            psc->arErrorWrongPass[0][1] = SGFReadFloat(pch, &pch);
+            psc->arErrorMissedDoubleDP[1][0] = SGFReadFloat(pch, &pch);
+            psc->arErrorMissedDoubleDP[1][1] = SGFReadFloat(pch, &pch);
+            psc->arErrorMissedDoubleTG[1][0] = SGFReadFloat(pch, &pch);
+            psc->arErrorMissedDoubleTG[1][1] = SGFReadFloat(pch, &pch);
+            psc->arErrorWrongDoubleDP[1][0] = SGFReadFloat(pch, &pch);
+            psc->arErrorWrongDoubleDP[1][1] = SGFReadFloat(pch, &pch);
+            psc->arErrorWrongDoubleTG[1][0] = SGFReadFloat(pch, &pch);
+            psc->arErrorWrongDoubleTG[1][1] = SGFReadFloat(pch, &pch);
+            psc->arErrorWrongTake[1][0] = SGFReadFloat(pch, &pch);
+            psc->arErrorWrongTake[1][1] = SGFReadFloat(pch, &pch);
+            psc->arErrorWrongPass[1][0] = SGFReadFloat(pch, &pch);
+            psc->arErrorWrongPass[1][1] = SGFReadFloat(pch, &pch);
 
             break;
 
@@ -297,10 +299,10 @@ RestoreGS(listOLD * pl, statcontext * psc)
                 psc->anLuck[1][lt] = (int) strtol(pch, &pch, 10);
             }
 
-            psc->arLuck[0][0] = (float) g_ascii_strtod(pch, &pch);
-            psc->arLuck[0][1] = (float) g_ascii_strtod(pch, &pch);
-            psc->arLuck[1][0] = (float) g_ascii_strtod(pch, &pch);
-            psc->arLuck[1][1] = (float) g_ascii_strtod(pch, &pch);
+            psc->arLuck[0][0] = SGFReadFloat(pch, &pch);
+            psc->arLuck[0][1] = SGFReadFloat(pch, &pch);
+            psc->arLuck[1][0] = SGFReadFloat(pch, &pch);
+            psc->arLuck[1][1] = SGFReadFloat(pch, &pch);
 
             break;
 
@@ -308,7 +310,12 @@ RestoreGS(listOLD * pl, statcontext * psc)
             /* ignore */
             break;
         }
+}
 
+static void
+RestoreGS(listOLD * pl, statcontext * psc)
+{
+    ParseGS(pl, psc);
     AddStatcontext(psc, &scMatch);
 }
 
@@ -518,8 +525,8 @@ RestoreRolloutScore(move * pm, const char *sz)
 
     if (pc) {
         pc += 6;
-        pm->rScore = (float) g_ascii_strtod(pc, &pc);
-        pm->rScore2 = (float) g_ascii_strtod(pc, &pc);
+        pm->rScore = SGFReadFloat(pc, &pc);
+        pm->rScore2 = SGFReadFloat(pc, &pc);
     } else {
         pm->rScore = -99999;
         pm->rScore2 = -99999;
@@ -559,7 +566,7 @@ RestoreRolloutOutput(float ar[NUM_ROLLOUT_OUTPUTS], const char *sz, const char *
     pc += strlen(szKeyword) + 1;
 
     for (i = 0; i < 7; i++)
-        ar[i] = (float) g_ascii_strtod(pc, &pc);
+        ar[i] = SGFReadFloat(pc, &pc);
 
 }
 
@@ -591,10 +598,10 @@ RestoreEvalContext(evalcontext * pec, char *pc)
     if (ver < 3) {
         (void) strtol(pc, &pc, 10);     /* reduced evaluation -- no longer supported */
         pec->fDeterministic = (unsigned int) strtol(pc, &pc, 10);
-        pec->rNoise = (float) g_ascii_strtod(pc, &pc);
+        pec->rNoise = SGFReadFloat(pc, &pc);
     } else {
         pec->fDeterministic = (unsigned int) strtol(pc, &pc, 10);
-        pec->rNoise = (float) g_ascii_strtod(pc, &pc);
+        pec->rNoise = SGFReadFloat(pc, &pc);
         pec->fUsePrune = (unsigned int) strtol(pc, &pc, 10);
         pec->fAutoRollout = (unsigned int) strtol(pc, &pc, 10);
     }
@@ -621,6 +628,20 @@ RestoreRolloutContextEvalContext(evalcontext * pec, const char *sz, const char *
 }
 
 
+/* The dice generator saved as sz by WriteRolloutContext(). Old files
+ * without a known name were rolled out with the Mersenne Twister. */
+static rng
+RestoreRolloutRNG(const char *sz)
+{
+    int i;
+
+    for (i = 0; i < NUM_RNGS; i++)
+        if (!strcmp(sz, aszRNG[i]))
+            return (rng) i;
+
+    return RNG_MERSENNE;
+}
+
 static void
 RestoreRolloutRolloutContext(rolloutcontext * prc, const char *sz)
 {
@@ -639,6 +660,7 @@ RestoreRolloutRolloutContext(rolloutcontext * prc, const char *sz)
     fRotate = TRUE;
     fTruncBearoff2 = FALSE;
     fTruncBearoffOS = FALSE;
+    prc->fTruncOSR = FALSE;
     /* set usable, but ignored values for everything else */
     prc->fLateEvals = 0;
     prc->fStopOnSTD = 0;
@@ -649,6 +671,7 @@ RestoreRolloutRolloutContext(rolloutcontext * prc, const char *sz)
     if (!pc)
         return;
 
+    szTemp[0] = 0;
     sscanf(pc, "RC %d %d %d %hu %u \"%1023[^\"]\" %lu %d %d %d",
            &fCubeful,
            &fVarRedn,
@@ -658,6 +681,7 @@ RestoreRolloutRolloutContext(rolloutcontext * prc, const char *sz)
     prc->fVarRedn = fVarRedn;
     prc->fRotate = fRotate;
     prc->fInitial = fInitial;
+    prc->rngRollout = RestoreRolloutRNG(szTemp);
     prc->fTruncBearoff2 = fTruncBearoff2;
     prc->fTruncBearoffOS = fTruncBearoffOS;
 
@@ -758,7 +782,7 @@ RestoreRolloutMoveFilter(const char *sz, char *name, movefilter mf[MAX_FILTER_PL
     for (i = 0; i < nPlies; ++i) {
         mf[nPlies - 1][i].Accept = (int) strtol(pc, &pc, 10);
         mf[nPlies - 1][i].Extra = (int) strtol(pc, &pc, 10);
-        mf[nPlies - 1][i].Threshold = (float) g_ascii_strtod(pc, &pc);
+        mf[nPlies - 1][i].Threshold = SGFReadFloat(pc, &pc);
     }
 }
 
@@ -769,21 +793,23 @@ RestoreExtendedRolloutContext(rolloutcontext * prc, const char *sz)
     char *pc = strstr(sz, "RC");
     char szTemp[1024];
     int fCubeful, fVarRedn, fInitial, fRotate, fTruncBearoff2, fTruncBearoffOS;
-    int fLateEvals, fDoTruncate;
-    int i;
+    int fLateEvals, fDoTruncate, fTruncOSR;
+    int i, n;
 
 
     if (!pc)
         return;
 
-    if (sscanf(pc, "RC %d %d %d %d %d %d %hu %d %d %hu \"%1023[^\"]\" %lu",
+    /* fTruncOSR is missing from older files */
+    n = sscanf(pc, "RC %d %d %d %d %d %d %hu %d %d %hu \"%1023[^\"]\" %lu %d",
                &fCubeful,
                &fVarRedn,
                &fInitial,
                &fRotate,
                &fLateEvals,
                &fDoTruncate,
-               &prc->nTruncate, &fTruncBearoff2, &fTruncBearoffOS, &prc->nLate, szTemp, &prc->nSeed) != 12)
+               &prc->nTruncate, &fTruncBearoff2, &fTruncBearoffOS, &prc->nLate, szTemp, &prc->nSeed, &fTruncOSR);
+    if (n < 12)
         return;
 
     prc->fCubeful = fCubeful;
@@ -794,7 +820,8 @@ RestoreExtendedRolloutContext(rolloutcontext * prc, const char *sz)
     prc->fDoTruncate = fDoTruncate;
     prc->fTruncBearoff2 = fTruncBearoff2;
     prc->fTruncBearoffOS = fTruncBearoffOS;
-    prc->rngRollout = RNG_MERSENNE;
+    prc->fTruncOSR = n > 12 && fTruncOSR;
+    prc->rngRollout = RestoreRolloutRNG(szTemp);
     prc->nMinimumGames = 324;
     prc->rStdLimit = 0.01f;
 
@@ -879,10 +906,10 @@ RestoreDoubleAnalysis(property * pp,
 
         if (ver < 2) {
             /* skip 4 fields left over from earlier formats */
-            (void) g_ascii_strtod(pch, &pch);
-            (void) g_ascii_strtod(pch, &pch);
-            (void) g_ascii_strtod(pch, &pch);
-            (void) g_ascii_strtod(pch, &pch);
+            (void) SGFReadFloat(pch, &pch);
+            (void) SGFReadFloat(pch, &pch);
+            (void) SGFReadFloat(pch, &pch);
+            (void) SGFReadFloat(pch, &pch);
             pes->ec.nPlies = (unsigned int) strtol(pch, &pch, 10);
             if (*pch == 'C') {
                 pes->ec.fCubeful = TRUE;
@@ -890,7 +917,7 @@ RestoreDoubleAnalysis(property * pp,
             }
             (void) strtol(pch, &pch, 10);       /* reduced evaluation -- no longer supported */
             pes->ec.fDeterministic = (unsigned int) strtol(pch, &pch, 10);
-            pes->ec.rNoise = (float) g_ascii_strtod(pch, &pch);
+            pes->ec.rNoise = SGFReadFloat(pch, &pch);
         } else if (ver == 2) {
             pes->ec.nPlies = (unsigned int) strtol(pch, &pch, 10);
             if (*pch == 'C') {
@@ -899,7 +926,7 @@ RestoreDoubleAnalysis(property * pp,
             }
             (void) strtol(pch, &pch, 10);       /* reduced evaluation -- no longer supported */
             pes->ec.fDeterministic = (unsigned int) strtol(pch, &pch, 10);
-            pes->ec.rNoise = (float) g_ascii_strtod(pch, &pch);
+            pes->ec.rNoise = SGFReadFloat(pch, &pch);
             fUsePrune = (int) strtol(pch, &pch, 10);
         } else {
             pes->ec.nPlies = (unsigned int) strtol(pch, &pch, 10);
@@ -908,7 +935,7 @@ RestoreDoubleAnalysis(property * pp,
                 pch++;
             }
             pes->ec.fDeterministic = (unsigned int) strtol(pch, &pch, 10);
-            pes->ec.rNoise = (float) g_ascii_strtod(pch, &pch);
+            pes->ec.rNoise = SGFReadFloat(pch, &pch);
             fUsePrune = (int) strtol(pch, &pch, 10);
             pes->ec.fAutoRollout = (unsigned int) strtol(pch, &pch, 10);
         }
@@ -916,7 +943,7 @@ RestoreDoubleAnalysis(property * pp,
 
         for (i = 0; i < 2; i++)
             for (j = 0; j < 7; j++)
-                aarOutput[i][j] = (float) g_ascii_strtod(pch, &pch);
+                aarOutput[i][j] = SGFReadFloat(pch, &pch);
         break;
 
     case 'R':
@@ -1011,8 +1038,8 @@ RestoreMoveAnalysis(property * pp, int fPlayer,
             /* EVAL_EVAL */
             pm->esMove.et = EVAL_EVAL;
             for (i = 0; i < 5; i++)
-                pm->arEvalMove[i] = (float) g_ascii_strtod(pch, &pch);
-            pm->rScore = (float) g_ascii_strtod(pch, &pch);
+                pm->arEvalMove[i] = SGFReadFloat(pch, &pch);
+            pm->rScore = SGFReadFloat(pch, &pch);
             if (ver < 2) {
                 pm->esMove.ec.nPlies = (unsigned int) strtol(pch, &pch, 10);
                 if (*pch == 'C') {
@@ -1021,7 +1048,7 @@ RestoreMoveAnalysis(property * pp, int fPlayer,
                 }
                 (void) strtol(pch, &pch, 10);   /* reduced evaluation -- no longer supported */
                 pm->esMove.ec.fDeterministic = (unsigned int) strtol(pch, &pch, 10);
-                pm->esMove.ec.rNoise = (float) g_ascii_strtod(pch, &pch);
+                pm->esMove.ec.rNoise = SGFReadFloat(pch, &pch);
 /*
  * Alternatives for ver == 2 and ver > 2 (that is == 3) are identical,
  * version 3 still writes a reduced evalution flag (set to 0) and
@@ -1047,7 +1074,7 @@ RestoreMoveAnalysis(property * pp, int fPlayer,
                 }
                 (void) strtol(pch, &pch, 10);   /* reduced evaluation -- no longer supported */
                 pm->esMove.ec.fDeterministic = (unsigned int) strtol(pch, &pch, 10);
-                pm->esMove.ec.rNoise = (float) g_ascii_strtod(pch, &pch);
+                pm->esMove.ec.rNoise = SGFReadFloat(pch, &pch);
                 fUsePrune = (int) strtol(pch, &pch, 10);
                 pm->esMove.ec.fAutoRollout = (unsigned int) strtol(pch, &pch, 10);
             }
@@ -1274,7 +1301,7 @@ RestoreNode(listOLD * pl)
         else if (pp->ach[0] == 'D' && pp->ach[1] == 'C')
             ast[1] = SKILL_DOUBTFUL;
         else if (pp->ach[0] == 'L' && pp->ach[1] == 'U')
-            rLuck = (float) g_ascii_strtod(pp->pl->plNext->p, NULL);
+            rLuck = SGFReadFloat(pp->pl->plNext->p, NULL);
         else if (pp->ach[0] == 'G' && pp->ach[1] == 'B')
             /* good for black */
             lt = *((char *) pp->pl->plNext->p) == '2' ? LUCK_VERYGOOD : LUCK_GOOD;
@@ -1285,10 +1312,10 @@ RestoreNode(listOLD * pl)
         else if (pp->ach[0] == 'M' && pp->ach[1] == 'W') {
             char *pch2 = pp->pl->plNext->p;
             //++pch2;
-            mwcMove = (float) g_ascii_strtod(pch2, &pch2);
-            mwcBestMove = (float) g_ascii_strtod(pch2, &pch2);
-            mwcCube = (float) g_ascii_strtod(pch2, &pch2);
-            mwcBestCube = (float) g_ascii_strtod(pch2, &pch2);
+            mwcMove = SGFReadFloat(pch2, &pch2);
+            mwcBestMove = SGFReadFloat(pch2, &pch2);
+            mwcCube = SGFReadFloat(pch2, &pch2);
+            mwcBestCube = SGFReadFloat(pch2, &pch2);
             // mwcMove = (float) g_ascii_strtod(pp->pl->plNext->p, NULL);
             // mwcBestMove = (float) g_ascii_strtod(pp->pl->plNext->p, NULL);
             // mwcCube = (float) g_ascii_strtod(pp->pl->plNext->p, NULL);
@@ -1451,7 +1478,7 @@ CommandLoadGame(char *sz)
         return;
     }
 
-    if ((pl = LoadCollection(sz))) {
+    if ((pl = LoadCollection(sz, FALSE))) {
         if (!get_input_discard())
             return;
 #if USE_GTK
@@ -1506,7 +1533,7 @@ CommandLoadPosition(char *sz)
         return;
     }
 
-    if ((pl = LoadCollection(sz))) {
+    if ((pl = LoadCollection(sz, FALSE))) {
         if (!get_input_discard())
             return;
 #if USE_GTK
@@ -1555,7 +1582,7 @@ CommandLoadMatch(char *sz)
         return;
     }
 
-    if ((pl = LoadCollection(sz))) {
+    if ((pl = LoadCollection(sz, FALSE))) {
         int nGames = 0, nMoves = 0;
 
         /* FIXME make sure the root nodes have MI properties; if not,
@@ -1626,45 +1653,104 @@ CommandLoadMatch(char *sz)
     }
 }
 
-static void
-WriteEscapedString(FILE * pf, char *pch, int fEscapeColons)
+/* Summarise a saved match from the root nodes of its games only: the
+ * players, the score and the statistics stored by "save match" after an
+ * analysis. The match in memory is left alone. */
+extern void
+CommandShowStatisticsFile(char *sz)
 {
+    listOLD *plCollection, *pl;
+    statcontext sc, scGame;
+    char szOutput[STATCONTEXT_MAXSIZE];
+    char *aszName[2] = { NULL, NULL };
+    int nMatch = 0, nGames = 0, anScore[2] = { 0, 0 };
 
-    char *sz, *pc;
+    sz = NextToken(&sz);
 
-    sz = (char *) g_malloc(2 * strlen(pch) + 1);
+    if (!sz || !*sz) {
+        outputl(_("You must specify a file to read (see `help show statistics file')."));
+        return;
+    }
 
-    for (pc = sz; *pch; pch++)
-        switch (*pch) {
-        case '\\':
-            *pc++ = '\\';
-            *pc++ = '\\';
-            break;
-        case ':':
-            if (fEscapeColons)
-                *pc++ = '\\';
-            *pc++ = ':';
-            break;
-        case ']':
-            *pc++ = '\\';
-            *pc++ = ']';
-            break;
-        default:
-            *pc++ = *pch;
-            break;
+    if (!(plCollection = LoadCollection(sz, TRUE)))
+        return;
+
+    IniStatcontext(&sc);
+
+    for (pl = plCollection->plNext; pl->p; pl = pl->plNext) {
+        listOLD *plRoot = ((listOLD *) ((listOLD *) pl->p)->plNext->p)->plNext->p;
+        listOLD *plProp;
+        moverecord mr;
+
+        memset(&mr, 0, sizeof(mr));
+        mr.g.fWinner = -1;
+        IniStatcontext(&scGame);
+
+        for (plProp = plRoot->plNext; plProp != plRoot; plProp = plProp->plNext) {
+            property *pp = plProp->p;
+            char *pch = pp->pl->plNext->p;
+
+            if (pp->ach[0] == 'M' && pp->ach[1] == 'I')
+                RestoreMI(pp->pl, &mr);
+            else if (pp->ach[0] == 'P' && (pp->ach[1] == 'W' || pp->ach[1] == 'B')) {
+                int i = pp->ach[1] == 'B';
+
+                g_free(aszName[i]);
+                aszName[i] = CopyEscapedString(pch);
+            } else if (pp->ach[0] == 'R' && pp->ach[1] == 'E') {
+                if (toupper(*pch) == 'W' || toupper(*pch) == 'B') {
+                    mr.g.fWinner = toupper(*pch) == 'B';
+                    mr.g.nPoints = pch[1] == '+' ? MAX((int) strtol(pch + 2, NULL, 10), 1) : 1;
+                }
+            } else if (pp->ach[0] == 'G' && pp->ach[1] == 'S')
+                ParseGS(pp->pl, &scGame);
         }
 
-    *pc = 0;
+        nMatch = mr.g.nMatch;
+        anScore[0] = mr.g.anScore[0];
+        anScore[1] = mr.g.anScore[1];
+        if (mr.g.fWinner >= 0)
+            anScore[mr.g.fWinner] += mr.g.nPoints;
+
+        AddStatcontext(&scGame, &sc);
+        nGames++;
+    }
+
+    FreeGameTreeSeq(plCollection);
 
-    fputs(sz, pf);
-    g_free(sz);
+    if (nMatch)
+        outputf(_("%s: %d point match, %d games, score %s %d, %s %d\n"), sz, nMatch, nGames,
+                aszName[0] ? aszName[0] : "?", anScore[0], aszName[1] ? aszName[1] : "?", anScore[1]);
+    else
+        outputf(_("%s: money session, %d games, %s %+d points\n"), sz, nGames,
+                aszName[0] ? aszName[0] : "?", anScore[0] - anScore[1]);
+
+    if (sc.fMoves || sc.fCube || sc.fDice) {
+        DumpStatcontext(szOutput, &sc, aszName[0] ? aszName[0] : "", aszName[1] ? aszName[1] : "", nMatch);
+        outputl(szOutput);
+    } else
+        outputl(_("The file holds no analysis statistics."));
+
+    g_free(aszName[0]);
+    g_free(aszName[1]);
+}
+
+static void
+WriteEscapedString(FILE * pf, char *pch, int fEscapeColons)
+{
+
+    for (; *pch; pch++) {
+        if (*pch == '\\' || *pch == ']' || (*pch == ':' && fEscapeColons))
+            putc('\\', pf);
+        putc(*pch, pf);
+    }
 }
 
 static void
 WriteEvalContext(FILE * pf, const evalcontext * pec)
 {
     gchar buffer[G_ASCII_DTOSTR_BUF_SIZE];
-    g_ascii_formatd(buffer, sizeof(buffer), "%.6f", pec->rNoise);
+    SGFFormatFloat(buffer, pec->rNoise, 6);
     fprintf(pf, "ver %d %u%s %u %s %u %u",
             SGF_FORMAT_VER, pec->nPlies, pec->fCubeful ? "C" : "", pec->fDeterministic, buffer, pec->fUsePrune, pec->fAutoRollout);
 }
@@ -1676,7 +1762,7 @@ WriteMoveFilters(FILE * pf, movefilter mf[MAX_FILTER_PLIES][MAX_FILTER_PLIES], i
     gchar buffer[G_ASCII_DTOSTR_BUF_SIZE];
 
     for (i = 0; i < nPlies; ++i) {
-        g_ascii_formatd(buffer, sizeof(buffer), "%.5f", mf[nPlies - 1][i].Threshold);
+        SGFFormatFloat(buffer, mf[nPlies - 1][i].Threshold, 5);
         fprintf(pf, "%d %d %s ", mf[nPlies - 1][i].Accept, mf[nPlies - 1][i].Extra, buffer);
     }
 }
@@ -1687,14 +1773,15 @@ WriteRolloutContext(FILE * pf, rolloutcontext * prc)
 
     int i;
 
-    fprintf(pf, "RC %u %u %u %u %u %u %u %u %u %u \"%s\" %lu ",
+    fprintf(pf, "RC %u %u %u %u %u %u %u %u %u %u \"%s\" %lu %u ",
             prc->fCubeful,
             prc->fVarRedn,
             prc->fInitial,
             prc->fRotate,
             prc->fLateEvals,
             prc->fDoTruncate,
-            prc->nTruncate, prc->fTruncBearoff2, prc->fTruncBearoffOS, prc->nLate, aszRNG[prc->rngRollout], prc->nSeed);
+            prc->nTruncate, prc->fTruncBearoff2, prc->fTruncBearoffOS, prc->nLate, aszRNG[prc->rngRollout], prc->nSeed,
+            prc->fTruncOSR);
 
     for (i = 0; i < 2; i++) {
         fprintf(pf, " cube%d ", i);
@@ -1800,14 +1887,14 @@ WriteDoubleAnalysis(FILE * pf,
 
     switch (pes->et) {
     case EVAL_EVAL:
-        g_ascii_formatd(buffer, sizeof(buffer), "%.6f", pes->ec.rNoise);
+        SGFFormatFloat(buffer, pes->ec.rNoise, 6);
         fprintf(pf, "E ver %d %u%s %u %s %u %u",
                 SGF_FORMAT_VER,
                 pes->ec.nPlies, pes->ec.fCubeful ? "C" : "", pes->ec.fDeterministic, buffer, pes->ec.fUsePrune, pes->ec.fAutoRollout);
 
         for (i = 0; i < 2; i++) {
             for (j = 0; j < 7; j++) {
-                g_ascii_formatd(buffer, sizeof(buffer), "%.6f", aarOutput[i][j]);
+                SGFFormatFloat(buffer, aarOutput[i][j], 6);
                 fprintf(pf, " %s", buffer);
             }
         }
@@ -1870,19 +1957,19 @@ WriteMoveAnalysis(FILE * pf, int fPlayer, movelist * pml, unsigned int iMove)
             break;
 
         case EVAL_EVAL:
-            g_ascii_formatd(buffer, sizeof(buffer), "%.6f", pml->amMoves[i].arEvalMove[0]);
+            SGFFormatFloat(buffer, pml->amMoves[i].arEvalMove[0], 6);
             fprintf(pf, "E ver %d %s ", SGF_FORMAT_VER, buffer);
-            g_ascii_formatd(buffer, sizeof(buffer), "%.6f", pml->amMoves[i].arEvalMove[1]);
+            SGFFormatFloat(buffer, pml->amMoves[i].arEvalMove[1], 6);
             fprintf(pf, "%s ", buffer);
-            g_ascii_formatd(buffer, sizeof(buffer), "%.6f", pml->amMoves[i].arEvalMove[2]);
+            SGFFormatFloat(buffer, pml->amMoves[i].arEvalMove[2], 6);
             fprintf(pf, "%s ", buffer);
-            g_ascii_formatd(buffer, sizeof(buffer), "%.6f", pml->amMoves[i].arEvalMove[3]);
+            SGFFormatFloat(buffer, pml->amMoves[i].arEvalMove[3], 6);
             fprintf(pf, "%s ", buffer);
-            g_ascii_formatd(buffer, sizeof(buffer), "%.6f", pml->amMoves[i].arEvalMove[4]);
+            SGFFormatFloat(buffer, pml->amMoves[i].arEvalMove[4], 6);
             fprintf(pf, "%s ", buffer);
-            g_ascii_formatd(buffer, sizeof(buffer), "%.6f", pml->amMoves[i].rScore);
+            SGFFormatFloat(buffer, pml->amMoves[i].rScore, 6);
             fprintf(pf, "%s ", buffer);
-            g_ascii_formatd(buffer, sizeof(buffer), "%.6f", pml->amMoves[i].esMove.ec.rNoise);
+            SGFFormatFloat(buffer, pml->amMoves[i].esMove.ec.rNoise, 6);
             fprintf(pf, "%u%s %d %u %s %u %u",
                     pml->amMoves[i].esMove.ec.nPlies,
                     pml->amMoves[i].esMove.ec.fCubeful ? "C" : "",
@@ -1937,7 +2024,7 @@ WriteLuck(FILE * pf, int fPlayer, float rLuck, lucktype lt)
 {
     gchar buffer[G_ASCII_DTOSTR_BUF_SIZE];
     if (rLuck != ERR_VAL) {
-        g_ascii_formatd(buffer, sizeof(buffer), "%.5f", rLuck);
+        SGFFormatFloat(buffer, rLuck, 5);
         fprintf(pf, "LU[%s]", buffer);
     }
 
@@ -2023,13 +2110,13 @@ WriteStatContext(FILE * pf, statcontext * psc)
                 psc->anUnforcedMoves[1], psc->anTotalMoves[0], psc->anTotalMoves[1]);
         for (st = SKILL_VERYBAD; st <= SKILL_NONE; st++)
             fprintf(pf, "%d %d ", psc->anMoves[0][st], psc->anMoves[1][st]);
-        g_ascii_formatd(buffer, sizeof(buffer), "%.6f", psc->arErrorCheckerplay[0][0]);
+        SGFFormatFloat(buffer, psc->arErrorCheckerplay[0][0], 6);
         fprintf(pf, "%s ", buffer);
-        g_ascii_formatd(buffer, sizeof(buffer), "%.6f", psc->arErrorCheckerplay[0][1]);
+        SGFFormatFloat(buffer, psc->arErrorCheckerplay[0][1], 6);
         fprintf(pf, "%s ", buffer);
-        g_ascii_formatd(buffer, sizeof(buffer), "%.6f", psc->arErrorCheckerplay[1][0]);
+        SGFFormatFloat(buffer, psc->arErrorCheckerplay[1][0], 6);
         fprintf(pf, "%s ", buffer);
-        g_ascii_formatd(buffer, sizeof(buffer), "%.6f", psc->arErrorCheckerplay[1][1]);
+        SGFFormatFloat(buffer, psc->arErrorCheckerplay[1][1], 6);
         fprintf(pf, "%s]", buffer);
     }
 
@@ -2045,53 +2132,53 @@ WriteStatContext(FILE * pf, statcontext * psc)
                 psc->anCubeWrongDoubleDP[0], psc->anCubeWrongDoubleDP[1],
                 psc->anCubeWrongDoubleTG[0], psc->anCubeWrongDoubleTG[1],
                 psc->anCubeWrongTake[0], psc->anCubeWrongTake[1], psc->anCubeWrongPass[0], psc->anCubeWrongPass[1]);
-        g_ascii_formatd(buffer, sizeof(buffer), "%.6f", psc->arErrorMissedDoubleDP[0][0]);
+        SGFFormatFloat(buffer, psc->arErrorMissedDoubleDP[0][0], 6);
         fprintf(pf, "%s ", buffer);
-        g_ascii_formatd(buffer, sizeof(buffer), "%.6f", psc->arErrorMissedDoubleDP[0][1]);
+        SGFFormatFloat(buffer, psc->arErrorMissedDoubleDP[0][1], 6);
         fprintf(pf, "%s ", buffer);
-        g_ascii_formatd(buffer, sizeof(buffer), "%.6f", psc->arErrorMissedDoubleTG[0][0]);
+        SGFFormatFloat(buffer, psc->arErrorMissedDoubleTG[0][0], 6);
         fprintf(pf, "%s ", buffer);
-        g_ascii_formatd(buffer, sizeof(buffer), "%.6f", psc->arErrorMissedDoubleTG[0][1]);
+        SGFFormatFloat(buffer, psc->arErrorMissedDoubleTG[0][1], 6);
         fprintf(pf, "%s ", buffer);
-        g_ascii_formatd(buffer, sizeof(buffer), "%.6f", psc->arErrorWrongDoubleDP[0][0]);
+        SGFFormatFloat(buffer, psc->arErrorWrongDoubleDP[0][0], 6);
         fprintf(pf, "%s ", buffer);
-        g_ascii_formatd(buffer, sizeof(buffer), "%.6f", psc->arErrorWrongDoubleDP[0][1]);
+        SGFFormatFloat(buffer, psc->arErrorWrongDoubleDP[0][1], 6);
         fprintf(pf, "%s ", buffer);
-        g_ascii_formatd(buffer, sizeof(buffer), "%.6f", psc->arErrorWrongDoubleTG[0][0]);
+        SGFFormatFloat(buffer, psc->arErrorWrongDoubleTG[0][0], 6);
         fprintf(pf, "%s ", buffer);
-        g_ascii_formatd(buffer, sizeof(buffer), "%.6f", psc->arErrorWrongDoubleTG[0][1]);
+        SGFFormatFloat(buffer, psc->arErrorWrongDoubleTG[0][1], 6);
         fprintf(pf, "%s ", buffer);
-        g_ascii_formatd(buffer, sizeof(buffer), "%.6f", psc->arErrorWrongTake[0][0]);
+        SGFFormatFloat(buffer, psc->arErrorWrongTake[0][0], 6);
         fprintf(pf, "%s ", buffer);
-        g_ascii_formatd(buffer, sizeof(buffer), "%.6f", psc->arErrorWrongTake[0][1]);
+        SGFFormatFloat(buffer, psc->arErrorWrongTake[0][1], 6);
         fprintf(pf, "%s ", buffer);
-        g_ascii_formatd(buffer, sizeof(buffer), "%.6f", psc->arErrorWrongPass[0][0]);
+        SGFFormatFloat(buffer, psc->arErrorWrongPass[0][0], 6);
         fprintf(pf, "%s ", buffer);
-        g_ascii_formatd(buffer, sizeof(buffer), "%.6f", psc->arErrorWrongPass[0][1]);
+        SGFFormatFloat(buffer, psc->arErrorWrongPass[0][1], 6);
         fprintf(pf, "%s ", buffer);
-        g_ascii_formatd(buffer, sizeof(buffer), "%.6f", psc->arErrorMissedDoubleDP[1][0]);
+        SGFFormatFloat(buffer, psc->arErrorMissedDoubleDP[1][0], 6);
         fprintf(pf, "%s ", buffer);
-        g_ascii_formatd(buffer, sizeof(buffer), "%.6f", psc->arErrorMissedDoubleDP[1][1]);
+        SGFFormatFloat(buffer, psc->arErrorMissedDoubleDP[1][1], 6);
         fprintf(pf, "%s ", buffer);
-        g_ascii_formatd(buffer, sizeof(buffer), "%.6f", psc->arErrorMissedDoubleTG[1][0]);
+        SGFFormatFloat(buffer, psc->arErrorMissedDoubleTG[1][0], 6);
         fprintf(pf, "%s ", buffer);
-        g_ascii_formatd(buffer, sizeof(buffer), "%.6f", psc->arErrorMissedDoubleTG[1][1]);
+        SGFFormatFloat(buffer, psc->arErrorMissedDoubleTG[1][1], 6);
         fprintf(pf, "%s ", buffer);
-        g_ascii_formatd(buffer, sizeof(buffer), "%.6f", psc->arErrorWrongDoubleDP[1][0]);
+        SGFFormatFloat(buffer, psc->arErrorWrongDoubleDP[1][0], 6);
         fprintf(pf, "%s ", buffer);
-        g_ascii_formatd(buffer, sizeof(buffer), "%.6f", psc->arErrorWrongDoubleDP[1][1]);
+        SGFFormatFloat(buffer, psc->arErrorWrongDoubleDP[1][1], 6);
         fprintf(pf, "%s ", buffer);
-        g_ascii_formatd(buffer, sizeof(buffer), "%.6f", psc->arErrorWrongDoubleTG[1][0]);
+        SGFFormatFloat(buffer, psc->arErrorWrongDoubleTG[1][0], 6);
         fprintf(pf, "%s ", buffer);
-        g_ascii_formatd(buffer, sizeof(buffer), "%.6f", psc->arErrorWrongDoubleTG[1][1]);
+        SGFFormatFloat(buffer, psc->arErrorWrongDoubleTG[1][1], 6);
         fprintf(pf, "%s ", buffer);
-        g_ascii_formatd(buffer, sizeof(buffer), "%.6f", psc->arErrorWrongTake[1][0]);
+        SGFFormatFloat(buffer, psc->arErrorWrongTake[1][0], 6);
         fprintf(pf, "%s ", buffer);
-        g_ascii_formatd(buffer, sizeof(buffer), "%.6f", psc->arErrorWrongTake[1][1]);
+        SGFFormatFloat(buffer, psc->arErrorWrongTake[1][1], 6);
         fprintf(pf, "%s ", buffer);
-        g_ascii_formatd(buffer, sizeof(buffer), "%.6f", psc->arErrorWrongPass[1][0]);
+        SGFFormatFloat(buffer, psc->arErrorWrongPass[1][0], 6);
         fprintf(pf, "%s ", buffer);
-        g_ascii_formatd(buffer, sizeof(buffer), "%.6f", psc->arErrorWrongPass[1][1]);
+        SGFFormatFloat(buffer, psc->arErrorWrongPass[1][1], 6);
         fprintf(pf, "%s]", buffer);
     }
 
@@ -2099,13 +2186,13 @@ WriteStatContext(FILE * pf, statcontext * psc)
         fputs("[D:", pf);
         for (lt = LUCK_VERYBAD; lt <= LUCK_VERYGOOD; lt++)
             fprintf(pf, "%d %d ", psc->anLuck[0][lt], psc->anLuck[1][lt]);
-        g_ascii_formatd(buffer, sizeof(buffer), "%.6f", psc->arLuck[0][0]);
+        SGFFormatFloat(buffer, psc->arLuck[0][0], 6);
         fprintf(pf, "%s ", buffer);
-        g_ascii_formatd(buffer, sizeof(buffer), "%.6f", psc->arLuck[0][1]);
+        SGFFormatFloat(buffer, psc->arLuck[0][1], 6);
         fprintf(pf, "%s ", buffer);
-        g_ascii_formatd(buffer, sizeof(buffer), "%.6f", psc->arLuck[1][0]);
+        SGFFormatFloat(buffer, psc->arLuck[1][0], 6);
         fprintf(pf, "%s ", buffer);
-        g_ascii_formatd(buffer, sizeof(buffer), "%.6f", psc->arLuck[1][1]);
+        SGFFormatFloat(buffer, psc->arLuck[1][1], 6);
         fprintf(pf, "%s]", buffer);
     }
 }
@@ -2393,7 +2480,8 @@ CommandSaveGame(char *sz)
     else if (!(pf = g_fopen(sz, "w"))) {
         outputerr(sz);
         return;
-    }
+    } else
+        setvbuf(pf, NULL, _IOFBF, SGF_WRITE_BUFFER);
 
     SaveGame(pf, plGame);
 
@@ -2435,7 +2523,8 @@ CommandSaveMatch(char *sz)
     } else if (!(pf = g_fopen(sz, "w"))) {
         outputerr(sz);
         return;
-    }
+    } else
+        setvbuf(pf, NULL, _IOFBF, SGF_WRITE_BUFFER);
 
     for (pl = lMatch.plNext; pl != &lMatch; pl = pl->plNext)
         SaveGame(pf, pl->p);
@@ -39,9 +39,23 @@ extern void (*SGFErrorHandler) (const char *szMessage, int fParseError);
  * Nodes consist of yet MORE lists; each element is a "property" struct
  * as defined above.
  * 
- * If there are any errors in the file, SGFParse calls SGFErrorHandler
- * (if set), or complains to stderr (otherwise). */
-extern listOLD *SGFParse(FILE * pf);
+ * If there are any errors in the file, SGFRead calls SGFErrorHandler
+ * (if set), or complains to stderr (otherwise).
+ *
+ * SGFReadHeaders keeps only the root node of every game tree, which holds
+ * the match information, result and game statistics, and skips the moves
+ * and variations. */
+extern listOLD *SGFRead(FILE * pf);
+extern listOLD *SGFReadHeaders(FILE * pf);
+
+/* Fast equivalents of (float) g_ascii_strtod() and of g_ascii_formatd()
+ * with "%.<nDecimals>f" (nDecimals <= 6) for the numbers in SGF files;
+ * sz must hold G_ASCII_DTOSTR_BUF_SIZE characters. */
+extern float SGFReadFloat(const char *sz, char **ppchEnd);
+extern char *SGFFormatFloat(char *sz, float r, int nDecimals);
+
+/* stdio buffer size for writing SGF files */
+#define SGF_WRITE_BUFFER 65536
 
 /* The following properties are defined for GNU Backgammon SGF files:
  * 
@@ -0,0 +1,416 @@
+/*
+ * Copyright (C) 2026 the AUTHORS
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * $Id$
+ */
+
+/*
+ * Hand-written streaming SGF reader, and fast float conversion for the
+ * SGF reader and writer.
+ *
+ * SGFRead() builds the syntax tree described in sgf.h. It reads the file
+ * through one large buffer and collects each property value in a single
+ * scratch buffer, so that every value costs one allocation. SGFReadHeaders() only keeps the root node of each
+ * game and skips the moves and variations without allocating anything.
+ */
+
+#include "config.h"
+#include "common.h"
+
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sgf.h"
+
+#define SGF_READ_BUFFER 65536
+
+void (*SGFErrorHandler) (const char *, int) = NULL;
+
+typedef struct {
+    FILE *pf;
+    size_t i, n;
+    int chPending;              /* character pushed back, or EOF */
+    GString *gsValue;           /* scratch buffer for property values */
+    char ach[SGF_READ_BUFFER];
+} sgfreader;
+
+static void
+ReadError(const char *sz)
+{
+    if (SGFErrorHandler)
+        SGFErrorHandler(sz, TRUE);
+    else
+        fprintf(stderr, "%s\n", sz);
+}
+
+static inline int
+ReadChar(sgfreader * psr)
+{
+    int ch;
+
+    if ((ch = psr->chPending) != EOF) {
+        psr->chPending = EOF;
+        return ch;
+    }
+
+    if (psr->i == psr->n) {
+        psr->n = fread(psr->ach, 1, sizeof(psr->ach), psr->pf);
+        psr->i = 0;
+        if (!psr->n)
+            return EOF;
+    }
+
+    return (unsigned char) psr->ach[psr->i++];
+}
+
+static inline void
+UnreadChar(sgfreader * psr, int ch)
+{
+    psr->chPending = ch;
+}
+
+static int
+ReadNonSpace(sgfreader * psr)
+{
+    int ch;
+
+    while ((ch = ReadChar(psr)) != EOF && g_ascii_isspace(ch));
+
+    return ch;
+}
+
+static listOLD *
+NewList(void)
+{
+    listOLD *pl = g_malloc(sizeof(listOLD));
+
+    ListCreate(pl);
+    return pl;
+}
+
+/* Read a value after its opening bracket. Escapes are handled as by the
+ * flex lexer: "\]" becomes "]", an escaped newline is dropped and any other
+ * escape is kept for CopyEscapedString() in sgf.c. Returns the value, or
+ * NULL if fStore is FALSE. */
+static char *
+ReadValue(sgfreader * psr, int fStore)
+{
+    GString *gs = psr->gsValue;
+    int ch;
+
+    g_string_truncate(gs, 0);
+
+    while ((ch = ReadChar(psr)) != ']') {
+        if (ch == EOF) {
+            ReadError(_("unexpected end of file in SGF value"));
+            break;
+        } else if (ch == '\\') {
+            ch = ReadChar(psr);
+            if (ch == EOF)
+                continue;
+            else if (ch == ']' || ch == '\n') {
+                if (fStore && ch == ']')
+                    g_string_append_c(gs, ']');
+            } else if (fStore) {
+                g_string_append_c(gs, '\\');
+                if (ch)
+                    g_string_append_c(gs, (gchar) ch);
+            }
+        } else if (fStore && ch)
+            g_string_append_c(gs, (gchar) ch);
+    }
+
+    return fStore ? g_strndup(gs->str, gs->len) : NULL;
+}
+
+/* Read the properties of a node after its ';'. Returns the node, or NULL
+ * if fStore is FALSE. */
+static listOLD *
+ReadNode(sgfreader * psr, int fStore)
+{
+    listOLD *plNode = fStore ? NewList() : NULL;
+    int ch;
+
+    while ((ch = ReadNonSpace(psr)) != EOF) {
+        property *pp;
+        char ach[2] = { 0, 0 };
+        int cUpper = 0;
+
+        if (!g_ascii_isalpha(ch)) {
+            UnreadChar(psr, ch);
+            break;
+        }
+
+        /* property identifier: the upper case letters count */
+        do {
+            if (g_ascii_isupper(ch) && cUpper < 2)
+                ach[cUpper++] = (char) ch;
+        } while ((ch = ReadChar(psr)) != EOF && g_ascii_isalpha(ch));
+
+        if (!cUpper) {
+            /* lower case words are ignored, as by the flex lexer */
+            UnreadChar(psr, ch);
+            continue;
+        }
+
+        if (g_ascii_isspace(ch))
+            ch = ReadNonSpace(psr);
+
+        if (ch != '[') {
+            UnreadChar(psr, ch);
+            ReadError(_("SGF property without value"));
+            continue;
+        }
+
+        pp = NULL;
+        if (fStore) {
+            pp = g_malloc(sizeof(property));
+            pp->ach[0] = ach[0];
+            pp->ach[1] = ach[1];
+            pp->pl = NewList();
+            ListInsert(plNode, pp);
+        }
+
+        do {
+            char *sz = ReadValue(psr, fStore);
+
+            if (pp)
+                ListInsert(pp->pl, sz);
+        } while ((ch = ReadNonSpace(psr)) == '[');
+
+        UnreadChar(psr, ch);
+    }
+
+    return plNode;
+}
+
+static void
+FreeNode(listOLD * plNode)
+{
+    while (!ListEmpty(plNode)) {
+        property *pp = plNode->plNext->p;
+
+        while (!ListEmpty(pp->pl)) {
+            free(pp->pl->plNext->p);
+            ListDelete(pp->pl->plNext);
+        }
+        free(pp->pl);
+        free(pp);
+        ListDelete(plNode->plNext);
+    }
+    free(plNode);
+}
+
+static void FreeGameTree(listOLD * plTree);
+
+static void
+FreeGameTreeSeqRead(listOLD * pl)
+{
+    while (!ListEmpty(pl)) {
+        FreeGameTree(pl->plNext->p);
+        ListDelete(pl->plNext);
+    }
+    free(pl);
+}
+
+static void
+FreeGameTree(listOLD * plTree)
+{
+    listOLD *plSeq = plTree->plNext->p;
+
+    while (!ListEmpty(plSeq)) {
+        FreeNode(plSeq->plNext->p);
+        ListDelete(plSeq->plNext);
+    }
+    free(plSeq);
+    ListDelete(plTree->plNext);
+
+    FreeGameTreeSeqRead(plTree);
+}
+
+/* Read a game tree after its '('. With fHeaders, only the first node of
+ * the main sequence is kept; fStore is FALSE for trees that are skipped
+ * altogether. Returns NULL when nothing was stored. */
+static listOLD *
+ReadGameTree(sgfreader * psr, int fStore, int fHeaders)
+{
+    listOLD *plTree = NULL, *plSeq = NULL;
+    int ch;
+
+    if (fStore) {
+        plTree = NewList();
+        plSeq = NewList();
+        ListInsert(plTree, plSeq);
+    }
+
+    for (;;) {
+        ch = ReadNonSpace(psr);
+
+        if (ch == ';') {
+            int fStoreNode = fStore && (!fHeaders || ListEmpty(plSeq));
+            listOLD *plNode = ReadNode(psr, fStoreNode);
+
+            if (plNode)
+                ListInsert(plSeq, plNode);
+        } else if (ch == '(') {
+            listOLD *plVar = ReadGameTree(psr, fStore && !fHeaders, fHeaders);
+
+            if (plVar)
+                ListInsert(plTree, plVar);
+        } else if (ch == ')')
+            break;
+        else if (ch == EOF) {
+            ReadError(_("unexpected end of file in SGF game tree"));
+            break;
+        } else
+            ReadError(_("illegal character in SGF file"));
+    }
+
+    if (plTree && ListEmpty(plSeq)) {
+        /* a game tree must start with a node */
+        ReadError(_("empty SGF game tree"));
+        FreeGameTree(plTree);
+        plTree = NULL;
+    }
+
+    return plTree;
+}
+
+static listOLD *
+ReadCollection(FILE * pf, int fHeaders)
+{
+    sgfreader *psr = g_malloc(sizeof(sgfreader));
+    listOLD *plCollection = NewList();
+    int ch;
+
+    psr->pf = pf;
+    psr->i = psr->n = 0;
+    psr->chPending = EOF;
+    psr->gsValue = g_string_sized_new(1024);
+
+    while ((ch = ReadNonSpace(psr)) != EOF) {
+        if (ch == '(') {
+            listOLD *plTree = ReadGameTree(psr, TRUE, fHeaders);
+
+            if (plTree)
+                ListInsert(plCollection, plTree);
+        } else
+            ReadError(_("illegal character in SGF file"));
+    }
+
+    g_string_free(psr->gsValue, TRUE);
+    g_free(psr);
+
+    return plCollection;
+}
+
+extern listOLD *
+SGFRead(FILE * pf)
+{
+    return ReadCollection(pf, FALSE);
+}
+
+extern listOLD *
+SGFReadHeaders(FILE * pf)
+{
+    return ReadCollection(pf, TRUE);
+}
+
+static const double arPow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/* Same result as (float) g_ascii_strtod(), without the locale handling
+ * and the general case of strtod() for the plain decimals written by
+ * SaveGame(). Up to 15 digits and 22 decimals, both the mantissa and the
+ * power of ten are exact doubles and one division is correctly rounded. */
+extern float
+SGFReadFloat(const char *sz, char **ppchEnd)
+{
+    const char *pch = sz;
+    guint64 n = 0;
+    int cDigits = 0, cDecimals = 0, fNegative = FALSE;
+    double r;
+
+    while (g_ascii_isspace(*pch))
+        pch++;
+
+    if (*pch == '-' || *pch == '+')
+        fNegative = *pch++ == '-';
+
+    for (; g_ascii_isdigit(*pch); pch++, cDigits++)
+        n = 10 * n + (guint64) (*pch - '0');
+
+    if (*pch == '.')
+        for (pch++; g_ascii_isdigit(*pch); pch++, cDigits++, cDecimals++)
+            n = 10 * n + (guint64) (*pch - '0');
+
+    if (!cDigits || cDigits > 15 || cDecimals > 22 || *pch == 'e' || *pch == 'E'
+        || *pch == 'x' || *pch == 'X')
+        return (float) g_ascii_strtod(sz, ppchEnd);
+
+    r = (double) n / arPow10[cDecimals];
+
+    if (ppchEnd)
+        *ppchEnd = (char *) pch;
+
+    return (float) (fNegative ? -r : r);
+}
+
+/* Same output as g_ascii_formatd() with "%.<nDecimals>f" for nDecimals up
+ * to 6. The float times the power of ten is exact in a double, so rounding
+ * it to an integer in the current rounding mode matches printf(). */
+extern char *
+SGFFormatFloat(char *sz, float r, int nDecimals)
+{
+    static const char *aszFormat[] = { "%.0f", "%.1f", "%.2f", "%.3f", "%.4f", "%.5f", "%.6f" };
+    double x;
+    guint64 n, nScale;
+    char *pch = sz;
+    int i;
+
+    g_assert(nDecimals >= 0 && nDecimals <= 6);
+
+    x = fabs((double) r) * arPow10[nDecimals];
+    if (!isfinite(x) || x >= 1e15)
+        return g_ascii_formatd(sz, G_ASCII_DTOSTR_BUF_SIZE, aszFormat[nDecimals], r);
+
+    n = (guint64) nearbyint(x);
+    nScale = (guint64) arPow10[nDecimals];
+
+    if (signbit(r))
+        *pch++ = '-';
+
+    pch += sprintf(pch, "%" G_GUINT64_FORMAT, n / nScale);
+
+    if (nDecimals) {
+        n %= nScale;
+        *pch++ = '.';
+        for (i = nDecimals - 1; i >= 0; i--) {
+            pch[i] = (char) ('0' + n % 10);
+            n /= 10;
+        }
+        pch += nDecimals;
+    }
+    *pch = 0;
+
+    return sz;
+}
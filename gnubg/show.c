@@ -39,6 +39,7 @@
 #include "matchequity.h"
 #include "matchid.h"
 #include "sound.h"
+#include "openingbook.h"
 #include "osr.h"
 #include "positionid.h"
 #include "boarddim.h"
@@ -250,6 +251,11 @@ ShowRollout(rolloutcontext * prc)
               "one-sided bearoff database.") :
             _("Will not truncate *cubeless* rollouts when reaching " "one-sided bearoff database."));
 
+    outputl(prc->fTruncOSR ?
+            _("Will truncate *cubeless* rollouts at race positions "
+              "with a one-sided rollout.") :
+            _("Will not truncate *cubeless* rollouts at race positions " "with a one-sided rollout."));
+
     outputl(prc->fVarRedn ?
             _("Lookahead variance reduction is enabled.") : _("Lookahead variance reduction is disabled."));
     outputl(prc->fRotate ? _("Quasi-random dice are enabled.") : _("Quasi-random dice are disabled."));
@@ -386,6 +392,9 @@ CommandShowAnalysis(char *UNUSED(sz))
     } else
         outputl(_("Chequer play will not be analysed."));
 
+    if (fAnalyseIncremental)
+        outputl(_("Moves already analysed with the current settings will be skipped."));
+
     outputl("");
     for (i = 0; i < 2; ++i)
         outputf(_("Analyse %s's chequerplay and cube decisions: %s\n"),
@@ -1155,7 +1164,14 @@ extern void
 CommandShowThreads(char *UNUSED(sz))
 {
     int c = MT_GetNumThreads();
+    unsigned int cStarted, cShared;
+
     outputf(ngettext("%d calculation thread.\n", "%d calculation threads.\n", c), c);
+
+    EvalInFlightStats(&cStarted, &cShared);
+    if (cStarted || cShared)
+        outputf(_("Since the last hint or evaluation, %u deep evaluations were computed "
+                  "and %u were shared with the thread already computing them.\n"), cStarted, cShared);
 }
 #endif
 
@@ -1524,6 +1540,19 @@ CommandShowMatchEquityTable(char *sz)
 
 }
 
+extern void
+CommandShowOpeningBook(char *UNUSED(sz))
+{
+    if (BookFile())
+        outputf(_("Opening book `%s' (%u positions).\n"), BookFile(), BookEntries());
+    else
+        outputl(_("No opening book is loaded (see `help save openingbook')."));
+
+    outputl(fUseOpeningBook ?
+            _("The opening book is used for move analysis and hints in the early game.") :
+            _("The opening book is not used."));
+}
+
 extern void
 CommandShowOutput(char *UNUSED(sz))
 {
@@ -1560,6 +1589,8 @@ CommandShowVersion(char *UNUSED(sz))
     outputl(gettext(VERSION_STRING));
     outputc('\n');
     ShowAuthors(ceAuthors, _("AUTHORS"));
+    outputc('\n');
+    ShowStartupTimes();
 }
 
 extern void
@@ -2138,6 +2169,176 @@ CommandShowTemperatureMap(char *sz)
 
 }
 
+static int
+ScoreMapLength(char *sz)
+{
+    /* as the default "variable" length of the ScoreMap window */
+    int n = ParseNumber(&sz);
+
+    if (n >= 2)
+        return MIN(n, MAXSCORE);
+    else if (ms.nMatchTo > 0 && ms.nMatchTo <= 3)
+        return 3;
+    else if (ms.nMatchTo >= 7)
+        return 7;
+    else
+        return 5;
+}
+
+/* Sets aci[] to the away scores 2..n for both players, the player on roll
+ * first, with the current cube. Returns the number of scores. */
+static int
+ScoreMapCubeInfos(cubeinfo aci[], int n)
+{
+    int i, j, c = 0;
+
+    for (i = 2; i <= n; i++)
+        for (j = 2; j <= n; j++) {
+            int anScore[2];
+
+            anScore[ms.fMove] = n - i;
+            anScore[!ms.fMove] = n - j;
+            SetCubeInfo(&aci[c++], ms.nCube, ms.fCubeOwner, ms.fMove, n, anScore, FALSE, ms.fJacoby, nBeavers,
+                        ms.bgv);
+        }
+
+    return c;
+}
+
+static void
+ShowScoreMapHeader(const char *szWhat, int n, const evalcontext * pec)
+{
+    int j;
+
+    outputf(_("%s for %s at %d-ply, by away score (rows: %s, columns: %s)\n"), szWhat, ap[ms.fMove].szName,
+            pec->nPlies, ap[ms.fMove].szName, ap[!ms.fMove].szName);
+    output("       ");
+    for (j = 2; j <= n; j++)
+        outputf(" %6d", j);
+    output("\n");
+}
+
+static const char *
+ScoreMapCubeDecision(float rND, float rDT)
+{
+    /* as DecisionVal() in gtkscoremap.c */
+    if (rND < MIN(rDT, 1.0f))
+        return rDT < 1.0f ? "D/T" : "D/P";
+    else
+        return rDT < 1.0f ? "ND" : "TG";
+}
+
+static void
+ShowScoreMapCube(int n)
+{
+    const evalcontext *pec = &GetEvalCube()->ec;
+    cubeinfo *aci = g_new(cubeinfo, (n - 1) * (n - 1));
+    float (*aaarOutput)[2][NUM_ROLLOUT_OUTPUTS] = g_malloc((n - 1) * (n - 1) * sizeof(*aaarOutput));
+    float aarMoney[2][NUM_ROLLOUT_OUTPUTS];
+    cubeinfo ciMoney;
+    int c, i, j;
+
+    c = ScoreMapCubeInfos(aci, n);
+    GetMoneyCubeInfo(&ciMoney, &ms);
+
+    ProgressStart(_("Evaluating cube decisions at all scores..."));
+    if (GeneralCubeDecisionEMulti(aaarOutput, msBoard(), aci, c, pec) < 0
+        || (GetDPEq(NULL, NULL, &ciMoney) && GeneralCubeDecisionE(aarMoney, msBoard(), &ciMoney, pec, NULL) < 0)) {
+        ProgressEnd();
+        g_free(aaarOutput);
+        g_free(aci);
+        return;
+    }
+    ProgressEnd();
+
+    ShowScoreMapHeader(_("Cube decisions"), n, pec);
+    for (i = 2, c = 0; i <= n; i++) {
+        outputf(" %6d", i);
+        for (j = 2; j <= n; j++, c++)
+            if (GetDPEq(NULL, NULL, &aci[c]))
+                outputf(" %6s", ScoreMapCubeDecision(mwc2eq(aaarOutput[c][0][OUTPUT_CUBEFUL_EQUITY], &aci[c]),
+                                                     mwc2eq(aaarOutput[c][1][OUTPUT_CUBEFUL_EQUITY], &aci[c])));
+            else
+                outputf(" %6s", "-");
+        output("\n");
+    }
+
+    if (GetDPEq(NULL, NULL, &ciMoney))
+        outputf(_("Money: %s\n"), ScoreMapCubeDecision(aarMoney[0][OUTPUT_CUBEFUL_EQUITY],
+                                                       aarMoney[1][OUTPUT_CUBEFUL_EQUITY]));
+    else
+        outputf(_("Money: %s\n"), "-");
+
+    g_free(aaarOutput);
+    g_free(aci);
+}
+
+static void
+ShowScoreMapMove(int n)
+{
+    const evalcontext *pec = &GetEvalChequer()->ec;
+    cubeinfo *aci = g_new(cubeinfo, (n - 1) * (n - 1) + 1);
+    movelist *aml = g_new(movelist, (n - 1) * (n - 1) + 1);
+    char (*aszMove)[FORMATEDMOVESIZE] = g_malloc(((n - 1) * (n - 1) + 1) * sizeof(*aszMove));
+    int *aiMove = g_new(int, (n - 1) * (n - 1) + 1);
+    int c, cMoves = 0, i, j, k;
+
+    c = ScoreMapCubeInfos(aci, n);
+
+    ProgressStart(_("Evaluating moves at all scores..."));
+    if (FindnSaveBestMovesMulti(aml, c, ms.anDice[0], ms.anDice[1], msBoard(), aci, pec, *GetEvalMoveFilter()) < 0) {
+        ProgressEnd();
+        goto done;
+    }
+    /* money play can't share the walk of the match scores */
+    GetMoneyCubeInfo(&aci[c], &ms);
+    if (FindnSaveBestMovesMulti(aml + c, 1, ms.anDice[0], ms.anDice[1], msBoard(), aci + c, pec,
+                                *GetEvalMoveFilter()) < 0) {
+        ProgressEnd();
+        for (k = 0; k < c; k++)
+            g_free(aml[k].amMoves);
+        goto done;
+    }
+    ProgressEnd();
+
+    /* number the distinct best moves */
+    for (k = 0; k <= c; k++) {
+        char sz[FORMATEDMOVESIZE];
+
+        if (!aml[k].cMoves) {
+            outputl(_("There are no legal moves."));
+            for (i = k; i <= c; i++)
+                g_free(aml[i].amMoves);
+            goto done;
+        }
+
+        FormatMove(sz, msBoard(), aml[k].amMoves[0].anMove);
+        for (i = 0; i < cMoves && strcmp(sz, aszMove[i]); i++);
+        if (i == cMoves)
+            strcpy(aszMove[cMoves++], sz);
+        aiMove[k] = i;
+        g_free(aml[k].amMoves);
+    }
+
+    ShowScoreMapHeader(_("Best moves"), n, pec);
+    for (i = 2, k = 0; i <= n; i++) {
+        outputf(" %6d", i);
+        for (j = 2; j <= n; j++, k++)
+            outputf(" %6d", aiMove[k] + 1);
+        output("\n");
+    }
+    outputf(_("Money: %d\n\n"), aiMove[c] + 1);
+
+    for (i = 0; i < cMoves; i++)
+        outputf("%3d. %s\n", i + 1, aszMove[i]);
+
+  done:
+    g_free(aiMove);
+    g_free(aszMove);
+    g_free(aml);
+    g_free(aci);
+}
+
 // defined in backgammon.h
 extern void
 CommandShowScoreMap(char *sz)
@@ -2192,10 +2393,22 @@ CommandShowScoreMap(char *sz)
         }
         return;
     }
-#else
-    (void) sz;                  /* suppress unused parameter compiler warning */
 #endif
-    CommandNotImplemented(NULL);
+
+    /* text mode: a table of the decisions at the away scores 2..n */
+    if (sz && *sz && !strncmp(sz, "=move", 5)) {
+        if (ms.anDice[0] <= 0) {
+            outputl(_("You must roll the dice before you can move."));
+            return;
+        }
+        ShowScoreMapMove(ScoreMapLength(sz + 5));
+    } else {
+        if (ms.anDice[0] > 0) {
+            outputl(_("You can't double after rolling the dice -- wait until your " "next turn."));
+            return;
+        }
+        ShowScoreMapCube(ScoreMapLength(sz));
+    }
 }
 
 extern void
@@ -2247,10 +2460,10 @@ show_bearoff(TanBoard an, char *szTemp)
     switch (ms.bgv) {
     case VARIATION_STANDARD:
     case VARIATION_NACKGAMMON:
-        if (isBearoff(pbcTS, (ConstTanBoard) an)) {
-            BearoffDump(pbcTS, (ConstTanBoard) an, szTemp);
-        } else if (isBearoff(pbc2, (ConstTanBoard) an)) {
-            BearoffDump(pbc2, (ConstTanBoard) an, szTemp);
+        if (isBearoff(GetBearoff(BDB_TS), (ConstTanBoard) an)) {
+            BearoffDump(GetBearoff(BDB_TS), (ConstTanBoard) an, szTemp);
+        } else if (isBearoff(GetBearoff(BDB_2), (ConstTanBoard) an)) {
+            BearoffDump(GetBearoff(BDB_2), (ConstTanBoard) an, szTemp);
         } else
             strcpy(szTemp, _("Position not in any two-sided database\n"));
         break;
@@ -2259,8 +2472,8 @@ show_bearoff(TanBoard an, char *szTemp)
     case VARIATION_HYPERGAMMON_2:
     case VARIATION_HYPERGAMMON_3:
 
-        if (isBearoff(apbcHyper[ms.bgv - VARIATION_HYPERGAMMON_1], (ConstTanBoard) an)) {
-            BearoffDump(apbcHyper[ms.bgv - VARIATION_HYPERGAMMON_1], (ConstTanBoard) an, szTemp);
+        if (isBearoff(GetBearoff(BDB_HYPER1 + ms.bgv - VARIATION_HYPERGAMMON_1), (ConstTanBoard) an)) {
+            BearoffDump(GetBearoff(BDB_HYPER1 + ms.bgv - VARIATION_HYPERGAMMON_1), (ConstTanBoard) an, szTemp);
             outputl(szTemp);
         }
 